@@ -8,6 +8,8 @@ FBroadPhaseLayerInterfaceImpl::FBroadPhaseLayerInterfaceImpl()
 	// Create a mapping table from object to broad phase layer
 	mObjectToBroadPhase[Layers::NON_MOVING] = BroadPhaseLayers::NON_MOVING;
 	mObjectToBroadPhase[Layers::MOVING] = BroadPhaseLayers::MOVING;
+	mObjectToBroadPhase[Layers::GHOST] = BroadPhaseLayers::GHOST;
+	mObjectToBroadPhase[Layers::SENSOR] = BroadPhaseLayers::SENSOR;
 }
 
 uint FBroadPhaseLayerInterfaceImpl::GetNumBroadPhaseLayers() const
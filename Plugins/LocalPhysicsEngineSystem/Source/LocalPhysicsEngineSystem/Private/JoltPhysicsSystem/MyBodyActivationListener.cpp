@@ -5,10 +5,18 @@
 
 void FMyBodyActivationListener::OnBodyActivated(const BodyID& inBodyID, uint64 inBodyUserData)
 {
-	UE_LOG(LogTemp, Warning, TEXT("A body got activated"));
+	FPhysicsServiceEvent ActivationEvent;
+	ActivationEvent.EventType = EPhysicsServiceEventType::BodyActivated;
+	ActivationEvent.Body1 = inBodyID;
+
+	EventBuffer.PushEvent(ActivationEvent);
 }
 
 void FMyBodyActivationListener::OnBodyDeactivated(const BodyID& inBodyID, uint64 inBodyUserData)
 {
-	UE_LOG(LogTemp, Warning, TEXT("A body went to sleep"));
+	FPhysicsServiceEvent DeactivationEvent;
+	DeactivationEvent.EventType = EPhysicsServiceEventType::BodyDeactivated;
+	DeactivationEvent.Body1 = inBodyID;
+
+	EventBuffer.PushEvent(DeactivationEvent);
 }
@@ -13,7 +13,20 @@ ValidateResult FMyContactListener::OnContactValidate(const Body& inBody1, const
 
 void FMyContactListener::OnContactAdded(const Body& inBody1, const Body& inBody2, const ContactManifold& inManifold, ContactSettings& ioSettings)
 {
-	// UE_LOG(LogTemp, Warning, TEXT("A contact was added"));
+	FPhysicsServiceEvent ContactAddedEvent;
+	ContactAddedEvent.EventType = EPhysicsServiceEventType::ContactAdded;
+	ContactAddedEvent.Body1 = inBody1.GetID();
+	ContactAddedEvent.Body2 = inBody2.GetID();
+
+	// Use the first contact point of the manifold
+	Vec3(inManifold.GetWorldSpaceContactPointOn1(0)).StoreFloat3
+		(&ContactAddedEvent.ContactPoint);
+	inManifold.mWorldSpaceNormal.StoreFloat3(&ContactAddedEvent.ContactNormal);
+
+	ContactAddedEvent.ImpulseMagnitude = EstimateContactImpulse(inBody1,
+		inBody2, inManifold, ioSettings);
+
+	EventBuffer.PushEvent(ContactAddedEvent);
 }
 
 void FMyContactListener::OnContactPersisted(const Body& inBody1, const Body& inBody2, const ContactManifold& inManifold, ContactSettings& ioSettings)
@@ -23,5 +36,35 @@ void FMyContactListener::OnContactPersisted(const Body& inBody1, const Body& inB
 
 void FMyContactListener::OnContactRemoved(const SubShapeIDPair& inSubShapePair)
 {
-	// UE_LOG(LogTemp, Warning, TEXT("A contact was removed"));
+	FPhysicsServiceEvent ContactRemovedEvent;
+	ContactRemovedEvent.EventType = EPhysicsServiceEventType::ContactRemoved;
+	ContactRemovedEvent.Body1 = inSubShapePair.GetBody1ID();
+	ContactRemovedEvent.Body2 = inSubShapePair.GetBody2ID();
+
+	EventBuffer.PushEvent(ContactRemovedEvent);
+}
+
+float FMyContactListener::EstimateContactImpulse(const Body& inBody1, const Body& inBody2, const ContactManifold& inManifold, const ContactSettings& inSettings)
+{
+	// Get the inverse masses. Non-dynamic bodies have infinite mass
+	const float InverseMass1 = inBody1.IsDynamic() ?
+		inBody1.GetMotionProperties()->GetInverseMass() : 0.f;
+	const float InverseMass2 = inBody2.IsDynamic() ?
+		inBody2.GetMotionProperties()->GetInverseMass() : 0.f;
+
+	const float InverseMassSum = InverseMass1 + InverseMass2;
+	if (InverseMassSum <= 0.f)
+	{
+		return 0.f;
+	}
+
+	// Get the approaching speed along the contact normal
+	const RVec3 ContactPoint = inManifold.GetWorldSpaceContactPointOn1(0);
+	const Vec3 RelativeVelocity = inBody2.GetPointVelocity(ContactPoint) -
+		inBody1.GetPointVelocity(ContactPoint);
+	const float NormalSpeed =
+		abs(RelativeVelocity.Dot(inManifold.mWorldSpaceNormal));
+
+	return (1.f + inSettings.mCombinedRestitution) * NormalSpeed /
+		InverseMassSum;
 }
@@ -11,6 +11,12 @@ bool FObjectBroadPhaseLayerFilterImpl::ShouldCollide(ObjectLayer inLayer1, Broad
 		return inLayer2 == BroadPhaseLayers::MOVING;
 	case Layers::MOVING:
 		return true;
+	case Layers::GHOST:
+		return inLayer2 == BroadPhaseLayers::MOVING ||
+			inLayer2 == BroadPhaseLayers::SENSOR;
+	case Layers::SENSOR:
+		return inLayer2 == BroadPhaseLayers::MOVING ||
+			inLayer2 == BroadPhaseLayers::GHOST;
 	default:
 		JPH_ASSERT(false);
 		return false;
@@ -11,6 +11,10 @@ bool FObjectLayerPairFilterImpl::ShouldCollide(ObjectLayer inObject1, ObjectLaye
 		return inObject2 == Layers::MOVING; // Non moving only collides with moving
 	case Layers::MOVING:
 		return true; // Moving collides with everything
+	case Layers::GHOST:
+		return inObject2 == Layers::MOVING || inObject2 == Layers::SENSOR; // Ghost collides with moving and sensors
+	case Layers::SENSOR:
+		return inObject2 == Layers::MOVING || inObject2 == Layers::GHOST; // Sensor collides with moving and ghosts
 	default:
 		return false;
 	}
@@ -0,0 +1,499 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/PhysicsCookedMeshCache.h"
+#include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/JoltMemoryStream.h"
+#include "LocalPhysicsEngineSystem/LocalPhysicsEngineSystemLogging.h"
+
+#include "Misc/Base64.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+
+#include <Jolt/Physics/Collision/Shape/BoxShape.h>
+#include <Jolt/Physics/Collision/Shape/CapsuleShape.h>
+#include <Jolt/Physics/Collision/Shape/MeshShape.h>
+#include <Jolt/Physics/Collision/Shape/ConvexHullShape.h>
+#include <Jolt/Physics/Collision/Shape/HeightFieldShape.h>
+#include <Jolt/Physics/Collision/Shape/RotatedTranslatedShape.h>
+#include <Jolt/Physics/Collision/Shape/SphereShape.h>
+#include <Jolt/Physics/Collision/Shape/StaticCompoundShape.h>
+
+#include <chrono>
+
+template <typename ElementType>
+bool FPhysicsCookedMeshCache::DecodeMeshData(const FString& EncodedData,
+	TArray<ElementType>& OutElements)
+{
+	TArray<uint8> DecodedBytes;
+	if (!FBase64::Decode(EncodedData.TrimStartAndEnd(), DecodedBytes) ||
+		DecodedBytes.Num() % sizeof(ElementType) != 0)
+	{
+		return false;
+	}
+
+	OutElements.SetNumUninitialized(DecodedBytes.Num() / sizeof(ElementType));
+	FMemory::Memcpy(OutElements.GetData(), DecodedBytes.GetData(),
+		DecodedBytes.Num());
+
+	return true;
+}
+
+bool FPhysicsCookedMeshCache::CookHeightField
+	(const TArray<FString>& CookMeshLines,
+	ShapeSettings::ShapeResult& OutCookResult)
+{
+	// The height field keeps the landscape's height within this error (cm)
+	constexpr float MaxHeightError = 1.f;
+
+	int32 SampleCount = 0;
+	float SampleSpacing = 0.f;
+	int32 BlockSize = 0;
+	TArray<float> Heights;
+
+	for (int32 i = 1; i < CookMeshLines.Num(); i++)
+	{
+		TArray<FString> HeightFieldInfo;
+		CookMeshLines[i].ParseIntoArray(HeightFieldInfo, TEXT(";"));
+
+		if (HeightFieldInfo.Num() >= 4 && HeightFieldInfo[0] == "HeightField")
+		{
+			SampleCount = FCString::Atoi(*HeightFieldInfo[1]);
+			SampleSpacing = FCString::Atof(*HeightFieldInfo[2]);
+			BlockSize = FCString::Atoi(*HeightFieldInfo[3]);
+		}
+		else if (HeightFieldInfo.Num() >= 2 && HeightFieldInfo[0] == "Heights")
+		{
+			DecodeMeshData(HeightFieldInfo[1], Heights);
+		}
+	}
+
+	if (BlockSize < 2 || BlockSize > 8 || SampleCount < 2 * BlockSize ||
+		SampleCount % BlockSize != 0 || !FMath::IsPowerOfTwo(SampleCount /
+		BlockSize) || SampleSpacing <= 0.f ||
+		Heights.Num() != SampleCount * SampleCount)
+	{
+		return false;
+	}
+
+	// Jolt's height fields are Y-up, with the samples on the XZ plane, so the
+	// samples are transposed and the field is rotated so its X, Y and Z axes
+	// are the Y, Z and X axes of the cooked shape. The holes are already
+	// Jolt's no collision value
+	HeightFieldShapeSettings HeightFieldSettings;
+	HeightFieldSettings.mScale = Vec3(SampleSpacing, 1.f, SampleSpacing);
+	HeightFieldSettings.mSampleCount = SampleCount;
+	HeightFieldSettings.mBlockSize = BlockSize;
+	HeightFieldSettings.mHeightSamples.resize(Heights.Num());
+
+	for (int32 y = 0; y < SampleCount; y++)
+	{
+		for (int32 x = 0; x < SampleCount; x++)
+		{
+			HeightFieldSettings.mHeightSamples[x * SampleCount + y] =
+				Heights[y * SampleCount + x];
+		}
+	}
+
+	HeightFieldSettings.mBitsPerSample =
+		HeightFieldSettings.CalculateBitsPerSampleForError(MaxHeightError);
+
+	const ShapeSettings::ShapeResult HeightFieldResult =
+		HeightFieldSettings.Create();
+	if (HeightFieldResult.HasError())
+	{
+		OutCookResult = HeightFieldResult;
+		return true;
+	}
+
+	OutCookResult = RotatedTranslatedShapeSettings(Vec3::sZero(),
+		Quat(0.5f, 0.5f, 0.5f, 0.5f), HeightFieldResult.Get()).Create();
+
+	return true;
+}
+
+bool FPhysicsCookedMeshCache::CookCompound
+	(const TArray<FString>& CookMeshLines,
+	ShapeSettings::ShapeResult& OutCookResult)
+{
+	// Jolt's capsules are along the Y-axis, while Unreal's are along Z
+	const Quat CapsuleAxisRotation = Quat::sRotation(Vec3::sAxisX(),
+		0.5f * JPH_PI);
+
+	StaticCompoundShapeSettings CompoundSettings;
+
+	for (int32 i = 1; i < CookMeshLines.Num(); i++)
+	{
+		TArray<FString> PrimitiveInfo;
+		CookMeshLines[i].ParseIntoArray(PrimitiveInfo, TEXT(";"));
+
+		if (PrimitiveInfo.Num() < 5)
+		{
+			return false;
+		}
+
+		const Vec3 PrimitivePosition(FCString::Atof(*PrimitiveInfo[1]),
+			FCString::Atof(*PrimitiveInfo[2]),
+			FCString::Atof(*PrimitiveInfo[3]));
+
+		if (PrimitiveInfo[0] == "Sphere")
+		{
+			const float SphereRadius = FCString::Atof(*PrimitiveInfo[4]);
+			if (SphereRadius <= 0.f)
+			{
+				return false;
+			}
+
+			CompoundSettings.AddShape(PrimitivePosition, Quat::sIdentity(),
+				new SphereShapeSettings(SphereRadius));
+			continue;
+		}
+
+		if (PrimitiveInfo.Num() < 10)
+		{
+			return false;
+		}
+
+		const Quat PrimitiveRotation = Quat(FCString::Atof(*PrimitiveInfo[4]),
+			FCString::Atof(*PrimitiveInfo[5]),
+			FCString::Atof(*PrimitiveInfo[6]),
+			FCString::Atof(*PrimitiveInfo[7])).Normalized();
+
+		if (PrimitiveInfo[0] == "Box" && PrimitiveInfo.Num() >= 11)
+		{
+			const Vec3 BoxHalfExtent(FCString::Atof(*PrimitiveInfo[8]),
+				FCString::Atof(*PrimitiveInfo[9]),
+				FCString::Atof(*PrimitiveInfo[10]));
+			if (BoxHalfExtent.ReduceMin() <= 0.f)
+			{
+				return false;
+			}
+
+			// The convex radius can't be over the thinnest side
+			CompoundSettings.AddShape(PrimitivePosition, PrimitiveRotation,
+				new BoxShapeSettings(BoxHalfExtent, FMath::Min
+				(cDefaultConvexRadius, BoxHalfExtent.ReduceMin())));
+		}
+		else if (PrimitiveInfo[0] == "Capsule")
+		{
+			const float CylinderHalfHeight = FCString::Atof(*PrimitiveInfo[8]);
+			const float CapsuleRadius = FCString::Atof(*PrimitiveInfo[9]);
+			if (CapsuleRadius <= 0.f)
+			{
+				return false;
+			}
+
+			// A capsule with no cylinder is a sphere
+			if (CylinderHalfHeight <= 0.f)
+			{
+				CompoundSettings.AddShape(PrimitivePosition,
+					Quat::sIdentity(), new SphereShapeSettings(CapsuleRadius));
+			}
+			else
+			{
+				CompoundSettings.AddShape(PrimitivePosition, PrimitiveRotation
+					* CapsuleAxisRotation, new CapsuleShapeSettings
+					(CylinderHalfHeight, CapsuleRadius));
+			}
+		}
+		else
+		{
+			return false;
+		}
+	}
+
+	// An empty compound is reported by its creation
+	OutCookResult = CompoundSettings.Create();
+
+	return true;
+}
+
+ShapeRefC FPhysicsCookedMeshCache::FindCookedMesh(const FString& MeshHash)
+{
+	FScopeLock CacheLock(&CacheCriticalSection);
+
+	// Check the memory cache first
+	if (const ShapeRefC* CookedMesh = CookedMeshes.Find(MeshHash))
+	{
+		return *CookedMesh;
+	}
+
+	// Load from disk, keeping it on memory for the next worlds
+	ShapeRefC LoadedCookedMesh = LoadCookedMeshFile(MeshHash);
+	if (LoadedCookedMesh)
+	{
+		CookedMeshes.Add(MeshHash, LoadedCookedMesh);
+	}
+
+	return LoadedCookedMesh;
+}
+
+FString FPhysicsCookedMeshCache::CookMesh(const FString& CookMeshInfo)
+{
+	TArray<FString> CookMeshLines;
+	CookMeshInfo.ParseIntoArrayLines(CookMeshLines);
+
+	// The first line is the mesh hash and collision type
+	TArray<FString> CookMeshHeader;
+	if (CookMeshLines.Num() > 0)
+	{
+		CookMeshLines[0].ParseIntoArray(CookMeshHeader, TEXT(";"));
+	}
+
+	if (CookMeshHeader.Num() < 2)
+	{
+		return "Mesh cook failed: no mesh hash.\n";
+	}
+
+	const FString MeshHash = CookMeshHeader[0].TrimStartAndEnd();
+	const FString CollisionType = CookMeshHeader[1].TrimStartAndEnd();
+
+	// Another region may have cooked it already
+	if (FindCookedMesh(MeshHash))
+	{
+		return "Mesh cook successful.\n";
+	}
+
+	// Get pre cook time
+	std::chrono::steady_clock::time_point preCookTime =
+		std::chrono::steady_clock::now();
+
+	ShapeSettings::ShapeResult CookResult;
+
+	if (CollisionType == "convex")
+	{
+		// Cook a convex hull for each convex element. If there is more than
+		// one, they are joined on a static compound
+		StaticCompoundShapeSettings ConvexElementsSettings;
+		ShapeSettings::ShapeResult LastHullResult;
+		int32 NumberOfConvexHulls = 0;
+
+		for (int32 i = 1; i < CookMeshLines.Num(); i++)
+		{
+			TArray<FString> HullInfo;
+			CookMeshLines[i].ParseIntoArray(HullInfo, TEXT(";"));
+
+			TArray<Float3> HullVertices;
+			if (HullInfo.Num() < 2 || HullInfo[0] != "Hull" ||
+				!DecodeMeshData(HullInfo[1], HullVertices))
+			{
+				return FString::Printf(TEXT("Mesh cook failed: could not "
+					"parse line %d.\n"), i);
+			}
+
+			Array<Vec3> HullPoints;
+			HullPoints.reserve(HullVertices.Num());
+			for (const Float3& HullVertex : HullVertices)
+			{
+				HullPoints.push_back(Vec3(HullVertex));
+			}
+
+			ConvexHullShapeSettings HullSettings(HullPoints);
+			LastHullResult = HullSettings.Create();
+			if (LastHullResult.HasError())
+			{
+				return FString::Printf(TEXT("Mesh cook failed: %s\n"),
+					UTF8_TO_TCHAR(LastHullResult.GetError().c_str()));
+			}
+
+			ConvexElementsSettings.AddShape(Vec3::sZero(), Quat::sIdentity(),
+				LastHullResult.Get());
+			NumberOfConvexHulls++;
+		}
+
+		if (NumberOfConvexHulls == 0)
+		{
+			return "Mesh cook failed: no convex elements.\n";
+		}
+
+		CookResult = NumberOfConvexHulls == 1 ? LastHullResult :
+			ConvexElementsSettings.Create();
+	}
+	else if (CollisionType == "mesh")
+	{
+		TArray<Float3> MeshVertices;
+		TArray<uint32> MeshIndices;
+
+		for (int32 i = 1; i < CookMeshLines.Num(); i++)
+		{
+			TArray<FString> MeshDataInfo;
+			CookMeshLines[i].ParseIntoArray(MeshDataInfo, TEXT(";"));
+
+			if (MeshDataInfo.Num() < 2)
+			{
+				continue;
+			}
+
+			if (MeshDataInfo[0] == "Vertices")
+			{
+				DecodeMeshData(MeshDataInfo[1], MeshVertices);
+			}
+			else if (MeshDataInfo[0] == "Indices")
+			{
+				DecodeMeshData(MeshDataInfo[1], MeshIndices);
+			}
+		}
+
+		if (MeshVertices.Num() == 0 || MeshIndices.Num() == 0 ||
+			MeshIndices.Num() % 3 != 0)
+		{
+			return "Mesh cook failed: invalid triangle data.\n";
+		}
+
+		VertexList TriangleVertices(MeshVertices.GetData(),
+			MeshVertices.GetData() + MeshVertices.Num());
+
+		const uint32 NumberOfVertices = MeshVertices.Num();
+
+		IndexedTriangleList IndexedTriangles;
+		IndexedTriangles.reserve(MeshIndices.Num() / 3);
+		for (int32 i = 0; i < MeshIndices.Num(); i += 3)
+		{
+			if (MeshIndices[i] >= NumberOfVertices ||
+				MeshIndices[i + 1] >= NumberOfVertices ||
+				MeshIndices[i + 2] >= NumberOfVertices)
+			{
+				return "Mesh cook failed: triangle index out of range.\n";
+			}
+
+			IndexedTriangles.push_back(IndexedTriangle(MeshIndices[i],
+				MeshIndices[i + 1], MeshIndices[i + 2], 0));
+		}
+
+		// The mesh shape creation builds the AABB tree of the triangles, which
+		// is where most of the cooking time goes
+		MeshShapeSettings MeshSettings(TriangleVertices, IndexedTriangles);
+		CookResult = MeshSettings.Create();
+	}
+	else if (CollisionType == "heightfield")
+	{
+		if (!CookHeightField(CookMeshLines, CookResult))
+		{
+			return "Mesh cook failed: invalid height field data.\n";
+		}
+	}
+	else if (CollisionType == "compound")
+	{
+		if (!CookCompound(CookMeshLines, CookResult))
+		{
+			return "Mesh cook failed: invalid compound primitive.\n";
+		}
+	}
+	else
+	{
+		return FString::Printf(TEXT("Mesh cook failed: unknown collision "
+			"type \"%s\".\n"), *CollisionType);
+	}
+
+	if (CookResult.HasError())
+	{
+		return FString::Printf(TEXT("Mesh cook failed: %s\n"),
+			UTF8_TO_TCHAR(CookResult.GetError().c_str()));
+	}
+
+	// Get post cook time
+	std::chrono::steady_clock::time_point postCookTime =
+		std::chrono::steady_clock::now();
+
+	LPES_LOG_INFO(TEXT("Mesh \"%s\" (%s) cooked in %lld microseconds."),
+		*MeshHash, *CollisionType, static_cast<long long>
+		(std::chrono::duration_cast<std::chrono::microseconds>
+		(postCookTime - preCookTime).count()));
+
+	// Cache the cooked mesh
+	FScopeLock CacheLock(&CacheCriticalSection);
+
+	ShapeRefC CookedMesh = CookResult.Get();
+	CookedMeshes.Add(MeshHash, CookedMesh);
+	SaveCookedMeshFile(MeshHash, *CookedMesh);
+
+	return "Mesh cook successful.\n";
+}
+
+void FPhysicsCookedMeshCache::Empty()
+{
+	FScopeLock CacheLock(&CacheCriticalSection);
+
+	CookedMeshes.Empty();
+}
+
+FString FPhysicsCookedMeshCache::GetCookedMeshFilePath
+	(const FString& MeshHash)
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(),
+		TEXT("PhysicsCookedMeshes"), FPaths::MakeValidFileName(MeshHash) +
+		TEXT(".jpcm"));
+}
+
+ShapeRefC FPhysicsCookedMeshCache::LoadCookedMeshFile(const FString& MeshHash)
+{
+	const FString CookedMeshFilePath = GetCookedMeshFilePath(MeshHash);
+
+	TArray<uint8> CookedMeshFileData;
+	if (!FFileHelper::LoadFileToArray(CookedMeshFileData,
+		*CookedMeshFilePath, FILEREAD_Silent))
+	{
+		return nullptr;
+	}
+
+	// Check the header: tag and version. The file name is the mesh hash
+	FMemoryStreamIn CookedMeshStream(CookedMeshFileData, 0);
+
+	uint32 FileTag = 0;
+	uint32 FileVersion = 0;
+	CookedMeshStream.Read(FileTag);
+	CookedMeshStream.Read(FileVersion);
+
+	if (CookedMeshStream.IsFailed() || FileTag != CookedMeshFileTag ||
+		FileVersion != CookedMeshFileVersion)
+	{
+		LPES_LOG_WARNING(TEXT("Cooked mesh file \"%s\" is invalid or from "
+			"another version. Ignoring it."), *CookedMeshFilePath);
+		return nullptr;
+	}
+
+	// Restore the shape with its sub shapes (the compound's convex hulls)
+	Shape::IDToShapeMap RestoredShapes;
+	Shape::IDToMaterialMap RestoredMaterials;
+	ShapeSettings::ShapeResult RestoreResult = Shape::sRestoreWithChildren
+		(CookedMeshStream, RestoredShapes, RestoredMaterials);
+	if (RestoreResult.HasError())
+	{
+		LPES_LOG_WARNING(TEXT("Could not restore cooked mesh \"%s\": %s"),
+			*CookedMeshFilePath, UTF8_TO_TCHAR
+			(RestoreResult.GetError().c_str()));
+		return nullptr;
+	}
+
+	LPES_LOG_INFO(TEXT("Cooked mesh \"%s\" loaded from disk (%d bytes)."),
+		*MeshHash, CookedMeshFileData.Num());
+
+	return RestoreResult.Get();
+}
+
+void FPhysicsCookedMeshCache::SaveCookedMeshFile(const FString& MeshHash,
+	const Shape& CookedMesh)
+{
+	TArray<uint8> CookedMeshFileData;
+	FMemoryStreamOut CookedMeshStream(CookedMeshFileData);
+
+	// Write the header, then the shape with its sub shapes
+	CookedMeshStream.Write(CookedMeshFileTag);
+	CookedMeshStream.Write(CookedMeshFileVersion);
+
+	Shape::ShapeToIDMap SavedShapes;
+	Shape::MaterialToIDMap SavedMaterials;
+	CookedMesh.SaveWithChildren(CookedMeshStream, SavedShapes,
+		SavedMaterials);
+
+	const FString CookedMeshFilePath = GetCookedMeshFilePath(MeshHash);
+	if (!FFileHelper::SaveArrayToFile(CookedMeshFileData,
+		*CookedMeshFilePath))
+	{
+		LPES_LOG_WARNING(TEXT("Could not save cooked mesh file \"%s\"."),
+			*CookedMeshFilePath);
+		return;
+	}
+
+	LPES_LOG_INFO(TEXT("Cooked mesh \"%s\" saved on \"%s\" (%d bytes)."),
+		*MeshHash, *CookedMeshFilePath, CookedMeshFileData.Num());
+}
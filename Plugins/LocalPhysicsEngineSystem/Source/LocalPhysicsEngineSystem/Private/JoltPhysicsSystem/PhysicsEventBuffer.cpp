@@ -0,0 +1,80 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/PhysicsEventBuffer.h"
+
+#include <thread>
+
+namespace
+{
+	/** The next ordinal to give to a thread recording events */
+	std::atomic<uint32> NextThreadOrdinal{ 0 };
+}
+
+FPhysicsEventBuffer::FPhysicsEventBuffer(const uint32 InEventsPerThreadSlot)
+	: EventsPerThreadSlot(InEventsPerThreadSlot)
+{
+	// One slot for each hardware thread. The job system uses one less thread
+	// than this, plus the thread that calls the physics update
+	const uint32 NumberOfThreadSlots =
+		FMath::Max(std::thread::hardware_concurrency(), 1u);
+
+	// Preallocate every slot so nothing is allocated during the step
+	ThreadSlots.Reserve(NumberOfThreadSlots);
+	for (uint32 i = 0; i < NumberOfThreadSlots; i++)
+	{
+		TUniquePtr<FThreadSlot> NewThreadSlot = MakeUnique<FThreadSlot>();
+		NewThreadSlot->Events.SetNum(EventsPerThreadSlot);
+		ThreadSlots.Add(MoveTemp(NewThreadSlot));
+	}
+}
+
+void FPhysicsEventBuffer::PushEvent(const FPhysicsServiceEvent& NewEvent)
+{
+	// Get the calling thread's slot. If there are more threads than slots,
+	// threads share a slot, which is still safe as entries are reserved
+	// atomically
+	FThreadSlot& ThreadSlot =
+		*ThreadSlots[GetCurrentThreadOrdinal() % ThreadSlots.Num()];
+
+	// Reserve an entry on the slot
+	const uint32 EventIndex = ThreadSlot.ReservedEventsCount.fetch_add(1,
+		std::memory_order_relaxed);
+
+	// If the slot is full, the event is dropped. The reserved count will
+	// tell how many were dropped once drained
+	if (EventIndex >= EventsPerThreadSlot)
+	{
+		return;
+	}
+
+	ThreadSlot.Events[EventIndex] = NewEvent;
+}
+
+uint32 FPhysicsEventBuffer::DrainEvents(TArray<FPhysicsServiceEvent>& OutEvents)
+{
+	uint32 DroppedEventsCount = 0;
+
+	for (TUniquePtr<FThreadSlot>& ThreadSlot : ThreadSlots)
+	{
+		// Get how many events were reserved on this slot and reset it
+		const uint32 ReservedEventsCount = ThreadSlot->ReservedEventsCount.
+			exchange(0, std::memory_order_acquire);
+
+		// Copy the recorded events
+		const uint32 RecordedEventsCount = FMath::Min(ReservedEventsCount,
+			EventsPerThreadSlot);
+		OutEvents.Append(ThreadSlot->Events.GetData(), RecordedEventsCount);
+
+		DroppedEventsCount += ReservedEventsCount - RecordedEventsCount;
+	}
+
+	return DroppedEventsCount;
+}
+
+uint32 FPhysicsEventBuffer::GetCurrentThreadOrdinal()
+{
+	thread_local const uint32 CurrentThreadOrdinal =
+		NextThreadOrdinal.fetch_add(1, std::memory_order_relaxed);
+
+	return CurrentThreadOrdinal;
+}
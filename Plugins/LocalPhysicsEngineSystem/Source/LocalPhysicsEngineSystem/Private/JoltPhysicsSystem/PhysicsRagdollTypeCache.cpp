@@ -0,0 +1,243 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/PhysicsRagdollTypeCache.h"
+#include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/ObjectLayerPairFilterImpl.h"
+#include "LocalPhysicsEngineSystem/LocalPhysicsEngineSystemLogging.h"
+
+#include "Misc/ScopeLock.h"
+
+#include <Jolt/Physics/Collision/Shape/BoxShape.h>
+#include <Jolt/Physics/Collision/Shape/CapsuleShape.h>
+#include <Jolt/Physics/Collision/Shape/RotatedTranslatedShape.h>
+#include <Jolt/Physics/Collision/Shape/SphereShape.h>
+#include <Jolt/Physics/Constraints/SwingTwistConstraint.h>
+
+namespace
+{
+	/** The amount of arguments on a ragdoll part line */
+	constexpr int32 RagdollPartArguments = 34;
+
+	/** Parses three line arguments, from the given one, as a vector */
+	Vec3 ParseVec3(const TArray<FString>& Arguments, const int32 First)
+	{
+		return Vec3(FCString::Atof(*Arguments[First]),
+			FCString::Atof(*Arguments[First + 1]),
+			FCString::Atof(*Arguments[First + 2]));
+	}
+
+	/** Parses four line arguments, from the given one, as a rotation */
+	Quat ParseQuat(const TArray<FString>& Arguments, const int32 First)
+	{
+		return Quat(FCString::Atof(*Arguments[First]),
+			FCString::Atof(*Arguments[First + 1]),
+			FCString::Atof(*Arguments[First + 2]),
+			FCString::Atof(*Arguments[First + 3])).Normalized();
+	}
+}
+
+FString FPhysicsRagdollTypeCache::RegisterRagdollType
+	(const FString& RagdollTypeInfo)
+{
+	TArray<FString> RagdollTypeLines;
+	RagdollTypeInfo.ParseIntoArrayLines(RagdollTypeLines);
+
+	// The first line is the type name and pool size
+	TArray<FString> RagdollTypeHeader;
+	if (RagdollTypeLines.Num() > 0)
+	{
+		RagdollTypeLines[0].ParseIntoArray(RagdollTypeHeader, TEXT(";"));
+	}
+
+	if (RagdollTypeHeader.Num() < 3 || RagdollTypeHeader[0] != "RagdollType")
+	{
+		return "Ragdoll type register failed: no ragdoll type header.\n";
+	}
+
+	const FString TypeName = RagdollTypeHeader[1].TrimStartAndEnd();
+	const int32 PoolSize = FCString::Atoi(*RagdollTypeHeader[2]);
+
+	// Another region may have registered it already
+	{
+		FScopeLock CacheLock(&CacheCriticalSection);
+		if (RagdollTypes.Contains(TypeName))
+		{
+			return "Ragdoll type register successful.\n";
+		}
+	}
+
+	if (PoolSize <= 0)
+	{
+		return FString::Printf(TEXT("Ragdoll type register failed: invalid "
+			"pool size %d.\n"), PoolSize);
+	}
+
+	Ref<RagdollSettings> NewRagdollSettings = new RagdollSettings();
+	NewRagdollSettings->mSkeleton = new Skeleton();
+
+	for (int32 i = 1; i < RagdollTypeLines.Num(); i++)
+	{
+		TArray<FString> PartInfo;
+		RagdollTypeLines[i].ParseIntoArray(PartInfo, TEXT(";"));
+
+		if (!AddRagdollPart(*NewRagdollSettings, PartInfo))
+		{
+			return FString::Printf(TEXT("Ragdoll type register failed: could "
+				"not parse part \"%s\".\n"), *RagdollTypeLines[i]);
+		}
+	}
+
+	if (NewRagdollSettings->mParts.empty())
+	{
+		return "Ragdoll type register failed: no parts.\n";
+	}
+
+	// Limit the mass ratios between the parents and children, so the chains
+	// don't jitter, and keep the parts from colliding with their parents
+	if (!NewRagdollSettings->Stabilize())
+	{
+		LPES_LOG_WARNING(TEXT("Could not stabilize ragdoll type \"%s\"."),
+			*TypeName);
+	}
+
+	NewRagdollSettings->DisableParentChildCollisions();
+
+	FPhysicsRagdollType NewRagdollType;
+	NewRagdollType.Settings = NewRagdollSettings;
+	NewRagdollType.PoolSize = PoolSize;
+
+	{
+		FScopeLock CacheLock(&CacheCriticalSection);
+		RagdollTypes.Add(TypeName, NewRagdollType);
+	}
+
+	LPES_LOG_INFO(TEXT("Ragdoll type \"%s\" registered (parts: %d; pool "
+		"size: %d)."), *TypeName,
+		static_cast<int32>(NewRagdollSettings->mParts.size()), PoolSize);
+
+	return "Ragdoll type register successful.\n";
+}
+
+bool FPhysicsRagdollTypeCache::FindRagdollType(const FString& TypeName,
+	FPhysicsRagdollType& OutRagdollType)
+{
+	FScopeLock CacheLock(&CacheCriticalSection);
+
+	if (const FPhysicsRagdollType* RagdollType = RagdollTypes.Find(TypeName))
+	{
+		OutRagdollType = *RagdollType;
+		return true;
+	}
+
+	return false;
+}
+
+void FPhysicsRagdollTypeCache::Empty()
+{
+	FScopeLock CacheLock(&CacheCriticalSection);
+	RagdollTypes.Empty();
+}
+
+bool FPhysicsRagdollTypeCache::AddRagdollPart(RagdollSettings& Settings,
+	const TArray<FString>& PartInfo)
+{
+	if (PartInfo.Num() < RagdollPartArguments || PartInfo[0] != "Part")
+	{
+		return false;
+	}
+
+	// The parents must come before their children
+	const int32 PartIndex = static_cast<int32>(Settings.mParts.size());
+	const int32 ParentPartIndex = FCString::Atoi(*PartInfo[2]);
+	if (ParentPartIndex >= PartIndex || (PartIndex == 0) !=
+		(ParentPartIndex < 0))
+	{
+		return false;
+	}
+
+	// Create the part's shape, placed relative to the part
+	const FString ShapeType = PartInfo[3].TrimStartAndEnd();
+	const Vec3 ShapeSize = ParseVec3(PartInfo, 4);
+
+	Ref<Shape> PartShape;
+	if (ShapeType == "capsule")
+	{
+		// Jolt's capsule is along the y-axis, while Unreal's is along the
+		// z-axis
+		PartShape = new RotatedTranslatedShape(Vec3::sZero(),
+			Quat::sRotation(Vec3::sAxisX(), 0.5f * JPH_PI),
+			new CapsuleShape(FMath::Max(ShapeSize.GetZ(), KINDA_SMALL_NUMBER),
+			ShapeSize.GetX()));
+	}
+	else if (ShapeType == "box")
+	{
+		PartShape = new BoxShape(ShapeSize);
+	}
+	else if (ShapeType == "sphere")
+	{
+		PartShape = new SphereShape(ShapeSize.GetX());
+	}
+	else
+	{
+		return false;
+	}
+
+	const ShapeSettings::ShapeResult PartShapeResult =
+		RotatedTranslatedShapeSettings(ParseVec3(PartInfo, 7),
+		ParseQuat(PartInfo, 10), PartShape).Create();
+	if (PartShapeResult.HasError())
+	{
+		LPES_LOG_ERROR(TEXT("Could not create ragdoll part \"%s\" shape: %s"),
+			*PartInfo[1], UTF8_TO_TCHAR(PartShapeResult.GetError().c_str()));
+		return false;
+	}
+
+	Settings.mSkeleton->AddJoint(TCHAR_TO_UTF8(*PartInfo[1]),
+		ParentPartIndex);
+
+	Settings.mParts.push_back(RagdollSettings::Part());
+
+	RagdollSettings::Part& NewPart = Settings.mParts.back();
+	NewPart.SetShape(PartShapeResult.Get());
+	NewPart.mPosition = RVec3(ParseVec3(PartInfo, 15));
+	NewPart.mRotation = ParseQuat(PartInfo, 18);
+	NewPart.mMotionType = EMotionType::Dynamic;
+	NewPart.mObjectLayer = Layers::MOVING;
+	NewPart.mOverrideMassProperties = EOverrideMassProperties::CalculateInertia;
+	NewPart.mMassPropertiesOverride.mMass = FMath::Max(FCString::Atof
+		(*PartInfo[14]), KINDA_SMALL_NUMBER);
+
+	if (ParentPartIndex < 0)
+	{
+		return true;
+	}
+
+	// The joint is on the bind pose, the same space the parts are on, so the
+	// constraint is created with the parts on the bind pose
+	const Vec3 TwistAxis = ParseVec3(PartInfo, 25).NormalizedOr
+		(Vec3::sAxisX());
+	Vec3 PlaneAxis = ParseVec3(PartInfo, 28);
+	PlaneAxis -= TwistAxis * TwistAxis.Dot(PlaneAxis);
+	PlaneAxis = PlaneAxis.IsNearZero() ?
+		TwistAxis.GetNormalizedPerpendicular() : PlaneAxis.Normalized();
+
+	const float TwistLimit = DegreesToRadians(FMath::Clamp(FCString::Atof
+		(*PartInfo[33]), 0.f, 180.f));
+
+	Ref<SwingTwistConstraintSettings> JointSettings =
+		new SwingTwistConstraintSettings();
+	JointSettings->mSpace = EConstraintSpace::WorldSpace;
+	JointSettings->mPosition1 = JointSettings->mPosition2 =
+		RVec3(ParseVec3(PartInfo, 22));
+	JointSettings->mTwistAxis1 = JointSettings->mTwistAxis2 = TwistAxis;
+	JointSettings->mPlaneAxis1 = JointSettings->mPlaneAxis2 = PlaneAxis;
+	JointSettings->mNormalHalfConeAngle = DegreesToRadians(FMath::Clamp
+		(FCString::Atof(*PartInfo[31]), 0.f, 180.f));
+	JointSettings->mPlaneHalfConeAngle = DegreesToRadians(FMath::Clamp
+		(FCString::Atof(*PartInfo[32]), 0.f, 180.f));
+	JointSettings->mTwistMinAngle = -TwistLimit;
+	JointSettings->mTwistMaxAngle = TwistLimit;
+
+	NewPart.mToParent = JointSettings;
+
+	return true;
+}
@@ -0,0 +1,622 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/PhysicsServiceAllocator.h"
+#include "LocalPhysicsEngineSystem/LocalPhysicsEngineSystemLogging.h"
+
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+#include "Misc/ScopeLock.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/WindowsHWrapper.h"
+#elif PLATFORM_LINUX
+#include <sys/mman.h>
+#endif
+
+#include <cstdlib>
+
+namespace
+{
+	/**
+	* The header before each Jolt allocation. Its size keeps the allocations
+	* 16 bytes aligned, as Jolt requires
+	*/
+	struct FAllocationHeader
+	{
+		/** The counters the allocation was accounted on */
+		FPhysicsMemoryAccounting* Accounting;
+
+		/** The size of the block allocated from the backend */
+		uint32 BlockSize;
+
+		/** The offset of the allocation from the block start */
+		uint32 BlockOffset;
+	};
+
+	static_assert(sizeof(FAllocationHeader) == 16,
+		"The allocation header must keep the allocations 16 bytes aligned");
+
+	/** The size of the pages used when huge pages can't be queried */
+	constexpr uint64 HugePageSize = 2 * 1024 * 1024;
+
+	/** The arena size classes, from 32 bytes to 64 KB */
+	constexpr uint32 MinSizeClassShift = 5;
+	constexpr int32 NumberOfSizeClasses = 12;
+
+	/** A free block on an arena size class' free list */
+	struct FArenaFreeBlock
+	{
+		FArenaFreeBlock* Next;
+	};
+
+	/** The free blocks of an arena size class */
+	struct FArenaSizeClass
+	{
+		FCriticalSection Lock;
+		FArenaFreeBlock* FreeBlocks = nullptr;
+	};
+
+	/** An arena reserved by the "Arena" backend */
+	struct FArenaChunk
+	{
+		uint8* Base;
+		uint64 Size;
+	};
+
+	/** The registered allocator settings */
+	FPhysicsAllocatorSettings AllocatorSettings;
+
+	/** The arena size classes */
+	FArenaSizeClass ArenaSizeClasses[NumberOfSizeClasses];
+
+	/** The reserved arenas, where the size classes' blocks are carved from */
+	TArray<FArenaChunk> ArenaChunks;
+
+	/** The carving position and end on the last reserved arena */
+	uint8* ArenaChunkTop = nullptr;
+	uint8* ArenaChunkEnd = nullptr;
+
+	/** Critical section to synchronize the arenas' reservation and carving */
+	FCriticalSection ArenaChunksCriticalSection;
+
+	/** The number of blocks currently allocated from the arenas */
+	std::atomic<int64> LiveArenaBlocks{ 0 };
+
+	/** The counters of each world. The key is the world id */
+	TMap<int32, FPhysicsMemoryAccounting*> WorldAccountings;
+
+	/** Critical section to synchronize access to the worlds' counters */
+	FCriticalSection WorldAccountingsCriticalSection;
+
+	/** The counters of the allocations made outside any world */
+	FPhysicsMemoryAccounting UnattributedAccounting;
+
+	/** The counters the calling thread is accounting on */
+	thread_local FPhysicsMemoryAccounting* CurrentAccounting = nullptr;
+
+	/** Gets the arena size class of a block size. -1 if too big for one */
+	int32 GetArenaSizeClass(const uint32 BlockSize)
+	{
+		const int32 SizeClass = static_cast<int32>(FMath::CeilLogTwo
+			(FMath::Max(BlockSize, 1u << MinSizeClassShift))) -
+			MinSizeClassShift;
+
+		return SizeClass < NumberOfSizeClasses ? SizeClass : -1;
+	}
+
+	void* ArenaAllocate(const uint32 BlockSize)
+	{
+		const int32 SizeClass = GetArenaSizeClass(BlockSize);
+		if (SizeClass < 0)
+		{
+			return FMemory::Malloc(BlockSize, 16);
+		}
+
+		LiveArenaBlocks.fetch_add(1, std::memory_order_relaxed);
+
+		// Reuse a freed block of the same size class
+		{
+			FArenaSizeClass& ArenaSizeClass = ArenaSizeClasses[SizeClass];
+			FScopeLock SizeClassLock(&ArenaSizeClass.Lock);
+
+			if (FArenaFreeBlock* FreeBlock = ArenaSizeClass.FreeBlocks)
+			{
+				ArenaSizeClass.FreeBlocks = FreeBlock->Next;
+				return FreeBlock;
+			}
+		}
+
+		// If there is none, carve a new one from the arena, reserving a new
+		// arena if the current one is full
+		const uint64 SizeClassBlockSize = 1ull << (SizeClass +
+			MinSizeClassShift);
+
+		FScopeLock ArenaChunksLock(&ArenaChunksCriticalSection);
+
+		if (!ArenaChunkTop || ArenaChunkTop + SizeClassBlockSize >
+			ArenaChunkEnd)
+		{
+			const uint64 ChunkSize = FMath::Max<uint64>
+				(AllocatorSettings.ArenaChunkSize, SizeClassBlockSize);
+
+			uint8* NewChunkBase = static_cast<uint8*>
+				(FPhysicsServiceAllocator::AllocateLargeBlock(ChunkSize));
+			if (!NewChunkBase)
+			{
+				LiveArenaBlocks.fetch_sub(1, std::memory_order_relaxed);
+				return nullptr;
+			}
+
+			ArenaChunks.Add({ NewChunkBase, ChunkSize });
+			ArenaChunkTop = NewChunkBase;
+			ArenaChunkEnd = NewChunkBase + ChunkSize;
+		}
+
+		void* NewBlock = ArenaChunkTop;
+		ArenaChunkTop += SizeClassBlockSize;
+
+		return NewBlock;
+	}
+
+	void ArenaFree(void* Block, const uint32 BlockSize)
+	{
+		const int32 SizeClass = GetArenaSizeClass(BlockSize);
+		if (SizeClass < 0)
+		{
+			FMemory::Free(Block);
+			return;
+		}
+
+		FArenaSizeClass& ArenaSizeClass = ArenaSizeClasses[SizeClass];
+		{
+			FScopeLock SizeClassLock(&ArenaSizeClass.Lock);
+
+			FArenaFreeBlock* FreeBlock = static_cast<FArenaFreeBlock*>(Block);
+			FreeBlock->Next = ArenaSizeClass.FreeBlocks;
+			ArenaSizeClass.FreeBlocks = FreeBlock;
+		}
+
+		LiveArenaBlocks.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	/** Allocates a 16 bytes aligned block from the registered backend */
+	void* BackendAllocate(const uint32 BlockSize)
+	{
+		switch (AllocatorSettings.Backend)
+		{
+		case EPhysicsAllocatorBackend::System:
+			return std::malloc(BlockSize);
+		case EPhysicsAllocatorBackend::Arena:
+			return ArenaAllocate(BlockSize);
+		default:
+			return FMemory::Malloc(BlockSize, 16);
+		}
+	}
+
+	/** Frees a block allocated with "BackendAllocate()" */
+	void BackendFree(void* Block, const uint32 BlockSize)
+	{
+		switch (AllocatorSettings.Backend)
+		{
+		case EPhysicsAllocatorBackend::System:
+			std::free(Block);
+			break;
+		case EPhysicsAllocatorBackend::Arena:
+			ArenaFree(Block, BlockSize);
+			break;
+		default:
+			FMemory::Free(Block);
+			break;
+		}
+	}
+
+	// Jolt's aligned allocation hook. Every other hook goes through it
+	void* AlignedAllocateImpl(size_t inSize, size_t inAlignment)
+	{
+		const size_t Alignment = FMath::Max<size_t>(inAlignment,
+			sizeof(FAllocationHeader));
+
+		// The block must fit the header before an aligned allocation. As
+		// the backend blocks are 16 bytes aligned, this is at most the
+		// alignment away from the block start
+		const size_t BlockSize = inSize + Alignment;
+		if (BlockSize > MAX_uint32)
+		{
+			LPES_LOG_ERROR(TEXT("Physics allocation of %llu bytes is too "
+				"big."), static_cast<uint64>(inSize));
+			return nullptr;
+		}
+
+		uint8* Block = static_cast<uint8*>(BackendAllocate
+			(static_cast<uint32>(BlockSize)));
+		if (!Block)
+		{
+			return nullptr;
+		}
+
+		uint8* Allocation = reinterpret_cast<uint8*>(Align
+			(reinterpret_cast<UPTRINT>(Block) + sizeof(FAllocationHeader),
+			Alignment));
+
+		FPhysicsMemoryAccounting* Accounting = CurrentAccounting ?
+			CurrentAccounting : &UnattributedAccounting;
+		Accounting->RecordAllocation(BlockSize);
+
+		FAllocationHeader* Header = reinterpret_cast<FAllocationHeader*>
+			(Allocation) - 1;
+		Header->Accounting = Accounting;
+		Header->BlockSize = static_cast<uint32>(BlockSize);
+		Header->BlockOffset = static_cast<uint32>(Allocation - Block);
+
+		return Allocation;
+	}
+
+	// Jolt's aligned free hook. Every other hook goes through it
+	void AlignedFreeImpl(void* inBlock)
+	{
+		if (!inBlock)
+		{
+			return;
+		}
+
+		const FAllocationHeader* Header =
+			static_cast<const FAllocationHeader*>(inBlock) - 1;
+
+		Header->Accounting->RecordFree(Header->BlockSize);
+
+		BackendFree(static_cast<uint8*>(inBlock) - Header->BlockOffset,
+			Header->BlockSize);
+	}
+
+	// Jolt's allocation hook
+	void* AllocateImpl(size_t inSize)
+	{
+		return AlignedAllocateImpl(inSize, sizeof(FAllocationHeader));
+	}
+
+	// Jolt's free hook
+	void FreeImpl(void* inBlock)
+	{
+		AlignedFreeImpl(inBlock);
+	}
+}
+
+FPhysicsAllocatorSettings FPhysicsAllocatorSettings::FromCommandLine()
+{
+	FPhysicsAllocatorSettings Settings;
+
+	FString BackendName = FString();
+	if (FParse::Value(FCommandLine::Get(), TEXT("PhysicsAllocator="),
+		BackendName))
+	{
+		if (BackendName == TEXT("System"))
+		{
+			Settings.Backend = EPhysicsAllocatorBackend::System;
+		}
+		else if (BackendName == TEXT("Arena"))
+		{
+			Settings.Backend = EPhysicsAllocatorBackend::Arena;
+		}
+		else if (BackendName == TEXT("Unreal"))
+		{
+			Settings.Backend = EPhysicsAllocatorBackend::UnrealMemory;
+		}
+		else
+		{
+			LPES_LOG_WARNING(TEXT("Unknown physics allocator \"%s\". Using "
+				"Unreal's allocator."), *BackendName);
+		}
+	}
+
+	uint32 ArenaChunkMegabytes = 0;
+	if (FParse::Value(FCommandLine::Get(), TEXT("PhysicsArenaChunkMB="),
+		ArenaChunkMegabytes))
+	{
+		Settings.ArenaChunkSize = static_cast<uint64>(FMath::Max
+			(ArenaChunkMegabytes, 1u)) * 1024 * 1024;
+	}
+
+	Settings.bUseHugePages = FParse::Param(FCommandLine::Get(),
+		TEXT("PhysicsHugePages"));
+
+	return Settings;
+}
+
+void FPhysicsMemoryAccounting::RecordAllocation(const int64 Size)
+{
+	const int64 NewAllocatedBytes = AllocatedBytes.fetch_add(Size,
+		std::memory_order_relaxed) + Size;
+
+	int64 CurrentPeak = PeakAllocatedBytes.load(std::memory_order_relaxed);
+	while (NewAllocatedBytes > CurrentPeak &&
+		!PeakAllocatedBytes.compare_exchange_weak(CurrentPeak,
+		NewAllocatedBytes, std::memory_order_relaxed))
+	{
+	}
+
+	AllocationCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FPhysicsMemoryAccounting::RecordFree(const int64 Size)
+{
+	AllocatedBytes.fetch_sub(Size, std::memory_order_relaxed);
+	FreeCount.fetch_add(1, std::memory_order_relaxed);
+}
+
+void FPhysicsMemoryAccounting::RecordTempAllocatorUsage
+	(const uint32 UsedBytes)
+{
+	uint32 CurrentHighWaterMark =
+		TempAllocatorHighWaterMark.load(std::memory_order_relaxed);
+	while (UsedBytes > CurrentHighWaterMark &&
+		!TempAllocatorHighWaterMark.compare_exchange_weak
+		(CurrentHighWaterMark, UsedBytes, std::memory_order_relaxed))
+	{
+	}
+}
+
+void FPhysicsMemoryAccounting::ResetPeaks()
+{
+	PeakAllocatedBytes.store(AllocatedBytes.load(std::memory_order_relaxed),
+		std::memory_order_relaxed);
+	TempAllocatorHighWaterMark.store(0, std::memory_order_relaxed);
+}
+
+FString FPhysicsMemoryAccounting::GetMeasureLine() const
+{
+	return FString::Printf(TEXT("Memory;%lld;%lld;%llu;%llu;%u\n"),
+		AllocatedBytes.load(std::memory_order_relaxed),
+		PeakAllocatedBytes.load(std::memory_order_relaxed),
+		AllocationCount.load(std::memory_order_relaxed),
+		FreeCount.load(std::memory_order_relaxed),
+		TempAllocatorHighWaterMark.load(std::memory_order_relaxed));
+}
+
+FPhysicsMemoryAccountingScope::FPhysicsMemoryAccountingScope
+	(FPhysicsMemoryAccounting* InAccounting)
+	: PreviousAccounting(CurrentAccounting)
+{
+	CurrentAccounting = InAccounting;
+}
+
+FPhysicsMemoryAccountingScope::~FPhysicsMemoryAccountingScope()
+{
+	CurrentAccounting = PreviousAccounting;
+}
+
+void FPhysicsServiceAllocator::Register
+	(const FPhysicsAllocatorSettings& Settings)
+{
+	AllocatorSettings = Settings;
+
+#ifndef JPH_DISABLE_CUSTOM_ALLOCATOR
+	JPH::Allocate = AllocateImpl;
+	JPH::Free = FreeImpl;
+	JPH::AlignedAllocate = AlignedAllocateImpl;
+	JPH::AlignedFree = AlignedFreeImpl;
+
+	LPES_LOG_INFO(TEXT("Physics allocator registered (backend: %d, arena "
+		"chunk: %llu bytes, huge pages: %d)."), (int32)Settings.Backend,
+		Settings.ArenaChunkSize, Settings.bUseHugePages);
+#else
+	LPES_LOG_WARNING(TEXT("Jolt was built without custom allocators. The "
+		"physics allocations are not accounted."));
+#endif
+}
+
+void FPhysicsServiceAllocator::Unregister()
+{
+	FScopeLock ArenaChunksLock(&ArenaChunksCriticalSection);
+
+	if (ArenaChunks.Num() == 0)
+	{
+		return;
+	}
+
+	// Blocks still allocated would point into the released arenas
+	const int64 LiveBlocks = LiveArenaBlocks.load(std::memory_order_relaxed);
+	if (LiveBlocks > 0)
+	{
+		LPES_LOG_WARNING(TEXT("Physics arenas were not released, as %lld "
+			"blocks are still allocated on them."), LiveBlocks);
+		return;
+	}
+
+	for (FArenaSizeClass& ArenaSizeClass : ArenaSizeClasses)
+	{
+		FScopeLock SizeClassLock(&ArenaSizeClass.Lock);
+		ArenaSizeClass.FreeBlocks = nullptr;
+	}
+
+	for (const FArenaChunk& ArenaChunk : ArenaChunks)
+	{
+		FreeLargeBlock(ArenaChunk.Base, ArenaChunk.Size);
+	}
+
+	ArenaChunks.Empty();
+	ArenaChunkTop = nullptr;
+	ArenaChunkEnd = nullptr;
+}
+
+FPhysicsMemoryAccounting* FPhysicsServiceAllocator::GetWorldAccounting
+	(const int32 WorldId)
+{
+	FScopeLock WorldAccountingsLock(&WorldAccountingsCriticalSection);
+
+	FPhysicsMemoryAccounting*& WorldAccounting =
+		WorldAccountings.FindOrAdd(WorldId);
+	if (!WorldAccounting)
+	{
+		WorldAccounting = new FPhysicsMemoryAccounting();
+	}
+
+	return WorldAccounting;
+}
+
+FPhysicsMemoryAccounting& FPhysicsServiceAllocator::GetUnattributedAccounting()
+{
+	return UnattributedAccounting;
+}
+
+void* FPhysicsServiceAllocator::AllocateLargeBlock(const uint64 Size)
+{
+	if (AllocatorSettings.Backend == EPhysicsAllocatorBackend::System)
+	{
+		return std::malloc(Size);
+	}
+
+	if (AllocatorSettings.Backend == EPhysicsAllocatorBackend::UnrealMemory)
+	{
+		return FMemory::Malloc(Size, 4096);
+	}
+
+	// The arena blocks are taken from the OS, on huge pages if enabled
+	void* LargeBlock = nullptr;
+
+#if PLATFORM_WINDOWS
+	if (AllocatorSettings.bUseHugePages)
+	{
+		// Large pages need the "Lock pages in memory" privilege. If not
+		// granted, this fails and regular pages are used
+		const SIZE_T LargePageSize = GetLargePageMinimum();
+		if (LargePageSize > 0)
+		{
+			LargeBlock = VirtualAlloc(nullptr, Align(Size, LargePageSize),
+				MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE);
+		}
+	}
+
+	if (!LargeBlock)
+	{
+		LargeBlock = VirtualAlloc(nullptr, Size, MEM_RESERVE | MEM_COMMIT,
+			PAGE_READWRITE);
+	}
+#elif PLATFORM_LINUX
+	const uint64 MappedSize = AllocatorSettings.bUseHugePages ?
+		Align(Size, HugePageSize) : Size;
+
+	if (AllocatorSettings.bUseHugePages)
+	{
+		LargeBlock = mmap(nullptr, MappedSize, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		if (LargeBlock == MAP_FAILED)
+		{
+			// No huge pages reserved. Ask for transparent huge pages instead
+			LargeBlock = mmap(nullptr, MappedSize, PROT_READ | PROT_WRITE,
+				MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (LargeBlock != MAP_FAILED)
+			{
+				madvise(LargeBlock, MappedSize, MADV_HUGEPAGE);
+			}
+		}
+	}
+	else
+	{
+		LargeBlock = mmap(nullptr, MappedSize, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	}
+
+	if (LargeBlock == MAP_FAILED)
+	{
+		LargeBlock = nullptr;
+	}
+#else
+	LargeBlock = FMemory::Malloc(Size, 4096);
+#endif
+
+	if (!LargeBlock)
+	{
+		LPES_LOG_ERROR(TEXT("Could not allocate a physics arena of %llu "
+			"bytes."), Size);
+		return nullptr;
+	}
+
+	// Pre-fault the pages, so the steps never page fault on them
+	FMemory::Memzero(LargeBlock, Size);
+
+	return LargeBlock;
+}
+
+void FPhysicsServiceAllocator::FreeLargeBlock(void* Block, const uint64 Size)
+{
+	if (!Block)
+	{
+		return;
+	}
+
+	if (AllocatorSettings.Backend == EPhysicsAllocatorBackend::System)
+	{
+		std::free(Block);
+		return;
+	}
+
+	if (AllocatorSettings.Backend == EPhysicsAllocatorBackend::UnrealMemory)
+	{
+		FMemory::Free(Block);
+		return;
+	}
+
+#if PLATFORM_WINDOWS
+	VirtualFree(Block, 0, MEM_RELEASE);
+#elif PLATFORM_LINUX
+	munmap(Block, AllocatorSettings.bUseHugePages ? Align(Size, HugePageSize) :
+		Size);
+#else
+	FMemory::Free(Block);
+#endif
+}
+
+FPhysicsTempAllocator::FPhysicsTempAllocator(const uint32 InSize)
+	: Size(InSize)
+{
+	Base = static_cast<uint8*>(FPhysicsServiceAllocator::AllocateLargeBlock
+		(Size));
+}
+
+FPhysicsTempAllocator::~FPhysicsTempAllocator()
+{
+	JPH_ASSERT(Top == 0);
+	FPhysicsServiceAllocator::FreeLargeBlock(Base, Size);
+}
+
+void* FPhysicsTempAllocator::Allocate(uint inSize)
+{
+	if (inSize == 0)
+	{
+		return nullptr;
+	}
+
+	const uint32 AlignedSize = AlignUp(inSize, JPH_RVECTOR_ALIGNMENT);
+
+	// Fall back to the heap if the allocation doesn't fit
+	if (!Base || Top + AlignedSize > Size)
+	{
+		OverflowCount++;
+		return JPH::AlignedAllocate(AlignedSize, JPH_RVECTOR_ALIGNMENT);
+	}
+
+	void* Address = Base + Top;
+	Top += AlignedSize;
+	HighWaterMark = FMath::Max(HighWaterMark, Top);
+
+	return Address;
+}
+
+void FPhysicsTempAllocator::Free(void* inAddress, uint inSize)
+{
+	if (!inAddress)
+	{
+		return;
+	}
+
+	// The allocations outside the block are the ones that didn't fit on it
+	uint8* Address = static_cast<uint8*>(inAddress);
+	if (!Base || Address < Base || Address >= Base + Size)
+	{
+		JPH::AlignedFree(inAddress);
+		return;
+	}
+
+	Top -= AlignUp(inSize, JPH_RVECTOR_ALIGNMENT);
+	JPH_ASSERT(Base + Top == Address);
+}
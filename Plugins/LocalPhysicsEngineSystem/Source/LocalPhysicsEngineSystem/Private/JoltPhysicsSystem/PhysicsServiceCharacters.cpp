@@ -0,0 +1,426 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/PhysicsServiceCharacters.h"
+#include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/ObjectLayerPairFilterImpl.h"
+#include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/BroadPhaseLayerInterfaceImpl.h"
+#include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/PhysicsParallelFor.h"
+#include "LocalPhysicsEngineSystem/LocalPhysicsEngineSystemLogging.h"
+
+#include <Jolt/Core/TempAllocator.h>
+#include <Jolt/Physics/Body/BodyCreationSettings.h>
+#include <Jolt/Physics/Body/BodyFilter.h>
+#include <Jolt/Physics/Collision/Shape/CapsuleShape.h>
+#include <Jolt/Physics/Collision/Shape/RotatedTranslatedShape.h>
+
+namespace
+{
+	/** The min amount of characters updated on each job */
+	constexpr int32 MinCharactersPerJob = 4;
+
+	/**
+	* The distance between the character and the client's position past which
+	* the character is teleported to the client's position (e.g. respawns)
+	*/
+	constexpr float CharacterTeleportDistance = 500.f;
+
+	/** The max slope the characters can walk on */
+	constexpr float CharacterMaxSlopeAngleDegrees = 45.f;
+
+	/** The character's mass, used to push the bodies it stands on (kg) */
+	constexpr float CharacterMass = 70.f;
+
+	/**
+	* The max force a character pushes the bodies with (kg * cm / s^2), as the
+	* world is on Unreal's units
+	*/
+	constexpr float CharacterMaxStrength = 10000.f;
+
+	/** The vertical speed below which a character is not leaving the ground */
+	constexpr float CharacterLeavingGroundSpeed = 10.f;
+
+	/**
+	* Broad phase layer filter of the characters. They collide with every
+	* layer but the sensors, which never block them
+	*/
+	class FCharacterBroadPhaseLayerFilter : public BroadPhaseLayerFilter
+	{
+	public:
+		virtual bool ShouldCollide(BroadPhaseLayer inLayer) const override
+			{ return inLayer != BroadPhaseLayers::SENSOR; }
+	};
+
+	/**
+	* Object layer filter of the characters. They collide with every layer
+	* but the sensors, which never block them
+	*/
+	class FCharacterObjectLayerFilter : public ObjectLayerFilter
+	{
+	public:
+		virtual bool ShouldCollide(ObjectLayer inLayer) const override
+			{ return inLayer != Layers::SENSOR; }
+	};
+}
+
+void FPhysicsServiceCharacters::Init(PhysicsSystem* InPhysicsSystem,
+	const uint32 InFirstCharacterBodyIndex,
+	const FPhysicsWorldOrigin& InWorldOrigin)
+{
+	RemoveAllCharacters();
+
+	World = InPhysicsSystem;
+	WorldOrigin = InWorldOrigin;
+	FirstCharacterBodyIndex = InFirstCharacterBodyIndex;
+
+	// Take the lowest indices first
+	FreeCharacterBodyIndices.Empty(MaxCharacters);
+	for (uint32 i = MaxCharacters; i > 0; i--)
+	{
+		FreeCharacterBodyIndices.Add(FirstCharacterBodyIndex + i - 1);
+	}
+}
+
+void FPhysicsServiceCharacters::SetCharacterInputs
+	(const TArray<FString>& CharacterInputLines)
+{
+	for (auto& CharacterPair : Characters)
+	{
+		CharacterPair.Value.bHasInput = false;
+	}
+
+	for (const FString& CharacterInputLine : CharacterInputLines)
+	{
+		TArray<FString> CharacterInput;
+		CharacterInputLine.ParseIntoArray(CharacterInput, TEXT(";"));
+
+		if (CharacterInput.Num() < 11 || CharacterInput[0] != "Character")
+		{
+			LPES_LOG_WARNING(TEXT("Could not parse character input \"%s\"."),
+				*CharacterInputLine);
+			continue;
+		}
+
+		const int32 CharacterId = FCString::Atoi(*CharacterInput[1]);
+		const float CapsuleRadius = FCString::Atof(*CharacterInput[2]);
+		const float CapsuleHalfHeight = FCString::Atof(*CharacterInput[3]);
+		const RVec3 ClientPosition = WorldOrigin.ParseLocalPosition
+			(CharacterInput, 4);
+
+		// Recreate the character if its capsule has changed (e.g. crouching)
+		FPhysicsCharacter* PhysicsCharacter = Characters.Find(CharacterId);
+		if (PhysicsCharacter &&
+			(PhysicsCharacter->CapsuleRadius != CapsuleRadius ||
+			PhysicsCharacter->CapsuleHalfHeight != CapsuleHalfHeight))
+		{
+			RemoveCharacter(CharacterId);
+			PhysicsCharacter = nullptr;
+		}
+
+		if (!PhysicsCharacter)
+		{
+			PhysicsCharacter = AddCharacter(CharacterId, CapsuleRadius,
+				CapsuleHalfHeight, ClientPosition);
+			if (!PhysicsCharacter)
+			{
+				continue;
+			}
+		}
+		else if (Vec3(PhysicsCharacter->Character->GetPosition() -
+			ClientPosition).Length() > CharacterTeleportDistance)
+		{
+			PhysicsCharacter->Character->SetPosition(ClientPosition);
+			PhysicsCharacter->Character->SetLinearVelocity(Vec3::sZero());
+			World->GetBodyInterface().SetPosition
+				(PhysicsCharacter->CapsuleBodyId, ClientPosition,
+				EActivation::Activate);
+		}
+
+		// Only the horizontal velocity is taken from the input, as the
+		// vertical one is given by gravity and jumps
+		const Vec3 Up = PhysicsCharacter->Character->GetUp();
+		const Vec3 DesiredVelocity(FCString::Atof(*CharacterInput[7]),
+			FCString::Atof(*CharacterInput[8]),
+			FCString::Atof(*CharacterInput[9]));
+
+		PhysicsCharacter->DesiredVelocity = DesiredVelocity -
+			Up * Up.Dot(DesiredVelocity);
+		PhysicsCharacter->JumpSpeed = FCString::Atof(*CharacterInput[10]);
+		PhysicsCharacter->bHasInput = true;
+	}
+
+	// Remove the characters whose players are no longer on this world
+	TArray<int32> CharactersWithNoInput;
+	for (const auto& CharacterPair : Characters)
+	{
+		if (!CharacterPair.Value.bHasInput)
+		{
+			CharactersWithNoInput.Add(CharacterPair.Key);
+		}
+	}
+
+	for (const int32 CharacterId : CharactersWithNoInput)
+	{
+		RemoveCharacter(CharacterId);
+	}
+}
+
+void FPhysicsServiceCharacters::UpdateCharacters(const float DeltaTime,
+	JobSystem& CharactersJobSystem)
+{
+	if (Characters.Num() == 0)
+	{
+		return;
+	}
+
+	TArray<FPhysicsCharacter*> CharactersToUpdate;
+	CharactersToUpdate.Reserve(Characters.Num());
+	for (auto& CharacterPair : Characters)
+	{
+		CharactersToUpdate.Add(&CharacterPair.Value);
+	}
+
+	// Split the characters in batches, one job each. Each character sweeps
+	// against the world many times per update, so they are the most
+	// expensive queries the service runs. The bodies a character pushes are
+	// write locked by it, so characters can be updated at the same time
+	ParallelForBatches(CharactersJobSystem, CharactersToUpdate.Num(),
+		MinCharactersPerJob, "UpdateCharacters", [this, &CharactersToUpdate,
+		DeltaTime](const int32 FirstCharacterIndex,
+		const int32 LastCharacterIndex)
+	{
+		for (int32 i = FirstCharacterIndex; i < LastCharacterIndex; i++)
+		{
+			UpdateCharacter(*CharactersToUpdate[i], DeltaTime);
+		}
+	});
+}
+
+void FPhysicsServiceCharacters::UpdateCharacter
+	(FPhysicsCharacter& PhysicsCharacter, const float DeltaTime) const
+{
+	CharacterVirtual& Character = *PhysicsCharacter.Character;
+	const Vec3 Up = Character.GetUp();
+	const Vec3 Gravity = World->GetGravity();
+
+	// Keep the ground's velocity while on ground, so the character moves
+	// along with platforms. Otherwise, keep falling
+	const Vec3 CurrentVerticalVelocity = Up *
+		Up.Dot(Character.GetLinearVelocity());
+	const bool bIsOnGround = Character.GetGroundState() ==
+		CharacterVirtual::EGroundState::OnGround && (CurrentVerticalVelocity -
+		Character.GetGroundVelocity()).Dot(Up) < CharacterLeavingGroundSpeed;
+
+	Vec3 NewVelocity;
+	if (bIsOnGround)
+	{
+		NewVelocity = Character.GetGroundVelocity();
+
+		if (PhysicsCharacter.JumpSpeed > 0.f)
+		{
+			NewVelocity += Up * PhysicsCharacter.JumpSpeed;
+		}
+	}
+	else
+	{
+		NewVelocity = CurrentVerticalVelocity;
+	}
+
+	// The jump is consumed, so catch up steps don't jump again
+	PhysicsCharacter.JumpSpeed = 0.f;
+
+	NewVelocity += PhysicsCharacter.DesiredVelocity + Gravity * DeltaTime;
+	Character.SetLinearVelocity(NewVelocity);
+
+	// The stairs and floor settings are on Unreal's units, as the world
+	CharacterVirtual::ExtendedUpdateSettings UpdateSettings;
+	UpdateSettings.mStickToFloorStepDown = -Up * 50.f;
+	UpdateSettings.mWalkStairsStepUp = Up * 45.f;
+	UpdateSettings.mWalkStairsMinStepForward = 2.f;
+	UpdateSettings.mWalkStairsStepForwardTest = 15.f;
+
+	// Each job has its own temp allocator, as the update may run on any
+	// thread. The character's temp allocations are small
+	TempAllocatorMalloc CharacterTempAllocator;
+
+	Character.ExtendedUpdate(DeltaTime, Gravity, UpdateSettings,
+		FCharacterBroadPhaseLayerFilter(), FCharacterObjectLayerFilter(),
+		IgnoreSingleBodyFilter(PhysicsCharacter.CapsuleBodyId),
+		ShapeFilter(), CharacterTempAllocator);
+
+	// Move the capsule body to the character during the next step, so it
+	// pushes the bodies on its way with the character's velocity
+	World->GetBodyInterface().MoveKinematic(PhysicsCharacter.CapsuleBodyId,
+		Character.GetPosition(), Quat::sIdentity(), DeltaTime);
+}
+
+FString FPhysicsServiceCharacters::GetCharactersStateResponse() const
+{
+	FString CharactersStateResponse = FString();
+
+	for (const auto& CharacterPair : Characters)
+	{
+		const CharacterVirtual& Character = *CharacterPair.Value.Character;
+
+		const RVec3 Position = Character.GetPosition();
+		const Vec3 LinearVelocity = Character.GetLinearVelocity();
+		const BodyID GroundBodyId = Character.GetGroundBodyID();
+
+		CharactersStateResponse += FString::Printf(TEXT("CharacterState;%d;"
+			"%s;%f;%f;%f;%d;%d\n"), CharacterPair.Key,
+			*WorldOrigin.ToClientPositionString(Position), LinearVelocity.GetX(),
+			LinearVelocity.GetY(), LinearVelocity.GetZ(),
+			static_cast<int32>(Character.GetGroundState()),
+			GroundBodyId.IsInvalid() ? INDEX_NONE :
+			static_cast<int32>(GroundBodyId.GetIndex()));
+	}
+
+	return CharactersStateResponse;
+}
+
+void FPhysicsServiceCharacters::RemoveAllCharacters()
+{
+	TArray<int32> CharacterIds;
+	Characters.GetKeys(CharacterIds);
+
+	for (const int32 CharacterId : CharacterIds)
+	{
+		RemoveCharacter(CharacterId);
+	}
+}
+
+void FPhysicsServiceCharacters::RemoveCapsuleBodiesFromWorld()
+{
+	if (!World)
+	{
+		return;
+	}
+
+	BodyInterface& WorldBodyInterface = World->GetBodyInterface();
+	for (const auto& CharacterPair : Characters)
+	{
+		WorldBodyInterface.RemoveBody(CharacterPair.Value.CapsuleBodyId);
+	}
+}
+
+void FPhysicsServiceCharacters::AddCapsuleBodiesBackToWorld()
+{
+	if (!World)
+	{
+		return;
+	}
+
+	// The capsules' velocities were cleared on their removal, but they are
+	// moved to their characters again before the next step
+	BodyInterface& WorldBodyInterface = World->GetBodyInterface();
+	for (const auto& CharacterPair : Characters)
+	{
+		WorldBodyInterface.AddBody(CharacterPair.Value.CapsuleBodyId,
+			EActivation::Activate);
+	}
+}
+
+FPhysicsServiceCharacters::FPhysicsCharacter*
+	FPhysicsServiceCharacters::AddCharacter(const int32 CharacterId,
+	const float CapsuleRadius, const float CapsuleHalfHeight,
+	const RVec3 Position)
+{
+	if (!World || FreeCharacterBodyIndices.Num() == 0)
+	{
+		LPES_LOG_ERROR(TEXT("Could not add character %d: the max of %d "
+			"characters was reached."), CharacterId, MaxCharacters);
+		return nullptr;
+	}
+
+	if (CapsuleRadius <= 0.f)
+	{
+		LPES_LOG_ERROR(TEXT("Could not add character %d: invalid capsule "
+			"radius %f."), CharacterId, CapsuleRadius);
+		return nullptr;
+	}
+
+	// Unreal's capsule half height includes the hemispheres and its axis is
+	// the z-axis, while Jolt's capsule is along the y-axis
+	const float CylinderHalfHeight = FMath::Max(CapsuleHalfHeight -
+		CapsuleRadius, KINDA_SMALL_NUMBER);
+	RotatedTranslatedShapeSettings CapsuleShapeSettings(Vec3::sZero(),
+		Quat::sRotation(Vec3::sAxisX(), 0.5f * JPH_PI),
+		new CapsuleShape(CylinderHalfHeight, CapsuleRadius));
+
+	const ShapeSettings::ShapeResult CapsuleShapeResult =
+		CapsuleShapeSettings.Create();
+	if (CapsuleShapeResult.HasError())
+	{
+		LPES_LOG_ERROR(TEXT("Could not create character %d capsule: %s"),
+			CharacterId, UTF8_TO_TCHAR
+			(CapsuleShapeResult.GetError().c_str()));
+		return nullptr;
+	}
+
+	// The settings are on Unreal's units. The character's origin is the
+	// capsule center, as Unreal's characters, so the contacts below the
+	// cylinder can support it
+	Ref<CharacterVirtualSettings> CharacterSettings =
+		new CharacterVirtualSettings();
+	CharacterSettings->mShape = CapsuleShapeResult.Get();
+	CharacterSettings->mUp = Vec3::sAxisZ();
+	CharacterSettings->mSupportingVolume = Plane(Vec3::sAxisZ(),
+		CylinderHalfHeight);
+	CharacterSettings->mMaxSlopeAngle = DegreesToRadians
+		(CharacterMaxSlopeAngleDegrees);
+	CharacterSettings->mMass = CharacterMass;
+	CharacterSettings->mMaxStrength = CharacterMaxStrength;
+	CharacterSettings->mPredictiveContactDistance = 10.f;
+	CharacterSettings->mCollisionTolerance = 0.1f;
+	CharacterSettings->mCharacterPadding = 2.f;
+
+	// Create the capsule body the bodies collide with. It is on the ghost
+	// layer, so it only collides with the moving bodies
+	const uint32 CapsuleBodyIndex = FreeCharacterBodyIndices.Pop(false);
+
+	BodyCreationSettings CapsuleBodySettings(CapsuleShapeResult.Get(),
+		Position, Quat::sIdentity(), EMotionType::Kinematic, Layers::GHOST);
+
+	BodyInterface& WorldBodyInterface = World->GetBodyInterface();
+	Body* CapsuleBody = WorldBodyInterface.CreateBodyWithID
+		(BodyID(CapsuleBodyIndex), CapsuleBodySettings);
+	if (!CapsuleBody)
+	{
+		LPES_LOG_ERROR(TEXT("Could not create character %d capsule body with "
+			"index %u."), CharacterId, CapsuleBodyIndex);
+		FreeCharacterBodyIndices.Add(CapsuleBodyIndex);
+		return nullptr;
+	}
+
+	WorldBodyInterface.AddBody(CapsuleBody->GetID(), EActivation::Activate);
+
+	FPhysicsCharacter& NewCharacter = Characters.Add(CharacterId);
+	NewCharacter.Character = new CharacterVirtual(CharacterSettings,
+		Position, Quat::sIdentity(), World);
+	NewCharacter.CapsuleBodyId = CapsuleBody->GetID();
+	NewCharacter.CapsuleRadius = CapsuleRadius;
+	NewCharacter.CapsuleHalfHeight = CapsuleHalfHeight;
+
+	LPES_LOG_INFO(TEXT("Character %d added (capsule body: %u)."), CharacterId,
+		CapsuleBodyIndex);
+
+	return &NewCharacter;
+}
+
+void FPhysicsServiceCharacters::RemoveCharacter(const int32 CharacterId)
+{
+	FPhysicsCharacter RemovedCharacter;
+	if (!Characters.RemoveAndCopyValue(CharacterId, RemovedCharacter))
+	{
+		return;
+	}
+
+	if (World)
+	{
+		BodyInterface& WorldBodyInterface = World->GetBodyInterface();
+		WorldBodyInterface.RemoveBody(RemovedCharacter.CapsuleBodyId);
+		WorldBodyInterface.DestroyBody(RemovedCharacter.CapsuleBodyId);
+	}
+
+	FreeCharacterBodyIndices.Add(RemovedCharacter.CapsuleBodyId.GetIndex());
+
+	LPES_LOG_INFO(TEXT("Character %d removed."), CharacterId);
+}
@@ -0,0 +1,615 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/PhysicsServiceConstraints.h"
+#include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/JoltMemoryStream.h"
+#include "LocalPhysicsEngineSystem/LocalPhysicsEngineSystemLogging.h"
+
+#include "Misc/Base64.h"
+
+#include <Jolt/Physics/Body/BodyLockMulti.h>
+#include <Jolt/Physics/Constraints/DistanceConstraint.h>
+#include <Jolt/Physics/Constraints/FixedConstraint.h>
+#include <Jolt/Physics/Constraints/HingeConstraint.h>
+#include <Jolt/Physics/Constraints/PointConstraint.h>
+#include <Jolt/Physics/Constraints/SixDOFConstraint.h>
+#include <Jolt/Physics/Constraints/SliderConstraint.h>
+
+namespace
+{
+	/** The amount of arguments on a constraint line, with no six-DOF limits */
+	constexpr int32 ConstraintArguments = 17;
+
+	/** The amount of six-DOF limits following the constraint line */
+	constexpr int32 SixDOFLimitArguments = 12;
+
+	/** The six-DOF translation limits over this free the axis (cm) */
+	constexpr float SixDOFMaxTranslationLimit = 1.e6f;
+
+	/** Parses three line arguments, from the given one, as a vector */
+	Vec3 ParseVec3(const TArray<FString>& Arguments, const int32 First)
+	{
+		return Vec3(FCString::Atof(*Arguments[First]),
+			FCString::Atof(*Arguments[First + 1]),
+			FCString::Atof(*Arguments[First + 2]));
+	}
+}
+
+void FPhysicsServiceConstraints::Init(PhysicsSystem* InPhysicsSystem,
+	const FPhysicsWorldOrigin& InWorldOrigin)
+{
+	RemoveAllConstraints();
+	ConstraintEventsResponse.Reset();
+
+	World = InPhysicsSystem;
+	WorldOrigin = InWorldOrigin;
+}
+
+void FPhysicsServiceConstraints::ApplyConstraintChanges
+	(const TArray<FString>& ConstraintLines)
+{
+	if (!World || ConstraintLines.Num() == 0)
+	{
+		return;
+	}
+
+	// The removals go first, so a constraint id can be removed and created
+	// again on the same batch. A constraint id already in use is replaced
+	TArray<uint32> ConstraintIdsToRemove;
+	for (const FString& ConstraintLine : ConstraintLines)
+	{
+		if (ConstraintLine.StartsWith(TEXT("RemoveConstraint;")))
+		{
+			ConstraintIdsToRemove.Add(static_cast<uint32>(FCString::Atoi
+				(*ConstraintLine.RightChop(17))));
+		}
+		else if (ConstraintLine.StartsWith(TEXT("Constraint;")))
+		{
+			ConstraintIdsToRemove.Add(static_cast<uint32>(FCString::Atoi
+				(*ConstraintLine.RightChop(11))));
+		}
+	}
+
+	RemoveConstraints(ConstraintIdsToRemove, nullptr);
+
+	TArray<Constraint*> ConstraintsToAdd;
+	for (const FString& ConstraintLine : ConstraintLines)
+	{
+		TArray<FString> ConstraintInfo;
+		ConstraintLine.ParseIntoArray(ConstraintInfo, TEXT(";"));
+
+		if (ConstraintInfo.Num() < 2 || ConstraintInfo[0] != "Constraint")
+		{
+			continue;
+		}
+
+		const uint32 ConstraintId = static_cast<uint32>(FCString::Atoi
+			(*ConstraintInfo[1]));
+		// The first constraint with the id is kept, so the client isn't told
+		// it was removed
+		if (Constraints.Contains(ConstraintId))
+		{
+			LPES_LOG_WARNING(TEXT("Constraint %u is created twice on the same "
+				"batch."), ConstraintId);
+			ConstraintEventsResponse += FString::Printf
+				(TEXT("ConstraintAdded;%u;duplicate\n"), ConstraintId);
+			continue;
+		}
+
+		const Ref<TwoBodyConstraintSettings> ConstraintSettings =
+			CreateConstraintSettings(ConstraintInfo);
+
+		FPhysicsConstraint NewPhysicsConstraint;
+		if (ConstraintInfo.Num() >= ConstraintArguments)
+		{
+			const int32 BodyIndex2 = FCString::Atoi(*ConstraintInfo[4]);
+			NewPhysicsConstraint.BodyId1 = BodyID(FCString::Atoi
+				(*ConstraintInfo[3]));
+			NewPhysicsConstraint.BodyId2 = BodyIndex2 < 0 ? BodyID() :
+				BodyID(BodyIndex2);
+		}
+
+		if (!ConstraintSettings || !CreateConstraint(ConstraintId,
+			*ConstraintSettings, NewPhysicsConstraint))
+		{
+			LPES_LOG_WARNING(TEXT("Could not create constraint \"%s\"."),
+				*ConstraintLine);
+			ConstraintEventsResponse += FString::Printf
+				(TEXT("ConstraintRemoved;%u;failed\n"), ConstraintId);
+			continue;
+		}
+
+		NewPhysicsConstraint.BreakImpulse = FMath::Max(FCString::Atof
+			(*ConstraintInfo[5]), 0.f);
+
+		ConstraintsToAdd.Add(NewPhysicsConstraint.Constraint.GetPtr());
+		Constraints.Add(ConstraintId, NewPhysicsConstraint);
+	}
+
+	if (ConstraintsToAdd.Num() == 0)
+	{
+		return;
+	}
+
+	World->AddConstraints(ConstraintsToAdd.GetData(), ConstraintsToAdd.Num());
+
+	// Sleeping bodies don't notice the new constraints by themselves
+	for (const Constraint* AddedConstraint : ConstraintsToAdd)
+	{
+		const uint32 ConstraintId = static_cast<uint32>
+			(AddedConstraint->GetUserData() & ~PSDConstraintTag);
+		ActivateConstraintBodies(Constraints[ConstraintId]);
+	}
+}
+
+void FPhysicsServiceConstraints::RemoveBodyConstraints
+	(const BodyID& ConstrainedBodyId)
+{
+	TArray<uint32> ConstraintIdsToRemove;
+	for (const auto& ConstraintPair : Constraints)
+	{
+		if (ConstraintPair.Value.BodyId1 == ConstrainedBodyId ||
+			ConstraintPair.Value.BodyId2 == ConstrainedBodyId)
+		{
+			ConstraintIdsToRemove.Add(ConstraintPair.Key);
+		}
+	}
+
+	RemoveConstraints(ConstraintIdsToRemove, TEXT("body"));
+}
+
+void FPhysicsServiceConstraints::BreakOverloadedConstraints()
+{
+	TArray<uint32> ConstraintIdsToBreak;
+	for (const auto& ConstraintPair : Constraints)
+	{
+		const FPhysicsConstraint& PhysicsConstraint = ConstraintPair.Value;
+		if (PhysicsConstraint.BreakImpulse > 0.f && GetConstraintImpulse
+			(*PhysicsConstraint.Constraint) > PhysicsConstraint.BreakImpulse)
+		{
+			ConstraintIdsToBreak.Add(ConstraintPair.Key);
+		}
+	}
+
+	RemoveConstraints(ConstraintIdsToBreak, TEXT("broken"));
+}
+
+FString FPhysicsServiceConstraints::ConsumeConstraintEventsResponse()
+{
+	FString ConsumedConstraintEvents = MoveTemp(ConstraintEventsResponse);
+	ConstraintEventsResponse.Reset();
+
+	return ConsumedConstraintEvents;
+}
+
+FString FPhysicsServiceConstraints::SaveConstraints() const
+{
+	if (!World)
+	{
+		return FString();
+	}
+
+	// The settings are relative to the bodies, so the constraints can be
+	// recreated on the bodies' initial placement
+	FString SavedConstraints = FString();
+	for (const auto& ConstraintPair : Constraints)
+	{
+		const FPhysicsConstraint& PhysicsConstraint = ConstraintPair.Value;
+
+		TArray<uint8> SettingsBytes;
+		FMemoryStreamOut SettingsStream(SettingsBytes);
+		PhysicsConstraint.Constraint->GetConstraintSettings()->
+			SaveBinaryState(SettingsStream);
+
+		SavedConstraints += FString::Printf(TEXT("SavedConstraint;%u;%d;%d;"
+			"%.9g;%s\n"), ConstraintPair.Key,
+			PhysicsConstraint.BodyId1.GetIndex(),
+			PhysicsConstraint.BodyId2.IsInvalid() ? INDEX_NONE :
+			static_cast<int32>(PhysicsConstraint.BodyId2.GetIndex()),
+			PhysicsConstraint.BreakImpulse, *FBase64::Encode(SettingsBytes));
+	}
+
+	// The vehicles' constraints are on the world too, and Jolt saves the
+	// state of every constraint on the order they are on the world
+	SavedConstraints += "ConstraintOrder";
+	for (const Ref<Constraint>& WorldConstraint : World->GetConstraints())
+	{
+		SavedConstraints += FString::Printf(TEXT(";%llu"),
+			WorldConstraint->GetUserData());
+	}
+
+	return SavedConstraints + "\n";
+}
+
+bool FPhysicsServiceConstraints::RestoreConstraints
+	(const TArray<FString>& SavedConstraintLines,
+	const FString& ConstraintOrderLine)
+{
+	if (!World)
+	{
+		return false;
+	}
+
+	bool bWereAllRestored = true;
+
+	TArray<Constraint*> ConstraintsToAdd;
+	for (const FString& SavedConstraintLine : SavedConstraintLines)
+	{
+		TArray<FString> SavedConstraintInfo;
+		SavedConstraintLine.ParseIntoArray(SavedConstraintInfo, TEXT(";"));
+
+		TArray<uint8> SettingsBytes;
+		if (SavedConstraintInfo.Num() < 6 ||
+			!FBase64::Decode(SavedConstraintInfo[5].TrimStartAndEnd(),
+			SettingsBytes))
+		{
+			bWereAllRestored = false;
+			continue;
+		}
+
+		FMemoryStreamIn SettingsStream(SettingsBytes, 0);
+		const ConstraintSettings::ConstraintResult SettingsResult =
+			ConstraintSettings::sRestoreFromBinaryState(SettingsStream);
+
+		const uint32 ConstraintId = static_cast<uint32>(FCString::Atoi
+			(*SavedConstraintInfo[1]));
+		const int32 BodyIndex2 = FCString::Atoi(*SavedConstraintInfo[3]);
+
+		FPhysicsConstraint RestoredPhysicsConstraint;
+		RestoredPhysicsConstraint.BodyId1 = BodyID(FCString::Atoi
+			(*SavedConstraintInfo[2]));
+		RestoredPhysicsConstraint.BodyId2 = BodyIndex2 < 0 ? BodyID() :
+			BodyID(BodyIndex2);
+		RestoredPhysicsConstraint.BreakImpulse = FCString::Atof
+			(*SavedConstraintInfo[4]);
+
+		const TwoBodyConstraintSettings* RestoredSettings =
+			SettingsResult.HasError() ? nullptr :
+			DynamicCast<TwoBodyConstraintSettings>(SettingsResult.Get().
+			GetPtr());
+
+		if (!RestoredSettings || !CreateConstraint(ConstraintId,
+			*RestoredSettings, RestoredPhysicsConstraint))
+		{
+			LPES_LOG_ERROR(TEXT("Could not restore constraint %u."),
+				ConstraintId);
+			bWereAllRestored = false;
+			continue;
+		}
+
+		ConstraintsToAdd.Add(RestoredPhysicsConstraint.Constraint.GetPtr());
+		Constraints.Add(ConstraintId, RestoredPhysicsConstraint);
+	}
+
+	World->AddConstraints(ConstraintsToAdd.GetData(), ConstraintsToAdd.Num());
+
+	// Put the world's constraints on the saved order. Any constraint not on
+	// it goes last
+	TArray<FString> SavedConstraintOrder;
+	ConstraintOrderLine.ParseIntoArray(SavedConstraintOrder, TEXT(";"));
+
+	TArray<Constraint*> WorldConstraints;
+	for (const Ref<Constraint>& WorldConstraint : World->GetConstraints())
+	{
+		WorldConstraints.Add(WorldConstraint.GetPtr());
+	}
+
+	TArray<Constraint*> OrderedConstraints;
+	OrderedConstraints.Reserve(WorldConstraints.Num());
+	for (int32 i = 1; i < SavedConstraintOrder.Num(); i++)
+	{
+		const uint64 ConstraintUserData = FCString::Strtoui64
+			(*SavedConstraintOrder[i], nullptr, 10);
+
+		const int32 WorldConstraintIndex = WorldConstraints.IndexOfByPredicate
+			([ConstraintUserData](const Constraint* WorldConstraint)
+			{ return WorldConstraint->GetUserData() == ConstraintUserData; });
+		if (WorldConstraintIndex != INDEX_NONE)
+		{
+			OrderedConstraints.Add(WorldConstraints[WorldConstraintIndex]);
+			WorldConstraints.RemoveAt(WorldConstraintIndex);
+		}
+	}
+	OrderedConstraints.Append(WorldConstraints);
+
+	// The world keeps a reference to the constraints, but so do the
+	// vehicles and this, so they survive being removed
+	World->RemoveConstraints(OrderedConstraints.GetData(),
+		OrderedConstraints.Num());
+	World->AddConstraints(OrderedConstraints.GetData(),
+		OrderedConstraints.Num());
+
+	return bWereAllRestored;
+}
+
+void FPhysicsServiceConstraints::RemoveAllConstraints()
+{
+	TArray<uint32> ConstraintIdsToRemove;
+	Constraints.GetKeys(ConstraintIdsToRemove);
+
+	RemoveConstraints(ConstraintIdsToRemove, nullptr);
+}
+
+Ref<TwoBodyConstraintSettings>
+	FPhysicsServiceConstraints::CreateConstraintSettings
+	(const TArray<FString>& ConstraintInfo)
+{
+	if (ConstraintInfo.Num() < ConstraintArguments)
+	{
+		return nullptr;
+	}
+
+	const FString ConstraintType = ConstraintInfo[2].TrimStartAndEnd();
+	const RVec3 Anchor = WorldOrigin.ParseLocalPosition(ConstraintInfo, 6);
+	const Vec3 Axis = ParseVec3(ConstraintInfo, 9);
+	const float LimitMin = FCString::Atof(*ConstraintInfo[15]);
+	const float LimitMax = FCString::Atof(*ConstraintInfo[16]);
+	const bool bHasLimits = LimitMin < LimitMax;
+
+	// The axes are made orthonormal, as Jolt expects
+	const Vec3 PrimaryAxis = Axis.NormalizedOr(Vec3::sAxisX());
+	Vec3 NormalAxis = ParseVec3(ConstraintInfo, 12);
+	NormalAxis -= PrimaryAxis * PrimaryAxis.Dot(NormalAxis);
+	NormalAxis = NormalAxis.IsNearZero() ?
+		PrimaryAxis.GetNormalizedPerpendicular() : NormalAxis.Normalized();
+
+	Ref<TwoBodyConstraintSettings> NewConstraintSettings;
+
+	if (ConstraintType == "fixed")
+	{
+		FixedConstraintSettings* FixedSettings =
+			new FixedConstraintSettings();
+		FixedSettings->mPoint1 = FixedSettings->mPoint2 = Anchor;
+		FixedSettings->mAxisX1 = FixedSettings->mAxisX2 = PrimaryAxis;
+		FixedSettings->mAxisY1 = FixedSettings->mAxisY2 = NormalAxis;
+		NewConstraintSettings = FixedSettings;
+	}
+	else if (ConstraintType == "point")
+	{
+		PointConstraintSettings* PointSettings =
+			new PointConstraintSettings();
+		PointSettings->mPoint1 = PointSettings->mPoint2 = Anchor;
+		NewConstraintSettings = PointSettings;
+	}
+	else if (ConstraintType == "hinge")
+	{
+		HingeConstraintSettings* HingeSettings =
+			new HingeConstraintSettings();
+		HingeSettings->mPoint1 = HingeSettings->mPoint2 = Anchor;
+		HingeSettings->mHingeAxis1 = HingeSettings->mHingeAxis2 = PrimaryAxis;
+		HingeSettings->mNormalAxis1 = HingeSettings->mNormalAxis2 =
+			NormalAxis;
+		if (bHasLimits)
+		{
+			HingeSettings->mLimitsMin = DegreesToRadians(FMath::Clamp
+				(LimitMin, -180.f, 0.f));
+			HingeSettings->mLimitsMax = DegreesToRadians(FMath::Clamp
+				(LimitMax, 0.f, 180.f));
+		}
+		NewConstraintSettings = HingeSettings;
+	}
+	else if (ConstraintType == "slider")
+	{
+		SliderConstraintSettings* SliderSettings =
+			new SliderConstraintSettings();
+		SliderSettings->mPoint1 = SliderSettings->mPoint2 = Anchor;
+		SliderSettings->mSliderAxis1 = SliderSettings->mSliderAxis2 =
+			PrimaryAxis;
+		SliderSettings->mNormalAxis1 = SliderSettings->mNormalAxis2 =
+			NormalAxis;
+		if (bHasLimits)
+		{
+			SliderSettings->mLimitsMin = FMath::Min(LimitMin, 0.f);
+			SliderSettings->mLimitsMax = FMath::Max(LimitMax, 0.f);
+		}
+		NewConstraintSettings = SliderSettings;
+	}
+	else if (ConstraintType == "distance")
+	{
+		// The distance is taken from the bodies' placement if not limited
+		DistanceConstraintSettings* DistanceSettings =
+			new DistanceConstraintSettings();
+		DistanceSettings->mPoint1 = Anchor;
+		DistanceSettings->mPoint2 = WorldOrigin.ParseLocalPosition
+			(ConstraintInfo, 9);
+		if (bHasLimits)
+		{
+			DistanceSettings->mMinDistance = FMath::Max(LimitMin, 0.f);
+			DistanceSettings->mMaxDistance = LimitMax;
+		}
+		NewConstraintSettings = DistanceSettings;
+	}
+	else if (ConstraintType == "sixdof" && ConstraintInfo.Num() >=
+		ConstraintArguments + SixDOFLimitArguments)
+	{
+		SixDOFConstraintSettings* SixDOFSettings =
+			new SixDOFConstraintSettings();
+		SixDOFSettings->mPosition1 = SixDOFSettings->mPosition2 = Anchor;
+		SixDOFSettings->mAxisX1 = SixDOFSettings->mAxisX2 = PrimaryAxis;
+		SixDOFSettings->mAxisY1 = SixDOFSettings->mAxisY2 = NormalAxis;
+
+		for (int32 AxisIndex = 0; AxisIndex < SixDOFConstraintSettings::Num;
+			AxisIndex++)
+		{
+			const SixDOFConstraintSettings::EAxis SixDOFAxis =
+				static_cast<SixDOFConstraintSettings::EAxis>(AxisIndex);
+			const bool bIsRotation = AxisIndex >=
+				SixDOFConstraintSettings::RotationX;
+
+			const int32 FirstLimit = ConstraintArguments + AxisIndex * 2;
+			float AxisLimitMin = FCString::Atof(*ConstraintInfo[FirstLimit]);
+			float AxisLimitMax = FCString::Atof(*ConstraintInfo
+				[FirstLimit + 1]);
+
+			const float MaxAxisLimit = bIsRotation ? 180.f :
+				SixDOFMaxTranslationLimit;
+			if (AxisLimitMin <= -MaxAxisLimit && AxisLimitMax >= MaxAxisLimit)
+			{
+				SixDOFSettings->MakeFreeAxis(SixDOFAxis);
+				continue;
+			}
+
+			if (AxisLimitMin >= AxisLimitMax)
+			{
+				SixDOFSettings->MakeFixedAxis(SixDOFAxis);
+				continue;
+			}
+
+			AxisLimitMin = FMath::Clamp(AxisLimitMin, -MaxAxisLimit, 0.f);
+			AxisLimitMax = FMath::Clamp(AxisLimitMax, 0.f, MaxAxisLimit);
+
+			// The swings are a cone, so their limits are symmetric
+			if (SixDOFAxis == SixDOFConstraintSettings::RotationY ||
+				SixDOFAxis == SixDOFConstraintSettings::RotationZ)
+			{
+				AxisLimitMax = FMath::Max(-AxisLimitMin, AxisLimitMax);
+				AxisLimitMin = -AxisLimitMax;
+			}
+
+			if (bIsRotation)
+			{
+				AxisLimitMin = DegreesToRadians(AxisLimitMin);
+				AxisLimitMax = DegreesToRadians(AxisLimitMax);
+			}
+
+			if (AxisLimitMin < AxisLimitMax)
+			{
+				SixDOFSettings->SetLimitedAxis(SixDOFAxis, AxisLimitMin,
+					AxisLimitMax);
+			}
+			else
+			{
+				SixDOFSettings->MakeFixedAxis(SixDOFAxis);
+			}
+		}
+		NewConstraintSettings = SixDOFSettings;
+	}
+	else
+	{
+		return nullptr;
+	}
+
+	NewConstraintSettings->mSpace = EConstraintSpace::WorldSpace;
+	return NewConstraintSettings;
+}
+
+bool FPhysicsServiceConstraints::CreateConstraint(const uint32 ConstraintId,
+	const TwoBodyConstraintSettings& ConstraintSettings,
+	FPhysicsConstraint& OutPhysicsConstraint) const
+{
+	// The constraint lines take the body ids from the line, while the
+	// restored ones come with them already set
+	const BodyID BodyIds[] = { OutPhysicsConstraint.BodyId1,
+		OutPhysicsConstraint.BodyId2 };
+	const int32 NumberOfBodies = BodyIds[1].IsInvalid() ? 1 : 2;
+
+	BodyLockMultiWrite BodiesLock(World->GetBodyLockInterface(), BodyIds,
+		NumberOfBodies);
+
+	Body* Body1 = BodiesLock.GetBody(0);
+	Body* Body2 = NumberOfBodies == 2 ? BodiesLock.GetBody(1) :
+		&Body::sFixedToWorld;
+
+	if (!Body1 || !Body2 || Body1 == Body2 || !Body1->IsInBroadPhase() ||
+		(NumberOfBodies == 2 && !Body2->IsInBroadPhase()))
+	{
+		return false;
+	}
+
+	TwoBodyConstraint* NewConstraint = ConstraintSettings.Create(*Body1,
+		*Body2);
+	if (!NewConstraint)
+	{
+		return false;
+	}
+
+	NewConstraint->SetUserData(PSDConstraintTag | ConstraintId);
+	OutPhysicsConstraint.Constraint = NewConstraint;
+
+	return true;
+}
+
+float FPhysicsServiceConstraints::GetConstraintImpulse
+	(const TwoBodyConstraint& Constraint)
+{
+	switch (Constraint.GetSubType())
+	{
+		case EConstraintSubType::Fixed:
+			return static_cast<const FixedConstraint&>(Constraint).
+				GetTotalLambdaPosition().Length();
+		case EConstraintSubType::Point:
+			return static_cast<const PointConstraint&>(Constraint).
+				GetTotalLambdaPosition().Length();
+		case EConstraintSubType::Hinge:
+			return static_cast<const HingeConstraint&>(Constraint).
+				GetTotalLambdaPosition().Length();
+		case EConstraintSubType::Slider:
+			return static_cast<const SliderConstraint&>(Constraint).
+				GetTotalLambdaPosition().Length();
+		case EConstraintSubType::Distance:
+			return FMath::Abs(static_cast<const DistanceConstraint&>
+				(Constraint).GetTotalLambdaPosition());
+		case EConstraintSubType::SixDOF:
+			return static_cast<const SixDOFConstraint&>(Constraint).
+				GetTotalLambdaPosition().Length();
+		default:
+			return 0.f;
+	}
+}
+
+void FPhysicsServiceConstraints::RemoveConstraints
+	(const TArray<uint32>& ConstraintIds, const TCHAR* Reason)
+{
+	if (!World || ConstraintIds.Num() == 0)
+	{
+		return;
+	}
+
+	TArray<Constraint*> ConstraintsToRemove;
+	TArray<FPhysicsConstraint> RemovedPhysicsConstraints;
+	for (const uint32 ConstraintId : ConstraintIds)
+	{
+		FPhysicsConstraint RemovedPhysicsConstraint;
+		if (!Constraints.RemoveAndCopyValue(ConstraintId,
+			RemovedPhysicsConstraint))
+		{
+			continue;
+		}
+
+		ConstraintsToRemove.Add(RemovedPhysicsConstraint.Constraint.GetPtr());
+		RemovedPhysicsConstraints.Add(RemovedPhysicsConstraint);
+
+		if (Reason)
+		{
+			ConstraintEventsResponse += FString::Printf
+				(TEXT("ConstraintRemoved;%u;%s\n"), ConstraintId, Reason);
+		}
+	}
+
+	World->RemoveConstraints(ConstraintsToRemove.GetData(),
+		ConstraintsToRemove.Num());
+
+	// The bodies that were held in place must fall (or drift) again
+	for (const FPhysicsConstraint& RemovedPhysicsConstraint :
+		RemovedPhysicsConstraints)
+	{
+		ActivateConstraintBodies(RemovedPhysicsConstraint);
+	}
+}
+
+void FPhysicsServiceConstraints::ActivateConstraintBodies
+	(const FPhysicsConstraint& PhysicsConstraint) const
+{
+	BodyInterface& WorldBodyInterface = World->GetBodyInterface();
+
+	// The removed bodies may still have constraints being removed
+	if (WorldBodyInterface.IsAdded(PhysicsConstraint.BodyId1))
+	{
+		WorldBodyInterface.ActivateBody(PhysicsConstraint.BodyId1);
+	}
+
+	if (!PhysicsConstraint.BodyId2.IsInvalid() &&
+		WorldBodyInterface.IsAdded(PhysicsConstraint.BodyId2))
+	{
+		WorldBodyInterface.ActivateBody(PhysicsConstraint.BodyId2);
+	}
+}
@@ -0,0 +1,401 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/PhysicsServiceForceFields.h"
+#include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/BroadPhaseLayerInterfaceImpl.h"
+#include "LocalPhysicsEngineSystem/LocalPhysicsEngineSystemLogging.h"
+
+#include <Jolt/Physics/Body/BodyLock.h>
+#include <Jolt/Physics/Collision/CollisionCollectorImpl.h>
+
+namespace
+{
+	/** The distance under which a body is on a field's center or axis (cm) */
+	constexpr float MinFieldDistance = 1.e-3f;
+
+	/** Broadphase layer filter that only accepts the moving bodies' tree */
+	class FMovingBroadPhaseLayerFilter : public BroadPhaseLayerFilter
+	{
+	public:
+		virtual bool ShouldCollide(BroadPhaseLayer inLayer) const override
+			{ return inLayer == BroadPhaseLayers::MOVING; }
+	};
+
+	/** Parses three line arguments, from the given one, as a vector */
+	Vec3 ParseVec3(const TArray<FString>& Arguments, const int32 First)
+	{
+		return Vec3(FCString::Atof(*Arguments[First]),
+			FCString::Atof(*Arguments[First + 1]),
+			FCString::Atof(*Arguments[First + 2]));
+	}
+}
+
+void FPhysicsServiceForceFields::Init(PhysicsSystem* InPhysicsSystem,
+	const FPhysicsWorldOrigin& InWorldOrigin)
+{
+	RemoveAllForceFields();
+
+	World = InPhysicsSystem;
+	WorldOrigin = InWorldOrigin;
+}
+
+void FPhysicsServiceForceFields::ApplyForceFieldChanges
+	(const TArray<FString>& ForceFieldLines)
+{
+	for (const FString& ForceFieldLine : ForceFieldLines)
+	{
+		TArray<FString> ForceFieldInfo;
+		ForceFieldLine.ParseIntoArray(ForceFieldInfo, TEXT(";"));
+
+		if (ForceFieldInfo.Num() == 0)
+		{
+			continue;
+		}
+
+		if (ForceFieldInfo[0] == "RemoveForceField")
+		{
+			if (ForceFieldInfo.Num() >= 2)
+			{
+				ForceFields.Remove(static_cast<uint32>(FCString::Atoi
+					(*ForceFieldInfo[1])));
+			}
+			continue;
+		}
+
+		if (ForceFieldInfo[0] == "RadialImpulse")
+		{
+			// "RadialImpulse; posX; posY; posZ; Radius; Impulse; Falloff"
+			if (ForceFieldInfo.Num() < 7)
+			{
+				LPES_LOG_WARNING(TEXT("Radial impulse with less than 7 "
+					"params: %s"), *ForceFieldLine);
+				continue;
+			}
+
+			FForceField RadialImpulse;
+			RadialImpulse.Type = EForceFieldType::RadialImpulse;
+			RadialImpulse.Center = Vec3(WorldOrigin.ParseLocalPosition
+				(ForceFieldInfo, 1));
+			RadialImpulse.Radius = FCString::Atof(*ForceFieldInfo[4]);
+			RadialImpulse.Impulse = FCString::Atof(*ForceFieldInfo[5]);
+			RadialImpulse.bLinearFalloff =
+				ForceFieldInfo[6].TrimStartAndEnd() != "constant";
+
+			if (RadialImpulse.Radius <= 0.f)
+			{
+				continue;
+			}
+
+			RadialImpulse.Bounds = AABox(RadialImpulse.Center -
+				Vec3::sReplicate(RadialImpulse.Radius), RadialImpulse.Center +
+				Vec3::sReplicate(RadialImpulse.Radius));
+
+			RadialImpulses.Add(MoveTemp(RadialImpulse));
+			continue;
+		}
+
+		FForceField ForceField;
+		if (ForceFieldInfo[0] != "ForceField" || ForceFieldInfo.Num() < 3 ||
+			!ParseForceField(ForceFieldInfo, ForceField))
+		{
+			LPES_LOG_WARNING(TEXT("Could not parse force field line: %s"),
+				*ForceFieldLine);
+			continue;
+		}
+
+		ForceFields.Add(static_cast<uint32>(FCString::Atoi
+			(*ForceFieldInfo[1])), MoveTemp(ForceField));
+	}
+}
+
+bool FPhysicsServiceForceFields::ParseForceField
+	(const TArray<FString>& ForceFieldInfo, FForceField& OutForceField) const
+{
+	const FString ForceFieldType = ForceFieldInfo[2].TrimStartAndEnd();
+	float Duration = 0.f;
+
+	if (ForceFieldType == "wind")
+	{
+		// "ForceField; FieldId; wind; min (3); max (3); windVel (3); Drag;
+		// Duration"
+		if (ForceFieldInfo.Num() < 14)
+		{
+			return false;
+		}
+
+		OutForceField.Type = EForceFieldType::Wind;
+		OutForceField.Bounds = AABox(Vec3(WorldOrigin.ParseLocalPosition
+			(ForceFieldInfo, 3)), Vec3(WorldOrigin.ParseLocalPosition
+			(ForceFieldInfo, 6)));
+		OutForceField.WindVelocity = ParseVec3(ForceFieldInfo, 9);
+		OutForceField.Drag = FMath::Max(FCString::Atof(*ForceFieldInfo[12]),
+			0.f);
+		Duration = FCString::Atof(*ForceFieldInfo[13]);
+
+		if (!OutForceField.Bounds.IsValid())
+		{
+			return false;
+		}
+	}
+	else if (ForceFieldType == "vortex")
+	{
+		// "ForceField; FieldId; vortex; pos (3); Radius; Height;
+		// TangentialAccel; InwardAccel; UpwardAccel; Duration"
+		if (ForceFieldInfo.Num() < 12)
+		{
+			return false;
+		}
+
+		OutForceField.Type = EForceFieldType::Vortex;
+		OutForceField.Center = Vec3(WorldOrigin.ParseLocalPosition
+			(ForceFieldInfo, 3));
+		OutForceField.Radius = FCString::Atof(*ForceFieldInfo[6]);
+		OutForceField.Height = FCString::Atof(*ForceFieldInfo[7]);
+		OutForceField.TangentialAcceleration =
+			FCString::Atof(*ForceFieldInfo[8]);
+		OutForceField.InwardAcceleration = FCString::Atof(*ForceFieldInfo[9]);
+		OutForceField.UpwardAcceleration =
+			FCString::Atof(*ForceFieldInfo[10]);
+		Duration = FCString::Atof(*ForceFieldInfo[11]);
+
+		if (OutForceField.Radius <= 0.f || OutForceField.Height <= 0.f)
+		{
+			return false;
+		}
+
+		const Vec3 VortexExtent(OutForceField.Radius, OutForceField.Radius,
+			0.f);
+		OutForceField.Bounds = AABox(OutForceField.Center - VortexExtent,
+			OutForceField.Center + VortexExtent + Vec3(0.f, 0.f,
+			OutForceField.Height));
+	}
+	else
+	{
+		return false;
+	}
+
+	OutForceField.RemainingTime = Duration > 0.f ? Duration : -1.f;
+
+	return true;
+}
+
+void FPhysicsServiceForceFields::GatherAffectedBodies()
+{
+	if (!World || (ForceFields.Num() == 0 && RadialImpulses.Num() == 0))
+	{
+		return;
+	}
+
+	Array<BodyID> BodiesToWake;
+
+	auto GatherAndCollect = [this, &BodiesToWake](FForceField& ForceField)
+	{
+		GatherForceFieldBodies(ForceField);
+		BodiesToWake.insert(BodiesToWake.end(),
+			ForceField.AffectedBodies.begin(), ForceField.AffectedBodies.end());
+	};
+
+	for (FForceField& RadialImpulse : RadialImpulses)
+	{
+		GatherAndCollect(RadialImpulse);
+	}
+
+	for (auto& ForceField : ForceFields)
+	{
+		GatherAndCollect(ForceField.Value);
+	}
+
+	// The sleeping bodies are not stepped, so they are woken up all at once.
+	// The ones already awake are skipped
+	if (!BodiesToWake.empty())
+	{
+		World->GetBodyInterface().ActivateBodies(BodiesToWake.data(),
+			static_cast<int>(BodiesToWake.size()));
+	}
+}
+
+void FPhysicsServiceForceFields::GatherForceFieldBodies
+	(FForceField& ForceField) const
+{
+	// Only the moving bodies' tree is queried, so the static bodies (and the
+	// kinematic ghosts) cost nothing
+	AllHitCollisionCollector<CollideShapeBodyCollector> BodiesCollector;
+	World->GetBroadPhaseQuery().CollideAABox(ForceField.Bounds,
+		BodiesCollector, FMovingBroadPhaseLayerFilter());
+
+	ForceField.AffectedBodies = MoveTemp(BodiesCollector.mHits);
+}
+
+void FPhysicsServiceForceFields::ApplyForceFields(const float DeltaTime)
+{
+	if (!World || (ForceFields.Num() == 0 && RadialImpulses.Num() == 0))
+	{
+		return;
+	}
+
+	// The world is not updating, so the bodies are locked as on any other
+	// access
+	const BodyLockInterfaceLocking& BodyLockInterface =
+		World->GetBodyLockInterface();
+
+	auto ApplyOnAffectedBodies = [&BodyLockInterface, DeltaTime]
+		(const FForceField& ForceField)
+	{
+		for (const BodyID& AffectedBodyId : ForceField.AffectedBodies)
+		{
+			BodyLockWrite AffectedBodyLock(BodyLockInterface, AffectedBodyId);
+			if (!AffectedBodyLock.Succeeded())
+			{
+				continue;
+			}
+
+			Body& AffectedBody = AffectedBodyLock.GetBody();
+			if (AffectedBody.IsDynamic() && AffectedBody.IsActive())
+			{
+				ApplyForceField(ForceField, AffectedBody, DeltaTime);
+			}
+		}
+	};
+
+	// The radial impulses are removed after the update, so they are applied
+	// once
+	for (const FForceField& RadialImpulse : RadialImpulses)
+	{
+		ApplyOnAffectedBodies(RadialImpulse);
+	}
+
+	for (const auto& ForceField : ForceFields)
+	{
+		ApplyOnAffectedBodies(ForceField.Value);
+	}
+}
+
+void FPhysicsServiceForceFields::ApplyForceField
+	(const FForceField& ForceField, Body& AffectedBody, const float DeltaTime)
+{
+	const Vec3 BodyPosition(AffectedBody.GetCenterOfMassPosition());
+
+	switch (ForceField.Type)
+	{
+		case EForceFieldType::RadialImpulse:
+		{
+			Vec3 ImpulseDirection = BodyPosition - ForceField.Center;
+			const float Distance = ImpulseDirection.Length();
+			if (Distance > ForceField.Radius)
+			{
+				return;
+			}
+
+			// A body right on the center is thrown up
+			ImpulseDirection = Distance > MinFieldDistance ?
+				ImpulseDirection / Distance : Vec3::sAxisZ();
+
+			const float Falloff = ForceField.bLinearFalloff ?
+				1.f - Distance / ForceField.Radius : 1.f;
+			AffectedBody.AddImpulse(ImpulseDirection * ForceField.Impulse *
+				Falloff);
+			break;
+		}
+		case EForceFieldType::Wind:
+		{
+			// Exponential pull, so it never overshoots the wind velocity
+			const Vec3 BodyVelocity = AffectedBody.GetLinearVelocity();
+			const float PullFraction = 1.f - FMath::Exp(-ForceField.Drag *
+				DeltaTime);
+			AffectedBody.SetLinearVelocityClamped(BodyVelocity +
+				(ForceField.WindVelocity - BodyVelocity) * PullFraction);
+			break;
+		}
+		case EForceFieldType::Vortex:
+		{
+			const Vec3 FromAxis(BodyPosition.GetX() - ForceField.Center.GetX(),
+				BodyPosition.GetY() - ForceField.Center.GetY(), 0.f);
+			const float Distance = FromAxis.Length();
+			if (Distance > ForceField.Radius || Distance < MinFieldDistance)
+			{
+				return;
+			}
+
+			const Vec3 Outward = FromAxis / Distance;
+			const Vec3 Tangent(-Outward.GetY(), Outward.GetX(), 0.f);
+			const float Falloff = 1.f - Distance / ForceField.Radius;
+
+			const Vec3 VortexAcceleration = (Tangent *
+				ForceField.TangentialAcceleration - Outward *
+				ForceField.InwardAcceleration + Vec3::sAxisZ() *
+				ForceField.UpwardAcceleration) * Falloff;
+			AffectedBody.SetLinearVelocityClamped
+				(AffectedBody.GetLinearVelocity() + VortexAcceleration *
+				DeltaTime);
+			break;
+		}
+		default:
+			break;
+	}
+}
+
+void FPhysicsServiceForceFields::AdvanceForceFields(const float DeltaTime)
+{
+	RadialImpulses.Reset();
+
+	for (auto ForceFieldIt = ForceFields.CreateIterator(); ForceFieldIt;
+		++ForceFieldIt)
+	{
+		FForceField& ForceField = ForceFieldIt.Value();
+		if (ForceField.RemainingTime < 0.f)
+		{
+			continue;
+		}
+
+		ForceField.RemainingTime -= DeltaTime;
+		if (ForceField.RemainingTime <= 0.f)
+		{
+			ForceFieldIt.RemoveCurrent();
+		}
+	}
+}
+
+FString FPhysicsServiceForceFields::SaveForceFields() const
+{
+	FString SavedForceFields = FString();
+
+	// The fields are saved on the client's space, as they are added
+	for (const auto& ForceField : ForceFields)
+	{
+		const FForceField& Field = ForceField.Value;
+		const float Duration = FMath::Max(Field.RemainingTime, 0.f);
+
+		if (Field.Type == EForceFieldType::Wind)
+		{
+			SavedForceFields += FString::Printf(TEXT("ForceField;%u;wind;"
+				"%.9g;%.9g;%.9g;%.9g;%.9g;%.9g;%.9g;%.9g;%.9g;%.9g;%.9g\n"),
+				ForceField.Key, WorldOrigin.X + Field.Bounds.mMin.GetX(),
+				WorldOrigin.Y + Field.Bounds.mMin.GetY(),
+				WorldOrigin.Z + Field.Bounds.mMin.GetZ(),
+				WorldOrigin.X + Field.Bounds.mMax.GetX(),
+				WorldOrigin.Y + Field.Bounds.mMax.GetY(),
+				WorldOrigin.Z + Field.Bounds.mMax.GetZ(),
+				Field.WindVelocity.GetX(),
+				Field.WindVelocity.GetY(), Field.WindVelocity.GetZ(),
+				Field.Drag, Duration);
+		}
+		else if (Field.Type == EForceFieldType::Vortex)
+		{
+			SavedForceFields += FString::Printf(TEXT("ForceField;%u;vortex;"
+				"%.9g;%.9g;%.9g;%.9g;%.9g;%.9g;%.9g;%.9g;%.9g\n"),
+				ForceField.Key, WorldOrigin.X + Field.Center.GetX(),
+				WorldOrigin.Y + Field.Center.GetY(),
+				WorldOrigin.Z + Field.Center.GetZ(), Field.Radius, Field.Height,
+				Field.TangentialAcceleration, Field.InwardAcceleration,
+				Field.UpwardAcceleration, Duration);
+		}
+	}
+
+	return SavedForceFields;
+}
+
+void FPhysicsServiceForceFields::RemoveAllForceFields()
+{
+	ForceFields.Empty();
+	RadialImpulses.Empty();
+	World = nullptr;
+}
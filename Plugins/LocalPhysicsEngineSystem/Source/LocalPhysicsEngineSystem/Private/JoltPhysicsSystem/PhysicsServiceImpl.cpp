@@ -1,57 +1,139 @@
 // Fill out your copyright notice in the Description page of Project Settings.
 
 #include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/PhysicsServiceImpl.h"
+#include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/PhysicsServiceWorldManager.h"
+#include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/PhysicsParallelFor.h"
 #include "LocalPhysicsEngineSystem/LocalPhysicsEngineSystemLogging.h"
 
-FPhysicsServiceImpl::FPhysicsServiceImpl()
+#include "Misc/Base64.h"
+
+#include <Jolt/Physics/Body/BodyLock.h>
+#include <Jolt/Physics/Collision/RayCast.h>
+#include <Jolt/Physics/Collision/CastResult.h>
+#include <Jolt/Physics/Collision/CollideShape.h>
+#include <Jolt/Physics/Collision/CollisionCollectorImpl.h>
+#include <Jolt/Physics/Collision/ShapeCast.h>
+#include <Jolt/Physics/Collision/Shape/ScaledShape.h>
+#include <Jolt/Physics/DeterminismLog.h>
+
+#include <algorithm>
+#include <atomic>
+
+namespace
 {
+	/** The min amount of rewind rays cast on each job */
+	constexpr int32 MinRaysPerRewindJob = 16;
+
+	/** The min amount of scene queries run on each job */
+	constexpr int32 MinQueriesPerSceneQueryJob = 16;
+
+	/** The min amount of bodies hashed on each state checksum job */
+	constexpr int32 MinBodiesPerChecksumJob = 256;
+
+	/** 
+	* The grid the body states are snapped to before hashing. Differences
+	* below it (e.g. float printing round-trips) do not change the checksum
+	*/
+	constexpr float StateChecksumQuantum = 1.f / 4096.f;
+
+	/**
+	* The max magnitude of a snapped body state value. Far or fast bodies are
+	* clamped to it, so the value always fits on an int64
+	*/
+	constexpr double MaxQuantizedStateValue = 4.e18;
+
+	/** Object layer filter that only accepts the static bodies */
+	class FNonMovingObjectLayerFilter : public ObjectLayerFilter
+	{
+	public:
+		virtual bool ShouldCollide(ObjectLayer inLayer) const override
+			{ return inLayer == Layers::NON_MOVING; }
+	};
+
+	/**
+	* Broadphase layer filter that only accepts the static and moving bodies'
+	* trees, which are the ones the scene queries see
+	*/
+	class FSceneQueryBroadPhaseLayerFilter : public BroadPhaseLayerFilter
+	{
+	public:
+		virtual bool ShouldCollide(BroadPhaseLayer inLayer) const override
+		{
+			return inLayer == BroadPhaseLayers::NON_MOVING ||
+				inLayer == BroadPhaseLayers::MOVING;
+		}
+	};
+
+	/**
+	* Object layer filter that only accepts the static and moving bodies. The
+	* ghosts and the character capsules are skipped, as they stand for bodies
+	* simulated elsewhere
+	*/
+	class FSceneQueryObjectLayerFilter : public ObjectLayerFilter
+	{
+	public:
+		virtual bool ShouldCollide(ObjectLayer inLayer) const override
+		{
+			return inLayer == Layers::NON_MOVING ||
+				inLayer == Layers::MOVING;
+		}
+	};
+
+	/** Body filter that skips the sensors, as they never block a query */
+	class FNonSensorBodyFilter : public BodyFilter
+	{
+	public:
+		FNonSensorBodyFilter(const FPhysicsServiceSensors& InSensors)
+			: Sensors(InSensors) {}
+
+		virtual bool ShouldCollide(const BodyID& inBodyID) const override
+			{ return !Sensors.IsSensor(inBodyID); }
+
+	private:
+		/** The world's sensors */
+		const FPhysicsServiceSensors& Sensors;
+	};
+}
 
+FPhysicsServiceImpl::FPhysicsServiceImpl(const int32 InWorldId,
+	FPhysicsServiceWorldManager& InWorldManager, const uint32 InMaxBodies)
+	: WorldId(InWorldId), WorldManager(InWorldManager), MaxBodies(InMaxBodies)
+{
+	MemoryAccounting = FPhysicsServiceAllocator::GetWorldAccounting(WorldId);
 }
 
 void FPhysicsServiceImpl::InitPhysicsSystem
 	(const FString& initializationActorsInfo)
 {
-	LPES_LOG_INFO(TEXT("Initializing physics system..."));
+	LPES_LOG_INFO(TEXT("Initializing physics system (world: %d)..."),
+		WorldId);
 	LPES_LOG_INFO(TEXT("Init message: %s"), *initializationActorsInfo);
 
+	FPhysicsMemoryAccountingScope MemoryAccountingScope(MemoryAccounting);
+
 	// If physics system is already initialized, clear the last initialization
 	if (bIsInitialized)
 	{
 		ClearPhysicsSystem();
 	}
 
-	// Register allocation hook
-	RegisterDefaultAllocator();
-
-	// Install callbacks
-	//Trace = TraceImpl;
-	JPH_IF_ENABLE_ASSERTS(AssertFailed = AssertFailedImpl;)
-
-	// Create a factory
-	Factory::sInstance = new Factory();
+	MemoryAccounting->ResetPeaks();
 
-	// Register all Jolt physics types
-	RegisterTypes();
-
-	// We need a temp allocator for temporary allocations during the physics 
-	// update. We're pre-allocating 10 * 1024 * 1024 MB to avoid having to do 
-	// allocations during the physics update. 
-	// If you don't want to pre-allocate you can also use TempAllocatorMalloc 
-	// to fall back to malloc/free.
-	temp_allocator = new TempAllocatorImpl(10 * 1024 * 1024);
-
-	// We need a job system that will execute physics jobs on multiple threads. 
-	// Typically you would implement the JobSystem interface yourself and let 
-	// Jolt Physics run on top of your own job scheduler. JobSystemThreadPool 
-	// is an example implementation.
-	job_system = new JobSystemThreadPool(cMaxPhysicsJobs, cMaxPhysicsBarriers,
-		thread::hardware_concurrency() - 1);
+	// The allocator, factory and Jolt types are registered once per process by
+	// the world manager. The job system is shared among all the worlds on this
+	// process, and the temp allocators are acquired from the manager's pool on
+	// each step. The jobs are run through this world's step profiler
+	StepProfiler = MakeUnique<FPhysicsStepProfiler>
+		(*WorldManager.GetSharedJobSystem(), MemoryAccounting);
+	job_system = StepProfiler.Get();
 
 	// This is the max amount of rigid bodies that you can add to the physics 
 	// system. If you try to add more you'll get an error.
-	// Note: This value is low because this is a simple test. For a real 
-	// project use something in the order of 65536.
-	const uint cMaxBodies = 128000;
+	// Note: This is set per world, so small regions don't need to pay for
+	// the memory of a big world. The characters' capsule bodies and the
+	// ragdolls' parts take the indices after the max bodies
+	const uint cMaxBodies = MaxBodies + FPhysicsServiceCharacters::MaxCharacters
+		+ FPhysicsServiceRagdolls::MaxRagdollBodies;
 
 	// This determines how many mutexes to allocate to protect rigid bodies 
 	// from concurrent access. Set it to 0 for the default settings.
@@ -112,15 +194,15 @@ void FPhysicsServiceImpl::InitPhysicsSystem
 	// A body activation listener gets notified when bodies activate and go 
 	// to sleep
 	// Note that this is called from a job so whatever you do here needs to be 
-	// thread safe.
-	// Registering one is entirely optional.
+	// thread safe. Thus, it only records the events on the lock-free buffer
+	body_activation_listener = new FMyBodyActivationListener(EventBuffer);
 	physics_system->SetBodyActivationListener(body_activation_listener);
 
 	// A contact listener gets notified when bodies (are about to) collide, 
 	// and when they separate again.
 	// Note that this is called from a job so whatever you do here needs to 
-	// be thread safe.
-	// Registering one is entirely optional.
+	// be thread safe. Thus, it only records the events on the lock-free buffer
+	contact_listener = new FMyContactListener(EventBuffer);
 	physics_system->SetContactListener(contact_listener);
 
 	// The main way to interact with the bodies in the physics system is 
@@ -129,6 +211,15 @@ void FPhysicsServiceImpl::InitPhysicsSystem
 	// we're not planning to access bodies from multiple threads)
 	body_interface = &physics_system->GetBodyInterface();
 
+	// The characters are created by the step inputs
+	Characters.Init(physics_system, MaxBodies, WorldOrigin);
+	Vehicles.Init(physics_system);
+	Ragdolls.Init(physics_system, MaxBodies +
+		FPhysicsServiceCharacters::MaxCharacters,
+		&WorldManager.GetRagdollTypeCache(), WorldOrigin);
+	Constraints.Init(physics_system, WorldOrigin);
+	ForceFields.Init(physics_system, WorldOrigin);
+
 	TArray<FString> initializationActorsInfoLines;
 	initializationActorsInfo.ParseIntoArrayLines
 		(initializationActorsInfoLines);
@@ -137,53 +228,24 @@ void FPhysicsServiceImpl::InitPhysicsSystem
 	// body's type, id and initial location
 	for (int i = 0; i < initializationActorsInfoLines.Num(); i++)
 	{
-		// Split info with ";" delimiter
-		TArray<FString> actorInfoList;
-		initializationActorsInfoLines[i].ParseIntoArray(actorInfoList,
-			TEXT(";"));
-
-		// Check for errors
-		if (actorInfoList.Num() < 5)
+		// The static bodies may come from a baked static scene
+		if (initializationActorsInfoLines[i].StartsWith("StaticScene;"))
 		{
-			LPES_LOG_INFO(TEXT("Error on parsing addBody message info. Line "
-				"with less than 5 params."));
-			continue;
-		}
+			TArray<FString> StaticSceneInfo;
+			initializationActorsInfoLines[i].ParseIntoArray(StaticSceneInfo,
+				TEXT(";"));
 
-		// Get the actor's type to be creates
-		const FString actorType = actorInfoList[0];
+			if (StaticSceneInfo.Num() >= 3)
+			{
+				AddStaticSceneToPhysicsWorld(StaticSceneInfo[1],
+					static_cast<uint32>(FCString::Strtoui64
+					(*StaticSceneInfo[2], nullptr, 10)));
+			}
 
-		// Get the actor ID from the init info
-		const int actorId =	FCString::Atoi(*actorInfoList[1]);
-		const BodyID newBodyID(actorId);
-
-		// We discard here actorInfoList[2] as it is the BodyType info, no
-		// used here
-
-		// Get actor initial pos
-		const double initialPosX = FCString::Atof(*actorInfoList[3]);
-		const double initialPosY = FCString::Atof(*actorInfoList[4]);
-		const double initialPosZ = FCString::Atof(*actorInfoList[5]);
-
-		const RVec3 bodyInitialPosition{ RVec3(initialPosX, initialPosY,
-			initialPosZ) };
-
-		// Check if we should create a floor
-		if (actorType.Contains("floor"))
-		{
-			// Add new floor to the physics world
-			AddNewFloorToPhysicsSystem(newBodyID, bodyInitialPosition);
 			continue;
 		}
 
-		// Check if we should create a sphere
-		if (actorType.Contains("sphere"))
-		{
-			// Add new sphere to the physics world
-			AddNewSphereToPhysicsWorld(newBodyID, bodyInitialPosition, RVec3(), 
-				RVec3());
-			continue;
-		}
+		AddBodyFromMessageLine(initializationActorsInfoLines[i]);
 	}
 
 	// Optional step: Before starting the physics simulation you can optimize 
@@ -195,62 +257,252 @@ void FPhysicsServiceImpl::InitPhysicsSystem
 	// keep the broad phase efficient.
 	//physics_system->OptimizeBroadPhase();
 
-	// Reset the step physics time measurement 
+	// Reset the step physics time measurement and the time accumulator
 	PhysicsStepSimulationTimeMeasure = "";
+	PhysicsStepPhasesMeasure = "";
+	TimeAccumulator = 0.f;
+
+	// Preallocate the rewind history, so recording the steps never allocates
+	StateHistory.Allocate(RewindHistoryLength, MaxRewindBodies);
+	if (StateHistory.IsEnabled())
+	{
+		LPES_LOG_INFO(TEXT("Rewind history of world %d keeps %d steps of up "
+			"to %d bodies (%llu bytes)."), WorldId, RewindHistoryLength,
+			MaxRewindBodies, static_cast<uint64>
+			(StateHistory.GetAllocatedSize()));
+	}
 
 	bIsInitialized = true;
+	LastStateChecksum = GetStateChecksum();
 
 	LPES_LOG_INFO(TEXT("Physics world has been initialized and is running."));
 }
 
-FString FPhysicsServiceImpl::StepPhysicsSimulation()
+void FPhysicsServiceImpl::SetStepSettings(const float InFixedDeltaTime,
+	const int32 InCollisionSteps, const int32 InIntegrationSubSteps,
+	const int32 InMaxCatchUpSteps)
 {
-	// If you take larger steps than 1 / 60th of a second you need to do 
-	// multiple collision steps in order to keep the simulation stable. 
-	// Do 1 collision step per 1 / 60th of a second (round up).
-	const int cCollisionSteps = 1;
+	// Check for invalid settings. Keep the previous ones if so
+	if (InFixedDeltaTime <= 0.f || InCollisionSteps < 1 ||
+		InIntegrationSubSteps < 1 || InMaxCatchUpSteps < 1)
+	{
+		LPES_LOG_WARNING(TEXT("Invalid step settings (FixedDeltaTime: %f; "
+			"CollisionSteps: %d; IntegrationSubSteps: %d; MaxCatchUpSteps: %d) "
+			"for world %d. Ignoring them."), InFixedDeltaTime, InCollisionSteps,
+			InIntegrationSubSteps, InMaxCatchUpSteps, WorldId);
+		return;
+	}
 
-	// If you want more accurate step results you can do multiple sub steps 
-	// within a collision step. Usually you would set this to 1.
-	const int cIntegrationSubSteps = 1;
+	FixedDeltaTime = InFixedDeltaTime;
+	CollisionSteps = InCollisionSteps;
+	IntegrationSubSteps = InIntegrationSubSteps;
+	MaxCatchUpSteps = InMaxCatchUpSteps;
 
-	// We simulate the physics world in discrete time steps. 60 Hz is a good 
-	// rate to update the physics system.
-	const float cDeltaTime = 1.0f / 60.f;
+	LPES_LOG_INFO(TEXT("Step settings for world %d: FixedDeltaTime: %f; "
+		"CollisionSteps: %d; IntegrationSubSteps: %d; MaxCatchUpSteps: %d"),
+		WorldId, FixedDeltaTime, CollisionSteps, IntegrationSubSteps,
+		MaxCatchUpSteps);
+}
 
-	// response string
-	FString stepPhysicsResponse = "";
+void FPhysicsServiceImpl::SetRewindHistorySettings
+	(const uint32 InRewindHistoryLength, const uint32 InMaxRewindBodies)
+{
+	RewindHistoryLength = InRewindHistoryLength;
+	MaxRewindBodies = InMaxRewindBodies;
+}
+
+FString FPhysicsServiceImpl::StepPhysicsSimulation(const float ElapsedTime)
+{
+	FPhysicsMemoryAccountingScope MemoryAccountingScope(MemoryAccounting);
+
+	// Accumulate the elapsed time. Negative times are ignored
+	TimeAccumulator += FMath::Max(ElapsedTime, 0.f);
+
+	// Get how many fixed steps fit on the accumulated time
+	int32 NumberOfStepsToRun = FMath::FloorToInt(TimeAccumulator /
+		FixedDeltaTime);
+
+	// Clamp to the max catch up steps. If the client is too far behind, the
+	// remaining time is dropped so we don't spiral into longer and longer
+	// steps
+	if (NumberOfStepsToRun > MaxCatchUpSteps)
+	{
+		LPES_LOG_WARNING(TEXT("World %d is %d steps behind. Dropping %d of "
+			"them."), WorldId, NumberOfStepsToRun, NumberOfStepsToRun -
+			MaxCatchUpSteps);
+
+		NumberOfStepsToRun = MaxCatchUpSteps;
+		TimeAccumulator = FMath::Fmod(TimeAccumulator, FixedDeltaTime);
+	}
+	else
+	{
+		TimeAccumulator -= NumberOfStepsToRun * FixedDeltaTime;
+	}
 
 	// Get pre step physics time (time spent updating physics)
 	std::chrono::steady_clock::time_point preStepPhysicsTime =
 		std::chrono::steady_clock::now();
 
-	// Step the world
-	LPES_LOG_INFO(TEXT("(Step: %d)"), StepPhysicsCounter);
+	// Run the fixed steps
+	RunStepRequest(NumberOfStepsToRun);
+
+	// Measure the steps, if any was run
+	if (NumberOfStepsToRun > 0)
+	{
+		// Get post physics update time
+		std::chrono::steady_clock::time_point postStepPhysicsTime =
+			std::chrono::steady_clock::now();
+
+		// Calculate the microsseconds all step physics simulation took
+		std::stringstream ss;
+		ss << std::chrono::duration_cast<std::chrono::microseconds>
+			(postStepPhysicsTime - preStepPhysicsTime).count();
+		const std::string elapsedTime = ss.str();
+
+		// Get the step phyiscs time (time spent updating physics on 
+		// services) in FString
+		const FString ElapsedPhysicsTimeMicroseconds =
+			UTF8_TO_TCHAR(elapsedTime.c_str());
+
+		// Append the step physics time to the current step measurement
+		PhysicsStepSimulationTimeMeasure += ElapsedPhysicsTimeMicroseconds +
+			"\n";
+	}
+
+	// Hash the state after the steps, so the client can compare it with any
+	// other world that should be on the same state
+	if (NumberOfStepsToRun > 0)
+	{
+		LastStateChecksum = GetStateChecksum();
+	}
 
-	physics_system->Update(cDeltaTime, cCollisionSteps, cIntegrationSubSteps,
-		temp_allocator, job_system);
+	// The response starts with the step info, so the client knows if the
+	// bodies were updated and how to blend between the last two states
+	FString stepPhysicsResponse = FString::Printf(TEXT("StepInfo;%d;%f;%u;"
+		"%u\n"), NumberOfStepsToRun, GetInterpolationAlpha(),
+		StepPhysicsCounter, LastStateChecksum);
+
+	// Only send the bodies' state and events if they were stepped
+	if (NumberOfStepsToRun > 0)
+	{
+		stepPhysicsResponse += GetBodiesStateResponse();
+		stepPhysicsResponse += Characters.GetCharactersStateResponse();
+		stepPhysicsResponse += Vehicles.GetVehiclesStateResponse();
+		stepPhysicsResponse += Ragdolls.ConsumeRagdollsStateResponse();
+		stepPhysicsResponse += Constraints.ConsumeConstraintEventsResponse();
+		stepPhysicsResponse += Sensors.ConsumeSensorEventsResponse();
+		stepPhysicsResponse += GetContactEventsResponse();
+	}
 
-	LPES_LOG_INFO(TEXT("Physics stepping finished."));
+	return stepPhysicsResponse;
+}
 
-	// Get post physics update time
-	std::chrono::steady_clock::time_point postStepPhysicsTime =
-		std::chrono::steady_clock::now();
+void FPhysicsServiceImpl::RunStepRequest(const int32 NumberOfSteps)
+{
+	// Reset the events from the last step request. The memory is kept
+	LastStepEvents.Reset();
+	bDroppedLastStepEvents = false;
+
+	if (NumberOfSteps <= 0)
+	{
+		return;
+	}
+
+	// Move the ghosts along with their primaries on the other services
+	DriveGhostBodies(NumberOfSteps * FixedDeltaTime);
+
+	// And the movers to where the game placed them
+	DriveKinematicBodies(NumberOfSteps * FixedDeltaTime);
+
+	RunFixedSteps(NumberOfSteps);
+
+	// Find the bodies that entered or exited the sensors on the steps. If
+	// any contact event was dropped, the events can't be trusted and the
+	// sensors are queried instead
+	if (bDroppedLastStepEvents)
+	{
+		Sensors.RebuildOverlaps(*physics_system);
+	}
+	else
+	{
+		Sensors.UpdateOverlaps(LastStepEvents);
+	}
+
+	// Break the constraints that were pulled too hard on the steps
+	Constraints.BreakOverloadedConstraints();
+
+	// Give the ragdolls that came to rest back to their pools
+	Ragdolls.UpdateRagdolls(NumberOfSteps * FixedDeltaTime);
+}
+
+void FPhysicsServiceImpl::RunFixedSteps(const int32 NumberOfSteps)
+{
+	// Acquire a temp allocator from the world manager's pool, as other worlds
+	// may be stepping at the same time
+	FPhysicsTempAllocator* StepTempAllocator =
+		WorldManager.AcquireTempAllocator();
+	StepTempAllocator->ResetHighWaterMark();
+
+	for (int32 i = 0; i < NumberOfSteps; i++)
+	{
+		// Step the world
+		LPES_LOG_INFO(TEXT("(Step: %d)"), StepPhysicsCounter);
+
+		StepProfiler->BeginStep();
+
+		// Move the characters first, so the bodies react to them on the step
+		Characters.UpdateCharacters(FixedDeltaTime, *job_system);
+
+		// Find the bodies inside the force fields and push them. This is done
+		// before the update, as the step listeners run in parallel
+		ForceFields.GatherAffectedBodies();
+		ForceFields.ApplyForceFields(FixedDeltaTime);
+
+		physics_system->Update(FixedDeltaTime, CollisionSteps,
+			IntegrationSubSteps, StepTempAllocator, job_system);
+
+		ForceFields.AdvanceForceFields(FixedDeltaTime);
 
-	// Calculate the microsseconds all step physics simulation
-	// (considering communication )took
-	std::stringstream ss;
-	ss << std::chrono::duration_cast<std::chrono::microseconds>
-		(postStepPhysicsTime - preStepPhysicsTime).count();
-	const std::string elapsedTime = ss.str();
+		StepProfiler->EndStep();
+		PhysicsStepPhasesMeasure += StepProfiler->GetLastStepMeasureLine();
 
-	// Get the step phyiscs time (time spent updating physics on 
-	// services) in FString
-	const FString ElapsedPhysicsTimeMicroseconds =
-		UTF8_TO_TCHAR(elapsedTime.c_str());
+		// Drain the events recorded by the listeners during the step. No job
+		// thread is running at this point
+		const uint32 DroppedEventsCount = EventBuffer.DrainEvents
+			(LastStepEvents);
+		if (DroppedEventsCount > 0)
+		{
+			bDroppedLastStepEvents = true;
+			LPES_LOG_WARNING(TEXT("World %d dropped %d physics events on step "
+				"%d."), WorldId, DroppedEventsCount, StepPhysicsCounter);
+		}
+
+		// Count the step
+		StepPhysicsCounter++;
+
+		// Record the moving bodies' state on this step
+		StateHistory.RecordStep(StepPhysicsCounter, *body_interface,
+			KinematicBodyIdList, BodyIdList);
+	}
+
+	// Keep the max temp memory the steps needed, so the temp allocator size
+	// can be tuned
+	MemoryAccounting->RecordTempAllocatorUsage
+		(StepTempAllocator->GetHighWaterMark());
+	if (StepTempAllocator->GetOverflowCount() > 0)
+	{
+		LPES_LOG_WARNING(TEXT("World %d made %u temp allocations that did not "
+			"fit on the temp allocator."), WorldId,
+			StepTempAllocator->GetOverflowCount());
+	}
 
-	// Append the step physics time to the current step measurement
-	PhysicsStepSimulationTimeMeasure += ElapsedPhysicsTimeMicroseconds + "\n";
+	WorldManager.ReleaseTempAllocator(StepTempAllocator);
+}
+
+FString FPhysicsServiceImpl::GetBodiesStateResponse() const
+{
+	// response string
+	FString stepPhysicsResponse = "";
 
 	// For each body on the physics system:
 	for (auto& bodyId : BodyIdList)
@@ -260,12 +512,11 @@ FString FPhysicsServiceImpl::StepPhysicsSimulation()
 		// Apend the body Id as the first info on the body physics response
 		bodyStepResultInfo += FString::Printf(TEXT("%d;"), bodyId.GetIndex());
 
-		// Output current position of the sphere
+		// Output current position of the sphere, on the client's space
 		RVec3 position = body_interface->GetCenterOfMassPosition(bodyId);
 
-		const FString actorStepPhysicsPositionResult = 
-			FString::Printf(TEXT("%f;%f;%f;"), position.GetX(), 
-			position.GetY(), position.GetZ());
+		const FString actorStepPhysicsPositionResult =
+			WorldOrigin.ToClientPositionString(position) + ";";
 
 		// Append the body's physics position result
 		bodyStepResultInfo += actorStepPhysicsPositionResult;
@@ -299,18 +550,148 @@ FString FPhysicsServiceImpl::StepPhysicsSimulation()
 		stepPhysicsResponse += bodyStepResultInfo;
 	}
 
-	//LPES_LOG_INFO(TEXT("(Step: %d) StepPhysics response: %s"), 
-		//stepPhysicsCounter,	*stepPhysicsResponse);
+	return stepPhysicsResponse;
+}
+
+void FPhysicsServiceImpl::SetContactEventSubscription
+	(const BodyID SubscribedBodyId, const uint8 SubscriptionFlags,
+	const float MinContactImpulse)
+{
+	// No flags means no subscription at all
+	if (SubscriptionFlags == EContactEventSubscriptionFlags::None)
+	{
+		ContactEventSubscriptions.Remove(SubscribedBodyId.GetIndex());
+		return;
+	}
+
+	FContactEventSubscription& Subscription =
+		ContactEventSubscriptions.FindOrAdd(SubscribedBodyId.GetIndex());
+	Subscription.SubscriptionFlags = SubscriptionFlags;
+	Subscription.MinContactImpulse = FMath::Max(MinContactImpulse, 0.f);
+}
+
+bool FPhysicsServiceImpl::IsContactEventSubscribed
+	(const FPhysicsServiceEvent& ContactEvent) const
+{
+	// Get the flag and check if any of the bodies subscribed to the event
+	const bool bIsContactBegin =
+		(ContactEvent.EventType == EPhysicsServiceEventType::ContactAdded);
+	const uint8 RequiredFlag = bIsContactBegin ?
+		EContactEventSubscriptionFlags::ContactBegin :
+		EContactEventSubscriptionFlags::ContactEnd;
+
+	for (const BodyID& ContactBodyId : { ContactEvent.Body1,
+		ContactEvent.Body2 })
+	{
+		const FContactEventSubscription* Subscription =
+			ContactEventSubscriptions.Find(ContactBodyId.GetIndex());
+		if (!Subscription || !(Subscription->SubscriptionFlags & RequiredFlag))
+		{
+			continue;
+		}
 
-	// Count the step
-	StepPhysicsCounter++;
+		// Contact begin events must also reach the body's min impulse
+		if (!bIsContactBegin || ContactEvent.ImpulseMagnitude >=
+			Subscription->MinContactImpulse)
+		{
+			return true;
+		}
+	}
 
-	return stepPhysicsResponse;
+	return false;
+}
+
+FString FPhysicsServiceImpl::GetContactEventsResponse() const
+{
+	// Check if any body subscribed to contact events
+	if (ContactEventSubscriptions.Num() == 0 || MaxContactEventsPerStep == 0)
+	{
+		return FString();
+	}
+
+	// Get the subscribed contact events, on the order they happened
+	TArray<const FPhysicsServiceEvent*> ContactEvents;
+	TArray<const FPhysicsServiceEvent*> ContactBeginEvents;
+	for (const FPhysicsServiceEvent& PhysicsEvent : LastStepEvents)
+	{
+		if (PhysicsEvent.EventType != EPhysicsServiceEventType::ContactAdded &&
+			PhysicsEvent.EventType != EPhysicsServiceEventType::ContactRemoved)
+		{
+			continue;
+		}
+
+		// The sensor contacts are sent as sensor events
+		if (!IsContactEventSubscribed(PhysicsEvent) || Sensors.IsSensor
+			(PhysicsEvent.Body1) || Sensors.IsSensor(PhysicsEvent.Body2))
+		{
+			continue;
+		}
+
+		ContactEvents.Add(&PhysicsEvent);
+		if (PhysicsEvent.EventType == EPhysicsServiceEventType::ContactAdded)
+		{
+			ContactBeginEvents.Add(&PhysicsEvent);
+		}
+	}
+
+	// If over the budget, drop the weakest contact begin events. The contact
+	// end events are always kept, as dropping one would leave the client
+	// with a contact that never ends
+	TSet<const FPhysicsServiceEvent*> DroppedContactEvents;
+	if (ContactEvents.Num() > MaxContactEventsPerStep)
+	{
+		ContactBeginEvents.Sort([](const FPhysicsServiceEvent& EventA,
+			const FPhysicsServiceEvent& EventB)
+		{
+			return EventA.ImpulseMagnitude > EventB.ImpulseMagnitude;
+		});
+
+		const int32 ContactEndEventsCount = ContactEvents.Num() -
+			ContactBeginEvents.Num();
+		const int32 BeginEventsBudget = FMath::Max(MaxContactEventsPerStep -
+			ContactEndEventsCount, 0);
+		for (int32 i = BeginEventsBudget; i < ContactBeginEvents.Num(); i++)
+		{
+			DroppedContactEvents.Add(ContactBeginEvents[i]);
+		}
+
+		LPES_LOG_WARNING(TEXT("World %d has %d contact events on step %d. "
+			"Dropping the %d weakest contact begin events."), WorldId,
+			ContactEvents.Num(), StepPhysicsCounter,
+			DroppedContactEvents.Num());
+	}
+
+	// Append the kept events
+	FString ContactEventsResponse = FString();
+	for (const FPhysicsServiceEvent* ContactEvent : ContactEvents)
+	{
+		if (DroppedContactEvents.Contains(ContactEvent))
+		{
+			continue;
+		}
+
+		if (ContactEvent->EventType == EPhysicsServiceEventType::ContactRemoved)
+		{
+			ContactEventsResponse += FString::Printf(TEXT("Contact;E;%d;%d\n"),
+				ContactEvent->Body1.GetIndex(), ContactEvent->Body2.GetIndex());
+			continue;
+		}
+
+		ContactEventsResponse += FString::Printf(TEXT("Contact;B;%d;%d;%s;"
+			"%f;%f;%f;%f\n"), ContactEvent->Body1.GetIndex(),
+			ContactEvent->Body2.GetIndex(),
+			*WorldOrigin.ToClientPositionString(Vec3
+			(ContactEvent->ContactPoint)), ContactEvent->ContactNormal.x,
+			ContactEvent->ContactNormal.y, ContactEvent->ContactNormal.z,
+			ContactEvent->ImpulseMagnitude);
+	}
+
+	return ContactEventsResponse;
 }
 
 FString FPhysicsServiceImpl::AddNewSphereToPhysicsWorld(BodyID newBodyId, 
 	RVec3 newBodyInitialPosition, RVec3 newBodyInitialLinearVelocity, 
-	RVec3 newBodyInitialAngularVelocity)
+	RVec3 newBodyInitialAngularVelocity, const bool bIsGhost)
 {
 	LPES_LOG_INFO(TEXT("NewSphere addition to physics world requested."));
 
@@ -322,15 +703,22 @@ FString FPhysicsServiceImpl::AddNewSphereToPhysicsWorld(BodyID newBodyId,
 		return "No body interface valid when adding new sphere to world.\n";
 	}
 
-	// Create the settings for the body itself
-	BodyCreationSettings sphere_settings(new SphereShape(50.f),
+	// Create the settings for the body itself. The sphere shape is shared
+	// among every sphere on every world. Ghosts are kinematic, so they cost
+	// nothing on the solver and only push the moving bodies
+	BodyCreationSettings sphere_settings
+		(WorldManager.GetOrCreateSphereShape(50.f),
 		newBodyInitialPosition, Quat::sIdentity(),
-		EMotionType::Dynamic, Layers::MOVING);
+		bIsGhost ? EMotionType::Kinematic : EMotionType::Dynamic,
+		bIsGhost ? Layers::GHOST : Layers::MOVING);
 
 	// Set the sphere's restitution 
 	sphere_settings.mRestitution = 1.f;
 	sphere_settings.mMassPropertiesOverride.mMass = 10.f;
 
+	// Keep the body index on the body, so it maps back to its PSDActor
+	sphere_settings.mUserData = newBodyId.GetIndex();
+
 	// Create the actual rigid body
 	// Note that if we run out of bodies this can return nullptr
 	Body* newSphereBody = body_interface->CreateBodyWithID(newBodyId,
@@ -344,8 +732,12 @@ FString FPhysicsServiceImpl::AddNewSphereToPhysicsWorld(BodyID newBodyId,
 		return creationErrorString;
 	}
 
-	// Add the body's ID to the list of IDs
-	BodyIdList.push_back(newBodyId);
+	// Add the body's ID to the list of IDs. Ghosts are simulated by their
+	// primary's service, so their state is not sent back
+	if (!bIsGhost)
+	{
+		AddToBodyIdList(newBodyId);
+	}
 
 	// Set the body's linear velocity
 	newSphereBody->SetLinearVelocity(newBodyInitialLinearVelocity);
@@ -364,21 +756,16 @@ FString FPhysicsServiceImpl::AddNewFloorToPhysicsSystem(const BodyID newBodyId,
 {
 	LPES_LOG_INFO(TEXT("NewFloor addition to physics world requested."));
 
-	// Create the settings for the collision volume (the shape)
-	BoxShapeSettings floor_shape_settings(Vec3(1000.0f, 1000.f, 100.0f));
-
-	// Create the shape
-	ShapeSettings::ShapeResult floor_shape_result =
-		floor_shape_settings.Create();
-
-	// We don't expect an error here, but you can check floor_shape_result for 
-	// HasError() / GetError()
-	ShapeRefC floor_shape = floor_shape_result.Get();
+	// Check if body interface is valid
+	if (!body_interface)
+	{
+		return "No body interface valid when adding new floor to world.\n";
+	}
 
-	// Create the settings for the body itself. Note that here you can also set 
-	// other properties like the restitution / friction.
-	BodyCreationSettings floor_settings(floor_shape, newBodyInitialPosition,
-		Quat::sIdentity(), EMotionType::Static, Layers::NON_MOVING);
+	// Create the settings for the body itself
+	BodyCreationSettings floor_settings = GetFloorCreationSettings
+		(newBodyInitialPosition);
+	floor_settings.mUserData = newBodyId.GetIndex();
 
 	// Create the actual rigid body
 	// Note that if we run out of bodies this can return nullptr
@@ -392,8 +779,7 @@ FString FPhysicsServiceImpl::AddNewFloorToPhysicsSystem(const BodyID newBodyId,
 		return creationErrorString;
 	}
 
-	// Set the floor's friction and add a small rotation on y-axis
-	floor->SetFriction(1.0f);
+	// Add a small rotation on y-axis
 	//floor->AddRotationStep(RVec3(0.f, -0.01f, 0.f));
 
 	// Add it to the world
@@ -402,54 +788,1793 @@ FString FPhysicsServiceImpl::AddNewFloorToPhysicsSystem(const BodyID newBodyId,
 	return "New floor body created successfully.";
 }
 
-FString FPhysicsServiceImpl::RemoveBodyByID(const BodyID bodyToRemoveID)
+BodyCreationSettings FPhysicsServiceImpl::GetFloorCreationSettings
+	(const RVec3 Position)
 {
-	LPES_LOG_INFO(TEXT("Remove body by ID requested for id %d."),
-		bodyToRemoveID.GetIndex());
+	// Get the collision volume (the shape) from the shared shape cache
+	ShapeRefC floor_shape = WorldManager.GetOrCreateBoxShape
+		(Vec3(1000.0f, 1000.f, 100.0f));
+
+	// Create the settings for the body itself. Note that here you can also set 
+	// other properties like the restitution / friction.
+	BodyCreationSettings floor_settings(floor_shape, Position,
+		Quat::sIdentity(), EMotionType::Static, Layers::NON_MOVING);
+	floor_settings.mFriction = 1.0f;
+
+	return floor_settings;
+}
 
+FString FPhysicsServiceImpl::AddNewStaticMeshToPhysicsWorld
+	(const BodyID newBodyId, const TArray<FString>& BodyInfo)
+{
 	// Check if body interface is valid
 	if (!body_interface)
 	{
-		return "No body interface valid when removing body by ID.";
+		return "No body interface valid when adding new static mesh to "
+			"world.\n";
 	}
 
-	// Remove the ID from the list
-	BodyIdList.erase(std::remove(BodyIdList.begin(), BodyIdList.end(),
-		bodyToRemoveID), BodyIdList.end());
+	BodyCreationSettings StaticMeshSettings;
+	if (!GetStaticMeshCreationSettings(BodyInfo, StaticMeshSettings))
+	{
+		return FString::Printf(TEXT("Fail in creation of static mesh with id "
+			"%d: mesh not cooked."), newBodyId.GetIndex());
+	}
+	StaticMeshSettings.mUserData = newBodyId.GetIndex();
 
-	// Remove the body by its ID and destroy it
-	body_interface->RemoveBody(bodyToRemoveID);
-	body_interface->DestroyBody(bodyToRemoveID);
+	// A kinematic mover is on the moving layer, as it only collides with the
+	// moving bodies. Its mass is never used, but the mesh has none to give
+	const bool bIsKinematic = BodyInfo[2].TrimStartAndEnd() == "kinematic";
+	if (bIsKinematic)
+	{
+		StaticMeshSettings.mMotionType = EMotionType::Kinematic;
+		StaticMeshSettings.mObjectLayer = Layers::MOVING;
+		StaticMeshSettings.mOverrideMassProperties =
+			EOverrideMassProperties::MassAndInertiaProvided;
+		StaticMeshSettings.mMassPropertiesOverride.mMass = 1.f;
+	}
 
-	return "Body removal processed successfully";
+	Body* StaticMeshBody = body_interface->CreateBodyWithID(newBodyId,
+		StaticMeshSettings);
+	if (!StaticMeshBody)
+	{
+		return FString::Printf(TEXT("Fail in creation of body with id %d."),
+			newBodyId.GetIndex());
+	}
+
+	body_interface->AddBody(StaticMeshBody->GetID(), bIsKinematic ?
+		EActivation::Activate : EActivation::DontActivate);
+
+	// The movers are recorded on the rewind history, so the rewound rays hit
+	// them where they were
+	if (bIsKinematic)
+	{
+		KinematicBodyIdList.push_back(newBodyId);
+	}
+
+	return bIsKinematic ? "New kinematic mesh body created successfully." :
+		"New static mesh body created successfully.";
 }
 
-void FPhysicsServiceImpl::ClearPhysicsSystem()
+FString FPhysicsServiceImpl::AddNewVehicleToPhysicsWorld
+	(const BodyID newBodyId, const TArray<FString>& BodyInfo,
+	const bool bIsGhost)
 {
-	LPES_LOG_INFO(TEXT("Cleaning physics system..."));
+	// Check if body interface is valid
+	if (!body_interface)
+	{
+		return "No body interface valid when adding new vehicle to world.\n";
+	}
 
-	for (auto& bodyId : BodyIdList)
+	// "vehicle; Id; primaryOrClone; pos (3); linearVel (3); angularVel (3);
+	// rot (4); chassisHalfExtent (3); mass; wheelRadius; wheelWidth;
+	// suspensionLength; maxEngineTorque; maxSteerAngle"
+	if (BodyInfo.Num() < 25)
 	{
-		// Remove the sphere from the physics system. Note that the sphere 
-		// itself keeps all of its state and can be re-added at any time.
-		body_interface->RemoveBody(bodyId);
+		return FString::Printf(TEXT("Fail in creation of vehicle with id %d: "
+			"line with less than 25 params."), newBodyId.GetIndex());
+	}
 
-		// Destroy the sphere. After this the sphere ID is no longer valid.
-		body_interface->DestroyBody(bodyId);
+	FPhysicsVehicleSetup VehicleSetup;
+	VehicleSetup.ChassisHalfExtent = Vec3(FCString::Atof(*BodyInfo[16]),
+		FCString::Atof(*BodyInfo[17]), FCString::Atof(*BodyInfo[18]));
+	VehicleSetup.WheelRadius = FCString::Atof(*BodyInfo[20]);
+	VehicleSetup.WheelWidth = FCString::Atof(*BodyInfo[21]);
+	VehicleSetup.SuspensionLength = FCString::Atof(*BodyInfo[22]);
+	VehicleSetup.MaxEngineTorque = FCString::Atof(*BodyInfo[23]);
+	VehicleSetup.MaxSteerAngle = DegreesToRadians(FCString::Atof
+		(*BodyInfo[24]));
+
+	if (VehicleSetup.ChassisHalfExtent.ReduceMin() <= 0.f ||
+		VehicleSetup.WheelRadius <= 0.f || VehicleSetup.WheelWidth <= 0.f)
+	{
+		return FString::Printf(TEXT("Fail in creation of vehicle with id %d: "
+			"invalid chassis or wheels size."), newBodyId.GetIndex());
+	}
+
+	const RVec3 ChassisPosition = WorldOrigin.ParseLocalPosition(BodyInfo, 3);
+	const Quat ChassisRotation = Quat(FCString::Atof(*BodyInfo[12]),
+		FCString::Atof(*BodyInfo[13]), FCString::Atof(*BodyInfo[14]),
+		FCString::Atof(*BodyInfo[15])).Normalized();
+
+	// The chassis box is shared with every vehicle of the same size. The
+	// ghosts are kinematic, as the ghost spheres
+	BodyCreationSettings ChassisSettings(WorldManager.GetOrCreateBoxShape
+		(VehicleSetup.ChassisHalfExtent), ChassisPosition, ChassisRotation,
+		bIsGhost ? EMotionType::Kinematic : EMotionType::Dynamic,
+		bIsGhost ? Layers::GHOST : Layers::MOVING);
+	ChassisSettings.mOverrideMassProperties =
+		EOverrideMassProperties::CalculateInertia;
+	ChassisSettings.mMassPropertiesOverride.mMass = FMath::Max(FCString::Atof
+		(*BodyInfo[19]), 1.f);
+	ChassisSettings.mUserData = newBodyId.GetIndex();
+
+	Body* ChassisBody = body_interface->CreateBodyWithID(newBodyId,
+		ChassisSettings);
+	if (!ChassisBody)
+	{
+		return FString::Printf(TEXT("Fail in creation of body with id %d."),
+			newBodyId.GetIndex());
 	}
 
-	// Unregisters all types with the factory and cleans up the default 
-	// material
-	UnregisterTypes();
+	ChassisBody->SetLinearVelocity(Vec3(FCString::Atof(*BodyInfo[6]),
+		FCString::Atof(*BodyInfo[7]), FCString::Atof(*BodyInfo[8])));
+	ChassisBody->SetAngularVelocity(Vec3(FCString::Atof(*BodyInfo[9]),
+		FCString::Atof(*BodyInfo[10]), FCString::Atof(*BodyInfo[11])));
 
-	// Destroy the factory
-	delete Factory::sInstance;
-	Factory::sInstance = nullptr;
+	// The chassis is on the world before its constraint is
+	body_interface->AddBody(newBodyId, EActivation::Activate);
 
-	if (contact_listener) delete contact_listener;
-	if (physics_system) delete physics_system;
+	if (!Vehicles.AddVehicle(*ChassisBody, VehicleSetup, !bIsGhost))
+	{
+		body_interface->RemoveBody(newBodyId);
+		body_interface->DestroyBody(newBodyId);
+		return FString::Printf(TEXT("Fail in creation of vehicle with id "
+			"%d."), newBodyId.GetIndex());
+	}
+
+	if (!bIsGhost)
+	{
+		AddToBodyIdList(newBodyId);
+	}
+
+	return "New vehicle body created successfully.";
+}
+
+FString FPhysicsServiceImpl::AddNewCompoundToPhysicsWorld
+	(const BodyID newBodyId, const TArray<FString>& BodyInfo,
+	const bool bIsGhost)
+{
+	// Check if body interface is valid
+	if (!body_interface)
+	{
+		return "No body interface valid when adding new compound to world.\n";
+	}
+
+	// "compound; Id; primaryOrClone; pos (3); linearVel (3); angularVel (3);
+	// rot (4); mass; CompoundHash"
+	if (BodyInfo.Num() < 18)
+	{
+		return FString::Printf(TEXT("Fail in creation of compound with id "
+			"%d: line with less than 18 params."), newBodyId.GetIndex());
+	}
+
+	const FString CompoundHash = BodyInfo[17].TrimStartAndEnd();
+	const ShapeRefC CompoundShape =
+		WorldManager.GetCookedMeshCache().FindCookedMesh(CompoundHash);
+	if (!CompoundShape)
+	{
+		return FString::Printf(TEXT("Fail in creation of compound with id "
+			"%d: compound \"%s\" not cooked."), newBodyId.GetIndex(),
+			*CompoundHash);
+	}
+
+	const RVec3 CompoundPosition = WorldOrigin.ParseLocalPosition(BodyInfo,
+		3);
+	const Quat CompoundRotation = Quat(FCString::Atof(*BodyInfo[12]),
+		FCString::Atof(*BodyInfo[13]), FCString::Atof(*BodyInfo[14]),
+		FCString::Atof(*BodyInfo[15])).Normalized();
+
+	// The mass is given, as the density would be per cubic centimeter. The
+	// inertia still comes from the primitives
+	BodyCreationSettings CompoundSettings(CompoundShape, CompoundPosition,
+		CompoundRotation, bIsGhost ? EMotionType::Kinematic :
+		EMotionType::Dynamic, bIsGhost ? Layers::GHOST : Layers::MOVING);
+	CompoundSettings.mOverrideMassProperties =
+		EOverrideMassProperties::CalculateInertia;
+	CompoundSettings.mMassPropertiesOverride.mMass = FMath::Max(FCString::Atof
+		(*BodyInfo[16]), 0.1f);
+	CompoundSettings.mUserData = newBodyId.GetIndex();
+
+	Body* CompoundBody = body_interface->CreateBodyWithID(newBodyId,
+		CompoundSettings);
+	if (!CompoundBody)
+	{
+		return FString::Printf(TEXT("Fail in creation of body with id %d."),
+			newBodyId.GetIndex());
+	}
+
+	CompoundBody->SetLinearVelocity(Vec3(FCString::Atof(*BodyInfo[6]),
+		FCString::Atof(*BodyInfo[7]), FCString::Atof(*BodyInfo[8])));
+	CompoundBody->SetAngularVelocity(Vec3(FCString::Atof(*BodyInfo[9]),
+		FCString::Atof(*BodyInfo[10]), FCString::Atof(*BodyInfo[11])));
+
+	body_interface->AddBody(newBodyId, EActivation::Activate);
+
+	if (!bIsGhost)
+	{
+		AddToBodyIdList(newBodyId);
+	}
+
+	return "New compound body created successfully.";
+}
+
+FString FPhysicsServiceImpl::AddNewSensorToPhysicsWorld
+	(const BodyID newBodyId, const TArray<FString>& BodyInfo)
+{
+	// Check if body interface is valid
+	if (!body_interface)
+	{
+		return "No body interface valid when adding new sensor to world.\n";
+	}
+
+	// "sensor; Id; primary; pos (3); linearVel (3); angularVel (3); rot (4);
+	// halfExtent (3)"
+	if (BodyInfo.Num() < 19)
+	{
+		return FString::Printf(TEXT("Fail in creation of sensor with id %d: "
+			"line with less than 19 params."), newBodyId.GetIndex());
+	}
+
+	const Vec3 SensorHalfExtent(FCString::Atof(*BodyInfo[16]),
+		FCString::Atof(*BodyInfo[17]), FCString::Atof(*BodyInfo[18]));
+	if (SensorHalfExtent.ReduceMin() <= 0.f)
+	{
+		return FString::Printf(TEXT("Fail in creation of sensor with id %d: "
+			"invalid box size."), newBodyId.GetIndex());
+	}
+
+	const RVec3 SensorPosition = WorldOrigin.ParseLocalPosition(BodyInfo, 3);
+	const Quat SensorRotation = Quat(FCString::Atof(*BodyInfo[12]),
+		FCString::Atof(*BodyInfo[13]), FCString::Atof(*BodyInfo[14]),
+		FCString::Atof(*BodyInfo[15])).Normalized();
+
+	// The sensor is kinematic and never sleeps, as only an active sensor
+	// keeps the contacts with the bodies that fall asleep inside it
+	BodyCreationSettings SensorSettings(WorldManager.GetOrCreateBoxShape
+		(SensorHalfExtent), SensorPosition, SensorRotation,
+		EMotionType::Kinematic, Layers::SENSOR);
+	SensorSettings.mIsSensor = true;
+	SensorSettings.mAllowSleeping = false;
+	SensorSettings.mUserData = newBodyId.GetIndex();
+
+	Body* SensorBody = body_interface->CreateBodyWithID(newBodyId,
+		SensorSettings);
+	if (!SensorBody)
+	{
+		return FString::Printf(TEXT("Fail in creation of body with id %d."),
+			newBodyId.GetIndex());
+	}
+
+	body_interface->AddBody(newBodyId, EActivation::Activate);
+	Sensors.AddSensor(newBodyId);
+
+	return "New sensor body created successfully.";
+}
+
+bool FPhysicsServiceImpl::GetStaticMeshCreationSettings
+	(const TArray<FString>& BodyInfo,
+	BodyCreationSettings& OutStaticMeshSettings)
+{
+	// "mesh; Id; primaryOrClone; pos (3); linearVel (3); angularVel (3);
+	// rot (4); scale (3); MeshHash"
+	if (BodyInfo.Num() < 20)
+	{
+		LPES_LOG_WARNING(TEXT("Static mesh info with less than 20 params."));
+		return false;
+	}
+
+	const FString MeshHash = BodyInfo[19].TrimStartAndEnd();
+	ShapeRefC StaticMeshShape =
+		WorldManager.GetCookedMeshCache().FindCookedMesh(MeshHash);
+	if (!StaticMeshShape)
+	{
+		LPES_LOG_WARNING(TEXT("Mesh \"%s\" is not cooked."), *MeshHash);
+		return false;
+	}
+
+	// The cooked mesh is unscaled, so it can be shared by every actor using
+	// the same mesh
+	const Vec3 StaticMeshScale(FCString::Atof(*BodyInfo[16]),
+		FCString::Atof(*BodyInfo[17]), FCString::Atof(*BodyInfo[18]));
+	if (!StaticMeshScale.IsClose(Vec3::sReplicate(1.f)))
+	{
+		StaticMeshShape = new ScaledShape(StaticMeshShape, StaticMeshScale);
+	}
+
+	// The position is converted to the world's space in double precision,
+	// before it is narrowed
+	const RVec3 StaticMeshPosition = WorldOrigin.ParseLocalPosition(BodyInfo,
+		3);
+	const Quat StaticMeshRotation = Quat(FCString::Atof(*BodyInfo[12]),
+		FCString::Atof(*BodyInfo[13]), FCString::Atof(*BodyInfo[14]),
+		FCString::Atof(*BodyInfo[15])).Normalized();
+
+	OutStaticMeshSettings = BodyCreationSettings(StaticMeshShape,
+		StaticMeshPosition, StaticMeshRotation, EMotionType::Static,
+		Layers::NON_MOVING);
+	OutStaticMeshSettings.mFriction = 1.0f;
+
+	return true;
+}
+
+FString FPhysicsServiceImpl::BakeStaticScene(const FString& StaticSceneInfo)
+{
+	TArray<FString> StaticSceneLines;
+	StaticSceneInfo.ParseIntoArrayLines(StaticSceneLines);
+
+	// The first line is the scene key and content hash
+	TArray<FString> SceneHeader;
+	if (StaticSceneLines.Num() > 0)
+	{
+		StaticSceneLines[0].ParseIntoArray(SceneHeader, TEXT(";"));
+	}
+
+	if (SceneHeader.Num() < 2)
+	{
+		return "Static scene bake failed: no scene key.\n";
+	}
+
+	const FString SceneKey = SceneHeader[0].TrimStartAndEnd();
+	const uint32 ContentHash = static_cast<uint32>(FCString::Strtoui64
+		(*SceneHeader[1], nullptr, 10));
+
+	// Get each static body creation settings. The body id is kept on the
+	// user data, so the body is created with the same id on every world
+	Ref<PhysicsScene> StaticScene = new PhysicsScene();
+
+	for (int32 i = 1; i < StaticSceneLines.Num(); i++)
+	{
+		TArray<FString> BodyInfo;
+		StaticSceneLines[i].ParseIntoArray(BodyInfo, TEXT(";"));
+
+		if (BodyInfo.Num() < 6)
+		{
+			return FString::Printf(TEXT("Static scene bake failed: could not "
+				"parse line \"%s\".\n"), *StaticSceneLines[i]);
+		}
+
+		// Only static body types can be baked. The static meshes keep their
+		// cooked shape on the scene, so it is saved along with it
+		BodyCreationSettings StaticBodySettings;
+		if (BodyInfo[0].Contains("floor"))
+		{
+			StaticBodySettings = GetFloorCreationSettings
+				(WorldOrigin.ParseLocalPosition(BodyInfo, 3));
+		}
+		else if (BodyInfo[0].Contains("mesh"))
+		{
+			if (!GetStaticMeshCreationSettings(BodyInfo, StaticBodySettings))
+			{
+				return FString::Printf(TEXT("Static scene bake failed: could "
+					"not get static mesh \"%s\".\n"), *BodyInfo[1]);
+			}
+		}
+		else
+		{
+			return FString::Printf(TEXT("Static scene bake failed: \"%s\" is "
+				"not a static body type.\n"), *BodyInfo[0]);
+		}
+
+		StaticBodySettings.mUserData = FCString::Atoi(*BodyInfo[1]);
+
+		StaticScene->AddBody(StaticBodySettings);
+	}
+
+	WorldManager.GetStaticSceneCache().AddStaticScene(SceneKey, ContentHash,
+		StaticScene, WorldOrigin);
+
+	LPES_LOG_INFO(TEXT("Static scene \"%s\" baked with %d bodies."),
+		*SceneKey, static_cast<int32>(StaticScene->GetNumBodies()));
+
+	return "Static scene bake successful.\n";
+}
+
+FString FPhysicsServiceImpl::AddStaticSceneToPhysicsWorld
+	(const FString& SceneKey, const uint32 ContentHash)
+{
+	// Check if body interface is valid
+	if (!body_interface)
+	{
+		return "No body interface valid when adding static scene to world.\n";
+	}
+
+	FPhysicsWorldOrigin SceneOrigin;
+	Ref<PhysicsScene> StaticScene =
+		WorldManager.GetStaticSceneCache().FindStaticScene(SceneKey,
+		ContentHash, SceneOrigin);
+	if (!StaticScene)
+	{
+		LPES_LOG_WARNING(TEXT("Static scene \"%s\" (hash: %u) is not baked."),
+			*SceneKey, ContentHash);
+		bIsStaticSceneMissing = true;
+		return "Static scene is missing.\n";
+	}
+
+	// Create every body with its own id
+	const Array<BodyCreationSettings>& StaticBodiesSettings =
+		StaticScene->GetBodies();
+
+	TArray<BodyID> StaticBodyIds;
+	StaticBodyIds.Reserve(StaticBodiesSettings.size());
+
+	// The scene is on the space of the world that baked it, so it is rebased
+	// to this world's origin. The worlds of any origin share it
+	for (const BodyCreationSettings& StaticBodySettings : StaticBodiesSettings)
+	{
+		const BodyID StaticBodyId(static_cast<uint32>
+			(StaticBodySettings.mUserData));
+
+		BodyCreationSettings LocalStaticBodySettings = StaticBodySettings;
+		LocalStaticBodySettings.mPosition = WorldOrigin.ToLocalPosition
+			(SceneOrigin, StaticBodySettings.mPosition);
+
+		Body* StaticBody = body_interface->CreateBodyWithID(StaticBodyId,
+			LocalStaticBodySettings);
+		if (!StaticBody)
+		{
+			LPES_LOG_WARNING(TEXT("Fail in creation of static body with id "
+				"%d."), StaticBodyId.GetIndex());
+			continue;
+		}
+
+		StaticBodyIds.Add(StaticBodyId);
+	}
+
+	// Insert them all on the broadphase at once, instead of one at a time
+	if (StaticBodyIds.Num() > 0)
+	{
+		BodyInterface::AddState StaticBodiesAddState =
+			body_interface->AddBodiesPrepare(StaticBodyIds.GetData(),
+			StaticBodyIds.Num());
+		body_interface->AddBodiesFinalize(StaticBodyIds.GetData(),
+			StaticBodyIds.Num(), StaticBodiesAddState,
+			EActivation::DontActivate);
+	}
+
+	StaticSceneKey = SceneKey;
+	StaticSceneContentHash = ContentHash;
+
+	return FString::Printf(TEXT("Static scene added with %d bodies.\n"),
+		StaticBodyIds.Num());
+}
+
+FString FPhysicsServiceImpl::AddBodyFromMessageLine
+	(const FString& BodyInfoLine)
+{
+	// Split info with ";" delimiter
+	TArray<FString> actorInfoList;
+	BodyInfoLine.ParseIntoArray(actorInfoList, TEXT(";"));
+
+	// Check for errors
+	if (actorInfoList.Num() < 6)
+	{
+		LPES_LOG_INFO(TEXT("Error on parsing addBody message info. Line "
+			"with less than 6 params."));
+		return "Error on parsing addBody message info.\n";
+	}
+
+	// Get the actor's type to be creates
+	const FString actorType = actorInfoList[0];
+
+	// Get the actor ID from the init info
+	const int actorId = FCString::Atoi(*actorInfoList[1]);
+	const BodyID newBodyID(actorId);
+
+	// Get the body type. Clones are ghosts of a body simulated by another
+	// service
+	const bool bIsGhostBody = actorInfoList[2].TrimStartAndEnd() == "clone";
+
+	// Get actor initial pos, relative to this world's origin
+	const RVec3 bodyInitialPosition = WorldOrigin.ParseLocalPosition
+		(actorInfoList, 3);
+
+	FString addBodyResult = FString();
+
+	// Check if we should create a floor
+	if (actorType.Contains("floor"))
+	{
+		// Add new floor to the physics world
+		addBodyResult = AddNewFloorToPhysicsSystem(newBodyID,
+			bodyInitialPosition);
+	}
+	// Check if we should create a sphere
+	else if (actorType.Contains("sphere"))
+	{
+		// Get the initial velocities, if any was given
+		RVec3 bodyInitialLinearVelocity = RVec3::sZero();
+		RVec3 bodyInitialAngularVelocity = RVec3::sZero();
+		if (actorInfoList.Num() >= 12)
+		{
+			bodyInitialLinearVelocity = RVec3
+				(FCString::Atof(*actorInfoList[6]),
+				FCString::Atof(*actorInfoList[7]),
+				FCString::Atof(*actorInfoList[8]));
+			bodyInitialAngularVelocity = RVec3
+				(FCString::Atof(*actorInfoList[9]),
+				FCString::Atof(*actorInfoList[10]),
+				FCString::Atof(*actorInfoList[11]));
+		}
+
+		// Add new sphere to the physics world
+		addBodyResult = AddNewSphereToPhysicsWorld(newBodyID,
+			bodyInitialPosition, bodyInitialLinearVelocity,
+			bodyInitialAngularVelocity, bIsGhostBody);
+	}
+	// Check if we should create a multi-part body
+	else if (actorType.Contains("compound"))
+	{
+		addBodyResult = AddNewCompoundToPhysicsWorld(newBodyID,
+			actorInfoList, bIsGhostBody);
+	}
+	// Check if we should create a trigger volume
+	else if (actorType.Contains("sensor"))
+	{
+		addBodyResult = AddNewSensorToPhysicsWorld(newBodyID, actorInfoList);
+	}
+	// Check if we should create a static mesh
+	else if (actorType.Contains("mesh"))
+	{
+		addBodyResult = AddNewStaticMeshToPhysicsWorld(newBodyID,
+			actorInfoList);
+	}
+	// Check if we should create a vehicle
+	else if (actorType.Contains("vehicle"))
+	{
+		addBodyResult = AddNewVehicleToPhysicsWorld(newBodyID,
+			actorInfoList, bIsGhostBody);
+	}
+	else
+	{
+		return FString::Printf(TEXT("Unknown body type \"%s\".\n"),
+			*actorType);
+	}
+
+	// Keep the line the body was added with, so it can be recreated when
+	// restoring a world snapshot
+	if (body_interface && body_interface->IsAdded(newBodyID))
+	{
+		BodyInfoLines.Add(newBodyID.GetIndex(), BodyInfoLine.TrimStartAndEnd());
+	}
+
+	return addBodyResult;
+}
+
+FString FPhysicsServiceImpl::RemoveBodyByID(const BodyID bodyToRemoveID)
+{
+	LPES_LOG_INFO(TEXT("Remove body by ID requested for id %d."),
+		bodyToRemoveID.GetIndex());
+
+	// Check if body interface is valid
+	if (!body_interface)
+	{
+		return "No body interface valid when removing body by ID.";
+	}
+
+	// Remove the ID from the lists
+	RemoveFromBodyIdList(bodyToRemoveID);
+	KinematicBodyIdList.erase(std::remove(KinematicBodyIdList.begin(),
+		KinematicBodyIdList.end(), bodyToRemoveID), KinematicBodyIdList.end());
+
+	// Remove any contact event subscription and ghost target of the body
+	ContactEventSubscriptions.Remove(bodyToRemoveID.GetIndex());
+	GhostBodyTargets.RemoveAllSwap([bodyToRemoveID]
+		(const FGhostBodyTarget& GhostBodyTarget)
+		{ return GhostBodyTarget.GhostBodyId == bodyToRemoveID; });
+	KinematicBodyTargets.RemoveAllSwap([bodyToRemoveID]
+		(const FKinematicBodyTarget& KinematicBodyTarget)
+		{ return KinematicBodyTarget.KinematicBodyId == bodyToRemoveID; });
+	BodyInfoLines.Remove(bodyToRemoveID.GetIndex());
+
+	// The vehicle and client constraints must leave the world before their
+	// bodies
+	Constraints.RemoveBodyConstraints(bodyToRemoveID);
+	Vehicles.RemoveVehicle(bodyToRemoveID);
+	Sensors.RemoveBody(bodyToRemoveID);
+
+	// Remove the body by its ID and destroy it
+	body_interface->RemoveBody(bodyToRemoveID);
+	body_interface->DestroyBody(bodyToRemoveID);
+
+	return "Body removal processed successfully";
+}
+
+FString FPhysicsServiceImpl::UpdateBodyType(const BodyID TargetBodyId,
+	const FString& NewBodyType)
+{
+	if (!body_interface || !body_interface->IsAdded(TargetBodyId))
+	{
+		return FString::Printf(TEXT("No body with id %d to update its type."),
+			TargetBodyId.GetIndex());
+	}
+
+	// Only the moving bodies have a type
+	if (body_interface->GetObjectLayer(TargetBodyId) == Layers::NON_MOVING)
+	{
+		return FString::Printf(TEXT("Body %d is static and has no type."),
+			TargetBodyId.GetIndex());
+	}
+
+	// The sensors only detect bodies, so they are not simulated either
+	if (body_interface->GetObjectLayer(TargetBodyId) == Layers::SENSOR)
+	{
+		return FString::Printf(TEXT("Body %d is a sensor and has no type."),
+			TargetBodyId.GetIndex());
+	}
+
+	// The movers are driven by the game on every region they are on
+	if (body_interface->GetObjectLayer(TargetBodyId) == Layers::MOVING &&
+		body_interface->GetMotionType(TargetBodyId) == EMotionType::Kinematic)
+	{
+		return FString::Printf(TEXT("Body %d is kinematic and keeps its "
+			"type."), TargetBodyId.GetIndex());
+	}
+
+	const FString TrimmedNewBodyType = NewBodyType.TrimStartAndEnd();
+	const bool bIsNewTypeGhost = TrimmedNewBodyType == "clone";
+	if (!bIsNewTypeGhost && TrimmedNewBodyType != "primary")
+	{
+		return FString::Printf(TEXT("Unknown body type \"%s\"."),
+			*TrimmedNewBodyType);
+	}
+
+	if (bIsNewTypeGhost)
+	{
+		body_interface->SetMotionType(TargetBodyId, EMotionType::Kinematic,
+			EActivation::Activate);
+		body_interface->SetObjectLayer(TargetBodyId, Layers::GHOST);
+		RemoveFromBodyIdList(TargetBodyId);
+		Vehicles.SetVehicleEnabled(TargetBodyId, false);
+	}
+	else
+	{
+		// The ghost keeps the velocity it was driven with, so the body goes
+		// on from where its last primary left it
+		body_interface->SetMotionType(TargetBodyId, EMotionType::Dynamic,
+			EActivation::Activate);
+		body_interface->SetObjectLayer(TargetBodyId, Layers::MOVING);
+		AddToBodyIdList(TargetBodyId);
+		Vehicles.SetVehicleEnabled(TargetBodyId, true);
+
+		GhostBodyTargets.RemoveAllSwap([TargetBodyId]
+			(const FGhostBodyTarget& GhostBodyTarget)
+			{ return GhostBodyTarget.GhostBodyId == TargetBodyId; });
+	}
+
+	// Update the body line, so a restored snapshot has the same type
+	if (FString* BodyInfoLine = BodyInfoLines.Find(TargetBodyId.GetIndex()))
+	{
+		TArray<FString> BodyInfo;
+		BodyInfoLine->ParseIntoArray(BodyInfo, TEXT(";"), false);
+		if (BodyInfo.Num() > 2)
+		{
+			BodyInfo[2] = TrimmedNewBodyType;
+			*BodyInfoLine = FString::Join(BodyInfo, TEXT(";"));
+		}
+	}
+
+	return FString::Printf(TEXT("Body %d type updated to %s."),
+		TargetBodyId.GetIndex(), *TrimmedNewBodyType);
+}
+
+void FPhysicsServiceImpl::SetGhostBodyTargets
+	(const TArray<FString>& GhostStateLines)
+{
+	GhostBodyTargets.Reset();
+
+	for (const FString& GhostStateLine : GhostStateLines)
+	{
+		TArray<FString> GhostState;
+		GhostStateLine.ParseIntoArray(GhostState, TEXT(";"));
+
+		if (GhostState.Num() < 11 || GhostState[0] != "Ghost")
+		{
+			continue;
+		}
+
+		FGhostBodyTarget GhostBodyTarget;
+		GhostBodyTarget.GhostBodyId = BodyID(FCString::Atoi(*GhostState[1]));
+		GhostBodyTarget.Position = WorldOrigin.ParseLocalPosition(GhostState,
+			2);
+		GhostBodyTarget.LinearVelocity = Vec3(FCString::Atof(*GhostState[5]),
+			FCString::Atof(*GhostState[6]), FCString::Atof(*GhostState[7]));
+		GhostBodyTarget.AngularVelocity = Vec3(FCString::Atof(*GhostState[8]),
+			FCString::Atof(*GhostState[9]), FCString::Atof(*GhostState[10]));
+
+		GhostBodyTargets.Add(GhostBodyTarget);
+	}
+}
+
+void FPhysicsServiceImpl::SetKinematicBodyTargets
+	(const TArray<FString>& KinematicTargetLines)
+{
+	KinematicBodyTargets.Reset();
+
+	// The packed target: body id, position (3) and rotation (4)
+	constexpr int32 KinematicTargetSize = sizeof(int32) + 7 * sizeof(float);
+
+	for (const FString& KinematicTargetLine : KinematicTargetLines)
+	{
+		TArray<FString> KinematicTargetsInfo;
+		KinematicTargetLine.ParseIntoArray(KinematicTargetsInfo, TEXT(";"));
+
+		if (KinematicTargetsInfo.Num() < 3)
+		{
+			continue;
+		}
+
+		const int32 NumberOfTargets = FCString::Atoi
+			(*KinematicTargetsInfo[1]);
+
+		TArray<uint8> PackedTargets;
+		if (NumberOfTargets <= 0 || !FBase64::Decode
+			(KinematicTargetsInfo[2].TrimStartAndEnd(), PackedTargets) ||
+			PackedTargets.Num() != NumberOfTargets * KinematicTargetSize)
+		{
+			LPES_LOG_WARNING(TEXT("World %d could not decode %d kinematic "
+				"targets."), WorldId, NumberOfTargets);
+			continue;
+		}
+
+		KinematicBodyTargets.Reserve(KinematicBodyTargets.Num() +
+			NumberOfTargets);
+
+		for (int32 i = 0; i < NumberOfTargets; i++)
+		{
+			int32 KinematicBodyIndex = 0;
+			float TargetTransform[7];
+
+			const uint8* PackedTarget = PackedTargets.GetData() + i *
+				KinematicTargetSize;
+			FMemory::Memcpy(&KinematicBodyIndex, PackedTarget,
+				sizeof(int32));
+			FMemory::Memcpy(TargetTransform, PackedTarget + sizeof(int32),
+				sizeof(TargetTransform));
+
+			FKinematicBodyTarget KinematicBodyTarget;
+			KinematicBodyTarget.KinematicBodyId = BodyID(KinematicBodyIndex);
+			KinematicBodyTarget.Position = WorldOrigin.ToLocalPosition
+				(TargetTransform[0], TargetTransform[1], TargetTransform[2]);
+			KinematicBodyTarget.Rotation = Quat(TargetTransform[3],
+				TargetTransform[4], TargetTransform[5], TargetTransform[6])
+				.Normalized();
+
+			KinematicBodyTargets.Add(KinematicBodyTarget);
+		}
+	}
+}
+
+void FPhysicsServiceImpl::SetCharacterInputs
+	(const TArray<FString>& CharacterInputLines)
+{
+	FPhysicsMemoryAccountingScope MemoryAccountingScope(MemoryAccounting);
+
+	Characters.SetCharacterInputs(CharacterInputLines);
+}
+
+void FPhysicsServiceImpl::SetRagdollActivations
+	(const TArray<FString>& RagdollActivationLines)
+{
+	FPhysicsMemoryAccountingScope MemoryAccountingScope(MemoryAccounting);
+
+	Ragdolls.ActivateRagdolls(RagdollActivationLines);
+}
+
+void FPhysicsServiceImpl::ApplyConstraintChanges
+	(const TArray<FString>& ConstraintLines)
+{
+	FPhysicsMemoryAccountingScope MemoryAccountingScope(MemoryAccounting);
+
+	Constraints.ApplyConstraintChanges(ConstraintLines);
+}
+
+void FPhysicsServiceImpl::ApplyForceFieldChanges
+	(const TArray<FString>& ForceFieldLines)
+{
+	FPhysicsMemoryAccountingScope MemoryAccountingScope(MemoryAccounting);
+
+	ForceFields.ApplyForceFieldChanges(ForceFieldLines);
+}
+
+void FPhysicsServiceImpl::DriveGhostBodies(const float DriveTime)
+{
+	for (const FGhostBodyTarget& GhostBodyTarget : GhostBodyTargets)
+	{
+		const BodyID& GhostBodyId = GhostBodyTarget.GhostBodyId;
+		if (!body_interface->IsAdded(GhostBodyId) ||
+			body_interface->GetObjectLayer(GhostBodyId) != Layers::GHOST)
+		{
+			continue;
+		}
+
+		// The primary state is from the end of its service's last step, and
+		// both services advance the same time on this one
+		const RVec3 TargetPosition = GhostBodyTarget.Position +
+			GhostBodyTarget.LinearVelocity * DriveTime;
+
+		// Rotate the ghost by the primary's angular velocity
+		Quat TargetRotation = body_interface->GetRotation(GhostBodyId);
+		const float AngularSpeed = GhostBodyTarget.AngularVelocity.Length();
+		if (AngularSpeed > 1.e-6f)
+		{
+			TargetRotation = (Quat::sRotation(GhostBodyTarget.AngularVelocity
+				/ AngularSpeed, AngularSpeed * DriveTime) * TargetRotation)
+				.Normalized();
+		}
+
+		// Sets the velocities so the ghost arrives at the target once the
+		// steps are done
+		body_interface->MoveKinematic(GhostBodyId, TargetPosition,
+			TargetRotation, DriveTime);
+	}
+}
+
+void FPhysicsServiceImpl::DriveKinematicBodies(const float DriveTime)
+{
+	for (const FKinematicBodyTarget& KinematicBodyTarget :
+		KinematicBodyTargets)
+	{
+		const BodyID& KinematicBodyId = KinematicBodyTarget.KinematicBodyId;
+		if (!body_interface->IsAdded(KinematicBodyId) ||
+			body_interface->GetObjectLayer(KinematicBodyId) != Layers::MOVING
+			|| body_interface->GetMotionType(KinematicBodyId) !=
+			EMotionType::Kinematic)
+		{
+			continue;
+		}
+
+		body_interface->MoveKinematic(KinematicBodyId,
+			KinematicBodyTarget.Position, KinematicBodyTarget.Rotation,
+			DriveTime);
+	}
+}
+
+void FPhysicsServiceImpl::AddToBodyIdList(const BodyID BodyToAddID)
+{
+	const int32 BodyIndex = BodyToAddID.GetIndex();
+	// Only the new slots are cleared, as the others hold the listed bodies
+	if (BodyIdListSlots.Num() <= BodyIndex)
+	{
+		const int32 PreviousNumberOfSlots = BodyIdListSlots.Num();
+		BodyIdListSlots.SetNumUninitialized(BodyIndex + 1);
+		for (int32 i = PreviousNumberOfSlots; i <= BodyIndex; i++)
+		{
+			BodyIdListSlots[i] = INDEX_NONE;
+		}
+	}
+
+	if (BodyIdListSlots[BodyIndex] != INDEX_NONE)
+	{
+		return;
+	}
+
+	BodyIdListSlots[BodyIndex] = static_cast<int32>(BodyIdList.size());
+	BodyIdList.push_back(BodyToAddID);
+}
+
+void FPhysicsServiceImpl::RemoveFromBodyIdList(const BodyID BodyToRemoveID)
+{
+	const int32 BodyIndex = BodyToRemoveID.GetIndex();
+	if (!BodyIdListSlots.IsValidIndex(BodyIndex) ||
+		BodyIdListSlots[BodyIndex] == INDEX_NONE)
+	{
+		return;
+	}
+
+	// Move the last body to the removed body's slot
+	const int32 RemovedBodySlot = BodyIdListSlots[BodyIndex];
+	const BodyID LastBodyID = BodyIdList.back();
+
+	BodyIdList[RemovedBodySlot] = LastBodyID;
+	BodyIdListSlots[LastBodyID.GetIndex()] = RemovedBodySlot;
+
+	BodyIdList.pop_back();
+	BodyIdListSlots[BodyIndex] = INDEX_NONE;
+}
+
+FString FPhysicsServiceImpl::AddImpulseToBody(const BodyID BodyToPushID,
+	const Vec3 Impulse)
+{
+	// Check if the body is on the physics world
+	if (!body_interface || !body_interface->IsAdded(BodyToPushID))
+	{
+		return FString::Printf(TEXT("Body %d is not on the physics world.\n"),
+			BodyToPushID.GetIndex());
+	}
+
+	body_interface->AddImpulse(BodyToPushID, Impulse);
+
+	return "Impulse processed successfully";
+}
+
+FString FPhysicsServiceImpl::ApplySimulationCommand
+	(const FString& CommandLine)
+{
+	// Split the command from its arguments
+	FString Command;
+	FString CommandArguments;
+	if (!CommandLine.Split(TEXT(";"), &Command, &CommandArguments))
+	{
+		return FString::Printf(TEXT("Could not parse command \"%s\".\n"),
+			*CommandLine);
+	}
+
+	if (Command == "AddBody")
+	{
+		return AddBodyFromMessageLine(CommandArguments);
+	}
+
+	if (Command == "RemoveBody")
+	{
+		return RemoveBodyByID(BodyID(FCString::Atoi(*CommandArguments)));
+	}
+
+	if (Command == "Impulse")
+	{
+		TArray<FString> ParsedImpulse;
+		CommandArguments.ParseIntoArray(ParsedImpulse, TEXT(";"));
+		if (ParsedImpulse.Num() < 4)
+		{
+			return "Error on parsing impulse command.\n";
+		}
+
+		const Vec3 Impulse(FCString::Atof(*ParsedImpulse[1]),
+			FCString::Atof(*ParsedImpulse[2]),
+			FCString::Atof(*ParsedImpulse[3]));
+
+		return AddImpulseToBody(BodyID(FCString::Atoi(*ParsedImpulse[0])),
+			Impulse);
+	}
+
+	return FString::Printf(TEXT("Unknown command \"%s\".\n"), *Command);
+}
+
+uint32 FPhysicsServiceImpl::GetStateChecksum() const
+{
+	if (!bIsInitialized || !physics_system)
+	{
+		return 0;
+	}
+
+	// Hashes a single body's quantized state. The body index is hashed along,
+	// so swapping two bodies' states changes the checksum
+	const BodyInterface& NoLockBodyInterface =
+		physics_system->GetBodyInterfaceNoLock();
+	auto GetBodyStateHash = [&NoLockBodyInterface](const BodyID& BodyId)
+	{
+		const Vec3 BodyState[4] =
+		{
+			NoLockBodyInterface.GetCenterOfMassPosition(BodyId),
+			NoLockBodyInterface.GetRotation(BodyId).GetXYZ(),
+			NoLockBodyInterface.GetLinearVelocity(BodyId),
+			NoLockBodyInterface.GetAngularVelocity(BodyId)
+		};
+
+		int64 QuantizedBodyState[13];
+		QuantizedBodyState[0] = BodyId.GetIndex();
+		for (int32 i = 0; i < 4; i++)
+		{
+			for (int32 Axis = 0; Axis < 3; Axis++)
+			{
+				const double QuantizedValue = FMath::RoundToDouble
+					(static_cast<double>(BodyState[i][Axis]) /
+					StateChecksumQuantum);
+				QuantizedBodyState[1 + i * 3 + Axis] = static_cast<int64>
+					(FMath::Clamp(QuantizedValue, -MaxQuantizedStateValue,
+					MaxQuantizedStateValue));
+			}
+		}
+
+		return FCrc::MemCrc32(QuantizedBodyState, sizeof(QuantizedBodyState));
+	};
+
+	// Split the bodies in ranges, one job each. Each range sums its bodies'
+	// hashes, so the ranges (and bodies) can be combined on any order
+	std::atomic<uint32> BodiesChecksum(0);
+	ParallelForBatches(*job_system, static_cast<int32>(BodyIdList.size()),
+		MinBodiesPerChecksumJob, "StateChecksum", [this, &BodiesChecksum,
+		&GetBodyStateHash](const int32 FirstBodyIndex,
+		const int32 LastBodyIndex)
+	{
+		uint32 RangeChecksum = 0;
+		for (int32 i = FirstBodyIndex; i < LastBodyIndex; i++)
+		{
+			RangeChecksum += GetBodyStateHash(BodyIdList[i]);
+		}
+
+		BodiesChecksum.fetch_add(RangeChecksum, std::memory_order_relaxed);
+	});
+
+	// Combine the bodies and the step counter
+	const uint32 StateChecksum = FCrc::MemCrc32(&StepPhysicsCounter,
+		sizeof(StepPhysicsCounter)) + BodiesChecksum.load();
+
+	// Log the checksum and each body's state on Jolt's determinism log, if
+	// enabled, so two runs can be diffed to find the first divergent body
+#ifdef JPH_ENABLE_DETERMINISM_LOG
+	JPH_DET_LOG("StateChecksum: world: " << WorldId << " step: " <<
+		StepPhysicsCounter << " checksum: " << StateChecksum);
+	for (const BodyID& BodyId : BodyIdList)
+	{
+		JPH_DET_LOG("StateChecksum: id: " << BodyId << " p: " <<
+			NoLockBodyInterface.GetCenterOfMassPosition(BodyId) << " r: " <<
+			NoLockBodyInterface.GetRotation(BodyId) << " v: " <<
+			NoLockBodyInterface.GetLinearVelocity(BodyId) << " w: " <<
+			NoLockBodyInterface.GetAngularVelocity(BodyId));
+	}
+#endif
+
+	return StateChecksum;
+}
+
+FString FPhysicsServiceImpl::SaveWorldSnapshot()
+{
+	// Check if there is a world to save
+	if (!bIsInitialized || !physics_system)
+	{
+		LPES_LOG_WARNING(TEXT("Could not save snapshot of world %d as it is "
+			"not initialized."), WorldId);
+		return FString();
+	}
+
+	// Get pre save time
+	std::chrono::steady_clock::time_point preSaveTime =
+		std::chrono::steady_clock::now();
+
+	// Write the settings. The floats are written with enough digits to be
+	// read back exactly, so the restored world steps the same way
+	FString WorldSnapshot = FString::Printf(TEXT("Settings;%.9g;%d;%d;%d;%d;"
+		"%.9g;%u;%u;%u;%.17g;%.17g;%.17g\n"), FixedDeltaTime, CollisionSteps,
+		IntegrationSubSteps, MaxCatchUpSteps, MaxContactEventsPerStep,
+		TimeAccumulator, StepPhysicsCounter, RewindHistoryLength,
+		MaxRewindBodies, WorldOrigin.X, WorldOrigin.Y, WorldOrigin.Z);
+
+	// Write the static scene the world was initialized with, if any
+	if (!StaticSceneKey.IsEmpty())
+	{
+		WorldSnapshot += FString::Printf(TEXT("StaticScene;%s;%u\n"),
+			*StaticSceneKey, StaticSceneContentHash);
+	}
+
+	// Write the bodies ordered by their index, so they are recreated on the
+	// same order
+	TArray<uint32> BodyIndexes;
+	BodyInfoLines.GetKeys(BodyIndexes);
+	BodyIndexes.Sort();
+
+	for (const uint32 BodyIndex : BodyIndexes)
+	{
+		WorldSnapshot += FString::Printf(TEXT("Body;%s\n"),
+			*BodyInfoLines[BodyIndex]);
+	}
+
+	// Write the contact events subscriptions
+	for (const auto& Subscription : ContactEventSubscriptions)
+	{
+		WorldSnapshot += FString::Printf(TEXT("Subscription;%u;%d;%.9g\n"),
+			Subscription.Key, Subscription.Value.SubscriptionFlags,
+			Subscription.Value.MinContactImpulse);
+	}
+
+	// Write the constraints, which must be recreated before the state is
+	// restored
+	WorldSnapshot += Constraints.SaveConstraints();
+
+	// Write the lasting force fields, with their remaining time
+	WorldSnapshot += ForceFields.SaveForceFields();
+
+	// Record the Jolt state (bodies' state, activation, contact cache and
+	// constraints). The characters' and ragdolls' bodies are not part of the
+	// snapshot, so they are off the world while it is recorded
+	Characters.RemoveCapsuleBodiesFromWorld();
+	Ragdolls.RemoveActiveRagdollsFromWorld();
+
+	StateRecorderImpl WorldStateRecorder;
+	physics_system->SaveState(WorldStateRecorder);
+
+	Ragdolls.AddActiveRagdollsBackToWorld();
+	Characters.AddCapsuleBodiesBackToWorld();
+
+	// Encode the binary state, so it can be sent as a message line
+	const std::string WorldStateData = WorldStateRecorder.GetData();
+	TArray<uint8> WorldStateBytes;
+	WorldStateBytes.Append(reinterpret_cast<const uint8*>
+		(WorldStateData.data()), WorldStateData.size());
+
+	WorldSnapshot += FString::Printf(TEXT("State;%s\n"),
+		*FBase64::Encode(WorldStateBytes));
+
+	// Get post save time
+	std::chrono::steady_clock::time_point postSaveTime =
+		std::chrono::steady_clock::now();
+
+	LPES_LOG_INFO(TEXT("Snapshot of world %d saved (bodies: %d; state: %d "
+		"bytes) in %lld microseconds."), WorldId, BodyIndexes.Num(),
+		WorldStateBytes.Num(), static_cast<int64>(std::chrono::duration_cast
+		<std::chrono::microseconds>(postSaveTime - preSaveTime).count()));
+
+	return WorldSnapshot;
+}
+
+bool FPhysicsServiceImpl::RestoreWorldSnapshot(const FString& WorldSnapshot)
+{
+	// Get pre restore time
+	std::chrono::steady_clock::time_point preRestoreTime =
+		std::chrono::steady_clock::now();
+
+	TArray<FString> SnapshotLines;
+	WorldSnapshot.ParseIntoArrayLines(SnapshotLines);
+
+	// Split the snapshot lines by their type
+	TArray<FString> SettingsInfo;
+	FString BodiesInfo = FString();
+	TArray<FString> SubscriptionLines;
+	TArray<FString> SavedConstraintLines;
+	FString ConstraintOrderLine = FString();
+	TArray<FString> ForceFieldLines;
+	FString EncodedWorldState = FString();
+
+	for (const FString& SnapshotLine : SnapshotLines)
+	{
+		if (SnapshotLine.StartsWith("Settings;"))
+		{
+			SnapshotLine.ParseIntoArray(SettingsInfo, TEXT(";"));
+		}
+		else if (SnapshotLine.StartsWith("Body;"))
+		{
+			BodiesInfo += SnapshotLine.RightChop(5) + "\n";
+		}
+		else if (SnapshotLine.StartsWith("StaticScene;"))
+		{
+			// The static scene is added first, the same as on the "Init"
+			BodiesInfo = SnapshotLine + "\n" + BodiesInfo;
+		}
+		else if (SnapshotLine.StartsWith("Subscription;"))
+		{
+			SubscriptionLines.Add(SnapshotLine);
+		}
+		else if (SnapshotLine.StartsWith("SavedConstraint;"))
+		{
+			SavedConstraintLines.Add(SnapshotLine);
+		}
+		else if (SnapshotLine.StartsWith("ConstraintOrder;"))
+		{
+			ConstraintOrderLine = SnapshotLine;
+		}
+		else if (SnapshotLine.StartsWith("ForceField;"))
+		{
+			ForceFieldLines.Add(SnapshotLine);
+		}
+		else if (SnapshotLine.StartsWith("State;"))
+		{
+			EncodedWorldState = SnapshotLine.RightChop(6).TrimEnd();
+		}
+	}
+
+	// Check for errors
+	if (SettingsInfo.Num() < 8 || EncodedWorldState.IsEmpty())
+	{
+		LPES_LOG_ERROR(TEXT("Could not restore snapshot on world %d as it "
+			"has no settings or state."), WorldId);
+		return false;
+	}
+
+	TArray<uint8> WorldStateBytes;
+	if (!FBase64::Decode(EncodedWorldState, WorldStateBytes))
+	{
+		LPES_LOG_ERROR(TEXT("Could not decode the state of the snapshot on "
+			"world %d."), WorldId);
+		return false;
+	}
+
+	// The step settings must be set before the world is created
+	SetStepSettings(FCString::Atof(*SettingsInfo[1]),
+		FCString::Atoi(*SettingsInfo[2]), FCString::Atoi(*SettingsInfo[3]),
+		FCString::Atoi(*SettingsInfo[4]));
+	SetMaxContactEventsPerStep(FCString::Atoi(*SettingsInfo[5]));
+
+	if (SettingsInfo.Num() >= 10)
+	{
+		SetRewindHistorySettings(FCString::Atoi(*SettingsInfo[8]),
+			FCString::Atoi(*SettingsInfo[9]));
+	}
+
+	// The bodies, constraints and Jolt state are relative to the origin the
+	// world was saved with
+	FPhysicsWorldOrigin SnapshotWorldOrigin;
+	if (SettingsInfo.Num() >= 13)
+	{
+		SnapshotWorldOrigin.X = FCString::Atod(*SettingsInfo[10]);
+		SnapshotWorldOrigin.Y = FCString::Atod(*SettingsInfo[11]);
+		SnapshotWorldOrigin.Z = FCString::Atod(*SettingsInfo[12]);
+	}
+	SetWorldOrigin(SnapshotWorldOrigin);
+
+	// Create the world with the same bodies the snapshot was saved with. Their
+	// state is overwritten by the Jolt state right after
+	InitPhysicsSystem(BodiesInfo);
+
+	// Restore the contact events subscriptions
+	for (const FString& SubscriptionLine : SubscriptionLines)
+	{
+		TArray<FString> SubscriptionInfo;
+		SubscriptionLine.ParseIntoArray(SubscriptionInfo, TEXT(";"));
+
+		if (SubscriptionInfo.Num() < 4)
+		{
+			continue;
+		}
+
+		SetContactEventSubscription
+			(BodyID(FCString::Atoi(*SubscriptionInfo[1])),
+			static_cast<uint8>(FCString::Atoi(*SubscriptionInfo[2])),
+			FCString::Atof(*SubscriptionInfo[3]));
+	}
+
+	// Recreate the constraints, on the order the state was saved with
+	if (!Constraints.RestoreConstraints(SavedConstraintLines,
+		ConstraintOrderLine))
+	{
+		LPES_LOG_ERROR(TEXT("Could not restore the constraints of the "
+			"snapshot on world %d."), WorldId);
+		ClearPhysicsSystem();
+		return false;
+	}
+
+	// The force fields keep pushing their bodies on the restored world
+	ForceFields.ApplyForceFieldChanges(ForceFieldLines);
+
+	// Restore the Jolt state. This fails if the bodies don't match the ones
+	// the state was saved with
+	StateRecorderImpl WorldStateRecorder;
+	WorldStateRecorder.WriteBytes(WorldStateBytes.GetData(),
+		WorldStateBytes.Num());
+	WorldStateRecorder.Rewind();
+
+	if (!physics_system->RestoreState(WorldStateRecorder))
+	{
+		LPES_LOG_ERROR(TEXT("Could not restore the Jolt state on world %d. "
+			"The snapshot bodies don't match."), WorldId);
+		ClearPhysicsSystem();
+		return false;
+	}
+
+	// Continue from the same time and step the snapshot was saved on
+	TimeAccumulator = FCString::Atof(*SettingsInfo[6]);
+	StepPhysicsCounter = static_cast<uint32>(FCString::Strtoui64
+		(*SettingsInfo[7], nullptr, 10));
+	LastStateChecksum = GetStateChecksum();
+
+	// Get post restore time
+	std::chrono::steady_clock::time_point postRestoreTime =
+		std::chrono::steady_clock::now();
+
+	LPES_LOG_INFO(TEXT("Snapshot restored on world %d (state: %d bytes) in "
+		"%lld microseconds."), WorldId, WorldStateBytes.Num(),
+		static_cast<int64>(std::chrono::duration_cast
+		<std::chrono::microseconds>(postRestoreTime - preRestoreTime).count()));
+
+	return true;
+}
+
+FString FPhysicsServiceImpl::RewindRaycast(const FString& RaysInfo) const
+{
+	// The rewind info tells which steps can be queried and the history cost
+	FString RewindRaycastResponse = FString::Printf(TEXT("RewindInfo;%u;%u;"
+		"%llu\n"), StateHistory.GetOldestStepIndex(),
+		StateHistory.GetNewestStepIndex(), static_cast<uint64>
+		(StateHistory.GetAllocatedSize()));
+
+	// A ray to cast and its result
+	struct FRewindRay
+	{
+		/** The step the moving bodies are placed on */
+		uint32 StepIndex = 0;
+
+		/** The ray on world space */
+		RRayCast Ray;
+
+		/** If the step is no longer on the history */
+		bool bIsExpired = false;
+
+		/** The closest body hit. Invalid if none */
+		BodyID HitBodyId;
+
+		/** The closest hit fraction */
+		float HitFraction = 1.f + FLT_EPSILON;
+	};
+
+	// Parse the rays
+	TArray<FString> RaysInfoLines;
+	RaysInfo.ParseIntoArrayLines(RaysInfoLines);
+
+	TArray<FRewindRay> RewindRays;
+	RewindRays.Reserve(RaysInfoLines.Num());
+
+	for (const FString& RayInfoLine : RaysInfoLines)
+	{
+		TArray<FString> RayInfo;
+		RayInfoLine.ParseIntoArray(RayInfo, TEXT(";"));
+
+		if (RayInfo.Num() < 7)
+		{
+			LPES_LOG_WARNING(TEXT("Could not parse rewind ray \"%s\"."),
+				*RayInfoLine);
+			continue;
+		}
+
+		FRewindRay& RewindRay = RewindRays.AddDefaulted_GetRef();
+		RewindRay.StepIndex = static_cast<uint32>(FCString::Strtoui64
+			(*RayInfo[0], nullptr, 10));
+		RewindRay.Ray = RRayCast(WorldOrigin.ParseLocalPosition(RayInfo, 1),
+			Vec3(FCString::Atof(*RayInfo[4]), FCString::Atof(*RayInfo[5]),
+			FCString::Atof(*RayInfo[6])));
+
+		// Check if the step is still on the history
+		RewindRay.bIsExpired = !StateHistory.IsEnabled() ||
+			RewindRay.StepIndex < StateHistory.GetOldestStepIndex() ||
+			RewindRay.StepIndex > StateHistory.GetNewestStepIndex();
+	}
+
+	if (RewindRays.Num() == 0)
+	{
+		return RewindRaycastResponse;
+	}
+
+	// Get the moving bodies' and movers' shapes once, instead of on each
+	// ray. Bodies removed since a step was recorded are not found and thus
+	// ignored
+	TMap<uint32, ShapeRefC> MovingBodyShapes;
+	MovingBodyShapes.Reserve(BodyIdList.size() + KinematicBodyIdList.size());
+	for (const std::vector<BodyID>* MovingBodyIds : { &BodyIdList,
+		&KinematicBodyIdList })
+	{
+		for (const BodyID& MovingBodyId : *MovingBodyIds)
+		{
+			MovingBodyShapes.Add(MovingBodyId.GetIndex(),
+				body_interface->GetShape(MovingBodyId));
+		}
+	}
+
+	const NarrowPhaseQuery& WorldQuery = physics_system->GetNarrowPhaseQuery();
+	const FNonMovingObjectLayerFilter NonMovingObjectLayerFilter;
+	const FNonSensorBodyFilter NonSensorBodyFilter(Sensors);
+
+	// Casts a single ray against the moving bodies as they were on the ray's
+	// step and against the static bodies as they are
+	auto CastRewindRay = [this, &MovingBodyShapes, &WorldQuery,
+		&NonMovingObjectLayerFilter, &NonSensorBodyFilter]
+		(FRewindRay& RewindRay)
+	{
+		if (RewindRay.bIsExpired)
+		{
+			return;
+		}
+
+		const TArrayView<const FPhysicsBodyHistoryState> StepBodyStates =
+			StateHistory.GetStepBodyStates(RewindRay.StepIndex);
+
+		for (const FPhysicsBodyHistoryState& BodyState : StepBodyStates)
+		{
+			const ShapeRefC* BodyShape =
+				MovingBodyShapes.Find(BodyState.Body.GetIndex());
+			if (!BodyShape || *BodyShape == nullptr)
+			{
+				continue;
+			}
+
+			// Move the ray to the body's space as it was on the step
+			const Mat44 InverseBodyTransform =
+				Mat44::sInverseRotationTranslation
+				(Quat(Vec4::sLoadFloat4(&BodyState.Rotation)),
+				Vec3(BodyState.Position));
+			const RayCast LocalRay = static_cast<RayCast>(RewindRay.Ray).
+				Transformed(InverseBodyTransform);
+
+			// Only hits closer than the current one are reported
+			RayCastResult BodyHit;
+			BodyHit.mFraction = RewindRay.HitFraction;
+			if ((*BodyShape)->CastRay(LocalRay, SubShapeIDCreator(), BodyHit))
+			{
+				RewindRay.HitFraction = BodyHit.mFraction;
+				RewindRay.HitBodyId = BodyState.Body;
+			}
+		}
+
+		// The static bodies never move, so they are tested as they are
+		RayCastResult StaticHit;
+		StaticHit.mFraction = RewindRay.HitFraction;
+		if (WorldQuery.CastRay(RewindRay.Ray, StaticHit, { },
+			NonMovingObjectLayerFilter, NonSensorBodyFilter))
+		{
+			RewindRay.HitFraction = StaticHit.mFraction;
+			RewindRay.HitBodyId = StaticHit.mBodyID;
+		}
+	};
+
+	// Split the rays in batches, so the query is spread over the job system
+	// threads
+	ParallelForBatches(*job_system, RewindRays.Num(), MinRaysPerRewindJob,
+		"RewindRaycast", [&RewindRays, &CastRewindRay]
+		(const int32 FirstRayIndex, const int32 LastRayIndex)
+	{
+		for (int32 i = FirstRayIndex; i < LastRayIndex; i++)
+		{
+			CastRewindRay(RewindRays[i]);
+		}
+	});
+
+	// Append each ray result
+	for (int32 i = 0; i < RewindRays.Num(); i++)
+	{
+		const FRewindRay& RewindRay = RewindRays[i];
+
+		if (RewindRay.bIsExpired)
+		{
+			RewindRaycastResponse += FString::Printf(TEXT("RewindHit;%d;"
+				"Expired\n"), i);
+			continue;
+		}
+
+		if (RewindRay.HitBodyId.IsInvalid())
+		{
+			RewindRaycastResponse += FString::Printf(TEXT("RewindHit;%d;"
+				"None\n"), i);
+			continue;
+		}
+
+		const RVec3 HitPoint = RewindRay.Ray.GetPointOnRay
+			(RewindRay.HitFraction);
+		RewindRaycastResponse += FString::Printf(TEXT("RewindHit;%d;%d;%f;"
+			"%s\n"), i, RewindRay.HitBodyId.GetIndex(),
+			RewindRay.HitFraction,
+			*WorldOrigin.ToClientPositionString(HitPoint));
+	}
+
+	return RewindRaycastResponse;
+}
+
+FString FPhysicsServiceImpl::RunSceneQueries
+	(const TArray<FString>& QueryLines) const
+{
+	FString SceneQueriesResponse = FString();
+
+	// The types of scene queries
+	enum class ESceneQueryType : uint8
+	{
+		Ray,
+		Sweep,
+		Overlap
+	};
+
+	// A scene query and its result
+	struct FSceneQuery
+	{
+		/** The id the client tagged the query with */
+		int32 RequestId = INDEX_NONE;
+
+		/** The query type */
+		ESceneQueryType QueryType = ESceneQueryType::Ray;
+
+		/** The swept or overlapped shape. Null for rays */
+		ShapeRefC QueryShape;
+
+		/** The ray origin or the shape's start position */
+		RVec3 Origin = RVec3::sZero();
+
+		/** The shape rotation */
+		Quat Rotation = Quat::sIdentity();
+
+		/** The ray or sweep direction, also holding its length */
+		Vec3 Direction = Vec3::sZero();
+
+		/** The closest body hit. Invalid if none */
+		BodyID HitBodyId;
+
+		/** The closest hit fraction, point and normal */
+		float HitFraction = 1.f;
+		RVec3 HitPoint = RVec3::sZero();
+		Vec3 HitNormal = Vec3::sZero();
+
+		/** The bodies overlapping the shape */
+		TArray<uint32> OverlappingBodyIds;
+	};
+
+	// Parse the queries. The shapes are created here, as they are only used
+	// by this batch and thus should not go to the shared shape cache
+	TArray<FSceneQuery> SceneQueries;
+	SceneQueries.Reserve(QueryLines.Num());
+
+	for (const FString& QueryLine : QueryLines)
+	{
+		TArray<FString> QueryInfo;
+		QueryLine.ParseIntoArray(QueryInfo, TEXT(";"));
+
+		if (QueryInfo.Num() < 3 || QueryInfo[0] != "Query")
+		{
+			continue;
+		}
+
+		// Gets a vector from the query info, starting at the given field
+		auto GetQueryVector = [&QueryInfo](const int32 FirstField)
+		{
+			return Vec3(FCString::Atof(*QueryInfo[FirstField]),
+				FCString::Atof(*QueryInfo[FirstField + 1]),
+				FCString::Atof(*QueryInfo[FirstField + 2]));
+		};
+
+		// Gets a box shape from the query info, starting at the given field
+		auto GetQueryBoxShape = [&GetQueryVector](const int32 FirstField)
+		{
+			const Vec3 HalfExtents = Vec3::sMax(GetQueryVector(FirstField),
+				Vec3::sReplicate(FLT_EPSILON));
+			return ShapeRefC(new BoxShape(HalfExtents, FMath::Min
+				(cDefaultConvexRadius, HalfExtents.ReduceMin())));
+		};
+
+		FSceneQuery SceneQuery;
+		SceneQuery.RequestId = FCString::Atoi(*QueryInfo[1]);
+
+		const FString& QueryType = QueryInfo[2];
+		if (QueryType == "Ray" && QueryInfo.Num() >= 9)
+		{
+			SceneQuery.Origin = WorldOrigin.ParseLocalPosition(QueryInfo,
+				3);
+			SceneQuery.Direction = GetQueryVector(6);
+		}
+		else if (QueryType == "SphereSweep" && QueryInfo.Num() >= 10)
+		{
+			SceneQuery.QueryType = ESceneQueryType::Sweep;
+			SceneQuery.QueryShape = new SphereShape(FMath::Max(FCString::Atof
+				(*QueryInfo[3]), FLT_EPSILON));
+			SceneQuery.Origin = WorldOrigin.ParseLocalPosition(QueryInfo,
+				4);
+			SceneQuery.Direction = GetQueryVector(7);
+		}
+		else if (QueryType == "BoxSweep" && QueryInfo.Num() >= 16)
+		{
+			SceneQuery.QueryType = ESceneQueryType::Sweep;
+			SceneQuery.QueryShape = GetQueryBoxShape(3);
+			SceneQuery.Rotation = Quat(FCString::Atof(*QueryInfo[6]),
+				FCString::Atof(*QueryInfo[7]), FCString::Atof(*QueryInfo[8]),
+				FCString::Atof(*QueryInfo[9])).Normalized();
+			SceneQuery.Origin = WorldOrigin.ParseLocalPosition(QueryInfo,
+				10);
+			SceneQuery.Direction = GetQueryVector(13);
+		}
+		else if (QueryType == "SphereOverlap" && QueryInfo.Num() >= 7)
+		{
+			SceneQuery.QueryType = ESceneQueryType::Overlap;
+			SceneQuery.QueryShape = new SphereShape(FMath::Max(FCString::Atof
+				(*QueryInfo[3]), FLT_EPSILON));
+			SceneQuery.Origin = WorldOrigin.ParseLocalPosition(QueryInfo,
+				4);
+		}
+		else if (QueryType == "BoxOverlap" && QueryInfo.Num() >= 13)
+		{
+			SceneQuery.QueryType = ESceneQueryType::Overlap;
+			SceneQuery.QueryShape = GetQueryBoxShape(3);
+			SceneQuery.Rotation = Quat(FCString::Atof(*QueryInfo[6]),
+				FCString::Atof(*QueryInfo[7]), FCString::Atof(*QueryInfo[8]),
+				FCString::Atof(*QueryInfo[9])).Normalized();
+			SceneQuery.Origin = WorldOrigin.ParseLocalPosition(QueryInfo,
+				10);
+		}
+		else
+		{
+			LPES_LOG_WARNING(TEXT("Could not parse scene query \"%s\"."),
+				*QueryLine);
+			continue;
+		}
+
+		SceneQueries.Add(MoveTemp(SceneQuery));
+	}
+
+	if (SceneQueries.Num() == 0)
+	{
+		return SceneQueriesResponse;
+	}
+
+	const NarrowPhaseQuery& WorldQuery = physics_system->GetNarrowPhaseQuery();
+	const BodyLockInterface& WorldBodyLockInterface =
+		physics_system->GetBodyLockInterface();
+	const FSceneQueryBroadPhaseLayerFilter SceneQueryBroadPhaseLayerFilter;
+	const FSceneQueryObjectLayerFilter SceneQueryObjectLayerFilter;
+	const FNonSensorBodyFilter NonSensorBodyFilter(Sensors);
+
+	// Runs a single scene query against the world as it is
+	auto RunSceneQuery = [&WorldQuery, &WorldBodyLockInterface,
+		&SceneQueryBroadPhaseLayerFilter, &SceneQueryObjectLayerFilter,
+		&NonSensorBodyFilter](FSceneQuery& SceneQuery)
+	{
+		if (SceneQuery.QueryType == ESceneQueryType::Ray)
+		{
+			const RRayCast Ray(SceneQuery.Origin, SceneQuery.Direction);
+
+			RayCastResult RayHit;
+			if (!WorldQuery.CastRay(Ray, RayHit,
+				SceneQueryBroadPhaseLayerFilter, SceneQueryObjectLayerFilter,
+				NonSensorBodyFilter))
+			{
+				return;
+			}
+
+			SceneQuery.HitBodyId = RayHit.mBodyID;
+			SceneQuery.HitFraction = RayHit.mFraction;
+			SceneQuery.HitPoint = Ray.GetPointOnRay(RayHit.mFraction);
+
+			// The ray result has no normal, so it is taken from the body
+			BodyLockRead HitBodyLock(WorldBodyLockInterface, RayHit.mBodyID);
+			if (HitBodyLock.Succeeded())
+			{
+				SceneQuery.HitNormal = HitBodyLock.GetBody().
+					GetWorldSpaceSurfaceNormal(RayHit.mSubShapeID2,
+					SceneQuery.HitPoint);
+			}
+
+			return;
+		}
+
+		const RMat44 QueryTransform = RMat44::sRotationTranslation
+			(SceneQuery.Rotation, SceneQuery.Origin);
+
+		if (SceneQuery.QueryType == ESceneQueryType::Sweep)
+		{
+			const RShapeCast ShapeCast = RShapeCast::sFromWorldTransform
+				(SceneQuery.QueryShape, Vec3::sReplicate(1.f), QueryTransform,
+				SceneQuery.Direction);
+
+			ClosestHitCollisionCollector<CastShapeCollector> SweepCollector;
+			WorldQuery.CastShape(ShapeCast, ShapeCastSettings(),
+				RVec3::sZero(), SweepCollector,
+				SceneQueryBroadPhaseLayerFilter, SceneQueryObjectLayerFilter,
+				NonSensorBodyFilter);
+
+			if (!SweepCollector.HadHit())
+			{
+				return;
+			}
+
+			const ShapeCastResult& SweepHit = SweepCollector.mHit;
+			SceneQuery.HitBodyId = SweepHit.mBodyID2;
+			SceneQuery.HitFraction = SweepHit.mFraction;
+			SceneQuery.HitPoint = RVec3(SweepHit.mContactPointOn2);
+			SceneQuery.HitNormal = -SweepHit.mPenetrationAxis.
+				NormalizedOr(Vec3::sZero());
+
+			return;
+		}
+
+		AllHitCollisionCollector<CollideShapeCollector> OverlapCollector;
+		WorldQuery.CollideShape(SceneQuery.QueryShape, Vec3::sReplicate(1.f),
+			QueryTransform, CollideShapeSettings(), RVec3::sZero(),
+			OverlapCollector, SceneQueryBroadPhaseLayerFilter,
+			SceneQueryObjectLayerFilter, NonSensorBodyFilter);
+
+		// A body may overlap with more than one of its sub shapes
+		for (const CollideShapeResult& Overlap : OverlapCollector.mHits)
+		{
+			SceneQuery.OverlappingBodyIds.AddUnique
+				(Overlap.mBodyID2.GetIndex());
+		}
+	};
+
+	// Split the queries in batches, so hundreds of queries are spread over
+	// the job system threads
+	ParallelForBatches(*job_system, SceneQueries.Num(),
+		MinQueriesPerSceneQueryJob, "SceneQuery", [&SceneQueries,
+		&RunSceneQuery](const int32 FirstQueryIndex,
+		const int32 LastQueryIndex)
+	{
+		for (int32 i = FirstQueryIndex; i < LastQueryIndex; i++)
+		{
+			RunSceneQuery(SceneQueries[i]);
+		}
+	});
+
+	// Append each query result
+	for (const FSceneQuery& SceneQuery : SceneQueries)
+	{
+		if (SceneQuery.QueryType == ESceneQueryType::Overlap)
+		{
+			SceneQueriesResponse += FString::Printf(TEXT("QueryOverlap;%d"),
+				SceneQuery.RequestId);
+			for (const uint32 OverlappingBodyId :
+				SceneQuery.OverlappingBodyIds)
+			{
+				SceneQueriesResponse += FString::Printf(TEXT(";%u"),
+					OverlappingBodyId);
+			}
+			SceneQueriesResponse += "\n";
+			continue;
+		}
+
+		if (SceneQuery.HitBodyId.IsInvalid())
+		{
+			SceneQueriesResponse += FString::Printf(TEXT("QueryHit;%d;"
+				"None\n"), SceneQuery.RequestId);
+			continue;
+		}
+
+		SceneQueriesResponse += FString::Printf(TEXT("QueryHit;%d;%d;%f;%s;"
+			"%f;%f;%f\n"), SceneQuery.RequestId,
+			SceneQuery.HitBodyId.GetIndex(), SceneQuery.HitFraction,
+			*WorldOrigin.ToClientPositionString(SceneQuery.HitPoint),
+			SceneQuery.HitNormal.GetX(),
+			SceneQuery.HitNormal.GetY(), SceneQuery.HitNormal.GetZ());
+	}
+
+	return SceneQueriesResponse;
+}
+
+void FPhysicsServiceImpl::ClearPhysicsSystem()
+{
+	LPES_LOG_INFO(TEXT("Cleaning physics system..."));
+
+	FPhysicsMemoryAccountingScope MemoryAccountingScope(MemoryAccounting);
+
+	// The constraints, characters, vehicles, ragdolls and force fields
+	// reference the physics system, so they go first
+	Constraints.RemoveAllConstraints();
+	ForceFields.RemoveAllForceFields();
+	Characters.RemoveAllCharacters();
+	Vehicles.RemoveAllVehicles();
+	Ragdolls.RemoveAllRagdolls();
+	Sensors.RemoveAllSensors();
+
+	for (auto& bodyId : BodyIdList)
+	{
+		// Remove the sphere from the physics system. Note that the sphere 
+		// itself keeps all of its state and can be re-added at any time.
+		body_interface->RemoveBody(bodyId);
+
+		// Destroy the sphere. After this the sphere ID is no longer valid.
+		body_interface->DestroyBody(bodyId);
+	}
+
+	BodyIdList.clear();
+	BodyIdListSlots.Empty();
+	KinematicBodyIdList.clear();
+	GhostBodyTargets.Empty();
+	KinematicBodyTargets.Empty();
+	LastStepEvents.Empty();
+	bDroppedLastStepEvents = false;
+	ContactEventSubscriptions.Empty();
+	BodyInfoLines.Empty();
+	StateHistory.Release();
+	StaticSceneKey.Empty();
+	StaticSceneContentHash = 0;
+	bIsStaticSceneMissing = false;
+
+	// Discard any event recorded after the last drain
+	TArray<FPhysicsServiceEvent> DiscardedEvents;
+	EventBuffer.DrainEvents(DiscardedEvents);
+
+	// The Jolt types and factory are kept registered, as they are shared with
+	// every other world on the process. Only this world's data is destroyed
+	if (body_activation_listener) delete body_activation_listener;
+	if (contact_listener) delete contact_listener;
+	if (physics_system) delete physics_system;
+
+	body_activation_listener = nullptr;
+	contact_listener = nullptr;
+	physics_system = nullptr;
+	body_interface = nullptr;
+	job_system = nullptr;
+	StepProfiler.Reset();
 
 	bIsInitialized = false;
 
-	LPES_LOG_INFO(TEXT("Physics system was cleared. Exiting process..."));
+	LPES_LOG_INFO(TEXT("Physics system (world: %d) was cleared. Memory: %s"),
+		WorldId, *MemoryAccounting->GetMeasureLine().TrimEnd());
 }
@@ -0,0 +1,530 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/PhysicsServiceRagdolls.h"
+#include "LocalPhysicsEngineSystem/LocalPhysicsEngineSystemLogging.h"
+
+#include <Jolt/Physics/Body/BodyLock.h>
+
+namespace
+{
+	/** The amount of arguments on a ragdoll activation line, with no parts */
+	constexpr int32 RagdollActivationArguments = 17;
+
+	/** The amount of arguments of each part's transform */
+	constexpr int32 RagdollPartTransformArguments = 7;
+}
+
+void FPhysicsServiceRagdolls::Init(PhysicsSystem* InPhysicsSystem,
+	const uint32 InFirstRagdollBodyIndex,
+	FPhysicsRagdollTypeCache* InRagdollTypeCache,
+	const FPhysicsWorldOrigin& InWorldOrigin)
+{
+	RemoveAllRagdolls();
+
+	World = InPhysicsSystem;
+	WorldOrigin = InWorldOrigin;
+	RagdollTypeCache = InRagdollTypeCache;
+	NextRagdollBodyIndex = InFirstRagdollBodyIndex;
+	EndRagdollBodyIndex = InFirstRagdollBodyIndex + MaxRagdollBodies;
+}
+
+void FPhysicsServiceRagdolls::ActivateRagdolls
+	(const TArray<FString>& RagdollActivationLines)
+{
+	for (const FString& RagdollActivationLine : RagdollActivationLines)
+	{
+		TArray<FString> RagdollActivation;
+		RagdollActivationLine.ParseIntoArray(RagdollActivation, TEXT(";"));
+
+		if (RagdollActivation.Num() < RagdollActivationArguments ||
+			RagdollActivation[0] != "Ragdoll")
+		{
+			LPES_LOG_WARNING(TEXT("Could not parse ragdoll activation \"%s\"."),
+				*RagdollActivationLine);
+			continue;
+		}
+
+		const int32 InstanceId = FCString::Atoi(*RagdollActivation[1]);
+		FPhysicsRagdollPool* RagdollPool = GetOrCreateRagdollPool
+			(RagdollActivation[2].TrimStartAndEnd());
+		if (!RagdollPool)
+		{
+			continue;
+		}
+
+		// The client keeps the instance id, so it is not released, but
+		// activated again
+		if (FPhysicsRagdoll** ActiveRagdoll = ActiveRagdolls.Find(InstanceId))
+		{
+			ReleaseRagdoll(**ActiveRagdoll);
+		}
+		ReleasedInstanceIds.Remove(InstanceId);
+
+		FPhysicsRagdoll& RagdollToActivate = TakeRagdollFromPool(*RagdollPool);
+		const RagdollSettings& Settings = *RagdollPool->Settings;
+		const int32 NumberOfParts = RagdollToActivate.PartBodyIds.Num();
+
+		const RVec3 RootPosition = WorldOrigin.ParseLocalPosition
+			(RagdollActivation, 3);
+		const Quat RootRotation = Quat(FCString::Atof(*RagdollActivation[6]),
+			FCString::Atof(*RagdollActivation[7]),
+			FCString::Atof(*RagdollActivation[8]),
+			FCString::Atof(*RagdollActivation[9])).Normalized();
+		const Vec3 LinearVelocity(FCString::Atof(*RagdollActivation[10]),
+			FCString::Atof(*RagdollActivation[11]),
+			FCString::Atof(*RagdollActivation[12]));
+		const Vec3 AngularVelocity(FCString::Atof(*RagdollActivation[13]),
+			FCString::Atof(*RagdollActivation[14]),
+			FCString::Atof(*RagdollActivation[15]));
+
+		const RMat44 RootTransform = RMat44::sRotationTranslation(RootRotation,
+			RootPosition);
+		const Mat44 InverseRootBindTransform = Mat44::sRotationTranslation
+			(Settings.mParts[0].mRotation, Vec3(Settings.mParts[0].mPosition))
+			.InversedRotationTranslation();
+		const bool bHasPartTransforms = RagdollActivation.Num() >=
+			RagdollActivationArguments + NumberOfParts *
+			RagdollPartTransformArguments;
+
+		// Pose the parts while they are off the world, so they are inserted
+		// on the broadphase where they should be
+		const BodyLockInterface& WorldBodyLockInterface =
+			World->GetBodyLockInterface();
+		for (int32 PartIndex = 0; PartIndex < NumberOfParts; PartIndex++)
+		{
+			Mat44 PartRelativeTransform;
+			if (bHasPartTransforms)
+			{
+				const int32 FirstArgument = RagdollActivationArguments +
+					PartIndex * RagdollPartTransformArguments;
+				PartRelativeTransform = Mat44::sRotationTranslation(Quat
+					(FCString::Atof(*RagdollActivation[FirstArgument + 3]),
+					FCString::Atof(*RagdollActivation[FirstArgument + 4]),
+					FCString::Atof(*RagdollActivation[FirstArgument + 5]),
+					FCString::Atof(*RagdollActivation[FirstArgument + 6]))
+					.Normalized(), Vec3(FCString::Atof
+					(*RagdollActivation[FirstArgument]), FCString::Atof
+					(*RagdollActivation[FirstArgument + 1]), FCString::Atof
+					(*RagdollActivation[FirstArgument + 2])));
+			}
+			else
+			{
+				const RagdollSettings::Part& Part = Settings.mParts[PartIndex];
+				PartRelativeTransform = InverseRootBindTransform *
+					Mat44::sRotationTranslation(Part.mRotation,
+					Vec3(Part.mPosition));
+			}
+
+			const RMat44 PartTransform = RootTransform * PartRelativeTransform;
+			const Vec3 PartOffset(PartTransform.GetTranslation() -
+				RootPosition);
+
+			BodyLockWrite PartLock(WorldBodyLockInterface,
+				RagdollToActivate.PartBodyIds[PartIndex]);
+			if (PartLock.Succeeded())
+			{
+				Body& PartBody = PartLock.GetBody();
+				PartBody.SetPositionAndRotationInternal
+					(PartTransform.GetTranslation(),
+					PartTransform.GetQuaternion().Normalized());
+				PartBody.SetLinearVelocityClamped(LinearVelocity +
+					AngularVelocity.Cross(PartOffset));
+				PartBody.SetAngularVelocityClamped(AngularVelocity);
+			}
+		}
+
+		// Reset the constraints' impulses from the ragdoll's last activation
+		RagdollPool->InitialConstraintsState->Rewind();
+
+		TArray<Constraint*> ConstraintsToAdd;
+		ConstraintsToAdd.Reserve(RagdollToActivate.Constraints.Num());
+		for (const Ref<TwoBodyConstraint>& RagdollConstraint :
+			RagdollToActivate.Constraints)
+		{
+			RagdollConstraint->RestoreState
+				(*RagdollPool->InitialConstraintsState);
+			ConstraintsToAdd.Add(RagdollConstraint.GetPtr());
+		}
+
+		// Add every part at once. The ids are copied, as they are sorted
+		TArray<BodyID> PartBodyIdsToAdd = RagdollToActivate.PartBodyIds;
+
+		BodyInterface& WorldBodyInterface = World->GetBodyInterface();
+		const BodyInterface::AddState PartsAddState =
+			WorldBodyInterface.AddBodiesPrepare(PartBodyIdsToAdd.GetData(),
+			PartBodyIdsToAdd.Num());
+		WorldBodyInterface.AddBodiesFinalize(PartBodyIdsToAdd.GetData(),
+			PartBodyIdsToAdd.Num(), PartsAddState, EActivation::Activate);
+
+		World->AddConstraints(ConstraintsToAdd.GetData(),
+			ConstraintsToAdd.Num());
+
+		RagdollToActivate.InstanceId = InstanceId;
+		RagdollToActivate.RemainingLifetime = FCString::Atof
+			(*RagdollActivation[16]);
+		ActiveRagdolls.Add(InstanceId, &RagdollToActivate);
+	}
+}
+
+void FPhysicsServiceRagdolls::UpdateRagdolls(const float DeltaTime)
+{
+	if (ActiveRagdolls.Num() == 0)
+	{
+		return;
+	}
+
+	// The parts sleep together, as they are on the same island, so the root
+	// part tells if the whole ragdoll is asleep
+	const BodyInterface& WorldBodyInterface = World->GetBodyInterface();
+
+	TArray<FPhysicsRagdoll*> RagdollsToRelease;
+	for (const auto& ActiveRagdollPair : ActiveRagdolls)
+	{
+		FPhysicsRagdoll& ActiveRagdoll = *ActiveRagdollPair.Value;
+		ActiveRagdoll.RemainingLifetime -= DeltaTime;
+
+		if (ActiveRagdoll.RemainingLifetime <= 0.f ||
+			!WorldBodyInterface.IsActive(ActiveRagdoll.PartBodyIds[0]))
+		{
+			RagdollsToRelease.Add(&ActiveRagdoll);
+		}
+	}
+
+	for (FPhysicsRagdoll* RagdollToRelease : RagdollsToRelease)
+	{
+		ReleaseRagdoll(*RagdollToRelease);
+	}
+}
+
+FString FPhysicsServiceRagdolls::ConsumeRagdollsStateResponse()
+{
+	FString RagdollsStateResponse = FString();
+
+	// The released ragdolls go first, so a ragdoll released and activated
+	// again ends active
+	for (const int32 ReleasedInstanceId : ReleasedInstanceIds)
+	{
+		RagdollsStateResponse += FString::Printf(TEXT("RagdollReleased;%d\n"),
+			ReleasedInstanceId);
+	}
+	ReleasedInstanceIds.Reset();
+
+	if (!World)
+	{
+		return RagdollsStateResponse;
+	}
+
+	const BodyInterface& WorldBodyInterface = World->GetBodyInterface();
+	for (const auto& ActiveRagdollPair : ActiveRagdolls)
+	{
+		const TArray<BodyID>& PartBodyIds = ActiveRagdollPair.Value->
+			PartBodyIds;
+
+		RVec3 RootPosition;
+		Quat RootRotation;
+		WorldBodyInterface.GetPositionAndRotation(PartBodyIds[0],
+			RootPosition, RootRotation);
+
+		FString RagdollStateLine = FString::Printf(TEXT("RagdollState;%d;%s;"
+			"%f;%f;%f;%f"), ActiveRagdollPair.Key,
+			*WorldOrigin.ToClientPositionString(RootPosition),
+			RootRotation.GetX(),
+			RootRotation.GetY(), RootRotation.GetZ(), RootRotation.GetW());
+
+		const RMat44 InverseRootTransform = RMat44::sRotationTranslation
+			(RootRotation, RootPosition).InversedRotationTranslation();
+		for (int32 PartIndex = 1; PartIndex < PartBodyIds.Num(); PartIndex++)
+		{
+			RVec3 PartPosition;
+			Quat PartRotation;
+			WorldBodyInterface.GetPositionAndRotation(PartBodyIds[PartIndex],
+				PartPosition, PartRotation);
+
+			const Vec3 RelativePosition(InverseRootTransform * PartPosition);
+			const Quat RelativeRotation = RootRotation.Conjugated() *
+				PartRotation;
+
+			RagdollStateLine += FString::Printf(TEXT(";%.1f;%.1f;%.1f;%.4f;"
+				"%.4f;%.4f;%.4f"), RelativePosition.GetX(),
+				RelativePosition.GetY(), RelativePosition.GetZ(),
+				RelativeRotation.GetX(), RelativeRotation.GetY(),
+				RelativeRotation.GetZ(), RelativeRotation.GetW());
+		}
+
+		RagdollsStateResponse += RagdollStateLine + "\n";
+	}
+
+	return RagdollsStateResponse;
+}
+
+void FPhysicsServiceRagdolls::RemoveAllRagdolls()
+{
+	TArray<FPhysicsRagdoll*> RagdollsToRelease;
+	ActiveRagdolls.GenerateValueArray(RagdollsToRelease);
+
+	for (FPhysicsRagdoll* RagdollToRelease : RagdollsToRelease)
+	{
+		ReleaseRagdoll(*RagdollToRelease);
+	}
+
+	// Every ragdoll is off the world now, so the bodies can be destroyed
+	for (auto& RagdollPoolPair : RagdollPools)
+	{
+		DestroyRagdollPool(RagdollPoolPair.Value);
+	}
+
+	RagdollPools.Empty();
+	ActiveRagdolls.Empty();
+	ReleasedInstanceIds.Empty();
+	NextRagdollBodyIndex = EndRagdollBodyIndex - MaxRagdollBodies;
+}
+
+void FPhysicsServiceRagdolls::RemoveActiveRagdollsFromWorld()
+{
+	RemovedPartVelocities.Reset();
+
+	if (ActiveRagdolls.Num() == 0)
+	{
+		return;
+	}
+
+	BodyInterface& WorldBodyInterface = World->GetBodyInterface();
+
+	TArray<Constraint*> ConstraintsToRemove;
+	TArray<BodyID> PartBodyIdsToRemove;
+	for (const auto& ActiveRagdollPair : ActiveRagdolls)
+	{
+		const FPhysicsRagdoll& ActiveRagdoll = *ActiveRagdollPair.Value;
+		for (const Ref<TwoBodyConstraint>& RagdollConstraint :
+			ActiveRagdoll.Constraints)
+		{
+			ConstraintsToRemove.Add(RagdollConstraint.GetPtr());
+		}
+
+		// The removal clears the velocities, so they are kept to be set back
+		for (const BodyID& PartBodyId : ActiveRagdoll.PartBodyIds)
+		{
+			PartBodyIdsToRemove.Add(PartBodyId);
+			RemovedPartVelocities.Add(WorldBodyInterface.GetLinearVelocity
+				(PartBodyId));
+			RemovedPartVelocities.Add(WorldBodyInterface.GetAngularVelocity
+				(PartBodyId));
+		}
+	}
+
+	World->RemoveConstraints(ConstraintsToRemove.GetData(),
+		ConstraintsToRemove.Num());
+	WorldBodyInterface.RemoveBodies(PartBodyIdsToRemove.GetData(),
+		PartBodyIdsToRemove.Num());
+}
+
+void FPhysicsServiceRagdolls::AddActiveRagdollsBackToWorld()
+{
+	if (ActiveRagdolls.Num() == 0)
+	{
+		return;
+	}
+
+	BodyInterface& WorldBodyInterface = World->GetBodyInterface();
+
+	TArray<Constraint*> ConstraintsToAdd;
+	TArray<BodyID> PartBodyIdsToAdd;
+	for (const auto& ActiveRagdollPair : ActiveRagdolls)
+	{
+		const FPhysicsRagdoll& ActiveRagdoll = *ActiveRagdollPair.Value;
+		for (const Ref<TwoBodyConstraint>& RagdollConstraint :
+			ActiveRagdoll.Constraints)
+		{
+			ConstraintsToAdd.Add(RagdollConstraint.GetPtr());
+		}
+
+		PartBodyIdsToAdd.Append(ActiveRagdoll.PartBodyIds);
+	}
+
+	// The active ragdolls are never asleep between steps, as the ones that
+	// fell asleep are released after each step
+	TArray<BodyID> SortedPartBodyIdsToAdd = PartBodyIdsToAdd;
+	const BodyInterface::AddState PartsAddState =
+		WorldBodyInterface.AddBodiesPrepare(SortedPartBodyIdsToAdd.GetData(),
+		SortedPartBodyIdsToAdd.Num());
+	WorldBodyInterface.AddBodiesFinalize(SortedPartBodyIdsToAdd.GetData(),
+		SortedPartBodyIdsToAdd.Num(), PartsAddState, EActivation::Activate);
+
+	for (int32 PartIndex = 0; PartIndex < PartBodyIdsToAdd.Num() &&
+		2 * PartIndex + 1 < RemovedPartVelocities.Num(); PartIndex++)
+	{
+		WorldBodyInterface.SetLinearAndAngularVelocity
+			(PartBodyIdsToAdd[PartIndex], RemovedPartVelocities[2 * PartIndex],
+			RemovedPartVelocities[2 * PartIndex + 1]);
+	}
+
+	World->AddConstraints(ConstraintsToAdd.GetData(),
+		ConstraintsToAdd.Num());
+
+	RemovedPartVelocities.Reset();
+}
+
+FPhysicsServiceRagdolls::FPhysicsRagdollPool*
+	FPhysicsServiceRagdolls::GetOrCreateRagdollPool(const FString& TypeName)
+{
+	if (FPhysicsRagdollPool* RagdollPool = RagdollPools.Find(TypeName))
+	{
+		return RagdollPool;
+	}
+
+	FPhysicsRagdollType RagdollType;
+	if (!World || !RagdollTypeCache ||
+		!RagdollTypeCache->FindRagdollType(TypeName, RagdollType))
+	{
+		LPES_LOG_ERROR(TEXT("Could not activate ragdoll: type \"%s\" is not "
+			"registered."), *TypeName);
+		return nullptr;
+	}
+
+	const RagdollSettings& Settings = *RagdollType.Settings;
+	const uint32 NumberOfParts = static_cast<uint32>(Settings.mParts.size());
+	const uint32 NumberOfPoolBodies = NumberOfParts * RagdollType.PoolSize;
+	if (NextRagdollBodyIndex + NumberOfPoolBodies > EndRagdollBodyIndex)
+	{
+		LPES_LOG_ERROR(TEXT("Could not create ragdoll pool \"%s\": its %u "
+			"parts are over the max of %u ragdoll bodies."), *TypeName,
+			NumberOfPoolBodies, MaxRagdollBodies);
+		return nullptr;
+	}
+
+	// The parts are created with the ids after the last pool's, instead of
+	// Jolt's free ids, as those belong to the client
+	BodyInterface& WorldBodyInterface = World->GetBodyInterface();
+
+	FPhysicsRagdollPool& NewRagdollPool = RagdollPools.Add(TypeName);
+	NewRagdollPool.Settings = RagdollType.Settings;
+	NewRagdollPool.Ragdolls.SetNum(RagdollType.PoolSize);
+
+	// The pool's ids are given back if any of its parts can't be created
+	const uint32 FirstPoolBodyIndex = NextRagdollBodyIndex;
+
+	for (FPhysicsRagdoll& PooledRagdoll : NewRagdollPool.Ragdolls)
+	{
+		// Each ragdoll has its own collision group, so its parts only skip
+		// the collisions with their parents
+		const CollisionGroup::GroupID RagdollGroupId = NextRagdollBodyIndex;
+
+		TArray<Body*> PartBodies;
+		for (uint32 PartIndex = 0; PartIndex < NumberOfParts; PartIndex++)
+		{
+			const RagdollSettings::Part& Part = Settings.mParts[PartIndex];
+
+			Body* PartBody = WorldBodyInterface.CreateBodyWithID
+				(BodyID(NextRagdollBodyIndex++), Part);
+			if (!PartBody)
+			{
+				LPES_LOG_ERROR(TEXT("Could not create ragdoll pool \"%s\" "
+					"part with index %u."), *TypeName,
+					NextRagdollBodyIndex - 1);
+
+				DestroyRagdollPool(NewRagdollPool);
+				RagdollPools.Remove(TypeName);
+				NextRagdollBodyIndex = FirstPoolBodyIndex;
+				return nullptr;
+			}
+
+			PartBody->GetCollisionGroup().SetGroupID(RagdollGroupId);
+			PartBodies.Add(PartBody);
+			PooledRagdoll.PartBodyIds.Add(PartBody->GetID());
+
+			// The parts are on the bind pose, as the joints are
+			if (Part.mToParent != nullptr)
+			{
+				const int32 ParentPartIndex = Settings.GetSkeleton()->
+					GetJoint(PartIndex).mParentJointIndex;
+				PooledRagdoll.Constraints.Add(Part.mToParent->Create
+					(*PartBodies[ParentPartIndex], *PartBody));
+			}
+		}
+	}
+
+	// Every pooled ragdoll has the same constraints, so a single state
+	// resets any of them
+	NewRagdollPool.InitialConstraintsState = MakeUnique<StateRecorderImpl>();
+	for (const Ref<TwoBodyConstraint>& RagdollConstraint :
+		NewRagdollPool.Ragdolls[0].Constraints)
+	{
+		RagdollConstraint->SaveState(*NewRagdollPool.InitialConstraintsState);
+	}
+
+	LPES_LOG_INFO(TEXT("Ragdoll pool \"%s\" created (ragdolls: %d; bodies: "
+		"%u)."), *TypeName, RagdollType.PoolSize, NumberOfPoolBodies);
+
+	return &NewRagdollPool;
+}
+
+FPhysicsServiceRagdolls::FPhysicsRagdoll&
+	FPhysicsServiceRagdolls::TakeRagdollFromPool
+	(FPhysicsRagdollPool& RagdollPool)
+{
+	FPhysicsRagdoll* RagdollToTake = nullptr;
+	for (FPhysicsRagdoll& PooledRagdoll : RagdollPool.Ragdolls)
+	{
+		if (PooledRagdoll.InstanceId == INDEX_NONE)
+		{
+			return PooledRagdoll;
+		}
+
+		if (!RagdollToTake || PooledRagdoll.RemainingLifetime <
+			RagdollToTake->RemainingLifetime)
+		{
+			RagdollToTake = &PooledRagdoll;
+		}
+	}
+
+	LPES_LOG_WARNING(TEXT("Ragdoll pool is full. Releasing ragdoll %d."),
+		RagdollToTake->InstanceId);
+
+	ReleaseRagdoll(*RagdollToTake);
+
+	return *RagdollToTake;
+}
+
+void FPhysicsServiceRagdolls::ReleaseRagdoll(FPhysicsRagdoll& RagdollToRelease)
+{
+	if (RagdollToRelease.InstanceId == INDEX_NONE)
+	{
+		return;
+	}
+
+	// The constraints go first, as they reference the parts
+	TArray<Constraint*> ConstraintsToRemove;
+	ConstraintsToRemove.Reserve(RagdollToRelease.Constraints.Num());
+	for (const Ref<TwoBodyConstraint>& RagdollConstraint :
+		RagdollToRelease.Constraints)
+	{
+		ConstraintsToRemove.Add(RagdollConstraint.GetPtr());
+	}
+
+	World->RemoveConstraints(ConstraintsToRemove.GetData(),
+		ConstraintsToRemove.Num());
+
+	TArray<BodyID> PartBodyIdsToRemove = RagdollToRelease.PartBodyIds;
+	World->GetBodyInterface().RemoveBodies(PartBodyIdsToRemove.GetData(),
+		PartBodyIdsToRemove.Num());
+
+	ActiveRagdolls.Remove(RagdollToRelease.InstanceId);
+	ReleasedInstanceIds.Add(RagdollToRelease.InstanceId);
+
+	RagdollToRelease.InstanceId = INDEX_NONE;
+	RagdollToRelease.RemainingLifetime = 0.f;
+}
+
+void FPhysicsServiceRagdolls::DestroyRagdollPool
+	(FPhysicsRagdollPool& RagdollPool)
+{
+	BodyInterface& WorldBodyInterface = World->GetBodyInterface();
+
+	for (FPhysicsRagdoll& PooledRagdoll : RagdollPool.Ragdolls)
+	{
+		PooledRagdoll.Constraints.Empty();
+		WorldBodyInterface.DestroyBodies(PooledRagdoll.PartBodyIds.GetData(),
+			PooledRagdoll.PartBodyIds.Num());
+		PooledRagdoll.PartBodyIds.Empty();
+	}
+}
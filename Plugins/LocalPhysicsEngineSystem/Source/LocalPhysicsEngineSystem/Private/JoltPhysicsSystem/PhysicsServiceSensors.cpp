@@ -0,0 +1,262 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/PhysicsServiceSensors.h"
+#include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/ObjectLayerPairFilterImpl.h"
+
+#include <Jolt/Physics/Collision/CollideShape.h>
+#include <Jolt/Physics/Collision/CollisionCollectorImpl.h>
+
+void FPhysicsServiceSensors::AddSensor(const BodyID SensorBodyId)
+{
+	SensorBodyIndices.Add(SensorBodyId.GetIndex());
+}
+
+void FPhysicsServiceSensors::RemoveBody(const BodyID RemovedBodyId)
+{
+	const uint32 RemovedBodyIndex = RemovedBodyId.GetIndex();
+	const bool bWasSensor = SensorBodyIndices.Remove(RemovedBodyIndex) > 0;
+
+	if (OverlapContactCounts.Num() == 0 && ChangedOverlaps.Num() == 0)
+	{
+		return;
+	}
+
+	// A removed body exits every sensor it was inside, so gameplay doesn't
+	// keep it inside them
+	if (!bWasSensor)
+	{
+		for (auto It = OverlapContactCounts.CreateIterator(); It; ++It)
+		{
+			if (static_cast<uint32>(It.Key()) == RemovedBodyIndex)
+			{
+				RecordOverlapChange(It.Key(), false);
+				It.RemoveCurrent();
+			}
+		}
+
+		return;
+	}
+
+	// A removed sensor forgets its overlaps, as the client removed it
+	auto IsOverlapOfRemovedSensor = [RemovedBodyIndex]
+		(const uint64 OverlapKey)
+		{ return static_cast<uint32>(OverlapKey >> 32) == RemovedBodyIndex; };
+
+	for (auto It = OverlapContactCounts.CreateIterator(); It; ++It)
+	{
+		if (IsOverlapOfRemovedSensor(It.Key()))
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	for (auto It = ChangedOverlaps.CreateIterator(); It; ++It)
+	{
+		if (IsOverlapOfRemovedSensor(It.Key()))
+		{
+			It.RemoveCurrent();
+		}
+	}
+}
+
+void FPhysicsServiceSensors::UpdateOverlaps
+	(const TArray<FPhysicsServiceEvent>& StepEvents)
+{
+	if (SensorBodyIndices.Num() == 0)
+	{
+		return;
+	}
+
+	// Sum the contacts added and removed on each overlap first, as the
+	// events of a single fixed step are not ordered
+	TMap<uint64, int32> ContactCountDeltas;
+	for (const FPhysicsServiceEvent& StepEvent : StepEvents)
+	{
+		if (StepEvent.EventType != EPhysicsServiceEventType::ContactAdded &&
+			StepEvent.EventType != EPhysicsServiceEventType::ContactRemoved)
+		{
+			continue;
+		}
+
+		const uint32 BodyIndex1 = StepEvent.Body1.GetIndex();
+		const uint32 BodyIndex2 = StepEvent.Body2.GetIndex();
+
+		uint64 OverlapKey = 0;
+		if (SensorBodyIndices.Contains(BodyIndex1))
+		{
+			OverlapKey = GetOverlapKey(BodyIndex1, BodyIndex2);
+		}
+		else if (SensorBodyIndices.Contains(BodyIndex2))
+		{
+			OverlapKey = GetOverlapKey(BodyIndex2, BodyIndex1);
+		}
+		else
+		{
+			continue;
+		}
+
+		ContactCountDeltas.FindOrAdd(OverlapKey) += StepEvent.EventType ==
+			EPhysicsServiceEventType::ContactAdded ? 1 : -1;
+	}
+
+	// A body is inside a sensor while it has any contact with it. The counts
+	// never go below zero, as the contacts from before a snapshot restore
+	// may be removed without being added
+	for (const auto& ContactCountDelta : ContactCountDeltas)
+	{
+		const int32 PreviousContactCount =
+			OverlapContactCounts.FindRef(ContactCountDelta.Key);
+		const int32 NewContactCount = FMath::Max(PreviousContactCount +
+			ContactCountDelta.Value, 0);
+
+		if (NewContactCount > 0)
+		{
+			OverlapContactCounts.Add(ContactCountDelta.Key, NewContactCount);
+		}
+		else
+		{
+			OverlapContactCounts.Remove(ContactCountDelta.Key);
+		}
+
+		if ((PreviousContactCount > 0) != (NewContactCount > 0))
+		{
+			RecordOverlapChange(ContactCountDelta.Key, NewContactCount > 0);
+		}
+	}
+}
+
+void FPhysicsServiceSensors::RebuildOverlaps
+	(const PhysicsSystem& WorldPhysicsSystem)
+{
+	if (SensorBodyIndices.Num() == 0)
+	{
+		return;
+	}
+
+	// Collide each sensor's shape with the bodies its layer detects. As on
+	// the contacts, each touching sub shape is counted
+	const BodyInterface& WorldBodyInterface =
+		WorldPhysicsSystem.GetBodyInterface();
+	const DefaultBroadPhaseLayerFilter SensorBroadPhaseLayerFilter =
+		WorldPhysicsSystem.GetDefaultBroadPhaseLayerFilter(Layers::SENSOR);
+	const DefaultObjectLayerFilter SensorObjectLayerFilter =
+		WorldPhysicsSystem.GetDefaultLayerFilter(Layers::SENSOR);
+
+	TMap<uint64, int32> RebuiltContactCounts;
+	for (const uint32 SensorIndex : SensorBodyIndices)
+	{
+		const BodyID SensorBodyId(SensorIndex);
+
+		AllHitCollisionCollector<CollideShapeCollector> SensorCollector;
+		WorldPhysicsSystem.GetNarrowPhaseQuery().CollideShape
+			(WorldBodyInterface.GetShape(SensorBodyId), Vec3::sReplicate(1.f),
+			WorldBodyInterface.GetCenterOfMassTransform(SensorBodyId),
+			CollideShapeSettings(), RVec3::sZero(), SensorCollector,
+			SensorBroadPhaseLayerFilter, SensorObjectLayerFilter);
+
+		for (const CollideShapeResult& SensorHit : SensorCollector.mHits)
+		{
+			RebuiltContactCounts.FindOrAdd(GetOverlapKey(SensorIndex,
+				SensorHit.mBodyID2.GetIndex()))++;
+		}
+	}
+
+	// Compare the bodies inside the sensors with the ones before the steps
+	for (const auto& OverlapContactCount : OverlapContactCounts)
+	{
+		if (!RebuiltContactCounts.Contains(OverlapContactCount.Key))
+		{
+			RecordOverlapChange(OverlapContactCount.Key, false);
+		}
+	}
+
+	for (const auto& RebuiltContactCount : RebuiltContactCounts)
+	{
+		if (!OverlapContactCounts.Contains(RebuiltContactCount.Key))
+		{
+			RecordOverlapChange(RebuiltContactCount.Key, true);
+		}
+	}
+
+	OverlapContactCounts = MoveTemp(RebuiltContactCounts);
+}
+
+FString FPhysicsServiceSensors::ConsumeSensorEventsResponse()
+{
+	if (ChangedOverlaps.Num() == 0)
+	{
+		return FString();
+	}
+
+	// Group the changes by sensor, sorted by sensor and body
+	ChangedOverlaps.KeySort([](const uint64 KeyA, const uint64 KeyB)
+		{ return KeyA < KeyB; });
+
+	FString SensorEventsResponse = FString();
+	TArray<uint32> EnteredBodyIndices;
+	TArray<uint32> ExitedBodyIndices;
+
+	auto AppendSensorEvents = [&](const uint32 SensorIndex)
+	{
+		SensorEventsResponse += FString::Printf(TEXT("Sensor;%u;%d;%d"),
+			SensorIndex, EnteredBodyIndices.Num(), ExitedBodyIndices.Num());
+		for (const uint32 EnteredBodyIndex : EnteredBodyIndices)
+		{
+			SensorEventsResponse += FString::Printf(TEXT(";%u"),
+				EnteredBodyIndex);
+		}
+		for (const uint32 ExitedBodyIndex : ExitedBodyIndices)
+		{
+			SensorEventsResponse += FString::Printf(TEXT(";%u"),
+				ExitedBodyIndex);
+		}
+		SensorEventsResponse += "\n";
+
+		EnteredBodyIndices.Reset();
+		ExitedBodyIndices.Reset();
+	};
+
+	uint32 CurrentSensorIndex = static_cast<uint32>
+		(ChangedOverlaps.CreateConstIterator().Key() >> 32);
+	for (const auto& ChangedOverlap : ChangedOverlaps)
+	{
+		const uint32 SensorIndex = static_cast<uint32>(ChangedOverlap.Key >>
+			32);
+		if (SensorIndex != CurrentSensorIndex)
+		{
+			AppendSensorEvents(CurrentSensorIndex);
+			CurrentSensorIndex = SensorIndex;
+		}
+
+		(ChangedOverlap.Value ? EnteredBodyIndices : ExitedBodyIndices).Add
+			(static_cast<uint32>(ChangedOverlap.Key));
+	}
+	AppendSensorEvents(CurrentSensorIndex);
+
+	ChangedOverlaps.Reset();
+
+	return SensorEventsResponse;
+}
+
+void FPhysicsServiceSensors::RecordOverlapChange(const uint64 OverlapKey,
+	const bool bEntered)
+{
+	// An overlap that changes back before its events are sent cancels out,
+	// as the body was never seen entering or exiting
+	if (ChangedOverlaps.Remove(OverlapKey) == 0)
+	{
+		ChangedOverlaps.Add(OverlapKey, bEntered);
+	}
+}
+
+void FPhysicsServiceSensors::ResetOverlaps()
+{
+	OverlapContactCounts.Empty();
+	ChangedOverlaps.Empty();
+}
+
+void FPhysicsServiceSensors::RemoveAllSensors()
+{
+	SensorBodyIndices.Empty();
+	ResetOverlaps();
+}
@@ -0,0 +1,307 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/PhysicsServiceVehicles.h"
+#include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/ObjectLayerPairFilterImpl.h"
+#include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/PhysicsServiceConstraints.h"
+#include "LocalPhysicsEngineSystem/LocalPhysicsEngineSystemLogging.h"
+
+#include <Jolt/Physics/Vehicle/WheeledVehicleController.h>
+
+namespace
+{
+	/**
+	* Scales the Jolt's torque and inertia defaults (kg m^2 / s^2 and kg m^2)
+	* to the world's units (kg cm^2 / s^2 and kg cm^2)
+	*/
+	constexpr float SquaredCentimetersPerSquaredMeter = 10000.f;
+
+	/** The wheels' mass, used for their inertia (kg) */
+	constexpr float WheelMass = 20.f;
+
+	/** The max brake and hand brake torques (N m) */
+	constexpr float WheelMaxBrakeTorque = 1500.f;
+	constexpr float WheelMaxHandBrakeTorque = 4000.f;
+
+	/** The anti roll bars' stiffness (N m / rad) */
+	constexpr float AntiRollBarStiffness = 1000.f;
+
+	/** How much the vehicles can pitch or roll, so they don't flip over */
+	constexpr float VehicleMaxPitchRollAngleDegrees = 60.f;
+}
+
+void FPhysicsServiceVehicles::Init(PhysicsSystem* InPhysicsSystem)
+{
+	RemoveAllVehicles();
+
+	World = InPhysicsSystem;
+
+	// The wheels are cast against every layer the moving bodies collide with
+	WheelCollisionTester = new VehicleCollisionTesterRay(Layers::MOVING,
+		Vec3::sAxisZ());
+}
+
+bool FPhysicsServiceVehicles::AddVehicle(Body& ChassisBody,
+	const FPhysicsVehicleSetup& VehicleSetup, const bool bIsEnabled)
+{
+	if (!World)
+	{
+		return false;
+	}
+
+	const uint32 ChassisBodyIndex = ChassisBody.GetID().GetIndex();
+	RemoveVehicle(ChassisBody.GetID());
+
+	const Vec3 HalfExtent = VehicleSetup.ChassisHalfExtent;
+	const float WheelRadius = VehicleSetup.WheelRadius;
+
+	// The wheels are on the chassis' corners, under it. The axles are kept
+	// inside the chassis, even if it is too short for the wheels
+	const float AxleX = FMath::Max(HalfExtent.GetX() - 2.f * WheelRadius,
+		0.5f * HalfExtent.GetX());
+	const float WheelZ = -0.9f * HalfExtent.GetZ();
+	const Vec3 WheelPositions[] =
+	{
+		Vec3(AxleX, -HalfExtent.GetY(), WheelZ),
+		Vec3(AxleX, HalfExtent.GetY(), WheelZ),
+		Vec3(-AxleX, -HalfExtent.GetY(), WheelZ),
+		Vec3(-AxleX, HalfExtent.GetY(), WheelZ)
+	};
+
+	// The vehicle is on Unreal's axes: x-axis forward and z-axis up
+	VehicleConstraintSettings VehicleSettings;
+	VehicleSettings.mUp = Vec3::sAxisZ();
+	VehicleSettings.mForward = Vec3::sAxisX();
+	VehicleSettings.mMaxPitchRollAngle = DegreesToRadians
+		(VehicleMaxPitchRollAngleDegrees);
+
+	const int32 NumberOfWheels = UE_ARRAY_COUNT(WheelPositions);
+	for (int32 WheelIndex = 0; WheelIndex < NumberOfWheels; WheelIndex++)
+	{
+		const bool bIsFrontWheel = WheelIndex < 2;
+
+		WheelSettingsWV* Wheel = new WheelSettingsWV();
+		Wheel->mPosition = WheelPositions[WheelIndex];
+		Wheel->mSuspensionDirection = -Vec3::sAxisZ();
+		Wheel->mSteeringAxis = Vec3::sAxisZ();
+		Wheel->mWheelUp = Vec3::sAxisZ();
+		Wheel->mWheelForward = Vec3::sAxisX();
+		Wheel->mSuspensionMinLength = 0.6f * VehicleSetup.SuspensionLength;
+		Wheel->mSuspensionMaxLength = VehicleSetup.SuspensionLength;
+		Wheel->mRadius = WheelRadius;
+		Wheel->mWidth = VehicleSetup.WheelWidth;
+		Wheel->mInertia = 0.5f * WheelMass * WheelRadius * WheelRadius;
+		Wheel->mMaxSteerAngle = bIsFrontWheel ?
+			VehicleSetup.MaxSteerAngle : 0.f;
+		Wheel->mMaxBrakeTorque = WheelMaxBrakeTorque *
+			SquaredCentimetersPerSquaredMeter;
+		Wheel->mMaxHandBrakeTorque = bIsFrontWheel ? 0.f :
+			WheelMaxHandBrakeTorque * SquaredCentimetersPerSquaredMeter;
+
+		VehicleSettings.mWheels.push_back(Wheel);
+	}
+
+	VehicleSettings.mAntiRollBars.resize(2);
+	for (uint32 AxleIndex = 0; AxleIndex < 2; AxleIndex++)
+	{
+		VehicleAntiRollBar& AntiRollBar =
+			VehicleSettings.mAntiRollBars[AxleIndex];
+		AntiRollBar.mLeftWheel = 2 * AxleIndex;
+		AntiRollBar.mRightWheel = 2 * AxleIndex + 1;
+		AntiRollBar.mStiffness = AntiRollBarStiffness *
+			SquaredCentimetersPerSquaredMeter;
+	}
+
+	// The front wheels drive the vehicle. The engine's torque and inertia are
+	// the only drivetrain settings with units
+	WheeledVehicleControllerSettings* ControllerSettings =
+		new WheeledVehicleControllerSettings();
+	ControllerSettings->mEngine.mMaxTorque = VehicleSetup.MaxEngineTorque *
+		SquaredCentimetersPerSquaredMeter;
+	ControllerSettings->mEngine.mInertia *= SquaredCentimetersPerSquaredMeter;
+	ControllerSettings->mTransmission.mClutchStrength *=
+		SquaredCentimetersPerSquaredMeter;
+	ControllerSettings->mDifferentials.resize(1);
+	ControllerSettings->mDifferentials[0].mLeftWheel = 0;
+	ControllerSettings->mDifferentials[0].mRightWheel = 1;
+	VehicleSettings.mController = ControllerSettings;
+
+	FPhysicsVehicle& NewVehicle = Vehicles.Add(ChassisBodyIndex);
+	NewVehicle.Constraint = new VehicleConstraint(ChassisBody,
+		VehicleSettings);
+	NewVehicle.Constraint->SetVehicleCollisionTester(WheelCollisionTester);
+
+	// Tagged, so its place among the world's constraints can be restored
+	NewVehicle.Constraint->SetUserData
+		(FPhysicsServiceConstraints::VehicleConstraintTag | ChassisBodyIndex);
+
+	SetVehicleOnWorld(NewVehicle, bIsEnabled);
+
+	LPES_LOG_INFO(TEXT("Vehicle added on body %u."), ChassisBodyIndex);
+
+	return true;
+}
+
+void FPhysicsServiceVehicles::SetVehicleEnabled(const BodyID& ChassisBodyId,
+	const bool bIsEnabled)
+{
+	if (FPhysicsVehicle* PhysicsVehicle = Vehicles.Find
+		(ChassisBodyId.GetIndex()))
+	{
+		SetVehicleOnWorld(*PhysicsVehicle, bIsEnabled);
+	}
+}
+
+void FPhysicsServiceVehicles::SetVehicleInputs
+	(const TArray<FString>& VehicleInputLines)
+{
+	for (auto& VehiclePair : Vehicles)
+	{
+		VehiclePair.Value.bHasInput = false;
+	}
+
+	for (const FString& VehicleInputLine : VehicleInputLines)
+	{
+		TArray<FString> VehicleInput;
+		VehicleInputLine.ParseIntoArray(VehicleInput, TEXT(";"));
+
+		if (VehicleInput.Num() < 6 || VehicleInput[0] != "Vehicle")
+		{
+			LPES_LOG_WARNING(TEXT("Could not parse vehicle input \"%s\"."),
+				*VehicleInputLine);
+			continue;
+		}
+
+		const uint32 ChassisBodyIndex = static_cast<uint32>(FCString::Atoi
+			(*VehicleInput[1]));
+		FPhysicsVehicle* PhysicsVehicle = Vehicles.Find(ChassisBodyIndex);
+		if (!PhysicsVehicle || !PhysicsVehicle->bIsEnabled)
+		{
+			continue;
+		}
+
+		const float Forward = FMath::Clamp(FCString::Atof(*VehicleInput[2]),
+			-1.f, 1.f);
+		const float Right = FMath::Clamp(FCString::Atof(*VehicleInput[3]),
+			-1.f, 1.f);
+		const float Brake = FMath::Clamp(FCString::Atof(*VehicleInput[4]),
+			0.f, 1.f);
+		const float HandBrake = FMath::Clamp(FCString::Atof
+			(*VehicleInput[5]), 0.f, 1.f);
+
+		// Jolt's right is the cross product of the forward and up axes,
+		// which is Unreal's left, as Unreal's axes are left handed
+		static_cast<WheeledVehicleController*>(PhysicsVehicle->Constraint->
+			GetController())->SetDriverInput(Forward, -Right, Brake,
+			HandBrake);
+		PhysicsVehicle->bHasInput = true;
+
+		// Wake the chassis up, as the input does not wake it by itself
+		if (Forward != 0.f || Right != 0.f || Brake != 0.f || HandBrake != 0.f)
+		{
+			World->GetBodyInterface().ActivateBody(BodyID(ChassisBodyIndex));
+		}
+	}
+
+	for (auto& VehiclePair : Vehicles)
+	{
+		if (!VehiclePair.Value.bHasInput)
+		{
+			static_cast<WheeledVehicleController*>(VehiclePair.Value.
+				Constraint->GetController())->SetDriverInput(0.f, 0.f, 0.f,
+				0.f);
+		}
+	}
+}
+
+FString FPhysicsServiceVehicles::GetVehiclesStateResponse() const
+{
+	FString VehiclesStateResponse = FString();
+
+	for (const auto& VehiclePair : Vehicles)
+	{
+		if (!VehiclePair.Value.bIsEnabled)
+		{
+			continue;
+		}
+
+		const VehicleConstraint& Constraint = *VehiclePair.Value.Constraint;
+		const WheeledVehicleController* Controller =
+			static_cast<const WheeledVehicleController*>
+			(Constraint.GetController());
+		const uint32 NumberOfWheels = static_cast<uint32>
+			(Constraint.GetWheels().size());
+
+		VehiclesStateResponse += FString::Printf(TEXT("VehicleState;%u;%f;%d;"
+			"%u"), VehiclePair.Key, Controller->GetEngine().GetCurrentRPM(),
+			Controller->GetTransmission().GetCurrentGear(), NumberOfWheels);
+
+		// The wheel models' axle is along the y-axis. It is mapped to Jolt's
+		// right, so a wheel at rest has no rotation
+		for (uint32 WheelIndex = 0; WheelIndex < NumberOfWheels; WheelIndex++)
+		{
+			const Mat44 WheelTransform = Constraint.GetWheelLocalTransform
+				(WheelIndex, -Vec3::sAxisY(), Vec3::sAxisZ());
+			const Vec3 WheelPosition = WheelTransform.GetTranslation();
+			const Quat WheelRotation = WheelTransform.GetQuaternion();
+
+			VehiclesStateResponse += FString::Printf(TEXT(";%f;%f;%f;%f;%f;%f;"
+				"%f"), WheelPosition.GetX(), WheelPosition.GetY(),
+				WheelPosition.GetZ(), WheelRotation.GetX(),
+				WheelRotation.GetY(), WheelRotation.GetZ(),
+				WheelRotation.GetW());
+		}
+
+		VehiclesStateResponse += "\n";
+	}
+
+	return VehiclesStateResponse;
+}
+
+void FPhysicsServiceVehicles::RemoveVehicle(const BodyID& ChassisBodyId)
+{
+	FPhysicsVehicle* PhysicsVehicle = Vehicles.Find(ChassisBodyId.GetIndex());
+	if (!PhysicsVehicle)
+	{
+		return;
+	}
+
+	SetVehicleOnWorld(*PhysicsVehicle, false);
+	Vehicles.Remove(ChassisBodyId.GetIndex());
+
+	LPES_LOG_INFO(TEXT("Vehicle removed from body %u."),
+		ChassisBodyId.GetIndex());
+}
+
+void FPhysicsServiceVehicles::RemoveAllVehicles()
+{
+	for (auto& VehiclePair : Vehicles)
+	{
+		SetVehicleOnWorld(VehiclePair.Value, false);
+	}
+
+	Vehicles.Empty();
+}
+
+void FPhysicsServiceVehicles::SetVehicleOnWorld
+	(FPhysicsVehicle& PhysicsVehicle, const bool bIsOnWorld)
+{
+	if (!World || PhysicsVehicle.bIsEnabled == bIsOnWorld)
+	{
+		return;
+	}
+
+	// A disabled vehicle is taken out of the world instead of only disabling
+	// its constraint, so its wheels are not cast on every step
+	if (bIsOnWorld)
+	{
+		World->AddConstraint(PhysicsVehicle.Constraint);
+		World->AddStepListener(PhysicsVehicle.Constraint);
+	}
+	else
+	{
+		World->RemoveStepListener(PhysicsVehicle.Constraint);
+		World->RemoveConstraint(PhysicsVehicle.Constraint);
+	}
+
+	PhysicsVehicle.bIsEnabled = bIsOnWorld;
+}
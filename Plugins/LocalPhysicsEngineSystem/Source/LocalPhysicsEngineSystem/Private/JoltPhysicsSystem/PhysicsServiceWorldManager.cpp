@@ -0,0 +1,672 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/PhysicsServiceWorldManager.h"
+#include "LocalPhysicsEngineSystem/LocalPhysicsEngineSystemLogging.h"
+
+#include "Misc/ScopeLock.h"
+
+#include <thread>
+
+FPhysicsServiceWorldManager* FPhysicsServiceWorldManager::Instance = nullptr;
+int32 FPhysicsServiceWorldManager::JoltGlobalsRefCount = 0;
+
+namespace
+{
+	// Callback for traces, connect this to your own trace function if you
+	// have one
+	void TraceImpl(const char* inFMT, ...)
+	{
+		// Format the message
+		va_list list;
+		va_start(list, inFMT);
+		char buffer[1024];
+		vsnprintf(buffer, sizeof(buffer), inFMT, list);
+		va_end(list);
+
+		LPES_LOG_INFO(TEXT("%s"), UTF8_TO_TCHAR(buffer));
+	}
+
+#ifdef JPH_ENABLE_ASSERTS
+	// Callback for asserts, connect this to your own assert handler if you
+	//  have one
+	bool AssertFailedImpl(const char* inExpression, const char* inMessage,
+		const char* inFile, uint inLine)
+	{
+		LPES_LOG_ERROR(TEXT("%s:%d: (%s) %s"), UTF8_TO_TCHAR(inFile), inLine,
+			UTF8_TO_TCHAR(inExpression), inMessage != nullptr ?
+			UTF8_TO_TCHAR(inMessage) : TEXT(""));
+
+		// Breakpoint
+		return true;
+	};
+#endif // JPH_ENABLE_ASSERTS
+}
+
+FPhysicsServiceWorldManager& FPhysicsServiceWorldManager::Get()
+{
+	if (!Instance)
+	{
+		Instance = new FPhysicsServiceWorldManager();
+	}
+
+	return *Instance;
+}
+
+void FPhysicsServiceWorldManager::Shutdown()
+{
+	if (Instance)
+	{
+		delete Instance;
+		Instance = nullptr;
+	}
+}
+
+FPhysicsServiceWorldManager::FPhysicsServiceWorldManager()
+{
+	// Register the Jolt globals if this is the first manager
+	AcquireJoltGlobals();
+
+	// We need a job system that will execute physics jobs on multiple threads.
+	// A single thread pool is shared by all the worlds, so adding worlds does
+	// not add threads competing for the same cores. Each world waits on the
+	// barriers of its own step profiler, so these are never handed out
+	SharedJobSystem = new JobSystemThreadPool(cMaxPhysicsJobs,
+		cMaxPhysicsBarriers, std::thread::hardware_concurrency() - 1);
+
+	LPES_LOG_INFO(TEXT("Physics service world manager created."));
+}
+
+FPhysicsServiceWorldManager::~FPhysicsServiceWorldManager()
+{
+	// Destroy every world before the resources they use
+	DestroyAllWorlds();
+
+	// Release the shared shapes, static scenes, cooked meshes and ragdoll
+	// types
+	ShapeCache.Empty();
+	StaticSceneCache.Empty();
+	CookedMeshCache.Empty();
+	RagdollTypeCache.Empty();
+
+	// Delete every temp allocator on the pool
+	for (FPhysicsTempAllocator* PooledTempAllocator : TempAllocatorPool)
+	{
+		delete PooledTempAllocator;
+	}
+
+	TempAllocatorPool.Empty();
+	FreeTempAllocators.Empty();
+
+	// Delete the shared job system
+	if (SharedJobSystem)
+	{
+		delete SharedJobSystem;
+		SharedJobSystem = nullptr;
+	}
+
+	// Unregister the Jolt globals if this is the last manager
+	ReleaseJoltGlobals();
+
+	LPES_LOG_INFO(TEXT("Physics service world manager destroyed."));
+}
+
+FPhysicsServiceImpl* FPhysicsServiceWorldManager::CreateWorld
+	(const int32 WorldId, const uint32 MaxBodies)
+{
+	FScopeLock WorldsLock(&WorldsCriticalSection);
+
+	// Check if the world already exists. Its bodies are already allocated,
+	// so a different max bodies can't be applied to it
+	if (FPhysicsServiceImpl* const* ExistingWorld = Worlds.Find(WorldId))
+	{
+		if ((*ExistingWorld)->GetMaxBodies() != MaxBodies)
+		{
+			LPES_LOG_WARNING(TEXT("Physics world %d already exists with %u "
+				"max bodies. The requested %u max bodies are ignored."),
+				WorldId, (*ExistingWorld)->GetMaxBodies(), MaxBodies);
+		}
+
+		return *ExistingWorld;
+	}
+
+	// Create the new world and add it to the map
+	FPhysicsServiceImpl* NewWorld = new FPhysicsServiceImpl(WorldId, *this,
+		MaxBodies);
+	Worlds.Add(WorldId, NewWorld);
+
+	LPES_LOG_INFO(TEXT("Physics world %d created. Hosted worlds: %d"),
+		WorldId, Worlds.Num());
+
+	return NewWorld;
+}
+
+FPhysicsServiceImpl* FPhysicsServiceWorldManager::GetWorld
+	(const int32 WorldId) const
+{
+	FScopeLock WorldsLock(&WorldsCriticalSection);
+
+	FPhysicsServiceImpl* const* FoundWorld = Worlds.Find(WorldId);
+	return FoundWorld ? *FoundWorld : nullptr;
+}
+
+int32 FPhysicsServiceWorldManager::GetNumberOfWorlds() const
+{
+	FScopeLock WorldsLock(&WorldsCriticalSection);
+	return Worlds.Num();
+}
+
+void FPhysicsServiceWorldManager::DestroyWorld(const int32 WorldId)
+{
+	// Get the world to destroy. Only the removal is locked, so the other
+	// worlds are not blocked while this one is cleared
+	FPhysicsServiceImpl* WorldToDestroy = nullptr;
+	int32 NumberOfWorlds = 0;
+	{
+		FScopeLock WorldsLock(&WorldsCriticalSection);
+
+		if (!Worlds.RemoveAndCopyValue(WorldId, WorldToDestroy))
+		{
+			return;
+		}
+
+		NumberOfWorlds = Worlds.Num();
+	}
+
+	// Clear the world if initialized and delete it
+	if (WorldToDestroy->bIsInitialized)
+	{
+		WorldToDestroy->ClearPhysicsSystem();
+	}
+
+	delete WorldToDestroy;
+
+	LPES_LOG_INFO(TEXT("Physics world %d destroyed. Hosted worlds: %d"),
+		WorldId, NumberOfWorlds);
+}
+
+void FPhysicsServiceWorldManager::DestroyAllWorlds()
+{
+	TArray<int32> WorldIds;
+	{
+		FScopeLock WorldsLock(&WorldsCriticalSection);
+		Worlds.GetKeys(WorldIds);
+	}
+
+	for (const int32 WorldId : WorldIds)
+	{
+		DestroyWorld(WorldId);
+	}
+}
+
+FString FPhysicsServiceWorldManager::HandleMessage(const FString& Message)
+{
+	// Split the message into lines
+	TArray<FString> MessageLines;
+	Message.ParseIntoArrayLines(MessageLines);
+
+	// Check for errors
+	if (MessageLines.Num() == 0)
+	{
+		return "Empty message received.\nMessageEnd\n";
+	}
+
+	// Get the command and the world it targets
+	FString Command = FString();
+	int32 TargetWorldId = 0;
+	TArray<FString> HeaderArguments;
+	ParseMessageHeader(MessageLines[0], Command, TargetWorldId,
+		HeaderArguments);
+
+	// Account the Jolt allocations made by the message to its world
+	FPhysicsMemoryAccountingScope MemoryAccountingScope
+		(FPhysicsServiceAllocator::GetWorldAccounting(TargetWorldId));
+
+	// Get the message payload (everything between the header and the
+	// "MessageEnd")
+	FString MessagePayload = FString();
+	for (int32 i = 1; i < MessageLines.Num(); i++)
+	{
+		if (MessageLines[i].Contains("MessageEnd"))
+		{
+			break;
+		}
+
+		MessagePayload += MessageLines[i] + "\n";
+	}
+
+	// The init message will create the world if it does not exist yet
+	if (Command == "Init")
+	{
+		FPhysicsServiceImpl* WorldToInit = CreateWorld(TargetWorldId);
+
+		// Set the step settings if given
+		if (HeaderArguments.Num() >= 4)
+		{
+			WorldToInit->SetStepSettings(FCString::Atof(*HeaderArguments[0]),
+				FCString::Atoi(*HeaderArguments[1]),
+				FCString::Atoi(*HeaderArguments[2]),
+				FCString::Atoi(*HeaderArguments[3]));
+		}
+
+		// Set the contact events budget if given
+		if (HeaderArguments.Num() >= 5)
+		{
+			WorldToInit->SetMaxContactEventsPerStep
+				(FCString::Atoi(*HeaderArguments[4]));
+		}
+
+		// Set the rewind history settings if given
+		if (HeaderArguments.Num() >= 7)
+		{
+			WorldToInit->SetRewindHistorySettings
+				(FCString::Atoi(*HeaderArguments[5]),
+				FCString::Atoi(*HeaderArguments[6]));
+		}
+
+		// Set the world's origin if given. The positions are kept on the
+		// client's space otherwise
+		FPhysicsWorldOrigin WorldOrigin;
+		if (HeaderArguments.Num() >= 10)
+		{
+			WorldOrigin.X = FCString::Atod(*HeaderArguments[7]);
+			WorldOrigin.Y = FCString::Atod(*HeaderArguments[8]);
+			WorldOrigin.Z = FCString::Atod(*HeaderArguments[9]);
+		}
+		WorldToInit->SetWorldOrigin(WorldOrigin);
+
+		WorldToInit->InitPhysicsSystem(MessagePayload);
+
+		// The client must bake the static scene and initialize again
+		if (WorldToInit->IsStaticSceneMissing())
+		{
+			return "StaticSceneMissing\nMessageEnd\n";
+		}
+
+		return "Initialization successful.\nMessageEnd\n";
+	}
+
+	// The bake static scene message is sent before the "Init" that uses it,
+	// so it also creates the world
+	if (Command == "BakeStaticScene")
+	{
+		return CreateWorld(TargetWorldId)->BakeStaticScene(MessagePayload) +
+			"MessageEnd\n";
+	}
+
+	// The mesh cooking messages are not addressed to any world, as the cooked
+	// meshes are shared by every world on this process. Each payload line of
+	// "HasCookedMeshes" is a mesh hash, and the response lists the ones that
+	// must be cooked
+	if (Command == "HasCookedMeshes")
+	{
+		TArray<FString> MeshHashes;
+		MessagePayload.ParseIntoArrayLines(MeshHashes);
+
+		FString MissingMeshes = FString();
+		for (const FString& MeshHash : MeshHashes)
+		{
+			if (!CookedMeshCache.FindCookedMesh(MeshHash.TrimStartAndEnd()))
+			{
+				MissingMeshes += FString::Printf(TEXT("MissingMesh;%s\n"),
+					*MeshHash.TrimStartAndEnd());
+			}
+		}
+
+		return MissingMeshes + "MessageEnd\n";
+	}
+
+	if (Command == "CookMesh")
+	{
+		return CookedMeshCache.CookMesh(MessagePayload) + "MessageEnd\n";
+	}
+
+	if (Command == "RegisterRagdollType")
+	{
+		return RagdollTypeCache.RegisterRagdollType(MessagePayload) +
+			"MessageEnd\n";
+	}
+
+	// The restore snapshot message also creates the world, as it is sent to
+	// the physics service the world is migrating to
+	if (Command == "RestoreSnapshot")
+	{
+		FPhysicsServiceImpl* WorldToRestore = CreateWorld(TargetWorldId);
+		if (!WorldToRestore->RestoreWorldSnapshot(MessagePayload))
+		{
+			DestroyWorld(TargetWorldId);
+			return "Snapshot restore failed.\nMessageEnd\n";
+		}
+
+		// Send the restored state checksum, so the client can check it is
+		// the same as the saved world's
+		return FString::Printf(TEXT("Snapshot restore successful.\n"
+			"Checksum;%u\nMessageEnd\n"),
+			WorldToRestore->GetLastStateChecksum());
+	}
+
+	// Any other command needs an existing world
+	FPhysicsServiceImpl* TargetWorld = GetWorld(TargetWorldId);
+	if (!TargetWorld || !TargetWorld->bIsInitialized)
+	{
+		LPES_LOG_WARNING(TEXT("Message \"%s\" targets world %d, which is not "
+			"initialized."), *Command, TargetWorldId);
+
+		return FString::Printf(TEXT("World %d is not initialized.\n"
+			"MessageEnd\n"), TargetWorldId);
+	}
+
+	if (Command == "Step")
+	{
+		// The first line is the elapsed time to step. If not given, step a
+		// single fixed step. The next ones are the ghost bodies' targets, the
+		// kinematic targets, the characters' and vehicles' inputs, the
+		// ragdolls to activate, the constraint and force field changes and
+		// the scene queries to run after stepping
+		TArray<FString> StepLines;
+		MessagePayload.ParseIntoArrayLines(StepLines);
+
+		const FString ElapsedTimeString = StepLines.Num() > 0 ?
+			StepLines[0].TrimStartAndEnd() : FString();
+		const float ElapsedTime = ElapsedTimeString.IsEmpty() ?
+			TargetWorld->GetFixedDeltaTime() :
+			FCString::Atof(*ElapsedTimeString);
+
+		TArray<FString> GhostLines;
+		TArray<FString> KinematicLines;
+		TArray<FString> CharacterLines;
+		TArray<FString> VehicleLines;
+		TArray<FString> RagdollLines;
+		TArray<FString> ConstraintLines;
+		TArray<FString> ForceFieldLines;
+		TArray<FString> QueryLines;
+		for (int32 i = 1; i < StepLines.Num(); i++)
+		{
+			if (StepLines[i].StartsWith(TEXT("Query;")))
+			{
+				QueryLines.Add(StepLines[i]);
+			}
+			else if (StepLines[i].StartsWith(TEXT("KinematicTargets;")))
+			{
+				KinematicLines.Add(StepLines[i]);
+			}
+			else if (StepLines[i].StartsWith(TEXT("Character;")))
+			{
+				CharacterLines.Add(StepLines[i]);
+			}
+			else if (StepLines[i].StartsWith(TEXT("Vehicle;")))
+			{
+				VehicleLines.Add(StepLines[i]);
+			}
+			else if (StepLines[i].StartsWith(TEXT("Ragdoll;")))
+			{
+				RagdollLines.Add(StepLines[i]);
+			}
+			else if (StepLines[i].StartsWith(TEXT("Constraint;")) ||
+				StepLines[i].StartsWith(TEXT("RemoveConstraint;")))
+			{
+				ConstraintLines.Add(StepLines[i]);
+			}
+			else if (StepLines[i].StartsWith(TEXT("RadialImpulse;")) ||
+				StepLines[i].StartsWith(TEXT("ForceField;")) ||
+				StepLines[i].StartsWith(TEXT("RemoveForceField;")))
+			{
+				ForceFieldLines.Add(StepLines[i]);
+			}
+			else
+			{
+				GhostLines.Add(StepLines[i]);
+			}
+		}
+		TargetWorld->SetGhostBodyTargets(GhostLines);
+		TargetWorld->SetKinematicBodyTargets(KinematicLines);
+		TargetWorld->SetCharacterInputs(CharacterLines);
+		TargetWorld->SetVehicleInputs(VehicleLines);
+		TargetWorld->SetRagdollActivations(RagdollLines);
+		TargetWorld->ApplyConstraintChanges(ConstraintLines);
+		TargetWorld->ApplyForceFieldChanges(ForceFieldLines);
+
+		// The queries see the bodies as they are after the step
+		const FString StepResponse = TargetWorld->StepPhysicsSimulation
+			(ElapsedTime);
+
+		return StepResponse + TargetWorld->RunSceneQueries(QueryLines) +
+			"MessageEnd\n";
+	}
+
+	if (Command == "SceneQuery")
+	{
+		TArray<FString> QueryLines;
+		MessagePayload.ParseIntoArrayLines(QueryLines);
+
+		return TargetWorld->RunSceneQueries(QueryLines) + "MessageEnd\n";
+	}
+
+	if (Command == "AddBody")
+	{
+		return TargetWorld->AddBodyFromMessageLine
+			(MessagePayload.TrimEnd()) + "\nMessageEnd\n";
+	}
+
+	if (Command == "RemoveBody")
+	{
+		const BodyID BodyToRemoveID(FCString::Atoi(*MessagePayload));
+		return TargetWorld->RemoveBodyByID(BodyToRemoveID) + "\nMessageEnd\n";
+	}
+
+	if (Command == "UpdateBodyType")
+	{
+		// The payload is "BodyId;NewBodyType"
+		TArray<FString> BodyTypeInfo;
+		MessagePayload.TrimStartAndEnd().ParseIntoArray(BodyTypeInfo,
+			TEXT(";"));
+
+		if (BodyTypeInfo.Num() < 2)
+		{
+			return "Could not parse body type update.\nMessageEnd\n";
+		}
+
+		return TargetWorld->UpdateBodyType(BodyID(FCString::Atoi
+			(*BodyTypeInfo[0])), BodyTypeInfo[1]) + "\nMessageEnd\n";
+	}
+
+	if (Command == "ContactSubscriptions")
+	{
+		// Each payload line is "BodyId;SubscriptionFlags;MinContactImpulse"
+		TArray<FString> SubscriptionLines;
+		MessagePayload.ParseIntoArrayLines(SubscriptionLines);
+
+		for (const FString& SubscriptionLine : SubscriptionLines)
+		{
+			TArray<FString> SubscriptionInfo;
+			SubscriptionLine.ParseIntoArray(SubscriptionInfo, TEXT(";"));
+
+			if (SubscriptionInfo.Num() < 3)
+			{
+				continue;
+			}
+
+			TargetWorld->SetContactEventSubscription
+				(BodyID(FCString::Atoi(*SubscriptionInfo[0])),
+				static_cast<uint8>(FCString::Atoi(*SubscriptionInfo[1])),
+				FCString::Atof(*SubscriptionInfo[2]));
+		}
+
+		return "Contact subscriptions updated.\nMessageEnd\n";
+	}
+
+	if (Command == "RewindRaycast")
+	{
+		return TargetWorld->RewindRaycast(MessagePayload) + "MessageEnd\n";
+	}
+
+	if (Command == "SaveSnapshot")
+	{
+		return TargetWorld->SaveWorldSnapshot() + "MessageEnd\n";
+	}
+
+	if (Command == "GetSimulationMeasures")
+	{
+		return TargetWorld->GetSimulationMeasures() + "MessageEnd\n";
+	}
+
+	if (Command == "GetMemoryMeasures")
+	{
+		return TargetWorld->GetMemoryMeasures() + "MessageEnd\n";
+	}
+
+	if (Command == "Clear")
+	{
+		DestroyWorld(TargetWorldId);
+		return "Clear successful.\nMessageEnd\n";
+	}
+
+	return FString::Printf(TEXT("Unknown command \"%s\".\nMessageEnd\n"),
+		*Command);
+}
+
+FPhysicsTempAllocator* FPhysicsServiceWorldManager::AcquireTempAllocator()
+{
+	FScopeLock TempAllocatorPoolLock(&TempAllocatorPoolCriticalSection);
+
+	// Reuse a free temp allocator if there is one
+	if (FreeTempAllocators.Num() > 0)
+	{
+		return FreeTempAllocators.Pop(false);
+	}
+
+	// If not, create a new one. The pool only grows up to the amount of worlds
+	// stepping at the same time.
+	// We're pre-allocating 10 MB to avoid having to do allocations during the
+	// physics update
+	FPhysicsTempAllocator* NewTempAllocator = new FPhysicsTempAllocator
+		(TempAllocatorSize);
+	TempAllocatorPool.Add(NewTempAllocator);
+
+	return NewTempAllocator;
+}
+
+void FPhysicsServiceWorldManager::ReleaseTempAllocator
+	(FPhysicsTempAllocator* TempAllocatorToRelease)
+{
+	if (!TempAllocatorToRelease)
+	{
+		return;
+	}
+
+	FScopeLock TempAllocatorPoolLock(&TempAllocatorPoolCriticalSection);
+	FreeTempAllocators.Add(TempAllocatorToRelease);
+}
+
+ShapeRefC FPhysicsServiceWorldManager::GetOrCreateSphereShape
+	(const float Radius)
+{
+	const FString ShapeKey = FString::Printf(TEXT("sphere;%f"), Radius);
+
+	FScopeLock ShapeCacheLock(&ShapeCacheCriticalSection);
+
+	// Check if the shape is already cached
+	if (const ShapeRefC* CachedShape = ShapeCache.Find(ShapeKey))
+	{
+		return *CachedShape;
+	}
+
+	// Create and cache the new shape
+	ShapeRefC NewSphereShape = new SphereShape(Radius);
+	ShapeCache.Add(ShapeKey, NewSphereShape);
+
+	return NewSphereShape;
+}
+
+ShapeRefC FPhysicsServiceWorldManager::GetOrCreateBoxShape
+	(const Vec3 HalfExtents)
+{
+	const FString ShapeKey = FString::Printf(TEXT("box;%f;%f;%f"),
+		HalfExtents.GetX(), HalfExtents.GetY(), HalfExtents.GetZ());
+
+	FScopeLock ShapeCacheLock(&ShapeCacheCriticalSection);
+
+	// Check if the shape is already cached
+	if (const ShapeRefC* CachedShape = ShapeCache.Find(ShapeKey))
+	{
+		return *CachedShape;
+	}
+
+	// Create the shape
+	BoxShapeSettings BoxSettings(HalfExtents);
+	ShapeSettings::ShapeResult BoxShapeResult = BoxSettings.Create();
+
+	if (BoxShapeResult.HasError())
+	{
+		LPES_LOG_ERROR(TEXT("Could not create box shape: %s"),
+			UTF8_TO_TCHAR(BoxShapeResult.GetError().c_str()));
+		return nullptr;
+	}
+
+	// Cache the new shape
+	ShapeRefC NewBoxShape = BoxShapeResult.Get();
+	ShapeCache.Add(ShapeKey, NewBoxShape);
+
+	return NewBoxShape;
+}
+
+void FPhysicsServiceWorldManager::AcquireJoltGlobals()
+{
+	// Only the first manager registers the globals
+	if (JoltGlobalsRefCount++ > 0)
+	{
+		return;
+	}
+
+	// Register allocation hook, routed to the backend set on the command line
+	FPhysicsServiceAllocator::Register
+		(FPhysicsAllocatorSettings::FromCommandLine());
+
+	// Install callbacks
+	Trace = TraceImpl;
+	JPH_IF_ENABLE_ASSERTS(AssertFailed = AssertFailedImpl;)
+
+	// Create a factory
+	Factory::sInstance = new Factory();
+
+	// Register all Jolt physics types
+	RegisterTypes();
+}
+
+void FPhysicsServiceWorldManager::ReleaseJoltGlobals()
+{
+	// Only the last manager unregisters the globals
+	if (--JoltGlobalsRefCount > 0)
+	{
+		return;
+	}
+
+	// Unregisters all types with the factory and cleans up the default
+	// material
+	UnregisterTypes();
+
+	// Destroy the factory
+	delete Factory::sInstance;
+	Factory::sInstance = nullptr;
+
+	// Release the allocator's arenas, as nothing should be allocated anymore
+	FPhysicsServiceAllocator::Unregister();
+}
+
+void FPhysicsServiceWorldManager::ParseMessageHeader(const FString& HeaderLine,
+	FString& OutCommand, int32& OutWorldId,
+	TArray<FString>& OutHeaderArguments)
+{
+	// Split the header with ";" delimiter
+	TArray<FString> HeaderInfo;
+	HeaderLine.TrimStartAndEnd().ParseIntoArray(HeaderInfo, TEXT(";"));
+
+	OutCommand = HeaderInfo.Num() > 0 ? HeaderInfo[0] : FString();
+	OutWorldId = HeaderInfo.Num() > 1 ? FCString::Atoi(*HeaderInfo[1]) : 0;
+
+	// Everything after the world id are the header arguments
+	OutHeaderArguments.Reset();
+	for (int32 i = 2; i < HeaderInfo.Num(); i++)
+	{
+		OutHeaderArguments.Add(HeaderInfo[i]);
+	}
+}
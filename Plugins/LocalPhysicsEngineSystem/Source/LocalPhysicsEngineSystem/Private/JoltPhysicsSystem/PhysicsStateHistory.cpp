@@ -0,0 +1,131 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/PhysicsStateHistory.h"
+#include "LocalPhysicsEngineSystem/LocalPhysicsEngineSystemLogging.h"
+
+void FPhysicsStateHistory::Allocate(const uint32 InHistoryLength,
+	const uint32 InMaxBodiesPerStep)
+{
+	HistoryLength = InHistoryLength;
+	MaxBodiesPerStep = InHistoryLength > 0 ? InMaxBodiesPerStep : 0;
+
+	// Preallocate every slot, so recording never allocates
+	BodyStates.Empty(HistoryLength * MaxBodiesPerStep);
+	BodyStates.SetNum(HistoryLength * MaxBodiesPerStep);
+	Steps.Empty(HistoryLength);
+	Steps.SetNum(HistoryLength);
+
+	NextSlotIndex = 0;
+	RecordedStepsCount = 0;
+	bHasWarnedAboutMaxBodies = false;
+}
+
+void FPhysicsStateHistory::Release()
+{
+	Allocate(0, 0);
+}
+
+void FPhysicsStateHistory::RecordStep(const uint32 StepIndex,
+	const BodyInterface& BodyInterface,
+	const std::vector<BodyID>& KinematicBodyIds,
+	const std::vector<BodyID>& DynamicBodyIds)
+{
+	if (!IsEnabled())
+	{
+		return;
+	}
+
+	// Get the bodies to record. Any body beyond the max is not recorded
+	const uint32 NumberOfBodies = static_cast<uint32>(KinematicBodyIds.size()
+		+ DynamicBodyIds.size());
+	if (NumberOfBodies > MaxBodiesPerStep && !bHasWarnedAboutMaxBodies)
+	{
+		LPES_LOG_WARNING(TEXT("Physics state history can only record %d "
+			"bodies per step, but %d are moving. The remaining are not "
+			"recorded."), MaxBodiesPerStep, static_cast<int32>
+			(NumberOfBodies));
+		bHasWarnedAboutMaxBodies = true;
+	}
+
+	// Write the bodies' state on the slot's range. The kinematic bodies go
+	// first, so they are kept once over the max
+	FStepSlot& StepSlot = Steps[NextSlotIndex];
+	StepSlot.StepIndex = StepIndex;
+	StepSlot.NumberOfBodies = 0;
+
+	FPhysicsBodyHistoryState* SlotBodyStates = BodyStates.GetData() +
+		NextSlotIndex * MaxBodiesPerStep;
+
+	for (const std::vector<BodyID>* BodyIds : { &KinematicBodyIds,
+		&DynamicBodyIds })
+	{
+		for (const BodyID& BodyId : *BodyIds)
+		{
+			if (StepSlot.NumberOfBodies == MaxBodiesPerStep)
+			{
+				break;
+			}
+
+			const RMat44 CenterOfMassTransform =
+				BodyInterface.GetCenterOfMassTransform(BodyId);
+
+			FPhysicsBodyHistoryState& BodyState =
+				SlotBodyStates[StepSlot.NumberOfBodies++];
+			BodyState.Body = BodyId;
+			Vec3(CenterOfMassTransform.GetTranslation()).StoreFloat3
+				(&BodyState.Position);
+			CenterOfMassTransform.GetQuaternion().GetXYZW().StoreFloat4
+				(&BodyState.Rotation);
+		}
+	}
+
+	// Move to the next slot, overwriting the oldest one once full
+	NextSlotIndex = (NextSlotIndex + 1) % HistoryLength;
+	RecordedStepsCount = FMath::Min(RecordedStepsCount + 1, HistoryLength);
+}
+
+TArrayView<const FPhysicsBodyHistoryState>
+	FPhysicsStateHistory::GetStepBodyStates(const uint32 StepIndex) const
+{
+	if (RecordedStepsCount == 0)
+	{
+		return TArrayView<const FPhysicsBodyHistoryState>();
+	}
+
+	// Check if the step is still on the ring
+	const uint32 StepsAgo = GetNewestStepIndex() - StepIndex;
+	if (StepIndex > GetNewestStepIndex() || StepsAgo >= RecordedStepsCount)
+	{
+		return TArrayView<const FPhysicsBodyHistoryState>();
+	}
+
+	// The steps are recorded sequentially, so the slot is found from how
+	// many steps ago it was recorded
+	const uint32 SlotIndex = (NextSlotIndex + HistoryLength - 1 - StepsAgo) %
+		HistoryLength;
+	const FStepSlot& StepSlot = Steps[SlotIndex];
+
+	return TArrayView<const FPhysicsBodyHistoryState>(BodyStates.GetData() +
+		SlotIndex * MaxBodiesPerStep, StepSlot.NumberOfBodies);
+}
+
+uint32 FPhysicsStateHistory::GetOldestStepIndex() const
+{
+	if (RecordedStepsCount == 0)
+	{
+		return 0;
+	}
+
+	return GetNewestStepIndex() - (RecordedStepsCount - 1);
+}
+
+uint32 FPhysicsStateHistory::GetNewestStepIndex() const
+{
+	if (RecordedStepsCount == 0)
+	{
+		return 0;
+	}
+
+	return Steps[(NextSlotIndex + HistoryLength - 1) % HistoryLength].
+		StepIndex;
+}
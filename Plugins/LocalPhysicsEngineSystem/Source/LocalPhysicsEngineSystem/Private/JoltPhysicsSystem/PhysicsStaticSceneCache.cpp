@@ -0,0 +1,155 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/PhysicsStaticSceneCache.h"
+#include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/JoltMemoryStream.h"
+#include "LocalPhysicsEngineSystem/LocalPhysicsEngineSystemLogging.h"
+
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+
+Ref<PhysicsScene> FPhysicsStaticSceneCache::FindStaticScene
+	(const FString& SceneKey, const uint32 ContentHash,
+	FPhysicsWorldOrigin& OutSceneOrigin)
+{
+	FScopeLock CacheLock(&CacheCriticalSection);
+
+	// Check the memory cache first
+	if (const FCachedStaticScene* CachedStaticScene =
+		CachedStaticScenes.Find(SceneKey))
+	{
+		if (CachedStaticScene->ContentHash == ContentHash)
+		{
+			OutSceneOrigin = CachedStaticScene->SceneOrigin;
+			return CachedStaticScene->StaticScene;
+		}
+	}
+
+	// Load from disk, keeping it on memory for the next worlds
+	Ref<PhysicsScene> LoadedStaticScene = LoadStaticSceneFile(SceneKey,
+		ContentHash, OutSceneOrigin);
+	if (LoadedStaticScene)
+	{
+		CachedStaticScenes.Add(SceneKey, { ContentHash, LoadedStaticScene,
+			OutSceneOrigin });
+	}
+
+	return LoadedStaticScene;
+}
+
+void FPhysicsStaticSceneCache::AddStaticScene(const FString& SceneKey,
+	const uint32 ContentHash, const Ref<PhysicsScene>& StaticScene,
+	const FPhysicsWorldOrigin& SceneOrigin)
+{
+	FScopeLock CacheLock(&CacheCriticalSection);
+
+	CachedStaticScenes.Add(SceneKey, { ContentHash, StaticScene,
+		SceneOrigin });
+	SaveStaticSceneFile(SceneKey, ContentHash, *StaticScene, SceneOrigin);
+}
+
+void FPhysicsStaticSceneCache::Empty()
+{
+	FScopeLock CacheLock(&CacheCriticalSection);
+
+	CachedStaticScenes.Empty();
+}
+
+FString FPhysicsStaticSceneCache::GetStaticSceneFilePath
+	(const FString& SceneKey)
+{
+	return FPaths::Combine(FPaths::ProjectSavedDir(),
+		TEXT("PhysicsStaticScenes"), FPaths::MakeValidFileName(SceneKey) +
+		TEXT(".jpsc"));
+}
+
+Ref<PhysicsScene> FPhysicsStaticSceneCache::LoadStaticSceneFile
+	(const FString& SceneKey, const uint32 ContentHash,
+	FPhysicsWorldOrigin& OutSceneOrigin)
+{
+	const FString StaticSceneFilePath = GetStaticSceneFilePath(SceneKey);
+
+	TArray<uint8> StaticSceneFileData;
+	if (!FFileHelper::LoadFileToArray(StaticSceneFileData,
+		*StaticSceneFilePath, FILEREAD_Silent))
+	{
+		return nullptr;
+	}
+
+	// Check the header: tag, version, content hash and scene origin
+	FMemoryStreamIn StaticSceneStream(StaticSceneFileData, 0);
+
+	uint32 FileTag = 0;
+	uint32 FileVersion = 0;
+	uint32 FileContentHash = 0;
+	FPhysicsWorldOrigin FileSceneOrigin;
+	StaticSceneStream.Read(FileTag);
+	StaticSceneStream.Read(FileVersion);
+	StaticSceneStream.Read(FileContentHash);
+	StaticSceneStream.Read(FileSceneOrigin.X);
+	StaticSceneStream.Read(FileSceneOrigin.Y);
+	StaticSceneStream.Read(FileSceneOrigin.Z);
+
+	if (StaticSceneStream.IsFailed() || FileTag != StaticSceneFileTag ||
+		FileVersion != StaticSceneFileVersion)
+	{
+		LPES_LOG_WARNING(TEXT("Static scene file \"%s\" is invalid or from "
+			"another version. Ignoring it."), *StaticSceneFilePath);
+		return nullptr;
+	}
+
+	if (FileContentHash != ContentHash)
+	{
+		LPES_LOG_INFO(TEXT("Static scene \"%s\" was baked from another "
+			"content. It must be baked again."), *SceneKey);
+		return nullptr;
+	}
+
+	// Restore the scene, shapes included
+	PhysicsScene::PhysicsSceneResult RestoreResult =
+		PhysicsScene::sRestoreFromBinaryState(StaticSceneStream);
+	if (RestoreResult.HasError())
+	{
+		LPES_LOG_WARNING(TEXT("Could not restore static scene \"%s\": %s"),
+			*StaticSceneFilePath, UTF8_TO_TCHAR
+			(RestoreResult.GetError().c_str()));
+		return nullptr;
+	}
+
+	LPES_LOG_INFO(TEXT("Static scene \"%s\" loaded from disk (bodies: %d; "
+		"%d bytes)."), *SceneKey, static_cast<int32>
+		(RestoreResult.Get()->GetNumBodies()), StaticSceneFileData.Num());
+
+	OutSceneOrigin = FileSceneOrigin;
+
+	return RestoreResult.Get();
+}
+
+void FPhysicsStaticSceneCache::SaveStaticSceneFile(const FString& SceneKey,
+	const uint32 ContentHash, const PhysicsScene& StaticScene,
+	const FPhysicsWorldOrigin& SceneOrigin)
+{
+	TArray<uint8> StaticSceneFileData;
+	FMemoryStreamOut StaticSceneStream(StaticSceneFileData);
+
+	// Write the header, then the scene with its shapes
+	StaticSceneStream.Write(StaticSceneFileTag);
+	StaticSceneStream.Write(StaticSceneFileVersion);
+	StaticSceneStream.Write(ContentHash);
+	StaticSceneStream.Write(SceneOrigin.X);
+	StaticSceneStream.Write(SceneOrigin.Y);
+	StaticSceneStream.Write(SceneOrigin.Z);
+	StaticScene.SaveBinaryState(StaticSceneStream, true, false);
+
+	const FString StaticSceneFilePath = GetStaticSceneFilePath(SceneKey);
+	if (!FFileHelper::SaveArrayToFile(StaticSceneFileData,
+		*StaticSceneFilePath))
+	{
+		LPES_LOG_WARNING(TEXT("Could not save static scene file \"%s\"."),
+			*StaticSceneFilePath);
+		return;
+	}
+
+	LPES_LOG_INFO(TEXT("Static scene \"%s\" saved on \"%s\" (%d bytes)."),
+		*SceneKey, *StaticSceneFilePath, StaticSceneFileData.Num());
+}
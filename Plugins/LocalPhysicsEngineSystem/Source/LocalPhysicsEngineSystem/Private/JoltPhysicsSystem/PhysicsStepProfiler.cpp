@@ -0,0 +1,145 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/PhysicsStepProfiler.h"
+
+#include <cstring>
+
+namespace
+{
+	/** The phase of each job created by the physics system's update */
+	struct FPhysicsStepJobPhase
+	{
+		const char* JobName;
+		EPhysicsStepPhase Phase;
+	};
+
+	const FPhysicsStepJobPhase PhysicsStepJobPhases[] =
+	{
+		{ "UpdateBroadPhasePrepare", EPhysicsStepPhase::BroadPhase },
+		{ "UpdateBroadPhaseFinalize", EPhysicsStepPhase::BroadPhase },
+		{ "FindCollisions", EPhysicsStepPhase::NarrowPhase },
+		{ "FindCCDContacts", EPhysicsStepPhase::NarrowPhase },
+		{ "SetupVelocityConstraints", EPhysicsStepPhase::ConstraintSetup },
+		{ "BuildIslandsFromConstraints", EPhysicsStepPhase::ConstraintSetup },
+		{ "DetermineActiveConstraints", EPhysicsStepPhase::ConstraintSetup },
+		{ "FinalizeIslands", EPhysicsStepPhase::ConstraintSetup },
+		{ "BodySetIslandIndex", EPhysicsStepPhase::ConstraintSetup },
+		{ "SolveVelocityConstraints", EPhysicsStepPhase::SolveVelocity },
+		{ "SolvePositionConstraints", EPhysicsStepPhase::SolvePosition },
+		{ "ResolveCCDContacts", EPhysicsStepPhase::SolvePosition },
+		{ "ApplyGravity", EPhysicsStepPhase::Integration },
+		{ "PreIntegrateVelocity", EPhysicsStepPhase::Integration },
+		{ "IntegrateVelocity", EPhysicsStepPhase::Integration },
+		{ "PostIntegrateVelocity", EPhysicsStepPhase::Integration }
+	};
+
+	/** Converts cycles to microseconds */
+	uint64 CyclesToMicroseconds(const uint64 Cycles)
+	{
+		return static_cast<uint64>(FPlatformTime::ToMilliseconds64(Cycles) *
+			1000.0);
+	}
+}
+
+void FPhysicsStepProfiler::BeginStep()
+{
+	for (auto& Cycles : PhaseCycles)
+	{
+		Cycles.store(0, std::memory_order_relaxed);
+	}
+	JobCount.store(0, std::memory_order_relaxed);
+
+	StepStartCycles = FPlatformTime::Cycles64();
+}
+
+void FPhysicsStepProfiler::EndStep()
+{
+	// Every job of the step has finished at this point, as the physics update
+	// waits for them
+	LastStepCycles = FPlatformTime::Cycles64() - StepStartCycles;
+
+	for (int32 i = 0; i < (int32)EPhysicsStepPhase::Num; i++)
+	{
+		LastStepPhaseCycles[i] = PhaseCycles[i].load(std::memory_order_relaxed);
+	}
+	LastStepJobCount = JobCount.load(std::memory_order_relaxed);
+}
+
+FString FPhysicsStepProfiler::GetLastStepMeasureLine() const
+{
+	uint64 JobsCycles = 0;
+	for (const uint64 Cycles : LastStepPhaseCycles)
+	{
+		JobsCycles += Cycles;
+	}
+
+	// The step's threads are the job system's threads plus the one that
+	// waits on the step, which also runs jobs
+	const double StepThreadsCycles = static_cast<double>(LastStepCycles) *
+		FMath::Max(GetMaxConcurrency(), 1);
+	const double ThreadUtilisation = StepThreadsCycles > 0.0 ?
+		FMath::Min(JobsCycles / StepThreadsCycles, 1.0) : 0.0;
+
+	FString MeasureLine = FString::Printf(TEXT("Phases;%llu"),
+		CyclesToMicroseconds(LastStepCycles));
+	for (const uint64 Cycles : LastStepPhaseCycles)
+	{
+		MeasureLine += FString::Printf(TEXT(";%llu"),
+			CyclesToMicroseconds(Cycles));
+	}
+	MeasureLine += FString::Printf(TEXT(";%u;%f\n"), LastStepJobCount,
+		ThreadUtilisation);
+
+	return MeasureLine;
+}
+
+EPhysicsStepPhase FPhysicsStepProfiler::GetJobPhase(const char* JobName)
+{
+	if (!JobName)
+	{
+		return EPhysicsStepPhase::Other;
+	}
+
+	for (const auto& JobPhase : PhysicsStepJobPhases)
+	{
+		if (std::strcmp(JobPhase.JobName, JobName) == 0)
+		{
+			return JobPhase.Phase;
+		}
+	}
+
+	// Step listeners, contact removed callbacks and the steps' starts
+	return EPhysicsStepPhase::Other;
+}
+
+JobHandle FPhysicsStepProfiler::CreateJob(const char* inName,
+	ColorArg inColor, const JobFunction& inJobFunction,
+	uint32 inNumDependencies)
+{
+	const int32 JobPhaseIndex = (int32)GetJobPhase(inName);
+
+	const FColor NamedEventColor(inColor.r, inColor.g, inColor.b, inColor.a);
+
+	// The job name is a literal on Jolt, so it can be kept for the event
+	return ProfiledJobSystem.CreateJob(inName, inColor, [this, inJobFunction,
+		JobPhaseIndex, inName, NamedEventColor]()
+	{
+#if ENABLE_NAMED_EVENTS
+		FPlatformMisc::BeginNamedEvent(NamedEventColor, inName);
+#endif
+		const uint64 JobStartCycles = FPlatformTime::Cycles64();
+
+		{
+			FPhysicsMemoryAccountingScope MemoryAccountingScope
+				(MemoryAccounting);
+			inJobFunction();
+		}
+
+		PhaseCycles[JobPhaseIndex].fetch_add(FPlatformTime::Cycles64() -
+			JobStartCycles, std::memory_order_relaxed);
+		JobCount.fetch_add(1, std::memory_order_relaxed);
+#if ENABLE_NAMED_EVENTS
+		FPlatformMisc::EndNamedEvent();
+#endif
+	}, inNumDependencies);
+}
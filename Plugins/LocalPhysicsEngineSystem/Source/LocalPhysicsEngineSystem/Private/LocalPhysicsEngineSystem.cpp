@@ -2,6 +2,7 @@
 
 #include "LocalPhysicsEngineSystem.h"
 #include "LocalPhysicsEngineSystem/LocalPhysicsEngineSystemLogging.h"
+#include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/PhysicsServiceWorldManager.h"
 
 #define LOCTEXT_NAMESPACE "FLocalPhysicsEngineSystemModule"
 
@@ -16,6 +17,9 @@ void FLocalPhysicsEngineSystemModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+
+	// Destroy every hosted physics world and the shared Jolt resources
+	FPhysicsServiceWorldManager::Shutdown();
 }
 
 #undef LOCTEXT_NAMESPACE
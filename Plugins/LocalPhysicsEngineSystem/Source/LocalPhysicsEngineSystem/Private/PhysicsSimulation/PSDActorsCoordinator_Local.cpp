@@ -4,6 +4,7 @@
 #include "PhysicsSimulation/PSDActorsCoordinator_Local.h"
 #include "LocalPhysicsEngineSystem/LocalPhysicsEngineSystemLogging.h"
 #include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/PhysicsServiceImpl.h"
+#include "LocalPhysicsEngineSystem/Public/JoltPhysicsSystem/PhysicsServiceWorldManager.h"
 #include "RemotePhysicsEngineSystem/Public/PhysicsSimulation/PSDActors/Base/PSDActorBase.h"
 
 #include "Net/UnrealNetwork.h"
@@ -30,6 +31,9 @@ void APSDActorsCoordinator_Local::EndPlay
 	(const EEndPlayReason::Type EndPlayReason)
 {
 	StopPSDActorsSimulation();
+
+	// Destroy the lockstep physics world, if this is a client running one
+	DestroyPhysicsWorld();
 }
 
 void APSDActorsCoordinator_Local::Tick(float DeltaTime)
@@ -73,7 +77,14 @@ void APSDActorsCoordinator_Local::Tick(float DeltaTime)
 	{
 		// Update PSD actors by simulating physics on the service
 		// and parsing it's results with the new actor position
-		UpdatePSDActors();
+		UpdatePSDActors(DeltaTime);
+	}
+
+	// Once the server stops simulating, destroy this client's lockstep
+	// physics world
+	if (!bIsSimulatingPhysics && !HasAuthority())
+	{
+		DestroyPhysicsWorld();
 	}
 }
 
@@ -92,10 +103,10 @@ void APSDActorsCoordinator_Local::InitializePhysicsWorld()
 	FString InitializationMessage = FString();
 
 	// Foreach PSD actor, get its StepPhysicsString
-	for (auto& PSDActor : PSDActorMap)
+	for (APSDActorBase* PSDActor : PSDActorMap.GetPSDActors())
 	{
 		InitializationMessage += 
-			PSDActor.Value->GetPhysicsServiceInitializationString();
+			PSDActor->GetPhysicsServiceInitializationString();
 	}
 
 	// Convert message to std string
@@ -109,7 +120,7 @@ void APSDActorsCoordinator_Local::InitializePhysicsWorld()
 	PhysicsServiceLocalImpl->InitPhysicsSystem(InitializationMessage);
 }
 
-void APSDActorsCoordinator_Local::UpdatePSDActors()
+void APSDActorsCoordinator_Local::UpdatePSDActors(const float DeltaTime)
 {
 	// Check if we are simulating
 	if (!bIsSimulatingPhysics)
@@ -119,19 +130,77 @@ void APSDActorsCoordinator_Local::UpdatePSDActors()
 
 	LPES_LOG_WARNING(TEXT("Stepping: %d"), StepPhysicsCounter++);
 
-	// Step physics
+	// Apply the simulation commands requested since the last step
+	const uint32 FirstStepIndex = PhysicsServiceLocalImpl->StepPhysicsCounter;
+	const TArray<FString> AppliedSimulationCommands =
+		MoveTemp(PendingSimulationCommands);
+	PendingSimulationCommands.Reset();
+
+	for (const FString& SimulationCommand : AppliedSimulationCommands)
+	{
+		PhysicsServiceLocalImpl->ApplySimulationCommand(SimulationCommand);
+	}
+
+	// Step physics by the elapsed game time
 	FString PhysicsSimulationResultStr =
-		PhysicsServiceLocalImpl->StepPhysicsSimulation();
+		PhysicsServiceLocalImpl->StepPhysicsSimulation(DeltaTime);
+
+	// Update the PSD actors with the result
+	const float InterpolationAlpha =
+		PhysicsServiceLocalImpl->GetInterpolationAlpha();
+	ApplyPhysicsSimulationResult(PhysicsSimulationResultStr,
+		InterpolationAlpha);
+
+	LPES_LOG_INFO(TEXT("Physics updated for this frame."));
+
+	if (!bUseLockstepSimulation)
+	{
+		return;
+	}
 
+	// On lockstep, send only the frame to the clients: the commands applied
+	// and how many steps were run. Every few steps, the world checksum is
+	// also sent so clients can detect if they have diverged
+	const uint32 LastStepIndex = PhysicsServiceLocalImpl->StepPhysicsCounter;
+	const int32 NumberOfSteps = LastStepIndex - FirstStepIndex;
+
+	uint32 StateChecksum = 0;
+	if (LockstepChecksumIntervalSteps > 0 && NumberOfSteps > 0 &&
+		FirstStepIndex / LockstepChecksumIntervalSteps != LastStepIndex /
+		LockstepChecksumIntervalSteps)
+	{
+		StateChecksum = PhysicsServiceLocalImpl->GetLastStateChecksum();
+	}
+
+	ReceiveLockstepFrame(FirstStepIndex, NumberOfSteps,
+		AppliedSimulationCommands, InterpolationAlpha, StateChecksum);
+}
+
+void APSDActorsCoordinator_Local::ApplyPhysicsSimulationResult
+	(const FString& PhysicsSimulationResult, const float InterpolationAlpha)
+{
 	// Parse physics simulation result
-	// Each line will contain a result for a actor in terms of:
+	// The first line is the step info: "StepInfo; NumberOfSteps; Alpha"
+	// Each other line will contain a result for a actor in terms of:
 	// "Id; posX; posY; posZ; rotX; rotY; rotZ"
 	TArray<FString> ParsedSimulationResult;
-	PhysicsSimulationResultStr.ParseIntoArrayLines(ParsedSimulationResult);
+	PhysicsSimulationResult.ParseIntoArrayLines(ParsedSimulationResult);
+
+	// Flag to gather the PSD actors only once if any is missing. The clients
+	// may receive a body before its PSD actor is replicated
+	bool bHasGatheredPSDActors = false;
 
 	// Foreach line, parse its results (getting each actor pos)
 	for (auto& SimulationResultLine : ParsedSimulationResult)
 	{
+		// Skip the step info and contact lines. The alpha is given by the
+		// caller
+		if (SimulationResultLine.StartsWith("StepInfo") ||
+			SimulationResultLine.StartsWith("Contact"))
+		{
+			continue;
+		}
+
 		// Parse the line with ";" delimit
 		TArray<FString> ParsedActorSimulationResult;
 		SimulationResultLine.ParseIntoArray(ParsedActorSimulationResult,
@@ -146,9 +215,16 @@ void APSDActorsCoordinator_Local::UpdatePSDActors()
 		}
 
 		// Get the actor id to float
-		const uint32 ActorID = FCString::Atoi(*ParsedActorSimulationResult[0]);
+		const int32 ActorID = FCString::Atoi(*ParsedActorSimulationResult[0]);
 
 		// Check if the PSDActor exist with such id on the map
+		if (!PSDActorMap.Contains(ActorID) && !HasAuthority() &&
+			!bHasGatheredPSDActors)
+		{
+			GatherPSDActors();
+			bHasGatheredPSDActors = true;
+		}
+
 		if (!PSDActorMap.Contains(ActorID))
 		{
 			UE_LOG(LogTemp, Warning, TEXT("Could not find actor with id %d"),
@@ -157,7 +233,7 @@ void APSDActorsCoordinator_Local::UpdatePSDActors()
 		}
 
 		// Find the actor on the map
-		APSDActorBase* ActorToUpdate = PSDActorMap[ActorID];
+		APSDActorBase* ActorToUpdate = PSDActorMap.FindRef(ActorID);
 		if (!ActorToUpdate)
 		{
 			UE_LOG(LogTemp, Warning, TEXT("Actor with id %d is not valid."),
@@ -206,13 +282,25 @@ void APSDActorsCoordinator_Local::UpdatePSDActors()
 		ActorToUpdate->UpdateRotationAfterPhysicsSimulation(NewRotEuler);
 	}
 
-	LPES_LOG_INFO(TEXT("Physics updated for this frame."));
+	// Blend every PSD actor between its two last physics states
+	for (APSDActorBase* PSDActor : PSDActorMap.GetPSDActors())
+	{
+		if (PSDActor && !PSDActor->IsPSDActorStatic())
+		{
+			PSDActor->InterpolatePhysicsState(InterpolationAlpha);
+		}
+	}
 }
 
-void APSDActorsCoordinator_Local::StartPSDActorsSimulation
-	(const TArray<FString>& SocketServerIpAddrList)
+void APSDActorsCoordinator_Local::GatherPSDActors()
 {
-	LPES_LOG_WARNING(TEXT("Starting PSD actors simulation."));
+	PSDActorMap.Empty();
+
+	// The server gives the body indices, which are replicated to the clients
+	if (HasAuthority())
+	{
+		BodyIndexAllocator.Reset();
+	}
 
 	// Get all PSDActors
 	TArray<AActor*> FoundActors;
@@ -230,15 +318,303 @@ void APSDActorsCoordinator_Local::StartPSDActorsSimulation
 		}
 
 		// Get the PSDActor body id
-		const auto PSDActorBodyId = PSDActor->GetPSDActorBodyId();
+		const auto PSDActorBodyId = HasAuthority() ?
+			BodyIndexAllocator.AllocateBodyIndex(PSDActor) :
+			PSDActor->GetPSDActorBodyId();
 
 		// Add to map 
 		// The key is the body id on the physics system.
 		// The value is the reference to the actor
 		PSDActorMap.Add(PSDActorBodyId, PSDActor);
 	}
+}
 
-	PhysicsServiceLocalImpl = new FPhysicsServiceImpl();
+void APSDActorsCoordinator_Local::DestroyPhysicsWorld()
+{
+	if (!PhysicsServiceLocalImpl)
+	{
+		return;
+	}
+
+	FPhysicsServiceWorldManager::Get().DestroyWorld
+		(PhysicsServiceLocalImpl->GetWorldId());
+	PhysicsServiceLocalImpl = nullptr;
+}
+
+void APSDActorsCoordinator_Local::AddPSDActorToSimulation
+	(APSDActorBase* PSDActorToAdd)
+{
+	if (!HasAuthority() || !PSDActorToAdd)
+	{
+		return;
+	}
+
+	const int32 PSDActorToAddBodyId =
+		BodyIndexAllocator.AllocateBodyIndex(PSDActorToAdd);
+	if (PSDActorToAddBodyId == INDEX_NONE)
+	{
+		return;
+	}
+
+	PSDActorMap.Add(PSDActorToAddBodyId, PSDActorToAdd);
+
+	// The clients run the simulation locally on lockstep
+	if (bUseLockstepSimulation)
+	{
+		PSDActorToAdd->SetReplicateMovement(false);
+	}
+
+	PendingSimulationCommands.Add(FString::Printf(TEXT("AddBody;%s"),
+		*PSDActorToAdd->GetPhysicsServiceInitializationString()
+		.TrimStartAndEnd()));
+}
+
+void APSDActorsCoordinator_Local::RemovePSDActorFromSimulation
+	(APSDActorBase* PSDActorToRemove)
+{
+	if (!HasAuthority() || !PSDActorToRemove)
+	{
+		return;
+	}
+
+	const int32 PSDActorToRemoveBodyId = PSDActorToRemove->GetPSDActorBodyId();
+	if (!PSDActorMap.Remove(PSDActorToRemoveBodyId))
+	{
+		return;
+	}
+
+	PendingSimulationCommands.Add(FString::Printf(TEXT("RemoveBody;%d"),
+		PSDActorToRemoveBodyId));
+
+	// The index is only recycled after the body removal is queued, so a
+	// later addition on the same step gets it after the removal
+	BodyIndexAllocator.ReleaseBodyIndex(PSDActorToRemove);
+}
+
+void APSDActorsCoordinator_Local::AddImpulseToPSDActor
+	(APSDActorBase* PSDActorToPush, const FVector& Impulse)
+{
+	if (!HasAuthority() || !PSDActorToPush)
+	{
+		return;
+	}
+
+	PendingSimulationCommands.Add(FString::Printf(TEXT("Impulse;%d;%.9g;%.9g;"
+		"%.9g"), PSDActorToPush->GetPSDActorBodyId(), Impulse.X, Impulse.Y,
+		Impulse.Z));
+}
+
+void APSDActorsCoordinator_Local::SendLockstepSnapshot()
+{
+	if (!HasAuthority() || !bIsSimulatingPhysics || !bUseLockstepSimulation)
+	{
+		return;
+	}
+
+	// Save the world as it is between steps. Any pending command is sent
+	// with the next frame, so clients apply it after restoring
+	const FString WorldSnapshot = PhysicsServiceLocalImpl->SaveWorldSnapshot();
+	if (WorldSnapshot.IsEmpty())
+	{
+		return;
+	}
+
+	// Send the snapshot in chunks. They are reliable and ordered with the
+	// frames, so clients restore it exactly between the same frames
+	const int32 NumberOfChunks = FMath::DivideAndRoundUp(WorldSnapshot.Len(),
+		LockstepSnapshotChunkSize);
+	LockstepSnapshotId++;
+
+	for (int32 ChunkIndex = 0; ChunkIndex < NumberOfChunks; ChunkIndex++)
+	{
+		ReceiveLockstepSnapshotChunk(LockstepSnapshotId, ChunkIndex,
+			NumberOfChunks, WorldSnapshot.Mid(ChunkIndex *
+			LockstepSnapshotChunkSize, LockstepSnapshotChunkSize));
+	}
+
+	LPES_LOG_INFO(TEXT("Lockstep snapshot %d sent on step %u (%d chunks)."),
+		LockstepSnapshotId, PhysicsServiceLocalImpl->StepPhysicsCounter,
+		NumberOfChunks);
+}
+
+bool APSDActorsCoordinator_Local::ConsumeLockstepResyncRequest()
+{
+	const bool bShouldRequestResync = bHasPendingLockstepResyncRequest;
+	bHasPendingLockstepResyncRequest = false;
+
+	return bShouldRequestResync;
+}
+
+void APSDActorsCoordinator_Local::RequestLockstepResync()
+{
+	bIsAwaitingLockstepSnapshot = true;
+	bHasPendingLockstepResyncRequest = true;
+	LockstepResyncRequestTime = GetWorld()->GetTimeSeconds();
+}
+
+void APSDActorsCoordinator_Local::ReceiveLockstepFrame_Implementation
+	(const uint32 FirstStepIndex, const int32 NumberOfSteps,
+	const TArray<FString>& SimulationCommands, const float InterpolationAlpha,
+	const uint32 StateChecksum)
+{
+	// The server has already run this frame
+	if (HasAuthority())
+	{
+		return;
+	}
+
+	// Ignore the frames until the snapshot arrives. If it takes too long
+	// (e.g. this client joined in the middle of one), request it again
+	if (bIsAwaitingLockstepSnapshot)
+	{
+		if (GetWorld()->GetTimeSeconds() - LockstepResyncRequestTime >
+			LockstepResyncTimeoutSeconds)
+		{
+			RequestLockstepResync();
+		}
+
+		return;
+	}
+
+	// Check if the frame continues from this client's world. If not, a frame
+	// was missed or there is no world yet
+	if (!PhysicsServiceLocalImpl || PhysicsServiceLocalImpl->
+		StepPhysicsCounter != FirstStepIndex)
+	{
+		LPES_LOG_WARNING(TEXT("Lockstep frame on step %u does not match this "
+			"client's world. Requesting resync."), FirstStepIndex);
+		RequestLockstepResync();
+		return;
+	}
+
+	// Apply the commands and run the same steps as the server
+	for (const FString& SimulationCommand : SimulationCommands)
+	{
+		PhysicsServiceLocalImpl->ApplySimulationCommand(SimulationCommand);
+	}
+
+	PhysicsServiceLocalImpl->RunStepRequest(NumberOfSteps);
+
+	// Check if this client is still on the same state as the server
+	if (StateChecksum != 0)
+	{
+		const uint32 ClientStateChecksum =
+			PhysicsServiceLocalImpl->GetStateChecksum();
+		if (ClientStateChecksum != StateChecksum)
+		{
+			// The first divergent step is after the last one checked
+			LPES_LOG_WARNING(TEXT("Lockstep world diverged on step %u "
+				"(checksum: %u; server: %u). First divergent step is within "
+				"(%u, %u]. Requesting resync."),
+				PhysicsServiceLocalImpl->StepPhysicsCounter,
+				ClientStateChecksum, StateChecksum,
+				LastVerifiedLockstepStepIndex,
+				PhysicsServiceLocalImpl->StepPhysicsCounter);
+			RequestLockstepResync();
+			return;
+		}
+
+		LastVerifiedLockstepStepIndex =
+			PhysicsServiceLocalImpl->StepPhysicsCounter;
+	}
+
+	// Update the PSD actors from this client's world
+	ApplyPhysicsSimulationResult(NumberOfSteps > 0 ?
+		PhysicsServiceLocalImpl->GetBodiesStateResponse() : FString(),
+		InterpolationAlpha);
+}
+
+void APSDActorsCoordinator_Local::ReceiveLockstepSnapshotChunk_Implementation
+	(const int32 SnapshotId, const int32 ChunkIndex, const int32 NumberOfChunks,
+	const FString& SnapshotChunk)
+{
+	if (HasAuthority())
+	{
+		return;
+	}
+
+	// Check if this is the first chunk of a new snapshot
+	if (SnapshotId != LockstepSnapshotId)
+	{
+		LockstepSnapshotId = SnapshotId;
+		ReceivedLockstepSnapshotChunks.Empty(NumberOfChunks);
+		ReceivedLockstepSnapshotChunks.SetNum(NumberOfChunks);
+		ReceivedLockstepSnapshotChunksCount = 0;
+		bIsAwaitingLockstepSnapshot = true;
+	}
+
+	if (!ReceivedLockstepSnapshotChunks.IsValidIndex(ChunkIndex))
+	{
+		return;
+	}
+
+	ReceivedLockstepSnapshotChunks[ChunkIndex] = SnapshotChunk;
+	ReceivedLockstepSnapshotChunksCount++;
+
+	// Wait for the remaining chunks
+	if (ReceivedLockstepSnapshotChunksCount < NumberOfChunks)
+	{
+		return;
+	}
+
+	const FString WorldSnapshot = FString::Join
+		(ReceivedLockstepSnapshotChunks, TEXT(""));
+	ReceivedLockstepSnapshotChunks.Empty();
+	ReceivedLockstepSnapshotChunksCount = 0;
+
+	// Create this client's physics world, if not yet created
+	if (!PhysicsServiceLocalImpl)
+	{
+		PhysicsServiceLocalImpl =
+			FPhysicsServiceWorldManager::Get().CreateWorld(GetUniqueID());
+	}
+
+	// Restore the server's world
+	if (!PhysicsServiceLocalImpl->RestoreWorldSnapshot(WorldSnapshot))
+	{
+		LPES_LOG_ERROR(TEXT("Could not restore lockstep snapshot %d."),
+			SnapshotId);
+		RequestLockstepResync();
+		return;
+	}
+
+	bIsAwaitingLockstepSnapshot = false;
+	LastVerifiedLockstepStepIndex =
+		PhysicsServiceLocalImpl->StepPhysicsCounter;
+
+	LPES_LOG_INFO(TEXT("Lockstep snapshot %d restored on step %u."),
+		SnapshotId, PhysicsServiceLocalImpl->StepPhysicsCounter);
+
+	// Update the PSD actors from the restored world
+	GatherPSDActors();
+	ApplyPhysicsSimulationResult(PhysicsServiceLocalImpl->
+		GetBodiesStateResponse(), PhysicsServiceLocalImpl->
+		GetInterpolationAlpha());
+}
+
+void APSDActorsCoordinator_Local::StartPSDActorsSimulation
+	(const TArray<FString>& SocketServerIpAddrList)
+{
+	LPES_LOG_WARNING(TEXT("Starting PSD actors simulation."));
+
+	// Get all PSDActors
+	GatherPSDActors();
+
+	// On lockstep, the clients run the simulation themselves. Thus, the PSD
+	// actors' movement must not be replicated
+	if (bUseLockstepSimulation)
+	{
+		for (APSDActorBase* PSDActor : PSDActorMap.GetPSDActors())
+		{
+			PSDActor->SetReplicateMovement(false);
+		}
+	}
+
+	// Create this coordinator's physics world on the world manager. The
+	// coordinator unique id is used as world id, so multiple coordinators on
+	// the same process never share a world
+	PhysicsServiceLocalImpl = 
+		FPhysicsServiceWorldManager::Get().CreateWorld(GetUniqueID());
 	if (!PhysicsServiceLocalImpl)
 	{
 		UE_LOG(LogTemp, Error, TEXT("Could not create physics impl instance"));
@@ -252,6 +628,9 @@ void APSDActorsCoordinator_Local::StartPSDActorsSimulation
 
 	bIsSimulatingPhysics = true;
 
+	// Send the initial world to the clients on lockstep
+	SendLockstepSnapshot();
+
 	LPES_LOG_WARNING(TEXT("PSD actors started simulating..."));
 }
 
@@ -282,6 +661,12 @@ void APSDActorsCoordinator_Local::StopPSDActorsSimulation()
 	// Set the flag to false to stop ticking PSDActors' update
 	bIsSimulatingPhysics = false;
 
+	// Only the server (or a client with a lockstep world) has a physics world
+	if (!PhysicsServiceLocalImpl)
+	{
+		return;
+	}
+
 	// Get the step physics time measurements on physics implementation
 	StepPhysicsTimeMeasure = PhysicsServiceLocalImpl->GetSimulationMeasures();
 
@@ -294,6 +679,23 @@ void APSDActorsCoordinator_Local::StopPSDActorsSimulation()
 		SaveAllocatedRamMeasurements();
 	}
 
+	// Give the PSD actors' movement replication back
+	if (HasAuthority() && bUseLockstepSimulation)
+	{
+		for (APSDActorBase* PSDActor : PSDActorMap.GetPSDActors())
+		{
+			if (PSDActor)
+			{
+				PSDActor->SetReplicateMovement(true);
+			}
+		}
+	}
+
+	PendingSimulationCommands.Empty();
+
+	// Destroy this coordinator's physics world
+	DestroyPhysicsWorld();
+
 	LPES_LOG_INFO(TEXT("PSD actors simulation has been stopped."));
 }
 
@@ -348,18 +750,25 @@ void APSDActorsCoordinator_Local::SaveDeltaTimeMeasurementToFile_Implementation(
 void APSDActorsCoordinator_Local::SaveStepPhysicsTimeMeasureToFile_Implementation()
 const
 {
-	FString TargetFolder = TEXT("StepPhysicsMeasureWithoutCommsOverhead");
-	FString FullFolderPath =
-		FString(FPlatformProcess::UserDir() + TargetFolder);
-
-	FullFolderPath = FullFolderPath.Replace(TEXT("/"), TEXT("\\\\"));
-
-	//Criando diretrio se j no existe
-	if (!IFileManager::Get().DirectoryExists(*FullFolderPath))
+	// Split the step phases from the step times, so each is saved on its
+	// own file
+	TArray<FString> MeasureLines;
+	StepPhysicsTimeMeasure.ParseIntoArrayLines(MeasureLines);
+
+	FString StepTimeMeasure = FString();
+	FString StepPhasesMeasure = FString("Phases;StepMicroseconds;BroadPhase;"
+		"NarrowPhase;ConstraintSetup;SolveVelocity;SolvePosition;Integration;"
+		"Other;JobCount;ThreadUtilisation\n");
+	for (const FString& MeasureLine : MeasureLines)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("Criando diretorio: %s"),
-			*FullFolderPath);
-		IFileManager::Get().MakeDirectory(*FullFolderPath);
+		if (MeasureLine.StartsWith(TEXT("Phases;")))
+		{
+			StepPhasesMeasure += MeasureLine + "\n";
+		}
+		else
+		{
+			StepTimeMeasure += MeasureLine + "\n";
+		}
 	}
 
 	// Get the current world
@@ -371,26 +780,50 @@ const
 	// Get the map name
 	FString MapName = CurrentLevel->GetOuter()->GetName();
 
-	int32 FileCount = 1;
-	FString FileName = FString::Printf(TEXT("/StepPhysicsTime_%s_%d.txt"),
-		*MapName, FileCount);
+	// Saves a measure on a new file of the target folder
+	auto SaveMeasureToNewFile = [&MapName](const FString& TargetFolder,
+		const FString& FilePrefix, const FString& Measure)
+	{
+		FString FullFolderPath =
+			FString(FPlatformProcess::UserDir() + TargetFolder);
 
-	FString FileFullPath = FPlatformProcess::UserDir() + TargetFolder +
-		FileName;
+		FullFolderPath = FullFolderPath.Replace(TEXT("/"), TEXT("\\\\"));
 
-	while (IFileManager::Get().FileExists(*FileFullPath))
-	{
-		FileCount++;
-		FileName = FString::Printf(TEXT("/StepPhysicsTime_%s_%d.txt"),
+		//Criando diretrio se j no existe
+		if (!IFileManager::Get().DirectoryExists(*FullFolderPath))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Criando diretorio: %s"),
+				*FullFolderPath);
+			IFileManager::Get().MakeDirectory(*FullFolderPath);
+		}
+
+		int32 FileCount = 1;
+		FString FileName = FString::Printf(TEXT("/%s_%s_%d.txt"), *FilePrefix,
 			*MapName, FileCount);
 
-		FileFullPath = FPlatformProcess::UserDir() + TargetFolder + FileName;
-	}
+		FString FileFullPath = FPlatformProcess::UserDir() + TargetFolder +
+			FileName;
 
-	LPES_LOG_WARNING(TEXT("Saving step physics time measurement into \"%s\""),
-		*FileFullPath);
+		while (IFileManager::Get().FileExists(*FileFullPath))
+		{
+			FileCount++;
+			FileName = FString::Printf(TEXT("/%s_%s_%d.txt"), *FilePrefix,
+				*MapName, FileCount);
+
+			FileFullPath = FPlatformProcess::UserDir() + TargetFolder +
+				FileName;
+		}
+
+		LPES_LOG_WARNING(TEXT("Saving step physics measurement into \"%s\""),
+			*FileFullPath);
+
+		FFileHelper::SaveStringToFile(Measure, *FileFullPath);
+	};
 
-	FFileHelper::SaveStringToFile(StepPhysicsTimeMeasure, *FileFullPath);
+	SaveMeasureToNewFile(TEXT("StepPhysicsMeasureWithoutCommsOverhead"),
+		TEXT("StepPhysicsTime"), StepTimeMeasure);
+	SaveMeasureToNewFile(TEXT("StepPhysicsPhasesMeasure"),
+		TEXT("StepPhysicsPhases"), StepPhasesMeasure);
 }
 
 void APSDActorsCoordinator_Local::SaveUsedRamMeasurements_Implementation() const
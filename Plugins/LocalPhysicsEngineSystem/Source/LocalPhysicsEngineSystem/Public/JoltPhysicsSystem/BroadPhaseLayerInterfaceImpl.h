@@ -25,7 +25,9 @@ namespace BroadPhaseLayers
 {
 	static constexpr BroadPhaseLayer NON_MOVING(0);
 	static constexpr BroadPhaseLayer MOVING(1);
-	static constexpr uint NUM_LAYERS(2);
+	static constexpr BroadPhaseLayer GHOST(2);
+	static constexpr BroadPhaseLayer SENSOR(3);
+	static constexpr uint NUM_LAYERS(4);
 };
 
 /**
@@ -49,6 +51,10 @@ public:
 			return "NON_MOVING";
 		case (BroadPhaseLayer::Type)BroadPhaseLayers::MOVING:
 			return "MOVING";
+		case (BroadPhaseLayer::Type)BroadPhaseLayers::GHOST:
+			return "GHOST";
+		case (BroadPhaseLayer::Type)BroadPhaseLayers::SENSOR:
+			return "SENSOR";
 		default:
 			JPH_ASSERT(false);
 			return "INVALID";
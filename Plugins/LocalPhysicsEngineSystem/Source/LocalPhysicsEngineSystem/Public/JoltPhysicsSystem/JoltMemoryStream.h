@@ -0,0 +1,66 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// The Jolt headers don't include Jolt.h. Always include Jolt.h before including any other Jolt header.
+// You can use Jolt.h in your precompiled header to speed up compilation.
+#include <Jolt/Jolt.h>
+
+// Jolt includes
+#include <Jolt/Core/StreamIn.h>
+#include <Jolt/Core/StreamOut.h>
+
+// All Jolt symbols are in the JPH namespace
+using namespace JPH;
+
+/** Jolt input stream that reads from a memory buffer */
+class FMemoryStreamIn : public StreamIn
+{
+public:
+	FMemoryStreamIn(const TArray<uint8>& InBuffer, const int32 InOffset)
+		: Buffer(InBuffer), Offset(InOffset) { }
+
+	virtual void ReadBytes(void* outData, size_t inNumBytes) override
+	{
+		if (bIsFailed || Offset + static_cast<int64>(inNumBytes) >
+			Buffer.Num())
+		{
+			bIsFailed = true;
+			return;
+		}
+
+		FMemory::Memcpy(outData, Buffer.GetData() + Offset, inNumBytes);
+		Offset += inNumBytes;
+	}
+
+	virtual bool IsEOF() const override
+		{ return Offset >= Buffer.Num(); }
+
+	virtual bool IsFailed() const override { return bIsFailed; }
+
+private:
+	const TArray<uint8>& Buffer;
+	int64 Offset = 0;
+	bool bIsFailed = false;
+};
+
+/** Jolt output stream that writes to a memory buffer */
+class FMemoryStreamOut : public StreamOut
+{
+public:
+	explicit FMemoryStreamOut(TArray<uint8>& InBuffer) : Buffer(InBuffer)
+		{ }
+
+	virtual void WriteBytes(const void* inData, size_t inNumBytes)
+		override
+	{
+		Buffer.Append(static_cast<const uint8*>(inData), inNumBytes);
+	}
+
+	virtual bool IsFailed() const override { return false; }
+
+private:
+	TArray<uint8>& Buffer;
+};
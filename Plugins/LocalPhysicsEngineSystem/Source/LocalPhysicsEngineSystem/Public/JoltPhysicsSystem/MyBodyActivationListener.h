@@ -12,6 +12,8 @@
 #include <Jolt/Physics/PhysicsSystem.h>
 #include <Jolt/Physics/Body/BodyActivationListener.h>
 
+#include "PhysicsEventBuffer.h"
+
 // STL includes
 #include <iostream>
 
@@ -22,12 +24,21 @@ using namespace JPH;
 using namespace JPH::literals;
 
 /**
- * 
- */
+* The body activation listener. This is called from the Jolt job threads, so
+* it only records the activation changes on the world's event buffer, which
+* is drained once the step is over.
+*/
 class LOCALPHYSICSENGINESYSTEM_API FMyBodyActivationListener : public BodyActivationListener
 {
 public:
+	FMyBodyActivationListener(FPhysicsEventBuffer& InEventBuffer)
+		: EventBuffer(InEventBuffer) {}
+
 	virtual void OnBodyActivated(const BodyID& inBodyID, uint64 inBodyUserData) override;
 
 	virtual void OnBodyDeactivated(const BodyID& inBodyID, uint64 inBodyUserData) override;
+
+private:
+	/** The event buffer to record the activation changes on */
+	FPhysicsEventBuffer& EventBuffer;
 };
@@ -11,6 +11,8 @@
 // Jolt includes
 #include <Jolt/Physics/PhysicsSystem.h>
 
+#include "PhysicsEventBuffer.h"
+
 // STL includes
 #include <iostream>
 
@@ -21,11 +23,16 @@ using namespace JPH;
 using namespace JPH::literals;
 
 /**
- * 
- */
+* The contact listener. This is called from the Jolt job threads, so it only
+* records the added and removed contacts on the world's event buffer, which is
+* drained once the step is over.
+*/
 class LOCALPHYSICSENGINESYSTEM_API FMyContactListener : public ContactListener
 {
 public:
+	FMyContactListener(FPhysicsEventBuffer& InEventBuffer)
+		: EventBuffer(InEventBuffer) {}
+
 	// See: ContactListener
 	virtual ValidateResult OnContactValidate(const Body& inBody1, const Body& inBody2, RVec3Arg inBaseOffset, const CollideShapeResult& inCollisionResult) override;
 
@@ -34,4 +41,17 @@ public:
 	virtual void OnContactPersisted(const Body& inBody1, const Body& inBody2, const ContactManifold& inManifold, ContactSettings& ioSettings) override;
 
 	virtual void OnContactRemoved(const SubShapeIDPair& inSubShapePair) override;
+
+private:
+	/**
+	* Estimates the impulse magnitude of a new contact. The contact impulse is
+	* only solved later on the step, so this uses the bodies' approaching speed
+	* along the contact normal, their masses and the combined restitution.
+	*/
+	static float EstimateContactImpulse(const Body& inBody1, const Body& inBody2,
+		const ContactManifold& inManifold, const ContactSettings& inSettings);
+
+private:
+	/** The event buffer to record the contacts on */
+	FPhysicsEventBuffer& EventBuffer;
 };
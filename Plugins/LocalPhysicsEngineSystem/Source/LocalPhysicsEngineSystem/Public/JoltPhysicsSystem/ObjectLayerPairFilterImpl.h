@@ -25,7 +25,16 @@ namespace Layers
 {
 	static constexpr ObjectLayer NON_MOVING = 0;
 	static constexpr ObjectLayer MOVING = 1;
-	static constexpr ObjectLayer NUM_LAYERS = 2;
+	// Kinematic clones of bodies simulated by a neighbouring region's service,
+	// and the players' capsules. They only push the moving bodies and are
+	// detected by the sensors, so they never collide with each other or with
+	// the static bodies
+	static constexpr ObjectLayer GHOST = 2;
+	// Kinematic trigger volumes. They only detect the moving and ghost
+	// bodies, and are kept away from the static bodies and from each other,
+	// as active sensors would otherwise pair with them on the broad phase
+	static constexpr ObjectLayer SENSOR = 3;
+	static constexpr ObjectLayer NUM_LAYERS = 4;
 };
 
 /**
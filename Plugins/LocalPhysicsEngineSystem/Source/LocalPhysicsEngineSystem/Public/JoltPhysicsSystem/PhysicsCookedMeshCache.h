@@ -0,0 +1,143 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+
+// The Jolt headers don't include Jolt.h. Always include Jolt.h before including any other Jolt header.
+// You can use Jolt.h in your precompiled header to speed up compilation.
+#include <Jolt/Jolt.h>
+
+// Jolt includes
+#include <Jolt/Physics/Collision/Shape/Shape.h>
+
+// All Jolt symbols are in the JPH namespace
+using namespace JPH;
+
+/**
+* A cache of cooked mesh shapes. Cooking converts the collision exported from
+* an Unreal static mesh into a Jolt shape: a MeshShape for triangle meshes,
+* whose AABB tree is built with the bundled AABBTree and TriangleSplitter code,
+* or ConvexHullShapes for convex elements. The heights sampled from a
+* landscape are cooked into a HeightFieldShape, and the primitives of a
+* multi-part actor into a StaticCompoundShape.
+*
+* Cooking a big mesh is slow, so each mesh is cooked only once and addressed
+* by the hash of its collision data. Cooked shapes are kept on memory, shared
+* by every world on the process, and saved on disk as Jolt binary shapes, so
+* a mesh is never cooked again, even after the physics service restarts.
+*/
+class LOCALPHYSICSENGINESYSTEM_API FPhysicsCookedMeshCache
+{
+public:
+	/**
+	* Finds a cooked mesh shape. The memory is searched first, then the disk.
+	*
+	* @param MeshHash The hash of the mesh collision data
+	*
+	* @return The cooked shape. Nullptr if not cooked yet
+	*/
+	ShapeRefC FindCookedMesh(const FString& MeshHash);
+
+	/**
+	* Cooks a mesh shape and adds it to the cache, saving it on disk. The
+	* template is:
+	*
+	* "MeshHash; CollisionType\n
+	* Hull; VerticesBase64\n
+	* ...
+	* Vertices; VerticesBase64\n
+	* Indices; IndicesBase64\n"
+	*
+	* The "convex" collision type has one "Hull" line for each convex element,
+	* and the "mesh" collision type has the "Vertices" and "Indices" lines. The
+	* vertices are encoded as float triples and the indices as uint32 triples.
+	*
+	* The "heightfield" collision type has the "HeightField; SampleCount;
+	* SampleSpacing; BlockSize" and "Heights; HeightsBase64" lines. The
+	* heights are SampleCount * SampleCount floats, row by row along X: the
+	* height at [y * SampleCount + x] is on (x * SampleSpacing, y *
+	* SampleSpacing). A height of FLT_MAX is a hole. SampleCount / BlockSize
+	* must be a power of 2, and the block size from 2 to 8.
+	*
+	* The "compound" collision type has a line for each primitive, on the
+	* actor's space: "Sphere; posX; posY; posZ; radius", "Box; pos (3); rot
+	* (4); halfExtentX; halfExtentY; halfExtentZ" or "Capsule; pos (3); rot
+	* (4); cylinderHalfHeight; radius", with the capsule along its Z-axis.
+	*
+	* @param CookMeshInfo The mesh collision data to cook
+	*
+	* @return The cook result message
+	*/
+	FString CookMesh(const FString& CookMeshInfo);
+
+	/** Empties the memory cache. The cooked meshes on disk are kept */
+	void Empty();
+
+private:
+	/** Getter to the file path a cooked mesh is saved on */
+	static FString GetCookedMeshFilePath(const FString& MeshHash);
+
+	/**
+	* Loads a cooked mesh from disk.
+	*
+	* @return The cooked shape. Nullptr if there is no file or if the file is
+	* invalid
+	*/
+	static ShapeRefC LoadCookedMeshFile(const FString& MeshHash);
+
+	/** Saves a cooked mesh on disk */
+	static void SaveCookedMeshFile(const FString& MeshHash,
+		const Shape& CookedMesh);
+
+	/**
+	* Decodes a base64 line value into an array of elements.
+	*
+	* @return True if decoded and the data size is a multiple of the element
+	* size
+	*/
+	template <typename ElementType>
+	static bool DecodeMeshData(const FString& EncodedData,
+		TArray<ElementType>& OutElements);
+
+	/**
+	* Cooks the "heightfield" collision type's lines into a height field on
+	* the Z-up space of the other cooked meshes.
+	*
+	* @param CookMeshLines The cook lines, after the header
+	* @param OutCookResult The cooked shape or the error
+	*
+	* @return False if the lines could not be parsed
+	*/
+	static bool CookHeightField(const TArray<FString>& CookMeshLines,
+		ShapeSettings::ShapeResult& OutCookResult);
+
+	/**
+	* Cooks the "compound" collision type's primitive lines into a single
+	* static compound.
+	*
+	* @param CookMeshLines The cook lines, after the header
+	* @param OutCookResult The cooked shape or the error
+	*
+	* @return False if any line could not be parsed
+	*/
+	static bool CookCompound(const TArray<FString>& CookMeshLines,
+		ShapeSettings::ShapeResult& OutCookResult);
+
+private:
+	/** The cooked meshes on memory. The key is the mesh hash */
+	TMap<FString, ShapeRefC> CookedMeshes;
+
+	/** Critical section to synchronize access to the cache */
+	FCriticalSection CacheCriticalSection;
+
+	/** The tag that starts every cooked mesh file ("JPCM") */
+	static constexpr uint32 CookedMeshFileTag = 0x4D43504A;
+
+	/**
+	* The cooked mesh file version. Must be increased whenever the way meshes
+	* are cooked changes, so older files are cooked again
+	*/
+	static constexpr uint32 CookedMeshFileVersion = 1;
+};
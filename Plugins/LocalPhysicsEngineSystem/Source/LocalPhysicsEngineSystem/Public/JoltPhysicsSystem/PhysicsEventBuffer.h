@@ -0,0 +1,130 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/UniquePtr.h"
+
+// The Jolt headers don't include Jolt.h. Always include Jolt.h before including any other Jolt header.
+// You can use Jolt.h in your precompiled header to speed up compilation.
+#include <Jolt/Jolt.h>
+
+// Jolt includes
+#include <Jolt/Physics/Body/BodyID.h>
+
+// STL includes
+#include <atomic>
+
+// All Jolt symbols are in the JPH namespace
+using namespace JPH;
+
+/** The types of events recorded during a physics step */
+enum class EPhysicsServiceEventType : uint8
+{
+	BodyActivated,
+	BodyDeactivated,
+	ContactAdded,
+	ContactRemoved
+};
+
+/**
+* A physics event recorded during a physics step. Activation events only fill
+* the first body. The contact point, normal and impulse are only filled on
+* "ContactAdded" events.
+*/
+struct FPhysicsServiceEvent
+{
+	/** The event type */
+	EPhysicsServiceEventType EventType = EPhysicsServiceEventType::BodyActivated;
+
+	/** The first body of the event */
+	BodyID Body1;
+
+	/** The second body of the event. Invalid on activation events */
+	BodyID Body2;
+
+	/** The contact point on world space */
+	Float3 ContactPoint = Float3(0.f, 0.f, 0.f);
+
+	/** The contact normal, pointing from the first body to the second */
+	Float3 ContactNormal = Float3(0.f, 0.f, 0.f);
+
+	/**
+	* The estimated impulse magnitude of the contact. This is estimated when
+	* the contact is added, from the bodies' approaching speed and masses
+	*/
+	float ImpulseMagnitude = 0.f;
+};
+
+/**
+* A lock-free buffer of physics events. The physics listeners are called from
+* the Jolt job threads, so each thread writes into its own preallocated slot,
+* reserving its entries with an atomic counter. No lock is ever taken and no
+* memory is allocated while the physics system is updating.
+*
+* The events should be drained once the step is over, when no job thread is
+* writing anymore. If a slot gets full, new events on it are dropped and
+* counted.
+*/
+class LOCALPHYSICSENGINESYSTEM_API FPhysicsEventBuffer
+{
+public:
+	/**
+	* Creates the event buffer, preallocating every thread slot.
+	*
+	* @param InEventsPerThreadSlot The max amount of events each thread slot
+	* can hold between two drains
+	*/
+	FPhysicsEventBuffer(const uint32 InEventsPerThreadSlot =
+		DefaultEventsPerThreadSlot);
+
+	/**
+	* Records a new event on the calling thread's slot. Safe to be called from
+	* any thread while the physics system is updating.
+	*
+	* @param NewEvent The event to record
+	*/
+	void PushEvent(const FPhysicsServiceEvent& NewEvent);
+
+	/**
+	* Moves every recorded event to the given array and resets the buffer.
+	* This must not be called while the physics system is updating.
+	*
+	* @param OutEvents The array to append the recorded events to
+	*
+	* @return The amount of events dropped since the last drain, as their
+	* slot was full
+	*/
+	uint32 DrainEvents(TArray<FPhysicsServiceEvent>& OutEvents);
+
+public:
+	/** The default max amount of events each thread slot can hold */
+	static constexpr uint32 DefaultEventsPerThreadSlot = 1024;
+
+private:
+	/**
+	* Gets the calling thread ordinal. Each thread receives a sequential
+	* ordinal the first time it records an event.
+	*/
+	static uint32 GetCurrentThreadOrdinal();
+
+private:
+	/**
+	* A single thread slot. Aligned to the cache line so threads writing to
+	* different slots don't contend on the same line.
+	*/
+	struct alignas(64) FThreadSlot
+	{
+		/** The preallocated events */
+		TArray<FPhysicsServiceEvent> Events;
+
+		/** The amount of entries reserved on this slot */
+		std::atomic<uint32> ReservedEventsCount{ 0 };
+	};
+
+	/** The thread slots. A thread writes on the slot of its ordinal */
+	TArray<TUniquePtr<FThreadSlot>> ThreadSlots;
+
+	/** The max amount of events each thread slot can hold */
+	uint32 EventsPerThreadSlot = DefaultEventsPerThreadSlot;
+};
@@ -0,0 +1,71 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// The Jolt headers don't include Jolt.h. Always include Jolt.h before including any other Jolt header.
+// You can use Jolt.h in your precompiled header to speed up compilation.
+#include <Jolt/Jolt.h>
+
+// Jolt includes
+#include <Jolt/Core/JobSystem.h>
+
+// All Jolt symbols are in the JPH namespace
+using namespace JPH;
+
+/**
+* Splits the items [0, Num) in batches, one job each, runs them on a job
+* system and waits for every batch. The calling thread also runs jobs while
+* waiting.
+*
+* A single batch is run on the calling thread, as a job would only add the
+* scheduling cost. Every batch is also run there if the job system has no
+* barrier to spare.
+*
+* @param BatchesJobSystem The job system to run the batches on
+* @param Num The amount of items
+* @param MinPerJob The min amount of items on each batch
+* @param JobName The name of the batches' jobs, as shown by the profilers
+* @param BatchFunction Called once for each batch with its first item index
+* and the index after its last item. May be called from any job system
+* thread
+*/
+template <typename FunctionType>
+void ParallelForBatches(JobSystem& BatchesJobSystem, const int32 Num,
+	const int32 MinPerJob, const char* JobName,
+	const FunctionType& BatchFunction)
+{
+	if (Num <= 0)
+	{
+		return;
+	}
+
+	const int32 NumberOfJobs = FMath::Clamp(FMath::DivideAndRoundUp(Num,
+		FMath::Max(MinPerJob, 1)), 1, BatchesJobSystem.GetMaxConcurrency());
+
+	JobSystem::Barrier* BatchesBarrier = NumberOfJobs > 1 ?
+		BatchesJobSystem.CreateBarrier() : nullptr;
+	if (!BatchesBarrier)
+	{
+		BatchFunction(0, Num);
+		return;
+	}
+
+	const int32 ItemsPerJob = FMath::DivideAndRoundUp(Num, NumberOfJobs);
+	for (int32 FirstIndex = 0; FirstIndex < Num; FirstIndex += ItemsPerJob)
+	{
+		const int32 LastIndex = FMath::Min(FirstIndex + ItemsPerJob, Num);
+
+		JobHandle BatchJob = BatchesJobSystem.CreateJob(JobName,
+			Color::sCyan, [&BatchFunction, FirstIndex, LastIndex]()
+		{
+			BatchFunction(FirstIndex, LastIndex);
+		});
+
+		BatchesBarrier->AddJob(BatchJob);
+	}
+
+	BatchesJobSystem.WaitForJobs(BatchesBarrier);
+	BatchesJobSystem.DestroyBarrier(BatchesBarrier);
+}
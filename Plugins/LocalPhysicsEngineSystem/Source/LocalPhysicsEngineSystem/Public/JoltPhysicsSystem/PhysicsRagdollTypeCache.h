@@ -0,0 +1,98 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+
+// The Jolt headers don't include Jolt.h. Always include Jolt.h before including any other Jolt header.
+// You can use Jolt.h in your precompiled header to speed up compilation.
+#include <Jolt/Jolt.h>
+
+// Jolt includes
+#include <Jolt/Physics/Ragdoll/Ragdoll.h>
+
+// All Jolt symbols are in the JPH namespace
+using namespace JPH;
+
+/** A ragdoll type registered on the cache */
+struct FPhysicsRagdollType
+{
+	/**
+	* The ragdoll's skeleton, parts and constraints. The parts are on the
+	* root part's space, as they are on the bind pose
+	*/
+	RefConst<RagdollSettings> Settings;
+
+	/** The amount of ragdolls of this type each world keeps on its pool */
+	int32 PoolSize = 0;
+};
+
+/**
+* A cache of ragdoll types. A type is the skeleton and the constraints of a
+* ragdoll, built from an Unreal physics asset, so it is sent and built only
+* once and then shared by every world on the process. The worlds instantiate
+* their pooled ragdolls from it.
+*
+* @see FPhysicsServiceRagdolls
+*/
+class LOCALPHYSICSENGINESYSTEM_API FPhysicsRagdollTypeCache
+{
+public:
+	/**
+	* Builds a ragdoll type and adds it to the cache. If a type with the same
+	* name is already registered, it is kept. The template is:
+	*
+	* "RagdollType; TypeName; PoolSize\n
+	* Part; BoneName; ParentPartIndex; ShapeType; SizeX; SizeY; SizeZ;
+	* shapeCenterX; shapeCenterY; shapeCenterZ; shapeRotX; shapeRotY;
+	* shapeRotZ; shapeRotW; Mass; posX; posY; posZ; rotX; rotY; rotZ; rotW;
+	* jointPosX; jointPosY; jointPosZ; twistAxisX; twistAxisY; twistAxisZ;
+	* planeAxisX; planeAxisY; planeAxisZ; Swing1Limit; Swing2Limit;
+	* TwistLimit\n
+	* ..."
+	*
+	* The parts' and joints' transforms are on the root part's space, on the
+	* bind pose, and the parents come before their children. The shape type
+	* is "capsule" (radius; 0; cylinder half height, along the z-axis), "box"
+	* (half extents) or "sphere" (radius; 0; 0), placed by the shape center
+	* and rotation relative to the part. The limits are in degrees: the
+	* swings around the joint's normal and plane axes and the twist around
+	* the twist axis, from -TwistLimit to TwistLimit.
+	*
+	* @param RagdollTypeInfo The ragdoll type to register
+	*
+	* @return The register result message
+	*/
+	FString RegisterRagdollType(const FString& RagdollTypeInfo);
+
+	/**
+	* Finds a ragdoll type.
+	*
+	* @param TypeName The ragdoll type name
+	* @param OutRagdollType The found ragdoll type
+	*
+	* @return False if no type with such name is registered
+	*/
+	bool FindRagdollType(const FString& TypeName,
+		FPhysicsRagdollType& OutRagdollType);
+
+	/** Empties the cache */
+	void Empty();
+
+private:
+	/**
+	* Adds a part to the ragdoll settings given its info line, split by ";".
+	*
+	* @return False if the line could not be parsed or its shape created
+	*/
+	static bool AddRagdollPart(RagdollSettings& Settings,
+		const TArray<FString>& PartInfo);
+
+private:
+	/** The registered ragdoll types. The key is the type name */
+	TMap<FString, FPhysicsRagdollType> RagdollTypes;
+
+	/** Critical section to synchronize access to the cache */
+	FCriticalSection CacheCriticalSection;
+};
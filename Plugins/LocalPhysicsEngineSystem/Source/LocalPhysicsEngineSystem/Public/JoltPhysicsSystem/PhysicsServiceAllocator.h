@@ -0,0 +1,209 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// The Jolt headers don't include Jolt.h. Always include Jolt.h before including any other Jolt header.
+// You can use Jolt.h in your precompiled header to speed up compilation.
+#include <Jolt/Jolt.h>
+
+// Jolt includes
+#include <Jolt/Core/TempAllocator.h>
+
+// STL includes
+#include <atomic>
+
+// All Jolt symbols are in the JPH namespace
+using namespace JPH;
+
+/** The backends the Jolt allocations can be routed to */
+enum class EPhysicsAllocatorBackend : uint8
+{
+	/** The C runtime heap, as Jolt's default allocator */
+	System,
+	/**
+	* Unreal's FMemory. The allocations go through the engine's malloc, which
+	* may be binned, mimalloc or any other the engine is set to use
+	*/
+	UnrealMemory,
+	/**
+	* Size-class free lists carved from arenas that are pre-faulted when
+	* reserved, optionally on huge pages. Big allocations go to FMemory
+	*/
+	Arena
+};
+
+/**
+* The Jolt allocator settings. These are read from the command line, as the
+* allocator must be set before any Jolt allocation:
+*
+* "-PhysicsAllocator=System|Unreal|Arena -PhysicsArenaChunkMB=64
+* -PhysicsHugePages"
+*/
+struct LOCALPHYSICSENGINESYSTEM_API FPhysicsAllocatorSettings
+{
+	/** The backend to route the Jolt allocations to */
+	EPhysicsAllocatorBackend Backend = EPhysicsAllocatorBackend::UnrealMemory;
+
+	/** The size of each arena reserved by the "Arena" backend */
+	uint64 ArenaChunkSize = 64 * 1024 * 1024;
+
+	/**
+	* If the arenas and temp allocators should be on huge pages. If the OS
+	* can't give huge pages, regular pages are used
+	*/
+	bool bUseHugePages = false;
+
+	/** Reads the settings from the process command line */
+	static FPhysicsAllocatorSettings FromCommandLine();
+};
+
+/**
+* The memory counters of a physics world. Every allocation keeps the counters
+* it was accounted on, so freeing it updates the same world, no matter which
+* thread or world frees it.
+*/
+struct LOCALPHYSICSENGINESYSTEM_API FPhysicsMemoryAccounting
+{
+	/** The bytes currently allocated, including the allocation headers */
+	std::atomic<int64> AllocatedBytes{ 0 };
+
+	/** The max "AllocatedBytes" since the last peak reset */
+	std::atomic<int64> PeakAllocatedBytes{ 0 };
+
+	/** The number of allocations made */
+	std::atomic<uint64> AllocationCount{ 0 };
+
+	/** The number of allocations freed */
+	std::atomic<uint64> FreeCount{ 0 };
+
+	/** The max bytes used on the temp allocator by a step */
+	std::atomic<uint32> TempAllocatorHighWaterMark{ 0 };
+
+	/** Records an allocation of the given size */
+	void RecordAllocation(const int64 Size);
+
+	/** Records a free of an allocation of the given size */
+	void RecordFree(const int64 Size);
+
+	/** Records the temp allocator bytes used by a step */
+	void RecordTempAllocatorUsage(const uint32 UsedBytes);
+
+	/** Resets the peak and high water mark to the current usage */
+	void ResetPeaks();
+
+	/**
+	* Gets the counters as a measurement line. The template is:
+	*
+	* "Memory; AllocatedBytes; PeakAllocatedBytes; AllocationCount;
+	* FreeCount; TempAllocatorHighWaterMark\n"
+	*/
+	FString GetMeasureLine() const;
+};
+
+/**
+* Accounts every Jolt allocation made on the calling thread to the given
+* counters while in scope. Scopes can be nested.
+*/
+class LOCALPHYSICSENGINESYSTEM_API FPhysicsMemoryAccountingScope
+{
+public:
+	FPhysicsMemoryAccountingScope(FPhysicsMemoryAccounting* InAccounting);
+	~FPhysicsMemoryAccountingScope();
+
+private:
+	/** The counters the thread was accounting on before this scope */
+	FPhysicsMemoryAccounting* PreviousAccounting = nullptr;
+};
+
+/**
+* Routes the Jolt allocation hooks to the configured backend and accounts
+* each allocation to the world that made it.
+*
+* @see FPhysicsAllocatorSettings
+*/
+class LOCALPHYSICSENGINESYSTEM_API FPhysicsServiceAllocator
+{
+public:
+	/**
+	* Sets the Jolt allocation hooks to the given backend. Must be called
+	* before any Jolt allocation, as the backend can't change afterwards.
+	*/
+	static void Register(const FPhysicsAllocatorSettings& Settings);
+
+	/**
+	* Releases the arenas if every allocation on them was freed. The hooks
+	* are kept, so Jolt objects freed after this still go to the backend.
+	*/
+	static void Unregister();
+
+	/**
+	* Getter to a world's memory counters. The counters live until the
+	* process ends, as allocations may outlive the world that made them.
+	*/
+	static FPhysicsMemoryAccounting* GetWorldAccounting(const int32 WorldId);
+
+	/** Getter to the counters of the allocations made outside any world */
+	static FPhysicsMemoryAccounting& GetUnattributedAccounting();
+
+	/**
+	* Allocates a big block for long lived buffers, such as the temp
+	* allocators. With the "Arena" backend, the block is pre-faulted (and on
+	* huge pages, if enabled).
+	*/
+	static void* AllocateLargeBlock(const uint64 Size);
+
+	/** Frees a block allocated with "AllocateLargeBlock()" */
+	static void FreeLargeBlock(void* Block, const uint64 Size);
+};
+
+/**
+* A temp allocator that tracks its high water mark. Like Jolt's
+* "TempAllocatorImpl", this is a stack on a block allocated upfront, but
+* allocations that don't fit fall back to the heap instead of crashing.
+*/
+class LOCALPHYSICSENGINESYSTEM_API FPhysicsTempAllocator final :
+	public TempAllocator
+{
+public:
+	/**
+	* Constructor.
+	*
+	* @param InSize The size of the block allocated upfront
+	*/
+	explicit FPhysicsTempAllocator(const uint32 InSize);
+	virtual ~FPhysicsTempAllocator() override;
+
+	// TempAllocator interface
+	virtual void* Allocate(uint inSize) override;
+	virtual void Free(void* inAddress, uint inSize) override;
+
+	/** Getter to the max bytes used since the last reset */
+	uint32 GetHighWaterMark() const { return HighWaterMark; }
+
+	/**
+	* Getter to the number of allocations that didn't fit on the block since
+	* the last reset
+	*/
+	uint32 GetOverflowCount() const { return OverflowCount; }
+
+	/** Resets the high water mark to the current usage and the overflows */
+	void ResetHighWaterMark() { HighWaterMark = Top; OverflowCount = 0; }
+
+private:
+	/** The block allocated upfront */
+	uint8* Base = nullptr;
+
+	/** The size of the block */
+	uint32 Size = 0;
+
+	/** The current top of the stack */
+	uint32 Top = 0;
+
+	/** The max top since the last reset */
+	uint32 HighWaterMark = 0;
+
+	/** The number of allocations that didn't fit since the last reset */
+	uint32 OverflowCount = 0;
+};
@@ -0,0 +1,169 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PhysicsWorldOrigin.h"
+
+// The Jolt headers don't include Jolt.h. Always include Jolt.h before including any other Jolt header.
+// You can use Jolt.h in your precompiled header to speed up compilation.
+#include <Jolt/Jolt.h>
+
+// Jolt includes
+#include <Jolt/Core/JobSystem.h>
+#include <Jolt/Physics/PhysicsSystem.h>
+#include <Jolt/Physics/Character/CharacterVirtual.h>
+
+// All Jolt symbols are in the JPH namespace
+using namespace JPH;
+
+/**
+* The players' characters of a physics world. Each character is a Jolt
+* "CharacterVirtual", moved by collision sweeps against the world with the
+* movement input the client sends on each step, so the players collide with
+* the bodies on the service instead of walking through them.
+*
+* The virtual character is not seen by the bodies, so each one is paired with
+* a kinematic capsule body on the ghost layer that follows it. The character
+* pushes the bodies it walks into, and the capsule body blocks the bodies that
+* move into a character.
+*
+* The capsule bodies take the body indices after the world's max bodies, so
+* they never clash with the client's body indices.
+*/
+class LOCALPHYSICSENGINESYSTEM_API FPhysicsServiceCharacters
+{
+public:
+	/** The max amount of characters on a single world */
+	static constexpr uint32 MaxCharacters = 256;
+
+	/**
+	* Sets the world the characters live on. Any character already added is
+	* removed.
+	*
+	* @param InPhysicsSystem The world's physics system. Must outlive the
+	* characters
+	* @param InFirstCharacterBodyIndex The first body index the characters'
+	* capsule bodies can take. The world must have room for "MaxCharacters"
+	* bodies from it
+	* @param InWorldOrigin The world's origin on the client's space
+	*/
+	void Init(PhysicsSystem* InPhysicsSystem,
+		const uint32 InFirstCharacterBodyIndex,
+		const FPhysicsWorldOrigin& InWorldOrigin);
+
+	/**
+	* Sets the characters' movement input for the next step. Each line is
+	* "Character; CharacterId; CapsuleRadius; CapsuleHalfHeight; posX; posY;
+	* posZ; desiredVelX; desiredVelY; desiredVelZ; JumpSpeed".
+	*
+	* A character is created on its first input, at the given position. After
+	* that, the position is only used to teleport it if it is too far from the
+	* client's. The desired velocity is the horizontal walk velocity and the
+	* jump speed is greater than zero if the character should jump.
+	*
+	* A character lives as long as its input keeps coming: characters with no
+	* input on a step are removed, e.g. as their player has left the region.
+	*
+	* @param CharacterInputLines The character input lines
+	*/
+	void SetCharacterInputs(const TArray<FString>& CharacterInputLines);
+
+	/**
+	* Moves every character by its input. Should be called before each fixed
+	* step, so the bodies react to the characters' new positions on the step.
+	* The characters are split in batches run on the job system threads.
+	*
+	* @param DeltaTime The time the next fixed step advances
+	* @param CharactersJobSystem The job system to run the batches on
+	*/
+	void UpdateCharacters(const float DeltaTime,
+		JobSystem& CharactersJobSystem);
+
+	/**
+	* Gets the characters' state as the step response lines. The template is:
+	*
+	* "CharacterState; CharacterId; posX; posY; posZ; velX; velY; velZ;
+	* GroundState; GroundBodyId\n"
+	*
+	* The ground state is the Jolt "EGroundState" (0: on ground; 1: on steep
+	* ground; 2: not supported; 3: in air). The ground body id is -1 if the
+	* character is not touching any body.
+	*/
+	FString GetCharactersStateResponse() const;
+
+	/** Removes every character and its capsule body */
+	void RemoveAllCharacters();
+
+	/**
+	* Takes the capsule bodies off the world, keeping the characters, so the
+	* world's state can be recorded without them. They must be put back with
+	* "AddCapsuleBodiesBackToWorld()" before the next step.
+	*/
+	void RemoveCapsuleBodiesFromWorld();
+
+	/** Puts back the capsule bodies taken off the world */
+	void AddCapsuleBodiesBackToWorld();
+
+	/** Getter to the amount of characters on the world */
+	int32 GetNumCharacters() const { return Characters.Num(); }
+
+private:
+	/** A player's character and its last input */
+	struct FPhysicsCharacter
+	{
+		/** The virtual character moved by the input */
+		Ref<CharacterVirtual> Character;
+
+		/** The kinematic capsule body following the character */
+		BodyID CapsuleBodyId;
+
+		/** The capsule size the character was created with */
+		float CapsuleRadius = 0.f;
+		float CapsuleHalfHeight = 0.f;
+
+		/** The horizontal velocity the player wants to walk with */
+		Vec3 DesiredVelocity = Vec3::sZero();
+
+		/** The jump speed. Cleared once the character jumps */
+		float JumpSpeed = 0.f;
+
+		/** If an input for this character came on the current step */
+		bool bHasInput = false;
+	};
+
+	/**
+	* Creates a character and its capsule body.
+	*
+	* @return The created character. Nullptr if there is no room for it
+	*/
+	FPhysicsCharacter* AddCharacter(const int32 CharacterId,
+		const float CapsuleRadius, const float CapsuleHalfHeight,
+		const RVec3 Position);
+
+	/** Removes a character and its capsule body */
+	void RemoveCharacter(const int32 CharacterId);
+
+	/**
+	* Moves a single character by its input and moves its capsule body after
+	* it. May be called from any job system thread.
+	*/
+	void UpdateCharacter(FPhysicsCharacter& PhysicsCharacter,
+		const float DeltaTime) const;
+
+private:
+	/** The world's physics system */
+	PhysicsSystem* World = nullptr;
+
+	/** The world's origin, which the client's positions are relative to */
+	FPhysicsWorldOrigin WorldOrigin;
+
+	/** The characters. The key is the character id given by the client */
+	TMap<int32, FPhysicsCharacter> Characters;
+
+	/** The first body index the capsule bodies can take */
+	uint32 FirstCharacterBodyIndex = 0;
+
+	/** The capsule body indices not taken by any character */
+	TArray<uint32> FreeCharacterBodyIndices;
+};
@@ -0,0 +1,199 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PhysicsWorldOrigin.h"
+
+// The Jolt headers don't include Jolt.h. Always include Jolt.h before including any other Jolt header.
+// You can use Jolt.h in your precompiled header to speed up compilation.
+#include <Jolt/Jolt.h>
+
+// Jolt includes
+#include <Jolt/Physics/PhysicsSystem.h>
+#include <Jolt/Physics/Constraints/TwoBodyConstraint.h>
+
+// All Jolt symbols are in the JPH namespace
+using namespace JPH;
+
+/**
+* The constraints (joints) between the bodies of a physics world, created
+* and removed by the client. The constraint ids are given by the client, so
+* they are the same on any service the world is migrated to.
+*
+* The changes of a step message are applied as a single batch before the
+* step: the removals first, then the creations, each added to or removed
+* from the world at once. A constraint can break once the impulse it applies
+* goes over its break impulse, and the client is told of every constraint
+* the service removed by itself.
+*/
+class LOCALPHYSICSENGINESYSTEM_API FPhysicsServiceConstraints
+{
+public:
+	/**
+	* The tags on the constraints' user data, so any constraint on a world
+	* can be told apart on the world snapshots. The lower bits are the
+	* constraint id or the vehicle's chassis body index
+	*/
+	static constexpr uint64 PSDConstraintTag = uint64(1) << 32;
+	static constexpr uint64 VehicleConstraintTag = uint64(2) << 32;
+
+	/**
+	* Sets the world the constraints live on. Any constraint already created
+	* is removed.
+	*
+	* @param InPhysicsSystem The world's physics system. Must outlive the
+	* constraints
+	* @param InWorldOrigin The world's origin on the client's space
+	*/
+	void Init(PhysicsSystem* InPhysicsSystem,
+		const FPhysicsWorldOrigin& InWorldOrigin);
+
+	/**
+	* Applies a batch of constraint changes. The lines are either
+	* "RemoveConstraint; ConstraintId" or:
+	*
+	* "Constraint; ConstraintId; Type; BodyId1; BodyId2; BreakImpulse; posX;
+	* posY; posZ; axisX; axisY; axisZ; normalX; normalY; normalZ; LimitMin;
+	* LimitMax"
+	*
+	* The type is "fixed", "point", "hinge", "slider", "distance" or "sixdof"
+	* and a BodyId2 of -1 attaches the first body to the world. The bodies
+	* are constrained where they are, around the anchor on world space:
+	* - hinge: rotates around the axis, from LimitMin to LimitMax (degrees)
+	* - slider: slides along the axis, from LimitMin to LimitMax (cm)
+	* - distance: keeps the anchor and the "axis" point, the anchor on the
+	* second body, from LimitMin to LimitMax apart (cm)
+	* - sixdof: the axis and normal are its x and y-axes, and the line is
+	* followed by each axis' "LimitMin; LimitMax", the translations first
+	* (cm) and then the rotations (degrees)
+	*
+	* A LimitMin not below LimitMax means no limits, but for the six-DOF
+	* axes, which are locked. A six-DOF axis is free if its limits are over
+	* the max limit of its kind. The break impulse is the max impulse the
+	* constraint can apply on a step (kg cm/s). It never breaks if 0. A
+	* constraint id created twice on the same batch keeps its first
+	* constraint.
+	*
+	* @param ConstraintLines The constraint lines of the step message
+	*/
+	void ApplyConstraintChanges(const TArray<FString>& ConstraintLines);
+
+	/**
+	* Removes the constraints on a body. Must be called before the body is
+	* removed from the world.
+	*
+	* @param ConstrainedBodyId The body to remove the constraints of
+	*/
+	void RemoveBodyConstraints(const BodyID& ConstrainedBodyId);
+
+	/**
+	* Removes the breakable constraints whose impulse on the last step is
+	* over their break impulse. Should be called after the steps.
+	*/
+	void BreakOverloadedConstraints();
+
+	/**
+	* Takes the constraints removed by the service as the step response
+	* lines. The template is "ConstraintRemoved; ConstraintId; Reason\n",
+	* where the reason is "broken", "failed" (could not be created) or
+	* "body" (one of its bodies was removed). A constraint created twice on
+	* the same batch is "ConstraintAdded; ConstraintId; duplicate\n", and its
+	* first constraint is kept.
+	*/
+	FString ConsumeConstraintEventsResponse();
+
+	/**
+	* Saves the constraints as world snapshot lines: a "SavedConstraint"
+	* line for each constraint, with its settings relative to its bodies,
+	* followed by the "ConstraintOrder" of every constraint on the world.
+	*/
+	FString SaveConstraints() const;
+
+	/**
+	* Recreates the saved constraints on a world with the same bodies, and
+	* puts every constraint on the world on the order they were saved on.
+	* Must be done before the Jolt state is restored, as the constraints'
+	* state is restored on their order.
+	*
+	* @param SavedConstraintLines The "SavedConstraint" lines
+	* @param ConstraintOrderLine The "ConstraintOrder" line. Empty if none
+	*
+	* @return False if any constraint could not be recreated
+	*/
+	bool RestoreConstraints(const TArray<FString>& SavedConstraintLines,
+		const FString& ConstraintOrderLine);
+
+	/** Removes every constraint */
+	void RemoveAllConstraints();
+
+	/** Getter to the amount of constraints on the world */
+	int32 GetNumConstraints() const { return Constraints.Num(); }
+
+private:
+	/** A constraint created by the client */
+	struct FPhysicsConstraint
+	{
+		/** The Jolt constraint, on the world */
+		Ref<TwoBodyConstraint> Constraint;
+
+		/** The constrained bodies. The second is invalid if the world */
+		BodyID BodyId1;
+		BodyID BodyId2;
+
+		/** The max impulse on a step before it breaks. Unbreakable if 0 */
+		float BreakImpulse = 0.f;
+	};
+
+	/**
+	* Creates the settings of a constraint line, split by ";".
+	*
+	* @return The settings. Nullptr if the line could not be parsed
+	*/
+	static Ref<TwoBodyConstraintSettings> CreateConstraintSettings
+		(const TArray<FString>& ConstraintInfo);
+
+	/**
+	* Creates a constraint between two bodies. The bodies are locked while
+	* it is created.
+	*
+	* @return True if the bodies exist and the constraint was created
+	*/
+	bool CreateConstraint(const uint32 ConstraintId,
+		const TwoBodyConstraintSettings& ConstraintSettings,
+		FPhysicsConstraint& OutPhysicsConstraint) const;
+
+	/** Gets the linear impulse a constraint applied on the last step */
+	static float GetConstraintImpulse(const TwoBodyConstraint& Constraint);
+
+	/**
+	* Removes constraints from the world as a single batch and wakes their
+	* bodies up.
+	*
+	* @param ConstraintIds The constraints to remove
+	* @param Reason The reason the client is told of. Nullptr if the client
+	* asked for the removal
+	*/
+	void RemoveConstraints(const TArray<uint32>& ConstraintIds,
+		const TCHAR* Reason);
+
+	/** Wakes the bodies of a constraint up, so they react to the change */
+	void ActivateConstraintBodies(const FPhysicsConstraint& PhysicsConstraint)
+		const;
+
+private:
+	/** The world's physics system */
+	PhysicsSystem* World = nullptr;
+
+	/** The world's origin, which the client's positions are relative to */
+	FPhysicsWorldOrigin WorldOrigin;
+
+	/** The constraints. The key is the constraint id */
+	TMap<uint32, FPhysicsConstraint> Constraints;
+
+	/**
+	* The "ConstraintRemoved" and "ConstraintAdded" lines since the last
+	* response
+	*/
+	FString ConstraintEventsResponse;
+};
@@ -0,0 +1,186 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PhysicsWorldOrigin.h"
+
+// The Jolt headers don't include Jolt.h. Always include Jolt.h before including any other Jolt header.
+// You can use Jolt.h in your precompiled header to speed up compilation.
+#include <Jolt/Jolt.h>
+
+// Jolt includes
+#include <Jolt/Geometry/AABox.h>
+#include <Jolt/Physics/PhysicsSystem.h>
+
+// All Jolt symbols are in the JPH namespace
+using namespace JPH;
+
+/**
+* The area effects on the moving bodies of a physics world: radial impulses
+* (explosions), wind volumes and vortices. Each effect is a single line of
+* the step message, no matter how many bodies it pushes, and its bodies are
+* found on the service with a broadphase query on its bounds.
+*
+* The effects are applied before each physics update, outside of it. Jolt
+* runs the step listeners in parallel, along with the vehicles that write
+* to their bodies, so applying them there would race with the vehicles and
+* break the determinism of the steps. A radial impulse is applied once, on
+* the next step, while the wind volumes and vortices last until their
+* duration is over or the client removes them.
+*/
+class LOCALPHYSICSENGINESYSTEM_API FPhysicsServiceForceFields
+{
+public:
+	/**
+	* Sets the world the force fields act on. Any force field already added
+	* is removed.
+	*
+	* @param InPhysicsSystem The world's physics system
+	* @param InWorldOrigin The world's origin on the client's space
+	*/
+	void Init(PhysicsSystem* InPhysicsSystem,
+		const FPhysicsWorldOrigin& InWorldOrigin);
+
+	/**
+	* Applies the force field lines of a step message. The lines are:
+	*
+	* "RadialImpulse; posX; posY; posZ; Radius; Impulse; Falloff"
+	*
+	* "ForceField; FieldId; wind; minX; minY; minZ; maxX; maxY; maxZ;
+	* windVelX; windVelY; windVelZ; Drag; Duration"
+	*
+	* "ForceField; FieldId; vortex; posX; posY; posZ; Radius; Height;
+	* TangentialAccel; InwardAccel; UpwardAccel; Duration"
+	*
+	* "RemoveForceField; FieldId"
+	*
+	* The radial impulse (kg cm/s) pushes every dynamic body within its
+	* radius away from its center, fading to zero at the radius if the
+	* falloff is "linear", or the same on the whole radius if "constant".
+	*
+	* The wind pulls the velocity of the bodies in its box towards the wind
+	* velocity (cm/s), by a Drag fraction per second. The vortex is a
+	* cylinder up from its position, whose accelerations (cm/s^2) fade to
+	* zero at its radius: around its axis (counterclockwise, seen from above),
+	* towards its axis and up. A field lasts for its duration (s), or until
+	* removed if 0. A field with the id of another field replaces it.
+	*
+	* @param ForceFieldLines The force field lines of the step message
+	*/
+	void ApplyForceFieldChanges(const TArray<FString>& ForceFieldLines);
+
+	/**
+	* Finds the bodies inside each force field and wakes them up, so they
+	* are on the next step. Must be called before each physics update.
+	*/
+	void GatherAffectedBodies();
+
+	/**
+	* Applies the force fields on the bodies found by
+	* "GatherAffectedBodies()". Must be called before each physics update,
+	* never during it.
+	*
+	* @param DeltaTime The time the next update advances
+	*/
+	void ApplyForceFields(const float DeltaTime);
+
+	/**
+	* Advances the force fields' time after a physics update, removing the
+	* radial impulses that were applied and the fields whose time is over.
+	*
+	* @param DeltaTime The time the update advanced
+	*/
+	void AdvanceForceFields(const float DeltaTime);
+
+	/**
+	* Saves the force fields that last as world snapshot lines, on the same
+	* "ForceField" template they are added with, with their remaining time.
+	*/
+	FString SaveForceFields() const;
+
+	/**
+	* Removes every force field and forgets the world. Must be called before
+	* the world is destroyed.
+	*/
+	void RemoveAllForceFields();
+
+	/** Getter to the amount of lasting force fields */
+	int32 GetNumForceFields() const { return ForceFields.Num(); }
+
+private:
+	/** The kinds of force field */
+	enum class EForceFieldType : uint8
+	{
+		RadialImpulse,
+		Wind,
+		Vortex
+	};
+
+	/** A force field and the bodies it acts on */
+	struct FForceField
+	{
+		EForceFieldType Type = EForceFieldType::RadialImpulse;
+
+		/** The field's bounds, queried on the broadphase */
+		AABox Bounds;
+
+		/** The impulse's or vortex's center. The vortex's base */
+		Vec3 Center = Vec3::sZero();
+
+		/** The radius of the radial impulse or vortex */
+		float Radius = 0.f;
+
+		/** The radial impulse on its center */
+		float Impulse = 0.f;
+
+		/** If the radial impulse fades to zero at its radius */
+		bool bLinearFalloff = true;
+
+		/** The wind velocity and the fraction pulled towards it per second */
+		Vec3 WindVelocity = Vec3::sZero();
+		float Drag = 0.f;
+
+		/** The vortex's accelerations: around, towards and along its axis */
+		float TangentialAcceleration = 0.f;
+		float InwardAcceleration = 0.f;
+		float UpwardAcceleration = 0.f;
+
+		/** The vortex's height, up from its center */
+		float Height = 0.f;
+
+		/** The time left until the field is removed. Never if negative */
+		float RemainingTime = -1.f;
+
+		/** The bodies inside the field's bounds on the next update */
+		Array<BodyID> AffectedBodies;
+	};
+
+	/**
+	* Parses a "ForceField" line, split by ";".
+	*
+	* @return False if the line could not be parsed
+	*/
+	bool ParseForceField(const TArray<FString>& ForceFieldInfo,
+		FForceField& OutForceField) const;
+
+	/** Applies a force field on a single body, before an update */
+	static void ApplyForceField(const FForceField& ForceField,
+		Body& AffectedBody, const float DeltaTime);
+
+	/** Queries the bodies inside a force field's bounds */
+	void GatherForceFieldBodies(FForceField& ForceField) const;
+
+private:
+	/** The world's physics system */
+	PhysicsSystem* World = nullptr;
+
+	/** The world's origin, which the client's positions are relative to */
+	FPhysicsWorldOrigin WorldOrigin;
+
+	/** The lasting force fields. The key is the field id */
+	TMap<uint32, FForceField> ForceFields;
+
+	/** The radial impulses to apply on the next update */
+	TArray<FForceField> RadialImpulses;
+};
@@ -9,6 +9,17 @@
 #include "MyContactListener.h"
 #include "ObjectLayerPairFilterImpl.h"
 #include "ObjectBroadPhaseLayerFilterImpl.h"
+#include "PhysicsEventBuffer.h"
+#include "PhysicsServiceAllocator.h"
+#include "PhysicsServiceCharacters.h"
+#include "PhysicsServiceConstraints.h"
+#include "PhysicsServiceForceFields.h"
+#include "PhysicsServiceRagdolls.h"
+#include "PhysicsServiceSensors.h"
+#include "PhysicsServiceVehicles.h"
+#include "PhysicsStateHistory.h"
+#include "PhysicsStepProfiler.h"
+#include "PhysicsWorldOrigin.h"
 
 #include <Jolt/RegisterTypes.h>
 #include <Jolt/Core/Factory.h>
@@ -16,6 +27,7 @@
 #include <Jolt/Core/JobSystemThreadPool.h>
 #include <Jolt/Physics/PhysicsSettings.h>
 #include <Jolt/Physics/PhysicsSystem.h>
+#include <Jolt/Physics/StateRecorderImpl.h>
 #include <Jolt/Physics/Collision/Shape/BoxShape.h>
 #include <Jolt/Physics/Collision/Shape/SphereShape.h>
 #include <Jolt/Physics/Body/BodyCreationSettings.h>
@@ -24,14 +36,96 @@
 // Disable common warnings triggered by Jolt, you can use JPH_SUPPRESS_WARNING_PUSH / JPH_SUPPRESS_WARNING_POP to store and restore the warning state
 JPH_SUPPRESS_WARNINGS
 
+/** 
+* The contact events a body may subscribe to. These are bit flags, sent as a
+* number on the "ContactSubscriptions" message.
+*/
+namespace EContactEventSubscriptionFlags
+{
+    static constexpr uint8 None = 0;
+    static constexpr uint8 ContactBegin = 1 << 0;
+    static constexpr uint8 ContactEnd = 1 << 1;
+};
+
+/** A body subscription to contact events */
+struct FContactEventSubscription
+{
+    /** The subscribed events. @see EContactEventSubscriptionFlags */
+    uint8 SubscriptionFlags = EContactEventSubscriptionFlags::None;
+
+    /** The min impulse a contact must have to generate a begin event */
+    float MinContactImpulse = 0.f;
+};
+
+/**
+* The state of a ghost body's primary, simulated on a neighbouring region's
+* service. The ghost is moved towards it on the next step.
+*/
+struct FGhostBodyTarget
+{
+    /** The ghost body */
+    BodyID GhostBodyId;
+
+    /** The primary's position */
+    RVec3 Position = RVec3::sZero();
+
+    /** The primary's linear velocity */
+    Vec3 LinearVelocity = Vec3::sZero();
+
+    /** The primary's angular velocity */
+    Vec3 AngularVelocity = Vec3::sZero();
+};
+
 /**
- * 
- */
+* The transform a kinematic body is moved to on the next step, as the game
+* placed its mover.
+*/
+struct FKinematicBodyTarget
+{
+    /** The kinematic body */
+    BodyID KinematicBodyId;
+
+    /** The mover's position */
+    RVec3 Position = RVec3::sZero();
+
+    /** The mover's rotation */
+    Quat Rotation = Quat::sIdentity();
+};
+
+/**
+* A physics service world. This holds a single PhysicsSystem and all the
+* bodies on it. Multiple worlds may live on the same process, each one
+* addressed by its world id and created by the FPhysicsServiceWorldManager,
+* which owns the resources shared among them (job system, temp allocators
+* and shapes).
+*
+* @see FPhysicsServiceWorldManager
+*/
 class LOCALPHYSICSENGINESYSTEM_API FPhysicsServiceImpl
 {
 
 public:
-	FPhysicsServiceImpl();
+    /** The default max amount of bodies a world can have */
+    static constexpr uint32 DefaultMaxBodies = 128000;
+
+    /**
+    * Creates a physics world. The physics system itself is only created once
+    * InitPhysicsSystem() is called.
+    *
+    * @param InWorldId The id that addresses this world on the world manager
+    * @param InWorldManager The world manager that owns this world and the
+    * resources shared with it
+    * @param InMaxBodies The max amount of bodies this world can have
+    */
+    FPhysicsServiceImpl(const int32 InWorldId,
+        class FPhysicsServiceWorldManager& InWorldManager,
+        const uint32 InMaxBodies = DefaultMaxBodies);
+
+    /** Getter to this world id */
+    int32 GetWorldId() const { return WorldId; }
+
+    /** Getter to the max amount of bodies this world can have */
+    uint32 GetMaxBodies() const { return MaxBodies; }
 
     /**
     * Initializes a physics system. Any Body that may exist on the
@@ -45,17 +139,95 @@ public:
     * bodyType; Id_2; posX_2; posY_2; posZ_2\n
     * ...
     * MessageEnd"
+    *
+    * The static bodies may be given as a single "StaticScene; SceneKey;
+    * ContentHash" line instead. @see BakeStaticScene()
+    *
+    * The positions are on the client's space. @see SetWorldOrigin()
     */
     void InitPhysicsSystem(const FString& initializationActorsInfo);
 
     /**
-    * Steps the current physics system simulation by one frame.
+    * Sets the fixed-timestep settings used when stepping this world.
+    *
+    * @param InFixedDeltaTime The fixed time each physics step advances
+    * @param InCollisionSteps The collision steps done on each fixed step
+    * @param InIntegrationSubSteps The integration sub steps done on each
+    * collision step
+    * @param InMaxCatchUpSteps The max amount of fixed steps run on a single
+    * step request. Any time beyond that is dropped, so a slow frame does not
+    * make the next ones even slower
+    */
+    void SetStepSettings(const float InFixedDeltaTime,
+        const int32 InCollisionSteps, const int32 InIntegrationSubSteps,
+        const int32 InMaxCatchUpSteps);
+
+    /**
+    * Sets the rewind history settings. The history keeps the moving bodies'
+    * state on the last steps, so rays can be cast against the world as it was
+    * on a past step. It is allocated once the physics system is initialized.
     *
-    * @return The step physics simulation result. This will send each actor's
-    * Id, position and rotation of the current physics system state back to
-    * the client.
+    * @param InRewindHistoryLength The amount of steps kept on the history.
+    * 0 disables it
+    * @param InMaxRewindBodies The max amount of moving bodies recorded on
+    * each step
     */
-    FString StepPhysicsSimulation();
+    void SetRewindHistorySettings(const uint32 InRewindHistoryLength,
+        const uint32 InMaxRewindBodies);
+
+    /**
+    * Sets the local origin of this world, on the client's world space. The
+    * client keeps sending and receiving its world positions, which are
+    * converted to and from this origin as the messages are parsed and the
+    * responses written. Must be set before the physics system is
+    * initialized, and kept for its whole life.
+    *
+    * @param InWorldOrigin The world's origin, usually the center of the
+    * region that owns it
+    */
+    void SetWorldOrigin(const FPhysicsWorldOrigin& InWorldOrigin)
+        { WorldOrigin = InWorldOrigin; }
+
+    /** Getter to the fixed time each physics step advances */
+    float GetFixedDeltaTime() const { return FixedDeltaTime; }
+
+    /**
+    * Advances the current physics system simulation by the elapsed time.
+    * The elapsed time is added to an accumulator, which is consumed in
+    * fixed-size steps. Thus, the simulation speed does not depend on the
+    * rate the client requests steps.
+    *
+    * @param ElapsedTime The real time elapsed on the client since the last
+    * step request
+    *
+    * @return The step physics simulation result. The first line is the step
+    * info ("StepInfo; NumberOfStepsRun; InterpolationAlpha; StepIndex;
+    * StateChecksum"), where the step index and checksum are the ones of the
+    * sent state, followed by
+    * each actor's Id, position, rotation and velocities of the current
+    * physics system state. If no fixed step was run, only the step info is
+    * sent, as the bodies did not move.
+    */
+    FString StepPhysicsSimulation(const float ElapsedTime);
+
+    /**
+    * Runs the fixed steps of a step request, without touching the time
+    * accumulator. The ghosts and movers are driven over the steps first, and
+    * the sensors, constraint breaks and ragdolls are updated after them.
+    * Both "StepPhysicsSimulation()" and the lockstep clients step through
+    * this, so a world stepped either way ends on the same state.
+    *
+    * @param NumberOfSteps The amount of fixed steps to run
+    */
+    void RunStepRequest(const int32 NumberOfSteps);
+
+    /**
+    * Getter to the interpolation alpha. This is how far, in [0, 1), the time
+    * accumulator is between the last fixed step and the next one. The client
+    * should blend between the two last physics states with it.
+    */
+    float GetInterpolationAlpha() const
+        { return TimeAccumulator / FixedDeltaTime; }
 
     /**
     * Clears the current physics system. This will shut the created physics
@@ -66,11 +238,14 @@ public:
     /**
     * Adds a new sphere to the physics world. This will add a Body to the
     * current running physics system, given its BodyId and initial position.
-    * The sphere will be dynamic and movable.
+    * The sphere will be dynamic and movable, unless it is a ghost.
     *
     * @param newBodyId The BodyID of the sphere to add to the physics world
     * @param newBodyInitialPosition The sphere's initial position on the
     * physics world
+    * @param bIsGhost If the sphere is a clone of a body simulated by another
+    * service. Ghosts are kinematic, on the GHOST layer, and are not sent back
+    * on the step response
     *
     * @return The result of the sphere's addition. May return a failure message
     * if the sphere could not be added successfully
@@ -78,7 +253,7 @@ public:
     FString AddNewSphereToPhysicsWorld(BodyID newBodyId, 
         RVec3 newBodyInitialPosition,
         RVec3 newBodyInitialLinearVelocity,
-        RVec3 newBodyInitialAngularVelocity);
+        RVec3 newBodyInitialAngularVelocity, const bool bIsGhost = false);
 
     /**
     * Adds a new floor to the physics world. This will add a Body to the
@@ -95,9 +270,271 @@ public:
     FString AddNewFloorToPhysicsSystem(const BodyID newBodyId,
         const RVec3 newBodyInitialPosition);
 
-    /** */
+    /**
+    * Adds a new static mesh to the physics world. Its shape is a cooked mesh,
+    * which must be on the world manager's cooked mesh cache already. If its
+    * body type is "kinematic", the mesh is a mover driven by the game
+    * instead of a static body. @see SetKinematicBodyTargets
+    *
+    * @param newBodyId The BodyID of the static mesh to add to the physics
+    * world
+    * @param BodyInfo The static mesh body info line, split by ";"
+    *
+    * @return The result of the static mesh's addition. May return a failure
+    * message if the mesh is not cooked or the body could not be added
+    */
+    FString AddNewStaticMeshToPhysicsWorld(const BodyID newBodyId,
+        const TArray<FString>& BodyInfo);
+
+    /**
+    * Adds a new vehicle to the physics world. The chassis is a dynamic box
+    * body with a vehicle constraint on it, unless it is a ghost: ghost
+    * vehicles keep their constraint disabled, so they can take over once
+    * they become primary.
+    *
+    * @param newBodyId The BodyID of the vehicle's chassis
+    * @param BodyInfo The vehicle body info line, split by ";"
+    * @param bIsGhost If the vehicle is a clone of a vehicle simulated by
+    * another service
+    *
+    * @return The result of the vehicle's addition. May return a failure
+    * message if the line is missing the vehicle setup or the body could not
+    * be added
+    */
+    FString AddNewVehicleToPhysicsWorld(const BodyID newBodyId,
+        const TArray<FString>& BodyInfo, const bool bIsGhost);
+
+    /**
+    * Adds a new dynamic body made of many primitives to the physics world.
+    * Its shape is a cooked compound, shared by every body of the same actor
+    * class, so the line only has its transform, mass and compound hash.
+    *
+    * @param newBodyId The BodyID of the compound body
+    * @param BodyInfo The compound body info line, split by ";"
+    * @param bIsGhost If the body is a clone of a body simulated by another
+    * service
+    *
+    * @return The result of the compound's addition. May return a failure
+    * message if the compound is not cooked or the body could not be added
+    */
+    FString AddNewCompoundToPhysicsWorld(const BodyID newBodyId,
+        const TArray<FString>& BodyInfo, const bool bIsGhost);
+
+    /**
+    * Adds a new sensor (trigger volume) box to the physics world. The sensor
+    * is static and never pushes the bodies, which are only reported as they
+    * enter and exit it. Only the dynamic bodies trigger a sensor.
+    *
+    * @param newBodyId The BodyID of the sensor
+    * @param BodyInfo The sensor body info line, split by ";"
+    *
+    * @return The result of the sensor's addition
+    */
+    FString AddNewSensorToPhysicsWorld(const BodyID newBodyId,
+        const TArray<FString>& BodyInfo);
+
+    /**
+    * Adds a new body to the physics world given its message line. This is the
+    * same line used on the "Init" and "AddBody" messages:
+    *
+    * "bodyType; Id; primaryOrClone; posX; posY; posZ; linearVelX;
+    * linearVelY; linearVelZ; angularVelX; angularVelY; angularVelZ"
+    *
+    * The "mesh" body type is followed by "rotX; rotY; rotZ; rotW; scaleX;
+    * scaleY; scaleZ; MeshHash". Its "kinematic" body type is a mover.
+    *
+    * The "vehicle" body type is followed by "rotX; rotY; rotZ; rotW;
+    * chassisHalfExtentX; chassisHalfExtentY; chassisHalfExtentZ; mass;
+    * wheelRadius; wheelWidth; suspensionLength; maxEngineTorque;
+    * maxSteerAngle", with the steer angle in degrees.
+    *
+    * The "compound" body type is followed by "rotX; rotY; rotZ; rotW; mass;
+    * CompoundHash", the hash of its cooked "compound" collision.
+    *
+    * The "sensor" body type is followed by "rotX; rotY; rotZ; rotW;
+    * halfExtentX; halfExtentY; halfExtentZ", its box.
+    *
+    * @param BodyInfoLine The body info line to parse and add
+    *
+    * @return The result of the body's addition. May return a failure message
+    * if the line could not be parsed or the body could not be added
+    */
+    FString AddBodyFromMessageLine(const FString& BodyInfoLine);
+
+    /**
+    * Updates a body type. A "primary" body is simulated by this world, while
+    * a "clone" is a ghost driven by its primary on another world. Used once
+    * the body's ownership is transferred between regions. The kinematic
+    * movers keep their type.
+    *
+    * @param TargetBodyId The body to update
+    * @param NewBodyType Either "primary" or "clone"
+    *
+    * @return The result of the update
+    */
+    FString UpdateBodyType(const BodyID TargetBodyId,
+        const FString& NewBodyType);
+
+    /**
+    * Sets the states the ghost bodies are moved towards on the next step.
+    * Each line is "Ghost; Id; posX; posY; posZ; linearVelX; linearVelY;
+    * linearVelZ; angularVelX; angularVelY; angularVelZ", the last state of
+    * the ghost's primary.
+    *
+    * @param GhostStateLines The ghost state lines
+    */
+    void SetGhostBodyTargets(const TArray<FString>& GhostStateLines);
+
+    /**
+    * Sets the transforms the kinematic bodies are moved to on the next step.
+    * The targets of a region come packed on a single line:
+    *
+    * "KinematicTargets; Count; TargetsBase64"
+    *
+    * Each target is 32 bytes: the body id (int32), the position (3 floats)
+    * and the rotation quaternion (4 floats, XYZW). A kinematic body without
+    * a target keeps the velocity it was last moved with, so the client
+    * sends every mover on each step.
+    *
+    * @param KinematicTargetLines The "KinematicTargets" lines
+    */
+    void SetKinematicBodyTargets(const TArray<FString>& KinematicTargetLines);
+
+    /**
+    * Sets the players' characters movement input for the next step. The
+    * characters are moved before each fixed step and their state is sent on
+    * the step response. @see FPhysicsServiceCharacters::SetCharacterInputs
+    *
+    * @param CharacterInputLines The "Character" lines of the step message
+    */
+    void SetCharacterInputs(const TArray<FString>& CharacterInputLines);
+
+    /**
+    * Sets the vehicles' driver input for the next step. The wheels' state is
+    * sent on the step response.
+    * @see FPhysicsServiceVehicles::SetVehicleInputs
+    *
+    * @param VehicleInputLines The "Vehicle" lines of the step message
+    */
+    void SetVehicleInputs(const TArray<FString>& VehicleInputLines)
+        { Vehicles.SetVehicleInputs(VehicleInputLines); }
+
+    /**
+    * Activates the ragdolls of the step message from their pools. The
+    * ragdolls' state is sent on the step response.
+    * @see FPhysicsServiceRagdolls::ActivateRagdolls
+    *
+    * @param RagdollActivationLines The "Ragdoll" lines of the step message
+    */
+    void SetRagdollActivations(const TArray<FString>& RagdollActivationLines);
+
+    /**
+    * Creates and removes the constraints of the step message, each as a
+    * single batch. The constraints the service removed by itself are sent on
+    * the step response.
+    * @see FPhysicsServiceConstraints::ApplyConstraintChanges
+    *
+    * @param ConstraintLines The "Constraint" and "RemoveConstraint" lines of
+    * the step message
+    */
+    void ApplyConstraintChanges(const TArray<FString>& ConstraintLines);
+
+    /**
+    * Adds and removes the force fields of the step message. Each field is
+    * resolved with a broadphase query and applied before each collision
+    * step. @see FPhysicsServiceForceFields::ApplyForceFieldChanges
+    *
+    * @param ForceFieldLines The "RadialImpulse", "ForceField" and
+    * "RemoveForceField" lines of the step message
+    */
+    void ApplyForceFieldChanges(const TArray<FString>& ForceFieldLines);
+
+    /**
+    * Bakes the static bodies of a map region into a static scene, stored on
+    * the world manager's static scene cache (on memory and on disk). Worlds
+    * can then add all of them at once with a "StaticScene" line on the "Init"
+    * message. The template is:
+    *
+    * "SceneKey; ContentHash\n
+    * bodyInfoLine\n
+    * ..."
+    *
+    * The scene is kept on this world's space, along with its origin, so the
+    * worlds of any origin can rebase and add it.
+    *
+    * @param StaticSceneInfo The scene key, the hash of the body lines and the
+    * static body lines
+    *
+    * @return The result of the bake. May return a failure message if a line
+    * could not be parsed or is not a static body
+    */
+    FString BakeStaticScene(const FString& StaticSceneInfo);
+
+    /**
+    * Adds every body of a baked static scene to the physics world. The
+    * bodies are inserted on the broadphase as a single batch.
+    *
+    * @param SceneKey The key that addresses the scene
+    * @param ContentHash The hash of the content the scene must be baked from
+    *
+    * @return The result of the addition. May return a failure message if the
+    * scene is not baked yet, in which case "IsStaticSceneMissing()" is set
+    */
+    FString AddStaticSceneToPhysicsWorld(const FString& SceneKey,
+        const uint32 ContentHash);
+
+    /**
+    * Checks if the last initialization referenced a static scene that is not
+    * baked yet (or was baked from another content).
+    */
+    bool IsStaticSceneMissing() const { return bIsStaticSceneMissing; }
+
+    /**
+    * Subscribes a body to contact events. Only contacts that involve a
+    * subscribed body are sent back on the step response. Subscribing with no
+    * flags removes the subscription.
+    *
+    * @param SubscribedBodyId The body to subscribe
+    * @param SubscriptionFlags The events to subscribe to
+    * @see EContactEventSubscriptionFlags
+    * @param MinContactImpulse The min impulse a contact must have to generate
+    * a begin event for this body
+    */
+    void SetContactEventSubscription(const BodyID SubscribedBodyId,
+        const uint8 SubscriptionFlags, const float MinContactImpulse);
+
+    /**
+    * Sets the max amount of contact events sent on a single step response.
+    * Once over it, the contact begin events with the lowest impulses are
+    * dropped. The contact end events are always sent, so the client never
+    * keeps a contact that ended.
+    */
+    void SetMaxContactEventsPerStep(const int32 InMaxContactEventsPerStep)
+        { MaxContactEventsPerStep = FMath::Max(InMaxContactEventsPerStep, 0); }
+
+    /**
+    * Getter to the physics events (activation changes and contacts) recorded
+    * on the fixed steps run by the last step request.
+    */
+    const TArray<FPhysicsServiceEvent>& GetLastStepEvents() const
+        { return LastStepEvents; }
+
+    /**
+    * Gets the simulation measures since the initialization. The first lines
+    * are the microseconds of each step request, followed by a "Phases" line
+    * for each fixed step run, as given by
+    * "FPhysicsStepProfiler::GetLastStepMeasureLine()".
+    */
     FString GetSimulationMeasures() const
-        { return PhysicsStepSimulationTimeMeasure; }
+        { return PhysicsStepSimulationTimeMeasure + PhysicsStepPhasesMeasure; }
+
+    /**
+    * Gets this world's memory counters: the bytes and allocations made by
+    * its Jolt objects and the temp allocator high water mark of its steps.
+    * @see FPhysicsMemoryAccounting::GetMeasureLine
+    */
+    FString GetMemoryMeasures() const
+        { return MemoryAccounting->GetMeasureLine(); }
 
     /**
     * Removes a Body from the current running physics world. Thus, this body
@@ -111,37 +548,150 @@ public:
     */
     FString RemoveBodyByID(const BodyID bodyToRemoveID);
 
-private:
-    // Callback for traces, connect this to your own trace function if you 
-    // have one
-    static void TraceImpl(const char* inFMT, ...)
-    {
-        // Format the message
-        va_list list;
-        va_start(list, inFMT);
-        char buffer[1024];
-        vsnprintf(buffer, sizeof(buffer), inFMT, list);
-        va_end(list);
-    }
-
-#ifdef JPH_ENABLE_ASSERTS
-    // Callback for asserts, connect this to your own assert handler if you
-    //  have one
-    static bool AssertFailedImpl(const char* inExpression,
-        const char* inMessage, const char* inFile, uint inLine)
-    {
-        // Print to the TTY
-        cout << inFile << ":" << inLine << ": (" << inExpression << ") "
-            << (inMessage != nullptr ? inMessage : "") << endl;
-
-        // Breakpoint
-        return true;
-    };
-
-#endif // JPH_ENABLE_ASSERTS
+    /**
+    * Adds an impulse to a body, applied at its center of mass.
+    *
+    * @param BodyToPushID The BodyID of the body to push
+    * @param Impulse The impulse to add
+    *
+    * @return The result of the impulse. May return a failure message if the
+    * body is not on the physics world
+    */
+    FString AddImpulseToBody(const BodyID BodyToPushID, const Vec3 Impulse);
+
+    /**
+    * Applies a simulation command to this world. Commands are the inputs that
+    * change the simulation besides stepping it, so a world fed with the same
+    * commands on the same steps ends on the same state. The templates are:
+    *
+    * "AddBody;bodyInfoLine"
+    * "RemoveBody;BodyId"
+    * "Impulse;BodyId;impulseX;impulseY;impulseZ"
+    *
+    * @param CommandLine The command to apply
+    *
+    * @return The result of the command. May return a failure message if the
+    * command could not be parsed or applied
+    */
+    FString ApplySimulationCommand(const FString& CommandLine);
+
+    /**
+    * Gets a checksum of this world's state. Every moving body's position,
+    * rotation and velocities are quantized and hashed, along with the step
+    * counter. The bodies' hashes are summed, so the checksum does not depend
+    * on the bodies' order, and are computed in ranges on the job system
+    * threads. Two worlds that ran the same commands on the same steps must
+    * have the same checksum, as the simulation is deterministic.
+    *
+    * If Jolt is built with JPH_ENABLE_DETERMINISM_LOG, the hashed states are
+    * also written to its determinism log, so two runs can be diffed.
+    *
+    * This must be called between steps, never while the world is updating.
+    *
+    * @return The checksum of this world's state. 0 if it is not initialized
+    */
+    uint32 GetStateChecksum() const;
+
+    /**
+    * Getter to the state checksum after the last step request, initialization
+    * or snapshot restore.
+    */
+    uint32 GetLastStateChecksum() const { return LastStateChecksum; }
+
+    /**
+    * Gets the current state of each body on this world as the step response
+    * lines.
+    */
+    FString GetBodiesStateResponse() const;
+
+    /**
+    * Saves a snapshot of this world, so it can be restored on another physics
+    * service. Besides the settings, bodies and subscriptions, the snapshot
+    * carries the Jolt state (positions, velocities, activation and contact
+    * cache), so the simulation continues exactly where it was. The template
+    * is:
+    *
+    * "Settings;FixedDeltaTime;CollisionSteps;IntegrationSubSteps;
+    * MaxCatchUpSteps;MaxContactEventsPerStep;TimeAccumulator;StepCounter;
+    * RewindHistoryLength;MaxRewindBodies;OriginX;OriginY;OriginZ\n
+    * Body;bodyInfoLine\n
+    * ...
+    * Subscription;BodyId;SubscriptionFlags;MinContactImpulse\n
+    * ...
+    * ForceField;forceFieldLine\n
+    * ...
+    * State;Base64JoltState\n"
+    *
+    * The characters and ragdolls are not saved: the characters are recreated
+    * from the next inputs on the restored world, and the client takes the
+    * ragdolls as released. Their bodies are only taken off the world while
+    * its state is recorded, so this world goes on with them.
+    *
+    * This must be called between steps, never while the world is updating.
+    *
+    * @return The world snapshot. Empty if this world is not initialized
+    */
+    FString SaveWorldSnapshot();
+
+    /**
+    * Restores a world snapshot saved by "SaveWorldSnapshot()". Any current
+    * physics system is cleared first.
+    *
+    * @param WorldSnapshot The world snapshot to restore
+    *
+    * @return True if the snapshot was restored. False otherwise, in which
+    * case this world is left cleared
+    */
+    bool RestoreWorldSnapshot(const FString& WorldSnapshot);
+
+    /**
+    * Casts rays against the world as it was on past steps. The moving bodies
+    * and the kinematic movers are placed where they were on each ray's step,
+    * using the rewind history, while the static bodies are tested as they
+    * are. The rays are split in batches run on the job system threads.
+    *
+    * Each line of the param is a ray: "StepIndex; originX; originY; originZ;
+    * directionX; directionY; directionZ", where the direction also holds the
+    * ray's length.
+    *
+    * @return The first line is the rewind info ("RewindInfo; OldestStep;
+    * NewestStep; HistoryBytes"), followed by a line for each ray. Either
+    * "RewindHit; RayIndex; BodyId; Fraction; hitX; hitY; hitZ" if it hit,
+    * "RewindHit; RayIndex; None" if not or "RewindHit; RayIndex; Expired" if
+    * the ray's step is no longer on the history.
+    */
+    FString RewindRaycast(const FString& RaysInfo) const;
+
+    /**
+    * Runs a batch of scene queries against the world as it is. The queries
+    * are split in batches run on the job system threads.
+    *
+    * Each query line is "Query; RequestId; QueryType; QueryParams", where
+    * the request id is given by the client to match the results. The query
+    * types and params are:
+    * "Ray; originX; originY; originZ; directionX; directionY; directionZ",
+    * "SphereSweep; Radius; startX; startY; startZ; directionX; directionY;
+    * directionZ",
+    * "BoxSweep; halfExtentX; halfExtentY; halfExtentZ; rotX; rotY; rotZ;
+    * rotW; startX; startY; startZ; directionX; directionY; directionZ",
+    * "SphereOverlap; Radius; centerX; centerY; centerZ" and
+    * "BoxOverlap; halfExtentX; halfExtentY; halfExtentZ; rotX; rotY; rotZ;
+    * rotW; centerX; centerY; centerZ". The directions also hold the length.
+    * Only the static and moving bodies are queried, so the ghosts, the
+    * character capsules and the sensors are never hit.
+    *
+    * @return A line for each query. Rays and sweeps return the closest hit:
+    * "QueryHit; RequestId; BodyId; Fraction; hitX; hitY; hitZ; normalX;
+    * normalY; normalZ" or "QueryHit; RequestId; None". Overlaps return every
+    * overlapping body: "QueryOverlap; RequestId; BodyId_0; BodyId_1; ..."
+    */
+    FString RunSceneQueries(const TArray<FString>& QueryLines) const;
 
 public:
-    TempAllocator* temp_allocator = nullptr;
+    /**
+    * The job system that executes this world's physics jobs. This is shared
+    * with every other world on the world manager
+    */
     JobSystem* job_system = nullptr;
 
     /**
@@ -171,6 +721,12 @@ public:
     /** The running physics system */
     PhysicsSystem* physics_system = nullptr;
 
+    /**
+    * The buffer the listeners record the physics events on. It is lock-free
+    * and drained after each fixed step
+    */
+    FPhysicsEventBuffer EventBuffer;
+
     /** The implemented body activation listener on the physics system */
     FMyBodyActivationListener* body_activation_listener = nullptr;
 
@@ -180,10 +736,24 @@ public:
     /**
     * The list of BodyID from all the bodies on the current running physics
     * system. Used to query each body location and rotation on each physics
-    * step
+    * step. Bodies are swap-removed, so the order is not kept
     */
     std::vector<BodyID> BodyIdList;
 
+    /**
+    * The slot of each body on "BodyIdList", indexed by the body index.
+    * INDEX_NONE if the body is not on the list. Body indices are dense, so
+    * this is a flat array and removing a body is O(1)
+    */
+    TArray<int32> BodyIdListSlots;
+
+    /**
+    * The kinematic movers (e.g. doors and moving platforms) on the world.
+    * The game drives them, so their state is not sent back, but they are
+    * recorded on the rewind history with "BodyIdList"
+    */
+    std::vector<BodyID> KinematicBodyIdList;
+
     /** Flag that indicates if the physics system is initialized */
     bool bIsInitialized = false;
 
@@ -198,4 +768,185 @@ public:
     * Used to test the overall system
     */
     FString PhysicsStepSimulationTimeMeasure = "";
+
+    /** The "Phases" measure line of each fixed step run */
+    FString PhysicsStepPhasesMeasure = "";
+
+    /**
+    * Measures the phases of this world's steps. This wraps the shared job
+    * system, and is the "job_system" this world steps with
+    */
+    TUniquePtr<FPhysicsStepProfiler> StepProfiler;
+
+private:
+    /**
+    * Runs a given number of fixed steps on the physics system. Only the
+    * Jolt steps and what must run on each of them are done here.
+    * @see RunStepRequest
+    *
+    * @param NumberOfSteps The amount of fixed steps to run
+    */
+    void RunFixedSteps(const int32 NumberOfSteps);
+
+    /**
+    * Gets the subscribed contact events of the last step request as the step
+    * response lines. The templates are:
+    *
+    * "Contact;B;BodyId1;BodyId2;pointX;pointY;pointZ;normalX;normalY;
+    * normalZ;impulse\n" for contact begin events and
+    * "Contact;E;BodyId1;BodyId2\n" for contact end events.
+    */
+    FString GetContactEventsResponse() const;
+
+    /** Adds a moving body to "BodyIdList" */
+    void AddToBodyIdList(const BodyID BodyToAddID);
+
+    /**
+    * Removes a moving body from "BodyIdList". The last body on the list takes
+    * its slot, so no other body is moved.
+    */
+    void RemoveFromBodyIdList(const BodyID BodyToRemoveID);
+
+    /**
+    * Moves the ghost bodies towards their targets. The targets are
+    * extrapolated by the primary's velocities, so the ghost arrives where
+    * the primary should be after the given time.
+    *
+    * @param DriveTime The time the next steps will advance
+    */
+    void DriveGhostBodies(const float DriveTime);
+
+    /**
+    * Moves the kinematic bodies to their targets, so they arrive once the
+    * next steps are done. The bodies they push get the velocity of the move.
+    *
+    * @param DriveTime The time the next steps will advance
+    */
+    void DriveKinematicBodies(const float DriveTime);
+
+    /**
+    * Checks if a contact event should be sent, given the subscriptions of
+    * the bodies involved.
+    */
+    bool IsContactEventSubscribed(const FPhysicsServiceEvent& ContactEvent)
+        const;
+
+    /** Gets the creation settings of a floor body at the given position */
+    BodyCreationSettings GetFloorCreationSettings(const RVec3 Position);
+
+    /**
+    * Gets the creation settings of a static mesh body given its info line.
+    * The position is the line's, converted to the world's space.
+    *
+    * @return False if the line could not be parsed or if its mesh is not
+    * cooked yet
+    */
+    bool GetStaticMeshCreationSettings(const TArray<FString>& BodyInfo,
+        BodyCreationSettings& OutStaticMeshSettings);
+
+private:
+    /** The id that addresses this world on the world manager */
+    int32 WorldId = 0;
+
+    /** The physics events drained since the last step request */
+    TArray<FPhysicsServiceEvent> LastStepEvents;
+
+    /**
+    * If the event buffer dropped any event since the last step request, so
+    * the last step events are incomplete
+    */
+    bool bDroppedLastStepEvents = false;
+
+    /** The world manager that owns this world */
+    class FPhysicsServiceWorldManager& WorldManager;
+
+    /**
+    * The counters this world's Jolt allocations are accounted on. Owned by
+    * the allocator, as they must outlive the world
+    */
+    FPhysicsMemoryAccounting* MemoryAccounting = nullptr;
+
+    /** The max amount of bodies this world can have */
+    uint32 MaxBodies = DefaultMaxBodies;
+
+    /** The fixed time each physics step advances. 60 Hz by default */
+    float FixedDeltaTime = 1.f / 60.f;
+
+    /** The collision steps done on each fixed step */
+    int32 CollisionSteps = 1;
+
+    /** The integration sub steps done on each collision step */
+    int32 IntegrationSubSteps = 1;
+
+    /** The max amount of fixed steps run on a single step request */
+    int32 MaxCatchUpSteps = 4;
+
+    /** The elapsed time not yet consumed by fixed steps */
+    float TimeAccumulator = 0.f;
+
+    /** The contact event subscriptions. The key is the body index */
+    TMap<uint32, FContactEventSubscription> ContactEventSubscriptions;
+
+    /** The max amount of contact events sent on a single step response */
+    int32 MaxContactEventsPerStep = 64;
+
+    /** The moving bodies' state on the last steps */
+    FPhysicsStateHistory StateHistory;
+
+    /** The ghost bodies' targets for the next step */
+    TArray<FGhostBodyTarget> GhostBodyTargets;
+
+    /** The kinematic bodies' targets for the next step */
+    TArray<FKinematicBodyTarget> KinematicBodyTargets;
+
+    /** The players' characters on this world */
+    FPhysicsServiceCharacters Characters;
+
+    /** The vehicles on this world, by their chassis body */
+    FPhysicsServiceVehicles Vehicles;
+
+    /** The pooled ragdolls on this world */
+    FPhysicsServiceRagdolls Ragdolls;
+
+    /** The constraints the client created between this world's bodies */
+    FPhysicsServiceConstraints Constraints;
+
+    /** The radial impulses, wind volumes and vortices on this world */
+    FPhysicsServiceForceFields ForceFields;
+
+    /** The trigger volumes on this world and the bodies inside them */
+    FPhysicsServiceSensors Sensors;
+
+    /** The amount of steps kept on the rewind history. Disabled if 0 */
+    uint32 RewindHistoryLength = 0;
+
+    /** The max amount of moving bodies recorded on each history step */
+    uint32 MaxRewindBodies = 1024;
+
+    /** The local origin of this world, on the client's world space */
+    FPhysicsWorldOrigin WorldOrigin;
+
+    /** The state checksum after the last step request. @see GetStateChecksum */
+    uint32 LastStateChecksum = 0;
+
+    /**
+    * The message line each body was added with. The key is the body index.
+    * Used to recreate the bodies when restoring a world snapshot
+    */
+    TMap<uint32, FString> BodyInfoLines;
+
+    /**
+    * The key of the static scene this world was initialized with. Empty if
+    * none
+    */
+    FString StaticSceneKey;
+
+    /** The content hash of the static scene this world was initialized with */
+    uint32 StaticSceneContentHash = 0;
+
+    /** 
+    * Flag that indicates if the last initialization referenced a static scene
+    * that is not baked
+    */
+    bool bIsStaticSceneMissing = false;
 };
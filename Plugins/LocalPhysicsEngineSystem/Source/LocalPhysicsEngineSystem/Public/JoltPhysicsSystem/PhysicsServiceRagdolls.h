@@ -0,0 +1,205 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PhysicsRagdollTypeCache.h"
+#include "PhysicsWorldOrigin.h"
+
+// The Jolt headers don't include Jolt.h. Always include Jolt.h before including any other Jolt header.
+// You can use Jolt.h in your precompiled header to speed up compilation.
+#include <Jolt/Jolt.h>
+
+// Jolt includes
+#include <Jolt/Physics/PhysicsSystem.h>
+#include <Jolt/Physics/StateRecorderImpl.h>
+#include <Jolt/Physics/Constraints/TwoBodyConstraint.h>
+
+// All Jolt symbols are in the JPH namespace
+using namespace JPH;
+
+/**
+* The ragdolls of a physics world. The ragdolls are instanced from the types
+* on the world manager's ragdoll type cache, and each type has a pool of
+* ragdolls on the world, created on its first activation. Activating a
+* ragdoll only poses its parts and adds them to the world, so no body or
+* constraint is created while the game is running.
+*
+* A ragdoll goes back to its pool once it falls asleep or its lifetime is
+* over. If every ragdoll of a type is active, the one closest to the end of
+* its lifetime is taken.
+*
+* The parts take the body indices after the characters' ones, so they never
+* clash with the client's body indices.
+*/
+class LOCALPHYSICSENGINESYSTEM_API FPhysicsServiceRagdolls
+{
+public:
+	/** The max amount of ragdoll parts on a single world, pooled or not */
+	static constexpr uint32 MaxRagdollBodies = 2048;
+
+	/**
+	* Sets the world the ragdolls live on. Any ragdoll already created is
+	* destroyed.
+	*
+	* @param InPhysicsSystem The world's physics system. Must outlive the
+	* ragdolls
+	* @param InFirstRagdollBodyIndex The first body index the ragdolls' parts
+	* can take. The world must have room for "MaxRagdollBodies" bodies from it
+	* @param InRagdollTypeCache The ragdoll types to instance the ragdolls from
+	* @param InWorldOrigin The world's origin on the client's space
+	*/
+	void Init(PhysicsSystem* InPhysicsSystem,
+		const uint32 InFirstRagdollBodyIndex,
+		FPhysicsRagdollTypeCache* InRagdollTypeCache,
+		const FPhysicsWorldOrigin& InWorldOrigin);
+
+	/**
+	* Activates ragdolls from their type's pool. Each line is "Ragdoll;
+	* InstanceId; TypeName; posX; posY; posZ; rotX; rotY; rotZ; rotW;
+	* linearVelX; linearVelY; linearVelZ; angularVelX; angularVelY;
+	* angularVelZ; Lifetime", optionally followed by each part's "posX; posY;
+	* posZ; rotX; rotY; rotZ; rotW" relative to the root part.
+	*
+	* The transform is the root part's, and the parts are placed on the bind
+	* pose if their transforms are not given. The velocities are the root
+	* part's, so the parts move as a single rigid body at first. The instance
+	* id is given by the client, and an active ragdoll with the same id is
+	* activated again.
+	*
+	* @param RagdollActivationLines The ragdoll activation lines
+	*/
+	void ActivateRagdolls(const TArray<FString>& RagdollActivationLines);
+
+	/**
+	* Releases the ragdolls that are asleep or whose lifetime is over. Should
+	* be called after the steps.
+	*
+	* @param DeltaTime The time the steps advanced
+	*/
+	void UpdateRagdolls(const float DeltaTime);
+
+	/**
+	* Takes the ragdolls' state as the step response lines. The templates
+	* are:
+	*
+	* "RagdollState; InstanceId; posX; posY; posZ; rotX; rotY; rotZ; rotW;
+	* ...\n" for each active ragdoll, where the root part's transform is
+	* followed by each other part's transform relative to the root, and
+	* "RagdollReleased; InstanceId\n" for each ragdoll released since the
+	* last call.
+	*
+	* The relative transforms are sent with less precision, as they are
+	* bounded by the ragdoll's size.
+	*/
+	FString ConsumeRagdollsStateResponse();
+
+	/** Destroys every ragdoll and pool */
+	void RemoveAllRagdolls();
+
+	/**
+	* Takes the active ragdolls' parts and constraints off the world, keeping
+	* them active, so the world's state can be recorded without them. They
+	* must be put back with "AddActiveRagdollsBackToWorld()" before the next
+	* step.
+	*/
+	void RemoveActiveRagdollsFromWorld();
+
+	/**
+	* Puts back the active ragdolls taken off the world, with the velocities
+	* their parts had
+	*/
+	void AddActiveRagdollsBackToWorld();
+
+	/** Getter to the amount of active ragdolls on the world */
+	int32 GetNumActiveRagdolls() const { return ActiveRagdolls.Num(); }
+
+private:
+	/** A pooled ragdoll */
+	struct FPhysicsRagdoll
+	{
+		/** The parts' bodies, in the ragdoll type's part order */
+		TArray<BodyID> PartBodyIds;
+
+		/** The constraints between the parts and their parents */
+		TArray<Ref<TwoBodyConstraint>> Constraints;
+
+		/** The instance id given by the client. INDEX_NONE if not active */
+		int32 InstanceId = INDEX_NONE;
+
+		/** The time left before the ragdoll is released */
+		float RemainingLifetime = 0.f;
+	};
+
+	/** The ragdolls of a single type */
+	struct FPhysicsRagdollPool
+	{
+		/** The ragdoll type */
+		RefConst<RagdollSettings> Settings;
+
+		/** The pooled ragdolls. Never resized once created */
+		TArray<FPhysicsRagdoll> Ragdolls;
+
+		/**
+		* The constraints' state as they are created, with no impulses. It is
+		* restored on activation, so the constraints don't warm start with the
+		* impulses of the ragdoll's last activation
+		*/
+		TUniquePtr<StateRecorderImpl> InitialConstraintsState;
+	};
+
+	/**
+	* Gets a ragdoll type's pool, creating it if needed.
+	*
+	* @return The pool. Nullptr if the type is not registered or there are
+	* not enough body indices left
+	*/
+	FPhysicsRagdollPool* GetOrCreateRagdollPool(const FString& TypeName);
+
+	/**
+	* Gets a ragdoll to activate from a pool. A free one if there is one,
+	* otherwise the active one closest to the end of its lifetime, which is
+	* released.
+	*/
+	FPhysicsRagdoll& TakeRagdollFromPool(FPhysicsRagdollPool& RagdollPool);
+
+	/** Removes an active ragdoll from the world and gives it to its pool */
+	void ReleaseRagdoll(FPhysicsRagdoll& RagdollToRelease);
+
+	/**
+	* Destroys the bodies and constraints of a pool's ragdolls. They must not
+	* be on the world
+	*/
+	void DestroyRagdollPool(FPhysicsRagdollPool& RagdollPool);
+
+private:
+	/** The world's physics system */
+	PhysicsSystem* World = nullptr;
+
+	/** The world's origin, which the client's positions are relative to */
+	FPhysicsWorldOrigin WorldOrigin;
+
+	/** The ragdoll types to instance the ragdolls from */
+	FPhysicsRagdollTypeCache* RagdollTypeCache = nullptr;
+
+	/** The ragdoll pools. The key is the ragdoll type name */
+	TMap<FString, FPhysicsRagdollPool> RagdollPools;
+
+	/** The active ragdolls. The key is the instance id */
+	TMap<int32, FPhysicsRagdoll*> ActiveRagdolls;
+
+	/** The instance ids released since the last response */
+	TArray<int32> ReleasedInstanceIds;
+
+	/**
+	* The linear and angular velocities of the parts taken off the world, in
+	* the active ragdolls' order
+	*/
+	TArray<Vec3> RemovedPartVelocities;
+
+	/** The next body index the pools' parts take */
+	uint32 NextRagdollBodyIndex = 0;
+
+	/** The body index after the last one the parts can take */
+	uint32 EndRagdollBodyIndex = 0;
+};
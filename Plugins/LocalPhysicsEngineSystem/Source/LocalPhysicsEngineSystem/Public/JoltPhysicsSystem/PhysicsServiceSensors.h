@@ -0,0 +1,124 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PhysicsEventBuffer.h"
+
+// The Jolt headers don't include Jolt.h. Always include Jolt.h before including any other Jolt header.
+// You can use Jolt.h in your precompiled header to speed up compilation.
+#include <Jolt/Jolt.h>
+
+// Jolt includes
+#include <Jolt/Physics/Body/BodyID.h>
+#include <Jolt/Physics/PhysicsSystem.h>
+
+// All Jolt symbols are in the JPH namespace
+using namespace JPH;
+
+/**
+* The sensor (trigger) bodies of a physics world and the bodies inside them.
+* A sensor is a kinematic body, always active on the SENSOR layer, that
+* reports contacts but never pushes back, so the bodies inside it are found
+* from the contact events of the steps. Being active, it keeps the contacts
+* of the bodies that fall asleep inside it.
+*
+* Jolt reports a contact for each pair of sub shapes, so a body is counted
+* inside a sensor while any of its sub shapes touches it. The overlaps are
+* only compared once all the fixed steps of a step request are done, so a
+* body that enters and leaves a sensor on the same request is never sent,
+* and a body is entered or exited at most once per request.
+*/
+class LOCALPHYSICSENGINESYSTEM_API FPhysicsServiceSensors
+{
+public:
+	/**
+	* Registers a sensor body, so its contacts are tracked as overlaps and
+	* not sent as contact events.
+	*
+	* @param SensorBodyId The sensor body, already added to the world
+	*/
+	void AddSensor(const BodyID SensorBodyId);
+
+	/**
+	* Forgets a body removed from the world. A removed sensor forgets its
+	* overlaps, as the client removed it. Any other body exits the sensors it
+	* was inside, sent with the next sensor events.
+	*/
+	void RemoveBody(const BodyID RemovedBodyId);
+
+	/** Checks if a body is a sensor */
+	bool IsSensor(const BodyID TestedBodyId) const
+		{ return SensorBodyIndices.Contains(TestedBodyId.GetIndex()); }
+
+	/**
+	* Updates the overlaps with the contact events of a step request's fixed
+	* steps, recording the bodies that entered or exited each sensor.
+	*
+	* @param StepEvents The events drained from the fixed steps
+	*/
+	void UpdateOverlaps(const TArray<FPhysicsServiceEvent>& StepEvents);
+
+	/**
+	* Finds the bodies inside each sensor again by querying the world, as
+	* "UpdateOverlaps()" would for a step request whose events were dropped
+	* by a full event buffer. The overlaps that changed since the last step
+	* request are recorded as entered or exited.
+	*
+	* @param WorldPhysicsSystem The physics system the sensors are on
+	*/
+	void RebuildOverlaps(const PhysicsSystem& WorldPhysicsSystem);
+
+	/**
+	* Consumes the sensor events recorded since the last call as a line for
+	* each sensor whose overlaps changed:
+	*
+	* "Sensor; SensorId; EnteredCount; ExitedCount; EnteredBodyId...;
+	* ExitedBodyId..."
+	*
+	* The sensors are sorted by id, so the response is the same on any
+	* service.
+	*/
+	FString ConsumeSensorEventsResponse();
+
+	/**
+	* Forgets every overlap, keeping the sensors. The bodies still inside a
+	* sensor enter it again on the next contacts.
+	*/
+	void ResetOverlaps();
+
+	/** Forgets every sensor and overlap */
+	void RemoveAllSensors();
+
+	/** Getter to the amount of sensors */
+	int32 GetNumSensors() const { return SensorBodyIndices.Num(); }
+
+private:
+	/** Gets the key of a sensor and body overlap */
+	static uint64 GetOverlapKey(const uint32 SensorIndex,
+		const uint32 BodyIndex)
+		{ return (static_cast<uint64>(SensorIndex) << 32) | BodyIndex; }
+
+	/**
+	* Records that a body entered or exited a sensor, to be sent with the
+	* next sensor events
+	*/
+	void RecordOverlapChange(const uint64 OverlapKey, const bool bEntered);
+
+private:
+	/** The sensor bodies' indices */
+	TSet<uint32> SensorBodyIndices;
+
+	/**
+	* The amount of sub shape contacts of each body inside a sensor. The key
+	* has the sensor index on the high bits and the body index on the low
+	* ones
+	*/
+	TMap<uint64, int32> OverlapContactCounts;
+
+	/**
+	* The overlaps that started or ended since the sensor events were last
+	* sent. The value is true if the body entered the sensor
+	*/
+	TMap<uint64, bool> ChangedOverlaps;
+};
@@ -0,0 +1,145 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// The Jolt headers don't include Jolt.h. Always include Jolt.h before including any other Jolt header.
+// You can use Jolt.h in your precompiled header to speed up compilation.
+#include <Jolt/Jolt.h>
+
+// Jolt includes
+#include <Jolt/Physics/PhysicsSystem.h>
+#include <Jolt/Physics/Vehicle/VehicleConstraint.h>
+#include <Jolt/Physics/Vehicle/VehicleCollisionTester.h>
+
+// All Jolt symbols are in the JPH namespace
+using namespace JPH;
+
+/**
+* The setup of a four wheeled vehicle, on Unreal's units (cm). The wheels are
+* placed on the chassis' corners: the front ones steer and drive the vehicle
+* and the rear ones take the hand brake.
+*/
+struct FPhysicsVehicleSetup
+{
+	/** The chassis box half extent */
+	Vec3 ChassisHalfExtent = Vec3(200.f, 90.f, 20.f);
+
+	/** The wheels' radius and width */
+	float WheelRadius = 30.f;
+	float WheelWidth = 10.f;
+
+	/** How long the suspension is at its max droop */
+	float SuspensionLength = 50.f;
+
+	/** The max torque the engine delivers (N m) */
+	float MaxEngineTorque = 500.f;
+
+	/** How much the front wheels steer (rad) */
+	float MaxSteerAngle = DegreesToRadians(30.f);
+};
+
+/**
+* The wheeled vehicles of a physics world. Each vehicle is a Jolt
+* "VehicleConstraint" on its chassis body, so the wheel raycasts, suspension
+* and drivetrain run on the service along with the step. The constraints are
+* step listeners, which Jolt splits among the job system threads.
+*
+* The chassis is a regular moving body, so its state is sent back with the
+* other bodies. Only the wheels' state is sent by the vehicles.
+*/
+class LOCALPHYSICSENGINESYSTEM_API FPhysicsServiceVehicles
+{
+public:
+	/**
+	* Sets the world the vehicles live on. Any vehicle already added is
+	* removed.
+	*
+	* @param InPhysicsSystem The world's physics system. Must outlive the
+	* vehicles
+	*/
+	void Init(PhysicsSystem* InPhysicsSystem);
+
+	/**
+	* Creates a vehicle on a chassis body already on the world.
+	*
+	* @param ChassisBody The vehicle's chassis body
+	* @param VehicleSetup The vehicle's chassis and wheels setup
+	* @param bIsEnabled If the vehicle is simulated. Vehicles on ghost bodies
+	* are disabled, as they are simulated by their primary's service
+	*
+	* @return True if the vehicle was created
+	*/
+	bool AddVehicle(Body& ChassisBody, const FPhysicsVehicleSetup& VehicleSetup,
+		const bool bIsEnabled);
+
+	/** Enables or disables the vehicle on a chassis body, if there is one */
+	void SetVehicleEnabled(const BodyID& ChassisBodyId, const bool bIsEnabled);
+
+	/**
+	* Sets the drivers' input for the next step. Each line is "Vehicle;
+	* ChassisBodyId; Forward; Right; Brake; HandBrake", where forward and
+	* right go from -1 to 1 and the brakes from 0 to 1.
+	*
+	* The vehicles with no input on a step are left with no input, so they
+	* roll to a stop once their driver is gone.
+	*
+	* @param VehicleInputLines The vehicle input lines
+	*/
+	void SetVehicleInputs(const TArray<FString>& VehicleInputLines);
+
+	/**
+	* Gets the enabled vehicles' state as the step response lines. The
+	* template is:
+	*
+	* "VehicleState; ChassisBodyId; EngineRPM; Gear; NumberOfWheels;
+	* wheelPosX; wheelPosY; wheelPosZ; wheelRotX; wheelRotY; wheelRotZ;
+	* wheelRotW; ...\n"
+	*
+	* The wheels' transforms are relative to the chassis, with the wheel's
+	* axle along the y-axis, so they follow the chassis as it is blended.
+	* The order is front left, front right, rear left and rear right.
+	*/
+	FString GetVehiclesStateResponse() const;
+
+	/** Removes the vehicle on a chassis body, if there is one */
+	void RemoveVehicle(const BodyID& ChassisBodyId);
+
+	/** Removes every vehicle. The chassis bodies are kept */
+	void RemoveAllVehicles();
+
+	/** Getter to the amount of vehicles on the world */
+	int32 GetNumVehicles() const { return Vehicles.Num(); }
+
+private:
+	/** A vehicle and its state on the world */
+	struct FPhysicsVehicle
+	{
+		/** The vehicle constraint on the chassis body */
+		Ref<VehicleConstraint> Constraint;
+
+		/** If the constraint is on the world as a step listener */
+		bool bIsEnabled = false;
+
+		/** If an input for this vehicle came on the current step */
+		bool bHasInput = false;
+	};
+
+	/** Adds or removes the vehicle's constraint from the world */
+	void SetVehicleOnWorld(FPhysicsVehicle& PhysicsVehicle,
+		const bool bIsOnWorld);
+
+private:
+	/** The world's physics system */
+	PhysicsSystem* World = nullptr;
+
+	/** The vehicles. The key is the chassis body index */
+	TMap<uint32, FPhysicsVehicle> Vehicles;
+
+	/**
+	* Tests the wheels' collision with the world. Shared among the vehicles,
+	* as it keeps no state
+	*/
+	RefConst<VehicleCollisionTester> WheelCollisionTester;
+};
@@ -0,0 +1,253 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+
+#include "PhysicsServiceAllocator.h"
+#include "PhysicsServiceImpl.h"
+#include "PhysicsStaticSceneCache.h"
+#include "PhysicsCookedMeshCache.h"
+#include "PhysicsRagdollTypeCache.h"
+
+/**
+* The physics service world manager. This hosts every physics world (one for
+* each physics service region) that runs on this process. Each world is a
+* independent FPhysicsServiceImpl with its own PhysicsSystem, addressed by its
+* world id.
+*
+* The process-global Jolt setup (allocator, factory and types registration) is
+* done only once, no matter how many worlds are created. All the worlds share
+* the same job system, a pool of temp allocators and a shape cache, so a single
+* process can host many small regions without a thread pool for each.
+*
+* The Jolt allocations are routed to the backend set on the command line, and
+* accounted to the world that made them.
+*
+* @see FPhysicsServiceImpl
+* @see FPhysicsAllocatorSettings
+*/
+class LOCALPHYSICSENGINESYSTEM_API FPhysicsServiceWorldManager
+{
+public:
+	/**
+	* Getter to the process-wide world manager. The manager is created on the
+	* first call and lives until the module is shut down.
+	*
+	* @return The world manager for this process
+	*/
+	static FPhysicsServiceWorldManager& Get();
+
+	/**
+	* Shuts the process-wide world manager down. This will destroy every world,
+	* the shared resources and unregister the Jolt globals.
+	*/
+	static void Shutdown();
+
+public:
+	FPhysicsServiceWorldManager();
+	~FPhysicsServiceWorldManager();
+
+	/**
+	* Creates a new physics world with the given id. If a world with such id
+	* already exists, it is returned instead.
+	*
+	* @param WorldId The world id. Usually the physics service region id
+	* @param MaxBodies The max amount of bodies this world can have
+	*
+	* @return The created physics world
+	*/
+	FPhysicsServiceImpl* CreateWorld(const int32 WorldId,
+		const uint32 MaxBodies = FPhysicsServiceImpl::DefaultMaxBodies);
+
+	/**
+	* Getter to a physics world by its id.
+	*
+	* @return The physics world. Nullptr if no world with such id exists
+	*/
+	FPhysicsServiceImpl* GetWorld(const int32 WorldId) const;
+
+	/**
+	* Clears and destroys a physics world by its id.
+	*
+	* @param WorldId The id of the world to destroy
+	*/
+	void DestroyWorld(const int32 WorldId);
+
+	/** Clears and destroys every world on this manager */
+	void DestroyAllWorlds();
+
+	/** Getter to the number of worlds currently hosted */
+	int32 GetNumberOfWorlds() const;
+
+	/**
+	* Handles a physics service message. The message first line is the
+	* command, optionally followed by the target world id with a ";" delimiter.
+	* If no world id is given, the world 0 is used. The template is:
+	*
+	* "Command;WorldId\n
+	* CommandPayload\n
+	* MessageEnd\n"
+	*
+	* The "Init" header may also carry the world step settings, the contact
+	* events budget, the rewind history settings and the world's origin:
+	* "Init;WorldId;FixedDeltaTime;CollisionSteps;IntegrationSubSteps;
+	* MaxCatchUpSteps;MaxContactEventsPerStep;RewindHistoryLength;
+	* MaxRewindBodies;OriginX;OriginY;OriginZ". The "Step"
+	* payload is the elapsed time to advance, followed by the "Ghost" lines of
+	* the clone bodies to drive. @see FPhysicsServiceImpl::SetGhostBodyTargets
+	* It may also carry "Query" lines, run after the step, whose results are
+	* appended to the step response. "SceneQuery" runs them without stepping.
+	* @see FPhysicsServiceImpl::RunSceneQueries
+	* The "Character" lines are the players' movement inputs.
+	* @see FPhysicsServiceCharacters::SetCharacterInputs
+	* The "Vehicle" lines are the vehicles' driver inputs.
+	* @see FPhysicsServiceVehicles::SetVehicleInputs
+	* The "Ragdoll" lines activate pooled ragdolls.
+	* @see FPhysicsServiceRagdolls::ActivateRagdolls
+	* The "KinematicTargets" line packs the movers' transforms.
+	* @see FPhysicsServiceImpl::SetKinematicBodyTargets
+	* The "Constraint" and "RemoveConstraint" lines change the constraints.
+	* @see FPhysicsServiceConstraints::ApplyConstraintChanges
+	* The "RadialImpulse", "ForceField" and "RemoveForceField" lines push the
+	* bodies on an area. @see FPhysicsServiceForceFields::ApplyForceFieldChanges
+	* The "UpdateBodyType" payload is "BodyId;primary|clone". The
+	* "RewindRaycast" payload are the rays to cast on past steps.
+	* @see FPhysicsServiceImpl::RewindRaycast
+	*
+	* To migrate a world between services, "SaveSnapshot" returns the world
+	* snapshot, which is sent as the "RestoreSnapshot" payload to the target
+	* service. Like "Init", "RestoreSnapshot" creates the world if needed.
+	*
+	* The "Init" payload may reference a baked static scene instead of sending
+	* each static body. If it is not baked yet, the response is
+	* "StaticSceneMissing", and the client should send "BakeStaticScene" and
+	* "Init" again. @see FPhysicsServiceImpl::BakeStaticScene
+	*
+	* "GetMemoryMeasures" returns the world's memory counters.
+	* @see FPhysicsMemoryAccounting::GetMeasureLine
+	*
+	* Static mesh bodies reference a cooked mesh by its hash. Before "Init",
+	* the client sends the hashes on "HasCookedMeshes", and "CookMesh" for
+	* each one listed as "MissingMesh". @see FPhysicsCookedMeshCache::CookMesh
+	*
+	* The ragdoll types are also shared by every world, so "RegisterRagdollType"
+	* needs no world. @see FPhysicsRagdollTypeCache::RegisterRagdollType
+	*
+	* @param Message The full message received by the physics service
+	*
+	* @return The response to send back, ending with "MessageEnd"
+	*/
+	FString HandleMessage(const FString& Message);
+
+public:
+	/** Getter to the job system shared by all worlds */
+	JobSystem* GetSharedJobSystem() const { return SharedJobSystem; }
+
+	/**
+	* Acquires a temp allocator from the pool. Each world should acquire one
+	* before stepping and release it right after, so worlds stepping at the
+	* same time never share a temp allocator.
+	*
+	* @return A temp allocator that is exclusive to the caller until released
+	*/
+	FPhysicsTempAllocator* AcquireTempAllocator();
+
+	/**
+	* Releases a temp allocator back to the pool.
+	*
+	* @param TempAllocatorToRelease The temp allocator acquired previously
+	*/
+	void ReleaseTempAllocator(FPhysicsTempAllocator* TempAllocatorToRelease);
+
+	/**
+	* Gets a sphere shape with the given radius from the shared shape cache,
+	* creating it if it does not exist yet.
+	*/
+	ShapeRefC GetOrCreateSphereShape(const float Radius);
+
+	/**
+	* Gets a box shape with the given half extents from the shared shape
+	* cache, creating it if it does not exist yet.
+	*/
+	ShapeRefC GetOrCreateBoxShape(const Vec3 HalfExtents);
+
+	/** Getter to the baked static scenes cache shared by all worlds */
+	FPhysicsStaticSceneCache& GetStaticSceneCache()
+		{ return StaticSceneCache; }
+
+	/** Getter to the cooked meshes cache shared by all worlds */
+	FPhysicsCookedMeshCache& GetCookedMeshCache() { return CookedMeshCache; }
+
+	/** Getter to the ragdoll types cache shared by all worlds */
+	FPhysicsRagdollTypeCache& GetRagdollTypeCache()
+		{ return RagdollTypeCache; }
+
+private:
+	/**
+	* Registers the process-global Jolt setup (allocator, factory and types).
+	* Reference counted, so it is only done by the first manager.
+	*/
+	static void AcquireJoltGlobals();
+
+	/**
+	* Unregisters the process-global Jolt setup once the last manager
+	* releases it.
+	*/
+	static void ReleaseJoltGlobals();
+
+	/**
+	* Parses the message header line into the command, the target world
+	* id and any further header arguments. The world id is 0 if not given.
+	*/
+	static void ParseMessageHeader(const FString& HeaderLine,
+		FString& OutCommand, int32& OutWorldId,
+		TArray<FString>& OutHeaderArguments);
+
+private:
+	/** The hosted physics worlds. The key is the world id */
+	TMap<int32, FPhysicsServiceImpl*> Worlds;
+
+	/**
+	* Critical section to synchronize access to the worlds map, as the worlds
+	* are created and destroyed by the coordinators' threads too
+	*/
+	mutable FCriticalSection WorldsCriticalSection;
+
+	/** The job system that executes the physics jobs of every world */
+	JobSystemThreadPool* SharedJobSystem = nullptr;
+
+	/** Every temp allocator created by the pool */
+	TArray<FPhysicsTempAllocator*> TempAllocatorPool;
+
+	/** The temp allocators on the pool that are not currently acquired */
+	TArray<FPhysicsTempAllocator*> FreeTempAllocators;
+
+	/** Critical section to synchronize access to the temp allocator pool */
+	FCriticalSection TempAllocatorPoolCriticalSection;
+
+	/** The shared shapes cache. The key is a description of the shape */
+	TMap<FString, ShapeRefC> ShapeCache;
+
+	/** Critical section to synchronize access to the shape cache */
+	FCriticalSection ShapeCacheCriticalSection;
+
+	/** The baked static scenes cache */
+	FPhysicsStaticSceneCache StaticSceneCache;
+
+	/** The cooked meshes cache */
+	FPhysicsCookedMeshCache CookedMeshCache;
+
+	/** The ragdoll types cache */
+	FPhysicsRagdollTypeCache RagdollTypeCache;
+
+	/** The process-wide world manager instance */
+	static FPhysicsServiceWorldManager* Instance;
+
+	/** The amount of managers holding the Jolt globals registered */
+	static int32 JoltGlobalsRefCount;
+
+	/** The size of each temp allocator on the pool (10 MB) */
+	static constexpr uint32 TempAllocatorSize = 10 * 1024 * 1024;
+};
@@ -0,0 +1,133 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// The Jolt headers don't include Jolt.h. Always include Jolt.h before including any other Jolt header.
+// You can use Jolt.h in your precompiled header to speed up compilation.
+#include <Jolt/Jolt.h>
+
+// Jolt includes
+#include <Jolt/Math/Float3.h>
+#include <Jolt/Math/Float4.h>
+#include <Jolt/Physics/Body/BodyID.h>
+#include <Jolt/Physics/Body/BodyInterface.h>
+
+// STL includes
+#include <vector>
+
+// All Jolt symbols are in the JPH namespace
+using namespace JPH;
+
+/** The state of a single body recorded on a physics step */
+struct FPhysicsBodyHistoryState
+{
+	/** The body the state belongs to */
+	BodyID Body;
+
+	/** The body's center of mass position */
+	Float3 Position = Float3(0.f, 0.f, 0.f);
+
+	/** The body's rotation as a quaternion (x, y, z, w) */
+	Float4 Rotation = Float4(0.f, 0.f, 0.f, 1.f);
+};
+
+/**
+* A ring of the bodies' states on the last physics steps. Used to query the
+* world as it was a few steps ago, e.g. to validate a hit against where the
+* bodies were when the player shot.
+*
+* Every step slot is preallocated for a max amount of bodies, so recording a
+* step never allocates and the memory cost is fixed:
+* HistoryLength * MaxBodiesPerStep * sizeof(FPhysicsBodyHistoryState).
+* Only the moving bodies should be recorded, as static ones never change.
+*/
+class LOCALPHYSICSENGINESYSTEM_API FPhysicsStateHistory
+{
+public:
+	/**
+	* Allocates the ring. Any recorded step is discarded.
+	*
+	* @param InHistoryLength The amount of steps kept. 0 disables the history
+	* @param InMaxBodiesPerStep The max amount of bodies recorded on each
+	* step. Bodies beyond it are not recorded
+	*/
+	void Allocate(const uint32 InHistoryLength,
+		const uint32 InMaxBodiesPerStep);
+
+	/** Discards every recorded step and frees the ring's memory */
+	void Release();
+
+	/**
+	* Records the state of the given bodies on a step, overwriting the oldest
+	* step if the ring is full.
+	*
+	* @param StepIndex The index of the step being recorded
+	* @param BodyInterface The body interface to read the bodies' state from
+	* @param KinematicBodyIds The kinematic bodies to record, e.g. doors and
+	* moving platforms. Recorded before the dynamic ones
+	* @param DynamicBodyIds The dynamic bodies to record
+	*/
+	void RecordStep(const uint32 StepIndex, const BodyInterface& BodyInterface,
+		const std::vector<BodyID>& KinematicBodyIds,
+		const std::vector<BodyID>& DynamicBodyIds);
+
+	/**
+	* Getter to the bodies' state recorded on a step.
+	*
+	* @param StepIndex The step to get the bodies' state of
+	*
+	* @return The bodies' state. Empty if the step is not on the history
+	*/
+	TArrayView<const FPhysicsBodyHistoryState> GetStepBodyStates
+		(const uint32 StepIndex) const;
+
+	/** Checks if the history is enabled, i.e. if it keeps any step */
+	bool IsEnabled() const { return HistoryLength > 0; }
+
+	/** Getter to the oldest step on the history */
+	uint32 GetOldestStepIndex() const;
+
+	/** Getter to the newest step on the history */
+	uint32 GetNewestStepIndex() const;
+
+	/** Getter to the memory, in bytes, allocated by the ring */
+	SIZE_T GetAllocatedSize() const
+		{ return BodyStates.GetAllocatedSize() + Steps.GetAllocatedSize(); }
+
+private:
+	/** A step slot on the ring */
+	struct FStepSlot
+	{
+		/** The index of the step recorded on this slot */
+		uint32 StepIndex = 0;
+
+		/** The amount of bodies recorded on this slot */
+		uint32 NumberOfBodies = 0;
+	};
+
+	/**
+	* The recorded bodies' state. Each step slot owns a fixed range of
+	* MaxBodiesPerStep entries
+	*/
+	TArray<FPhysicsBodyHistoryState> BodyStates;
+
+	/** The step slots */
+	TArray<FStepSlot> Steps;
+
+	/** The amount of steps kept */
+	uint32 HistoryLength = 0;
+
+	/** The max amount of bodies recorded on each step */
+	uint32 MaxBodiesPerStep = 0;
+
+	/** The slot the next step is recorded on */
+	uint32 NextSlotIndex = 0;
+
+	/** The amount of slots already recorded. Up to the history length */
+	uint32 RecordedStepsCount = 0;
+
+	/** If the bodies beyond the max were already warned about */
+	bool bHasWarnedAboutMaxBodies = false;
+};
@@ -0,0 +1,112 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/CriticalSection.h"
+#include "PhysicsWorldOrigin.h"
+
+// The Jolt headers don't include Jolt.h. Always include Jolt.h before including any other Jolt header.
+// You can use Jolt.h in your precompiled header to speed up compilation.
+#include <Jolt/Jolt.h>
+
+// Jolt includes
+#include <Jolt/Physics/PhysicsScene.h>
+
+// All Jolt symbols are in the JPH namespace
+using namespace JPH;
+
+/**
+* A cache of baked static scenes. A static scene holds the creation settings
+* (shapes included) of every static body on a map region, so a world can add
+* them all at once instead of parsing and recreating each one from the "Init"
+* message.
+*
+* Scenes are addressed by a key (usually the map and region id) and carry the
+* hash of the content they were baked from, so a changed map is never loaded
+* from a stale scene. Baked scenes are kept on memory, shared by every world
+* on the process, and saved on disk as Jolt binary scenes, so they survive
+* the physics service restarts.
+*
+* Each scene is on the space of the world that baked it, so its positions
+* stay small, and carries that world's origin, so the worlds of other
+* origins can rebase it.
+*/
+class LOCALPHYSICSENGINESYSTEM_API FPhysicsStaticSceneCache
+{
+public:
+	/**
+	* Finds a baked static scene. The memory is searched first, then the disk.
+	*
+	* @param SceneKey The key that addresses the scene
+	* @param ContentHash The hash of the content the scene must be baked from
+	* @param OutSceneOrigin The origin of the world the scene was baked on
+	*
+	* @return The static scene. Nullptr if not baked yet or if baked from
+	* another content
+	*/
+	Ref<PhysicsScene> FindStaticScene(const FString& SceneKey,
+		const uint32 ContentHash, FPhysicsWorldOrigin& OutSceneOrigin);
+
+	/**
+	* Adds a baked static scene to the cache, saving it on disk.
+	*
+	* @param SceneKey The key that addresses the scene
+	* @param ContentHash The hash of the content the scene was baked from
+	* @param StaticScene The static scene
+	* @param SceneOrigin The origin of the world the scene was baked on
+	*/
+	void AddStaticScene(const FString& SceneKey, const uint32 ContentHash,
+		const Ref<PhysicsScene>& StaticScene,
+		const FPhysicsWorldOrigin& SceneOrigin);
+
+	/** Empties the memory cache. The scenes on disk are kept */
+	void Empty();
+
+private:
+	/** Getter to the file path a scene is saved on */
+	static FString GetStaticSceneFilePath(const FString& SceneKey);
+
+	/**
+	* Loads a scene from disk.
+	*
+	* @return The scene. Nullptr if there is no file, if the file is invalid or
+	* if it was baked from another content
+	*/
+	static Ref<PhysicsScene> LoadStaticSceneFile(const FString& SceneKey,
+		const uint32 ContentHash, FPhysicsWorldOrigin& OutSceneOrigin);
+
+	/** Saves a scene on disk */
+	static void SaveStaticSceneFile(const FString& SceneKey,
+		const uint32 ContentHash, const PhysicsScene& StaticScene,
+		const FPhysicsWorldOrigin& SceneOrigin);
+
+private:
+	/** A static scene on the memory cache */
+	struct FCachedStaticScene
+	{
+		/** The hash of the content the scene was baked from */
+		uint32 ContentHash = 0;
+
+		/** The static scene */
+		Ref<PhysicsScene> StaticScene;
+
+		/** The origin of the world the scene was baked on */
+		FPhysicsWorldOrigin SceneOrigin;
+	};
+
+	/** The static scenes on memory. The key is the scene key */
+	TMap<FString, FCachedStaticScene> CachedStaticScenes;
+
+	/** Critical section to synchronize access to the cache */
+	FCriticalSection CacheCriticalSection;
+
+	/** The tag that starts every static scene file ("JPSC") */
+	static constexpr uint32 StaticSceneFileTag = 0x4353504A;
+
+	/**
+	* The static scene file version. Must be increased whenever the way static
+	* bodies are created changes, so older files are baked again
+	*/
+	static constexpr uint32 StaticSceneFileVersion = 2;
+};
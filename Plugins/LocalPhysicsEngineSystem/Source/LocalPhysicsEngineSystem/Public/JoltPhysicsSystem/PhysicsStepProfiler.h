@@ -0,0 +1,135 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PhysicsServiceAllocator.h"
+
+// The Jolt headers don't include Jolt.h. Always include Jolt.h before including any other Jolt header.
+// You can use Jolt.h in your precompiled header to speed up compilation.
+#include <Jolt/Jolt.h>
+
+// Jolt includes
+#include <Jolt/Core/JobSystemWithBarrier.h>
+#include <Jolt/Physics/PhysicsSettings.h>
+
+// STL includes
+#include <atomic>
+
+// All Jolt symbols are in the JPH namespace
+using namespace JPH;
+
+/** The phases of a physics step, given by the Jolt jobs that run them */
+enum class EPhysicsStepPhase : uint8
+{
+	BroadPhase,
+	NarrowPhase,
+	ConstraintSetup,
+	SolveVelocity,
+	SolvePosition,
+	Integration,
+	Other,
+	Num
+};
+
+/**
+* Collects the time spent on each phase of a physics step. The Jolt library is
+* prebuilt without its profiling macros, so the phases are measured on the job
+* system instead: this wraps the job system a world steps with, timing each
+* job it runs and adding the time to the phase of the job's name.
+*
+* Jobs are created on the wrapped job system, so they still run on its
+* threads. Only the job functions are wrapped. The jobs are also emitted as
+* named events, so they show on Unreal Insights when named events are enabled.
+*
+* As the job threads are shared by every world, the wrapped jobs also account
+* their allocations to the world that steps with this profiler. The barriers
+* are this profiler's own, so the worlds stepping at the same time never run
+* out of the wrapped job system's barriers.
+*/
+class LOCALPHYSICSENGINESYSTEM_API FPhysicsStepProfiler :
+	public JobSystemWithBarrier
+{
+public:
+	/**
+	* Constructor.
+	*
+	* @param InProfiledJobSystem The job system that runs the jobs. Must
+	* outlive this profiler
+	* @param InMemoryAccounting The counters to account the jobs' allocations
+	* on
+	*/
+	FPhysicsStepProfiler(JobSystem& InProfiledJobSystem,
+		FPhysicsMemoryAccounting* InMemoryAccounting = nullptr)
+		: JobSystemWithBarrier(cMaxPhysicsBarriers),
+		ProfiledJobSystem(InProfiledJobSystem),
+		MemoryAccounting(InMemoryAccounting) {}
+
+public:
+	/** Resets the phases' times. Should be called before each physics step */
+	void BeginStep();
+
+	/** Ends the physics step measurement started by "BeginStep()" */
+	void EndStep();
+
+	/**
+	* Gets the last measured physics step as a measurement line. The
+	* template is:
+	*
+	* "Phases; StepMicroseconds; BroadPhaseMicroseconds;
+	* NarrowPhaseMicroseconds; ConstraintSetupMicroseconds;
+	* SolveVelocityMicroseconds; SolvePositionMicroseconds;
+	* IntegrationMicroseconds; OtherMicroseconds; JobCount;
+	* ThreadUtilisation\n"
+	*
+	* The thread utilisation is the time spent on jobs over the time every
+	* job system thread had during the step, from 0 to 1.
+	*/
+	FString GetLastStepMeasureLine() const;
+
+	/** Gets the phase a Jolt job is part of, given by the job's name */
+	static EPhysicsStepPhase GetJobPhase(const char* JobName);
+
+public:
+	// JobSystem interface
+	virtual int GetMaxConcurrency() const override
+		{ return ProfiledJobSystem.GetMaxConcurrency(); }
+	virtual JobHandle CreateJob(const char* inName, ColorArg inColor,
+		const JobFunction& inJobFunction, uint32 inNumDependencies = 0)
+		override;
+
+protected:
+	/**
+	* The jobs are created on (and owned by) the profiled job system, so
+	* these are never called on this one
+	*/
+	virtual void QueueJob(Job* inJob) override { JPH_ASSERT(false); }
+	virtual void QueueJobs(Job** inJobs, uint inNumJobs) override
+		{ JPH_ASSERT(false); }
+	virtual void FreeJob(Job* inJob) override { JPH_ASSERT(false); }
+
+private:
+	/** The job system that runs the jobs */
+	JobSystem& ProfiledJobSystem;
+
+	/** The counters the jobs' allocations are accounted on */
+	FPhysicsMemoryAccounting* MemoryAccounting = nullptr;
+
+	/** The cycles spent on each phase's jobs on the current step */
+	std::atomic<uint64> PhaseCycles[(int32)EPhysicsStepPhase::Num] = {};
+
+	/** The number of jobs run on the current step */
+	std::atomic<uint32> JobCount{ 0 };
+
+	/** The cycle the current step has started on */
+	uint64 StepStartCycles = 0;
+
+	/** The last measured step's total cycles */
+	uint64 LastStepCycles = 0;
+
+	/** The cycles spent on each phase's jobs on the last measured step */
+	uint64 LastStepPhaseCycles[(int32)EPhysicsStepPhase::Num] = {};
+
+	/** The number of jobs run on the last measured step */
+	uint32 LastStepJobCount = 0;
+};
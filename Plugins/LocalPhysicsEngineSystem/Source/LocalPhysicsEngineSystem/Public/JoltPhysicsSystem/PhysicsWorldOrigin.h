@@ -0,0 +1,87 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+// The Jolt headers don't include Jolt.h. Always include Jolt.h before including any other Jolt header.
+// You can use Jolt.h in your precompiled header to speed up compilation.
+#include <Jolt/Jolt.h>
+
+// Jolt includes
+#include <Jolt/Math/Real.h>
+
+// All Jolt symbols are in the JPH namespace
+using namespace JPH;
+
+/**
+* The local origin of a physics world, on the client's world space. The
+* client sends and receives its world positions (cm), while the bodies are
+* simulated relative to this origin, usually the center of the region that
+* owns the world. Thus, the positions given to Jolt stay small and precise
+* on a single precision build, no matter how far the region is from the
+* client's world origin.
+*
+* Only positions are converted. Directions, velocities, rotations and
+* extents are the same on both spaces. The conversion is made in double
+* precision, so no precision is lost other than the final rounding.
+*/
+struct FPhysicsWorldOrigin
+{
+	/** The origin's location on the client's world space */
+	double X = 0.0;
+	double Y = 0.0;
+	double Z = 0.0;
+
+	/** Converts a position on the client's space to the world's space */
+	RVec3 ToLocalPosition(const double ClientX, const double ClientY,
+		const double ClientZ) const
+	{
+		return RVec3(static_cast<Real>(ClientX - X),
+			static_cast<Real>(ClientY - Y), static_cast<Real>(ClientZ - Z));
+	}
+
+	/** Converts a position on the client's space to the world's space */
+	RVec3 ToLocalPosition(RVec3Arg ClientPosition) const
+	{
+		return ToLocalPosition(ClientPosition.GetX(), ClientPosition.GetY(),
+			ClientPosition.GetZ());
+	}
+
+	/**
+	* Converts a position on the space of another origin to the world's
+	* space, e.g. a static scene baked by another world.
+	*/
+	RVec3 ToLocalPosition(const FPhysicsWorldOrigin& OtherOrigin,
+		RVec3Arg OtherPosition) const
+	{
+		return ToLocalPosition(OtherOrigin.X + OtherPosition.GetX(),
+			OtherOrigin.Y + OtherPosition.GetY(),
+			OtherOrigin.Z + OtherPosition.GetZ());
+	}
+
+	/**
+	* Parses three consecutive fields of a message line as a position on the
+	* client's space, converted to the world's space.
+	*
+	* @param LineInfo The message line, split by ";"
+	* @param FirstIndex The index of the position's X field
+	*/
+	RVec3 ParseLocalPosition(const TArray<FString>& LineInfo,
+		const int32 FirstIndex) const
+	{
+		return ToLocalPosition(FCString::Atod(*LineInfo[FirstIndex]),
+			FCString::Atod(*LineInfo[FirstIndex + 1]),
+			FCString::Atod(*LineInfo[FirstIndex + 2]));
+	}
+
+	/**
+	* Gets a position on the world's space as a "X;Y;Z" position on the
+	* client's space, as the positions are sent on the responses.
+	*/
+	FString ToClientPositionString(RVec3Arg LocalPosition) const
+	{
+		return FString::Printf(TEXT("%f;%f;%f"), X + LocalPosition.GetX(),
+			Y + LocalPosition.GetY(), Z + LocalPosition.GetZ());
+	}
+};
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "RemotePhysicsEngineSystem/Public/PhysicsSimulation/Utils/PSDBodyIndexAllocator.h"
 #include "PSDActorsCoordinator_Local.generated.h"
 
 UCLASS()
@@ -60,6 +61,54 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void StopPSDActorsSimulation();
 
+	/**
+	* Adds a PSD actor to the running simulation. The body is added to the
+	* physics world before the next step. Server only.
+	*
+	* @param PSDActorToAdd The PSD actor to add
+	*/
+	UFUNCTION(BlueprintCallable)
+	void AddPSDActorToSimulation(class APSDActorBase* PSDActorToAdd);
+
+	/**
+	* Removes a PSD actor from the running simulation. The body is removed
+	* from the physics world before the next step. Server only.
+	*
+	* @param PSDActorToRemove The PSD actor to remove
+	*/
+	UFUNCTION(BlueprintCallable)
+	void RemovePSDActorFromSimulation(class APSDActorBase* PSDActorToRemove);
+
+	/**
+	* Adds an impulse to a PSD actor on the running simulation. The impulse
+	* is applied before the next step. Server only.
+	*
+	* @param PSDActorToPush The PSD actor to push
+	* @param Impulse The impulse to add on the PSD actor's center of mass
+	*/
+	UFUNCTION(BlueprintCallable)
+	void AddImpulseToPSDActor(class APSDActorBase* PSDActorToPush,
+		const FVector& Impulse);
+
+	/**
+	* Sends the current physics world snapshot to every client, so they
+	* restart their lockstep simulation from it. Server only. This should be
+	* called once a client requests a resync.
+	*
+	* @see ConsumeLockstepResyncRequest()
+	*/
+	void SendLockstepSnapshot();
+
+	/**
+	* Checks if this client needs a lockstep resync, clearing the request.
+	* The client's player controller should poll this and ask the server to
+	* "SendLockstepSnapshot()", as only the server can send it.
+	*
+	* @return True if the client's lockstep simulation has diverged or missed
+	* a frame and a snapshot should be requested. False otherwise
+	*/
+	bool ConsumeLockstepResyncRequest();
+
 public:
 	/** Sets default values for this actor's properties */
 	APSDActorsCoordinator_Local();
@@ -99,16 +148,96 @@ private:
 	UFUNCTION(NetMulticast, Reliable)
 	void SaveAllocatedRamMeasurements() const;
 
+	/**
+	* Receives a lockstep frame from the server. The client applies the
+	* frame's commands and runs the same amount of fixed steps on its own
+	* physics world, instead of receiving each body's Transform.
+	*
+	* @param FirstStepIndex The server's step counter before the frame. Must
+	* match the client's one, or a frame was missed
+	* @param NumberOfSteps The amount of fixed steps to run
+	* @param SimulationCommands The commands applied before the steps
+	* @see FPhysicsServiceImpl::ApplySimulationCommand()
+	* @param InterpolationAlpha The server's interpolation alpha after the
+	* steps
+	* @param StateChecksum The server's world checksum after the steps. 0 if
+	* not checked on this frame
+	*/
+	UFUNCTION(NetMulticast, Reliable)
+	void ReceiveLockstepFrame(const uint32 FirstStepIndex,
+		const int32 NumberOfSteps, const TArray<FString>& SimulationCommands,
+		const float InterpolationAlpha, const uint32 StateChecksum);
+
+	/**
+	* Receives a chunk of the server's world snapshot. Once every chunk is
+	* received, the client's physics world is restored from it. The snapshot
+	* is chunked as a single RPC can't carry a large world.
+	*
+	* @param SnapshotId The id of the snapshot the chunk belongs to
+	* @param ChunkIndex The index of this chunk
+	* @param NumberOfChunks The amount of chunks on the snapshot
+	* @param SnapshotChunk The snapshot chunk
+	*/
+	UFUNCTION(NetMulticast, Reliable)
+	void ReceiveLockstepSnapshotChunk(const int32 SnapshotId,
+		const int32 ChunkIndex, const int32 NumberOfChunks,
+		const FString& SnapshotChunk);
+
 private:
 	/**
 	* Updates the PSD actors Transform. This will request the physics service
 	* server physics update and await its response. Once returned, will parse
 	* the result to update each PSD actor Transform.
+	*
+	* @param DeltaTime The game time elapsed since the last update. The
+	* physics world is advanced by this time
 	*/
-	void UpdatePSDActors();
+	void UpdatePSDActors(const float DeltaTime);
 
 	void InitializePhysicsWorld();
 
+	/**
+	* Updates the PSD actors Transform given a step physics result. The PSD
+	* actors are then blended between their two last physics states.
+	*
+	* @param PhysicsSimulationResult The bodies' state lines
+	* @param InterpolationAlpha The interpolation alpha to blend with
+	*/
+	void ApplyPhysicsSimulationResult(const FString& PhysicsSimulationResult,
+		const float InterpolationAlpha);
+
+	/** Maps every PSD actor on the level by its body id */
+	void GatherPSDActors();
+
+	/** Destroys this coordinator's physics world, if any */
+	void DestroyPhysicsWorld();
+
+	/**
+	* Flags this client's lockstep simulation as diverged. Frames are ignored
+	* until a snapshot is received.
+	*/
+	void RequestLockstepResync();
+
+public:
+	/**
+	* Flag that indicates if the simulation runs on lockstep. If so, each
+	* client runs the physics world locally and the server only sends the
+	* simulation commands and the amount of steps to run, instead of each
+	* PSD actor Transform. The simulation is deterministic, so every client
+	* ends on the same state. Periodic checksums detect any divergence, which
+	* is fixed by resending the world snapshot.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bUseLockstepSimulation = false;
+
+	/** 
+	* The interval, in physics steps, the lockstep world checksum is sent to
+	* clients. The smaller, the closer a divergence is reported to the step
+	* it happened on
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 LockstepChecksumIntervalSteps = 1;
+
 private:
 	/**
 	* Flag that indicates if this PSD actor coordinator is currently updating
@@ -126,8 +255,47 @@ private:
 	/** Counts the amount of step the physics system */
 	uint32 StepPhysicsCounter = 0;
 
-	/** */
-	TMap<uint32, class APSDActorBase*> PSDActorMap;
+	/** The PSDActors on the simulation, mapped by their body index */
+	FPSDActorBodyIndexMap PSDActorMap;
+
+	/** Allocates the PSDActors body indices. Only used on the server */
+	FPSDBodyIndexAllocator BodyIndexAllocator;
+
+	/** 
+	* The simulation commands to apply before the next step. On lockstep,
+	* they are also sent to clients with the next frame
+	*/
+	TArray<FString> PendingSimulationCommands;
+
+	/** The id of the last lockstep snapshot sent or being received */
+	int32 LockstepSnapshotId = 0;
+
+	/** The lockstep snapshot chunks received so far */
+	TArray<FString> ReceivedLockstepSnapshotChunks;
+
+	/** The amount of lockstep snapshot chunks received so far */
+	int32 ReceivedLockstepSnapshotChunksCount = 0;
+
+	/**
+	* Flag that indicates if this client is waiting for a lockstep snapshot.
+	* Frames are ignored meanwhile
+	*/
+	bool bIsAwaitingLockstepSnapshot = false;
+
+	/** Flag that indicates if this client should request a lockstep resync */
+	bool bHasPendingLockstepResyncRequest = false;
+
+	/** The last lockstep step this client's checksum matched the server's */
+	uint32 LastVerifiedLockstepStepIndex = 0;
+
+	/** The game time the last lockstep resync was requested at */
+	float LockstepResyncRequestTime = 0.f;
+
+	/** The time, in seconds, to wait for a snapshot before requesting again */
+	static constexpr float LockstepResyncTimeoutSeconds = 5.f;
+
+	/** The max amount of characters on each lockstep snapshot chunk */
+	static constexpr int32 LockstepSnapshotChunkSize = 32 * 1024;
 
 private:
 	/** */
@@ -69,6 +69,53 @@ bool FSocketClientProxy::CloseSocketConnectionsToServerById
     return true;
 }
 
+USocketClientInstance* FSocketClientProxy::CreateSocketConnection
+    (const FString& ServerIpAddr, const FString& ServerPort)
+{
+    // Create a new socket client instance
+    auto* NewSocketClientInstance = NewObject<USocketClientInstance>();
+
+    // Open connection to server
+    NewSocketClientInstance->OpenSocketConnectionToServer(ServerIpAddr, 
+        ServerPort);
+
+    // Check if we have found a valid connection with the request server
+    if (!NewSocketClientInstance->IsConnectionValid())
+    {
+        RPES_LOG_ERROR(TEXT("Unable to connect to server \"%s:%s\"."),
+            *ServerIpAddr, *ServerPort);
+        return nullptr;
+    }
+
+    return NewSocketClientInstance;
+}
+
+bool FSocketClientProxy::ReplaceSocketConnectionToServer
+    (const int32 TargetServerId, USocketClientInstance* NewSocketConnection)
+{
+    // Check if the new connection is valid
+    if (!NewSocketConnection || !NewSocketConnection->IsConnectionValid())
+    {
+        RPES_LOG_ERROR(TEXT("Could not replace socket connection with id "
+            "(%d) as the new connection is not valid."), TargetServerId);
+        return false;
+    }
+
+    // Close the previous connection, if any
+    if (IsConnectionValid(TargetServerId))
+    {
+        SocketConnectionsMap[TargetServerId]->CloseSocketConnection();
+    }
+
+    // Set the new connection on the socket connections map
+    SocketConnectionsMap.Add(TargetServerId, NewSocketConnection);
+
+    RPES_LOG_INFO(TEXT("Socket connection with id (%d) replaced."),
+        TargetServerId);
+
+    return true;
+}
+
 USocketClientInstance* FSocketClientProxy::GetSocketConnectionByServerId
     (const int32 TargetServerId)
 {
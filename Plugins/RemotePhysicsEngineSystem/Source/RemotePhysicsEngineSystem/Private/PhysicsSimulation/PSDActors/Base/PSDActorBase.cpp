@@ -37,21 +37,11 @@ APSDActorBase::APSDActorBase()
 	// Set this actor to replicate as it will spawn on the server
 	bReplicates = true;
 	SetReplicateMovement(true);
-
-	// Set the actor's BodyID as the UniqueID
-	PSDActorBodyId = GetUniqueID();
 }
 
 void APSDActorBase::BeginPlay()
 {
 	Super::BeginPlay();
-
-	// Set the actor's body id on the server
-	if (HasAuthority())
-	{
-		// Set the actor's BodyID as the UniqueID
-		PSDActorBodyId = GetUniqueID();
-	}
 }
 
 void APSDActorBase::Tick(float DeltaTime)
@@ -91,6 +81,19 @@ FString APSDActorBase::GetPSDActorAngularVelocityAsString() const
 	return ActorAngularVelocityAsString;
 }
 
+FString APSDActorBase::GetPhysicsServiceGhostStateString() const
+{
+	// Use the last physics position, as the actor itself is interpolated
+	// behind it
+	const FVector GhostPosition = bHasPhysicsLocation ?
+		CurrentPhysicsLocation : GetActorLocation();
+
+	return FString::Printf(TEXT("Ghost;%d;%f;%f;%f;%s;%s\n"), PSDActorBodyId,
+		GhostPosition.X, GhostPosition.Y, GhostPosition.Z,
+		*GetPSDActorLinearVelocityAsString(),
+		*GetPSDActorAngularVelocityAsString());
+}
+
 void APSDActorBase::GetLifetimeReplicatedProps
 	(TArray<FLifetimeProperty>& OutLifetimeProps) const
 {
@@ -108,6 +111,14 @@ FString APSDActorBase::GetPhysicsServiceInitializationString()
 	return FString();
 }
 
+FString APSDActorBase::GetPhysicsServiceCloneInitializationString() const
+{
+	return FString::Printf(TEXT("sphere;%d;clone;%s;%s;%s\n"), PSDActorBodyId,
+		*GetCurrentActorLocationAsString(),
+		*GetPSDActorLinearVelocityAsString(),
+		*GetPSDActorAngularVelocityAsString());
+}
+
 void APSDActorBase::OnEnteredPhysicsRegion(int32 EnteredPhysicsRegionId)
 {
 	OnActorEnteredPhysicsRegion.Broadcast(this, EnteredPhysicsRegionId);
@@ -118,6 +129,46 @@ void APSDActorBase::OnExitedPhysicsRegion(int32 ExitedPhysicsRegionId)
 	OnActorExitedPhysicsRegion.Broadcast(this, ExitedPhysicsRegionId);
 }
 
+FString APSDActorBase::GetContactSubscriptionString() const
+{
+	// The subscription flags, as expected by the physics service
+	// (1 = contact begin, 2 = contact end)
+	const int32 SubscriptionFlags = (bSubscribeToContactBegin ? 1 : 0) |
+		(bSubscribeToContactEnd ? 2 : 0);
+
+	if (SubscriptionFlags == 0)
+	{
+		return FString();
+	}
+
+	return FString::Printf(TEXT("%d;%d;%f\n"), PSDActorBodyId,
+		SubscriptionFlags, MinContactImpulse);
+}
+
+void APSDActorBase::OnPhysicsContactBegin(APSDActorBase* OtherPSDActor,
+	const int32 OtherBodyId, const FVector& ContactPoint,
+	const FVector& ContactNormal, const float ContactImpulse)
+{
+	if (!bSubscribeToContactBegin)
+	{
+		return;
+	}
+
+	OnPSDActorContactBegin.Broadcast(this, OtherPSDActor, OtherBodyId,
+		ContactPoint, ContactNormal, ContactImpulse);
+}
+
+void APSDActorBase::OnPhysicsContactEnd(APSDActorBase* OtherPSDActor,
+	const int32 OtherBodyId)
+{
+	if (!bSubscribeToContactEnd)
+	{
+		return;
+	}
+
+	OnPSDActorContactEnd.Broadcast(this, OtherPSDActor, OtherBodyId);
+}
+
 void APSDActorBase::OnRep_PhysicsRegionStatusUpdated()
 {
 	// Switch the enum and set the new physics region status string
@@ -154,7 +205,12 @@ void APSDActorBase::UpdatePositionAfterPhysicsSimulation
 	// If on server, update it
 	if (HasAuthority())
 	{
-		SetActorLocation(NewActorPosition);
+		// The current physics position becomes the previous one. If this is
+		// the first one, use the new position for both
+		PreviousPhysicsLocation = bHasPhysicsLocation ? CurrentPhysicsLocation
+			: NewActorPosition;
+		CurrentPhysicsLocation = NewActorPosition;
+		bHasPhysicsLocation = true;
 	}
 }
 
@@ -165,8 +221,33 @@ void APSDActorBase::UpdateRotationAfterPhysicsSimulation
 	if (HasAuthority())
 	{
 		FQuat NewRotation = FQuat::MakeFromEuler(NewActorRotationEulerAngles);
-		SetActorRotation(NewRotation);
+
+		// The current physics rotation becomes the previous one. If this is
+		// the first one, use the new rotation for both
+		PreviousPhysicsRotation = bHasPhysicsRotation ? CurrentPhysicsRotation
+			: NewRotation;
+		CurrentPhysicsRotation = NewRotation;
+		bHasPhysicsRotation = true;
+	}
+}
+
+void APSDActorBase::InterpolatePhysicsState(const float InterpolationAlpha)
+{
+	// Only the server updates the Transform, and only once it has a state
+	if (!HasAuthority() || !bHasPhysicsLocation || !bHasPhysicsRotation)
+	{
+		return;
 	}
+
+	const float ClampedAlpha = FMath::Clamp(InterpolationAlpha, 0.f, 1.f);
+
+	// Blend between the previous and current physics state
+	const FVector InterpolatedLocation = FMath::Lerp(PreviousPhysicsLocation,
+		CurrentPhysicsLocation, ClampedAlpha);
+	const FQuat InterpolatedRotation = FQuat::Slerp(PreviousPhysicsRotation,
+		CurrentPhysicsRotation, ClampedAlpha);
+
+	SetActorLocationAndRotation(InterpolatedLocation, InterpolatedRotation);
 }
 
 void APSDActorBase::UpdatePSDActorStatusOnRegion
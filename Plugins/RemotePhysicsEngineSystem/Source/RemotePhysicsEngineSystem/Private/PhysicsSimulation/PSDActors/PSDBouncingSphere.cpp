@@ -5,8 +5,8 @@
 
 APSDBouncingSphere::APSDBouncingSphere()
 {
-	// Set if this actor is static to false as it should be a dynamic body
-	bIsPSDActorStatic = false;
+	// This actor is simulated by the physics service
+	PSDActorMotionType = EPSDActorMotionType::Dynamic;
 }
 
 FString APSDBouncingSphere::GetPhysicsServiceInitializationString()
@@ -0,0 +1,102 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+
+#include "PhysicsSimulation/PSDActors/PSDCompoundActor.h"
+#include "RemotePhysicsEngineSystem/RemotePhysicsEngineSystemLogging.h"
+
+#include "Components/BoxComponent.h"
+#include "Components/CapsuleComponent.h"
+#include "Components/SphereComponent.h"
+
+APSDCompoundActor::APSDCompoundActor()
+{
+	// This actor is simulated by the physics service
+	PSDActorMotionType = EPSDActorMotionType::Dynamic;
+}
+
+FString APSDCompoundActor::GetPhysicsServiceInitializationString()
+{
+	// Export the primitives on the first time, so the hash is known
+	if (GetCollisionMeshHash().IsEmpty())
+	{
+		return FString();
+	}
+
+	return GetCompoundInitializationString(TEXT("primary"));
+}
+
+FString APSDCompoundActor::GetPhysicsServiceCloneInitializationString() const
+{
+	return GetCompoundInitializationString(TEXT("clone"));
+}
+
+FString APSDCompoundActor::GetCompoundInitializationString
+	(const TCHAR* BodyType) const
+{
+	const FQuat ActorRotation = GetActorQuat();
+
+	// For the initialization message, format to the template message:
+	// "compound; BodyID; bodyType; InitialPos (3); InitialLinearVelocity (3);
+	// InitialAngularVelocity (3); Rotation (4); Mass; CompoundHash\n"
+	return FString::Printf(TEXT("compound;%d;%s;%s;%s;%s;%f;%f;%f;%f;%f;%s\n"),
+		PSDActorBodyId, BodyType, *GetCurrentActorLocationAsString(),
+		*GetPSDActorLinearVelocityAsString(),
+		*GetPSDActorAngularVelocityAsString(), ActorRotation.X,
+		ActorRotation.Y, ActorRotation.Z, ActorRotation.W, Mass,
+		*GetExportedCollisionMeshHash());
+}
+
+bool APSDCompoundActor::ExportCollisionCookingData
+	(FString& OutCollisionCookingData)
+{
+	const FTransform ActorSpace = GetCollisionTransform();
+
+	TInlineComponentArray<UShapeComponent*> ShapeComponents(this);
+	for (const UShapeComponent* ShapeComponent : ShapeComponents)
+	{
+		// The scaled sizes already have the actor's scale, so only the
+		// placement is taken relative to the actor
+		const FTransform PrimitiveTransform = ShapeComponent->
+			GetComponentTransform().GetRelativeTransform(ActorSpace);
+		const FVector PrimitivePosition = PrimitiveTransform.GetLocation();
+		const FQuat PrimitiveRotation = PrimitiveTransform.GetRotation();
+
+		if (const USphereComponent* SphereComponent =
+			Cast<USphereComponent>(ShapeComponent))
+		{
+			OutCollisionCookingData += FString::Printf(TEXT("Sphere;%f;%f;%f;"
+				"%f\n"), PrimitivePosition.X, PrimitivePosition.Y,
+				PrimitivePosition.Z, SphereComponent->GetScaledSphereRadius());
+		}
+		else if (const UBoxComponent* BoxComponent =
+			Cast<UBoxComponent>(ShapeComponent))
+		{
+			const FVector BoxHalfExtent = BoxComponent->GetScaledBoxExtent();
+			OutCollisionCookingData += FString::Printf(TEXT("Box;%f;%f;%f;%f;"
+				"%f;%f;%f;%f;%f;%f\n"), PrimitivePosition.X,
+				PrimitivePosition.Y, PrimitivePosition.Z, PrimitiveRotation.X,
+				PrimitiveRotation.Y, PrimitiveRotation.Z, PrimitiveRotation.W,
+				BoxHalfExtent.X, BoxHalfExtent.Y, BoxHalfExtent.Z);
+		}
+		else if (const UCapsuleComponent* CapsuleComponent =
+			Cast<UCapsuleComponent>(ShapeComponent))
+		{
+			OutCollisionCookingData += FString::Printf(TEXT("Capsule;%f;%f;"
+				"%f;%f;%f;%f;%f;%f;%f\n"), PrimitivePosition.X,
+				PrimitivePosition.Y, PrimitivePosition.Z, PrimitiveRotation.X,
+				PrimitiveRotation.Y, PrimitiveRotation.Z, PrimitiveRotation.W,
+				CapsuleComponent->
+				GetScaledCapsuleHalfHeight_WithoutHemisphere(),
+				CapsuleComponent->GetScaledCapsuleRadius());
+		}
+	}
+
+	if (OutCollisionCookingData.IsEmpty())
+	{
+		RPES_LOG_ERROR(TEXT("PSDCompoundActor \"%s\" has no sphere, box or "
+			"capsule component."), *GetName());
+		return false;
+	}
+
+	return true;
+}
@@ -5,8 +5,8 @@
 
 APSDFloor::APSDFloor()
 {
-	// Set if this actor is static to true
-	bIsPSDActorStatic = true;
+	// This actor is level geometry that never moves
+	PSDActorMotionType = EPSDActorMotionType::Static;
 }
 
 FString APSDFloor::GetPhysicsServiceInitializationString()
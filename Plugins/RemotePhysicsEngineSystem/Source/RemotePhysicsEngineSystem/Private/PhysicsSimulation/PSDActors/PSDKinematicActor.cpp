@@ -0,0 +1,10 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+
+#include "PhysicsSimulation/PSDActors/PSDKinematicActor.h"
+
+APSDKinematicActor::APSDKinematicActor()
+{
+	// This actor is moved by the game, so its body follows it
+	PSDActorMotionType = EPSDActorMotionType::Kinematic;
+}
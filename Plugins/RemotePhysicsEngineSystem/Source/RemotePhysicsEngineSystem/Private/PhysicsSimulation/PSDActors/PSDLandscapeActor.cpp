@@ -0,0 +1,173 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+
+#include "PhysicsSimulation/PSDActors/PSDLandscapeActor.h"
+#include "PhysicsSimulation/Utils/Actors/PhysicsServiceRegion.h"
+#include "RemotePhysicsEngineSystem/RemotePhysicsEngineSystemLogging.h"
+
+#include "Kismet/GameplayStatics.h"
+#include "LandscapeProxy.h"
+#include "Misc/Base64.h"
+
+APSDLandscapeActor::APSDLandscapeActor()
+{
+	// The terrain is shown by the landscape itself
+	ActorMeshComponent->SetHiddenInGame(true);
+}
+
+bool APSDLandscapeActor::ExportCollisionCookingData
+	(FString& OutCollisionCookingData)
+{
+	const APhysicsServiceRegion* PhysicsServiceRegion =
+		FindPhysicsServiceRegion();
+	if (!PhysicsServiceRegion)
+	{
+		RPES_LOG_ERROR(TEXT("PSDLandscapeActor \"%s\" is not inside any "
+			"physics service region."), *GetName());
+		return false;
+	}
+
+	const FBox RegionBounds = PhysicsServiceRegion->GetRegionBounds();
+
+	ALandscapeProxy* LandscapeToSample = Landscape ? Landscape :
+		FindLandscape(RegionBounds);
+	if (!LandscapeToSample)
+	{
+		RPES_LOG_ERROR(TEXT("PSDLandscapeActor \"%s\" has no landscape to "
+			"sample."), *GetName());
+		return false;
+	}
+
+	// Only the part of the landscape inside the region is sampled
+	const FBox LandscapeBounds =
+		LandscapeToSample->GetComponentsBoundingBox(true);
+	const FVector SampledMin = FVector::Max(RegionBounds.Min,
+		LandscapeBounds.Min);
+	const FVector SampledMax = FVector::Min(RegionBounds.Max,
+		LandscapeBounds.Max);
+	if (SampledMin.X >= SampledMax.X || SampledMin.Y >= SampledMax.Y)
+	{
+		RPES_LOG_ERROR(TEXT("Landscape \"%s\" is not inside the region of "
+			"PSDLandscapeActor \"%s\"."), *LandscapeToSample->GetName(),
+			*GetName());
+		return false;
+	}
+
+	// The first sample is on the landscape's grid, so the samples are on its
+	// vertices if the spacing is its quad size
+	const FVector LandscapeLocation = LandscapeToSample->GetActorLocation();
+	float HeightFieldSpacing = SampleSpacing > 0.f ? SampleSpacing :
+		LandscapeToSample->GetActorScale3D().X;
+
+	HeightFieldOrigin = FVector(LandscapeLocation.X + FMath::FloorToFloat
+		((SampledMin.X - LandscapeLocation.X) / HeightFieldSpacing) *
+		HeightFieldSpacing, LandscapeLocation.Y + FMath::FloorToFloat
+		((SampledMin.Y - LandscapeLocation.Y) / HeightFieldSpacing) *
+		HeightFieldSpacing, 0.f);
+
+	const float SampledExtent = FMath::Max(SampledMax.X - HeightFieldOrigin.X,
+		SampledMax.Y - HeightFieldOrigin.Y);
+
+	int32 RequiredSampleCount = FMath::CeilToInt(SampledExtent /
+		HeightFieldSpacing) + 1;
+	if (RequiredSampleCount > MaxHeightFieldSampleCount)
+	{
+		HeightFieldSpacing = SampledExtent / (MaxHeightFieldSampleCount - 1);
+		RequiredSampleCount = MaxHeightFieldSampleCount;
+	}
+
+	// The sample count must be the block size times a power of two
+	const int32 BlockSize = FMath::Clamp(HeightFieldBlockSize, 2, 8);
+	const uint32 NumberOfBlocks = FMath::Max(2u, FMath::RoundUpToPowerOfTwo
+		(static_cast<uint32>(FMath::DivideAndRoundUp(RequiredSampleCount,
+		BlockSize))));
+	const int32 SampleCount = BlockSize * NumberOfBlocks;
+
+	// Trace down on each sample. The samples with no landscape under them
+	// are holes
+	const float TraceStartZ = LandscapeBounds.Max.Z + 1.f;
+	const float TraceEndZ = LandscapeBounds.Min.Z - 1.f;
+
+	TArray<float> Heights;
+	Heights.Init(FLT_MAX, SampleCount * SampleCount);
+
+	FCollisionQueryParams TraceParams(SCENE_QUERY_STAT(PSDLandscapeSample),
+		false);
+	int32 NumberOfHoles = 0;
+
+	for (int32 y = 0; y < SampleCount; y++)
+	{
+		const float SampleY = HeightFieldOrigin.Y + y * HeightFieldSpacing;
+		for (int32 x = 0; x < SampleCount; x++)
+		{
+			const float SampleX = HeightFieldOrigin.X + x * HeightFieldSpacing;
+			if (SampleX > SampledMax.X || SampleY > SampledMax.Y)
+			{
+				continue;
+			}
+
+			FHitResult LandscapeHit;
+			if (LandscapeToSample->ActorLineTraceSingle(LandscapeHit,
+				FVector(SampleX, SampleY, TraceStartZ), FVector(SampleX,
+				SampleY, TraceEndZ), ECC_Visibility, TraceParams))
+			{
+				Heights[y * SampleCount + x] = LandscapeHit.ImpactPoint.Z;
+			}
+			else
+			{
+				NumberOfHoles++;
+			}
+		}
+	}
+
+	OutCollisionCookingData = FString::Printf(TEXT("HeightField;%d;%f;%d\n"
+		"Heights;%s\n"), SampleCount, HeightFieldSpacing, BlockSize,
+		*FBase64::Encode(reinterpret_cast<const uint8*>(Heights.GetData()),
+		Heights.Num() * sizeof(float)));
+
+	RPES_LOG_INFO(TEXT("Landscape \"%s\" sampled into a %dx%d height field "
+		"(spacing: %f; holes: %d)."), *LandscapeToSample->GetName(),
+		SampleCount, SampleCount, HeightFieldSpacing, NumberOfHoles);
+
+	return true;
+}
+
+APhysicsServiceRegion* APSDLandscapeActor::FindPhysicsServiceRegion() const
+{
+	TArray<AActor*> FoundActors;
+	UGameplayStatics::GetAllActorsOfClass(GetWorld(),
+		APhysicsServiceRegion::StaticClass(), FoundActors);
+
+	for (AActor* FoundActor : FoundActors)
+	{
+		APhysicsServiceRegion* FoundPhysicsServiceRegion =
+			Cast<APhysicsServiceRegion>(FoundActor);
+		if (FoundPhysicsServiceRegion->IsLocationInsideRegion
+			(GetActorLocation()))
+		{
+			return FoundPhysicsServiceRegion;
+		}
+	}
+
+	return nullptr;
+}
+
+ALandscapeProxy* APSDLandscapeActor::FindLandscape(const FBox& RegionBounds)
+	const
+{
+	TArray<AActor*> FoundActors;
+	UGameplayStatics::GetAllActorsOfClass(GetWorld(),
+		ALandscapeProxy::StaticClass(), FoundActors);
+
+	for (AActor* FoundActor : FoundActors)
+	{
+		ALandscapeProxy* FoundLandscape = Cast<ALandscapeProxy>(FoundActor);
+		if (FoundLandscape->GetComponentsBoundingBox(true).Intersect
+			(RegionBounds))
+		{
+			return FoundLandscape;
+		}
+	}
+
+	return nullptr;
+}
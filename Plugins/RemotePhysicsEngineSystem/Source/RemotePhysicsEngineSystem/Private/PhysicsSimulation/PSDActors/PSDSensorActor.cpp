@@ -0,0 +1,49 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+
+#include "PhysicsSimulation/PSDActors/PSDSensorActor.h"
+
+#include "Components/BoxComponent.h"
+#include "Components/StaticMeshComponent.h"
+
+APSDSensorActor::APSDSensorActor()
+{
+	// The sensor never moves, so it is never updated by the steps
+	PSDActorMotionType = EPSDActorMotionType::Static;
+
+	SensorVolume = CreateDefaultSubobject<UBoxComponent>
+		(TEXT("SensorVolume"));
+	SensorVolume->SetupAttachment(ActorRootComponent);
+	SensorVolume->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+
+	// The volume is only evaluated on the physics service
+	ActorMeshComponent->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	ActorMeshComponent->SetHiddenInGame(true);
+}
+
+FString APSDSensorActor::GetPhysicsServiceInitializationString()
+{
+	const FTransform SensorTransform = SensorVolume->GetComponentTransform();
+	const FVector SensorLocation = SensorTransform.GetLocation();
+	const FQuat SensorRotation = SensorTransform.GetRotation();
+	const FVector SensorHalfExtent = SensorVolume->GetScaledBoxExtent();
+
+	return FString::Printf(TEXT("sensor;%d;primary;%f;%f;%f;%s;%s;%f;%f;%f;%f;"
+		"%f;%f;%f\n"), PSDActorBodyId, SensorLocation.X, SensorLocation.Y,
+		SensorLocation.Z, *GetPSDActorLinearVelocityAsString(),
+		*GetPSDActorAngularVelocityAsString(), SensorRotation.X,
+		SensorRotation.Y, SensorRotation.Z, SensorRotation.W,
+		SensorHalfExtent.X, SensorHalfExtent.Y, SensorHalfExtent.Z);
+}
+
+void APSDSensorActor::OnPhysicsSensorEntered(APSDActorBase* OtherPSDActor,
+	const int32 OtherBodyId)
+{
+	OnPSDSensorBeginOverlap.Broadcast(this, OtherPSDActor, OtherBodyId);
+}
+
+void APSDSensorActor::OnPhysicsSensorExited(APSDActorBase* OtherPSDActor,
+	const int32 OtherBodyId)
+{
+	OnPSDSensorEndOverlap.Broadcast(this, OtherPSDActor, OtherBodyId);
+}
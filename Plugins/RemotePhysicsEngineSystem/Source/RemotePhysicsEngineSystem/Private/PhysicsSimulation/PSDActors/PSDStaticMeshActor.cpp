@@ -0,0 +1,243 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+
+#include "PhysicsSimulation/PSDActors/PSDStaticMeshActor.h"
+#include "RemotePhysicsEngineSystem/RemotePhysicsEngineSystemLogging.h"
+
+#include "Components/StaticMeshComponent.h"
+#include "Engine/StaticMesh.h"
+#include "Interfaces/Interface_CollisionDataProvider.h"
+#include "Misc/Base64.h"
+#include "Misc/SecureHash.h"
+#include "PhysicsEngine/BodySetup.h"
+
+APSDStaticMeshActor::APSDStaticMeshActor()
+{
+	// This actor is level geometry that never moves
+	PSDActorMotionType = EPSDActorMotionType::Static;
+}
+
+FString APSDStaticMeshActor::GetPhysicsServiceInitializationString()
+{
+	if (!ExportCollisionData())
+	{
+		return FString();
+	}
+
+	// Get the current actor's linear velocity as a string
+	const auto CurrentActorLinearVelocityAsString =
+		GetPSDActorLinearVelocityAsString();
+
+	// Get the current actor's angular velocity as a string
+	const auto CurrentActorAngularVelocityString =
+		GetPSDActorAngularVelocityAsString();
+
+	// The body is placed as the collision was exported
+	const FTransform CollisionTransform = GetCollisionTransform();
+	const FVector MeshLocation = CollisionTransform.GetLocation();
+	const FQuat MeshRotation = CollisionTransform.GetRotation();
+	const FVector MeshScale = CollisionTransform.GetScale3D();
+
+	// For the initialization message, format to the template message:
+	// "mesh; BodyID; bodyType; InitialPosX; InitialPosY; InitialPosY;
+	// InitialLinearVelocityX; InitialLinearVelocityY; InitialLinearVelocityZ;
+	// InitialAngularVelocityX; InitialAngularVelocityY;
+	// InitialAngularVelocityZ; RotationX; RotationY; RotationZ; RotationW;
+	// ScaleX; ScaleY; ScaleZ; MeshHash\n"
+	// The kinematic movers are the only meshes that are not static
+	return FString::Printf(TEXT("mesh;%d;%s;%f;%f;%f;%s;%s;%f;%f;%f;%f;%f;"
+		"%f;%f;%s\n"), PSDActorBodyId, IsPSDActorKinematic() ?
+		TEXT("kinematic") : TEXT("primary"), MeshLocation.X, MeshLocation.Y,
+		MeshLocation.Z, *CurrentActorLinearVelocityAsString,
+		*CurrentActorAngularVelocityString, MeshRotation.X, MeshRotation.Y,
+		MeshRotation.Z, MeshRotation.W, MeshScale.X, MeshScale.Y, MeshScale.Z,
+		*CollisionMeshHash);
+}
+
+FString APSDStaticMeshActor::GetCollisionMeshHash()
+{
+	return ExportCollisionData() ? CollisionMeshHash : FString();
+}
+
+FString APSDStaticMeshActor::GetCollisionCookingString()
+{
+	if (!ExportCollisionData())
+	{
+		return FString();
+	}
+
+	return FString::Printf(TEXT("%s;%s\n%s"), *CollisionMeshHash,
+		*GetCollisionCookingType(), *CollisionCookingData);
+}
+
+FString APSDStaticMeshActor::GetCollisionCookingType() const
+{
+	return CollisionType == EPSDStaticMeshCollisionType::Convex ?
+		TEXT("convex") : TEXT("mesh");
+}
+
+FTransform APSDStaticMeshActor::GetCollisionTransform() const
+{
+	return ActorMeshComponent->GetComponentTransform();
+}
+
+bool APSDStaticMeshActor::ExportCollisionData()
+{
+	if (bHasExportedCollision)
+	{
+		return !CollisionMeshHash.IsEmpty();
+	}
+
+	bHasExportedCollision = true;
+
+	if (!ExportCollisionCookingData(CollisionCookingData) ||
+		CollisionCookingData.IsEmpty())
+	{
+		CollisionCookingData = FString();
+		return false;
+	}
+
+	// The hash is taken from the exported data, so the same collision is
+	// cooked only once, no matter how many actors or maps use it
+	FTCHARToUTF8 CollisionCookingDataAsUtf8(*CollisionCookingData);
+	uint8 CollisionHash[FSHA1::DigestSize];
+	FSHA1::HashBuffer(CollisionCookingDataAsUtf8.Get(),
+		CollisionCookingDataAsUtf8.Length(), CollisionHash);
+
+	CollisionMeshHash = BytesToHex(CollisionHash, FSHA1::DigestSize);
+
+	return true;
+}
+
+bool APSDStaticMeshActor::ExportCollisionCookingData
+	(FString& OutCollisionCookingData)
+{
+	UStaticMesh* StaticMesh = ActorMeshComponent ?
+		ActorMeshComponent->GetStaticMesh() : nullptr;
+	if (!StaticMesh)
+	{
+		RPES_LOG_ERROR(TEXT("PSDStaticMeshActor \"%s\" has no static mesh."),
+			*GetName());
+		return false;
+	}
+
+	if (CollisionType == EPSDStaticMeshCollisionType::Convex)
+	{
+		UBodySetup* StaticMeshBodySetup = StaticMesh->GetBodySetup();
+		if (!StaticMeshBodySetup)
+		{
+			RPES_LOG_ERROR(TEXT("Static mesh \"%s\" has no simple collision."),
+				*StaticMesh->GetName());
+			return false;
+		}
+
+		// Each convex element is a hull. The points are on the mesh space
+		for (const FKConvexElem& ConvexElement :
+			StaticMeshBodySetup->AggGeom.ConvexElems)
+		{
+			const FTransform ConvexElementTransform =
+				ConvexElement.GetTransform();
+
+			TArray<FVector> HullPoints;
+			for (const auto& ConvexVertex : ConvexElement.VertexData)
+			{
+				HullPoints.Add(ConvexElementTransform.TransformPosition
+					(FVector(ConvexVertex)));
+			}
+
+			AppendConvexHullCookingLine(HullPoints, OutCollisionCookingData);
+		}
+
+		// Each box element is a hull made of its corners
+		for (const FKBoxElem& BoxElement :
+			StaticMeshBodySetup->AggGeom.BoxElems)
+		{
+			const FTransform BoxElementTransform(BoxElement.Rotation,
+				BoxElement.Center);
+			const FVector BoxHalfExtents(BoxElement.X * 0.5f,
+				BoxElement.Y * 0.5f, BoxElement.Z * 0.5f);
+
+			TArray<FVector> HullPoints;
+			for (int32 CornerIndex = 0; CornerIndex < 8; CornerIndex++)
+			{
+				HullPoints.Add(BoxElementTransform.TransformPosition(FVector
+					((CornerIndex & 1) ? BoxHalfExtents.X : -BoxHalfExtents.X,
+					(CornerIndex & 2) ? BoxHalfExtents.Y : -BoxHalfExtents.Y,
+					(CornerIndex & 4) ? BoxHalfExtents.Z :
+					-BoxHalfExtents.Z)));
+			}
+
+			AppendConvexHullCookingLine(HullPoints, OutCollisionCookingData);
+		}
+	}
+	else
+	{
+		// Get the triangles the engine would cook as complex collision
+		FTriMeshCollisionData TriangleMeshData;
+		if (!StaticMesh->GetPhysicsTriMeshData(&TriangleMeshData, true) ||
+			TriangleMeshData.Indices.Num() == 0)
+		{
+			RPES_LOG_ERROR(TEXT("Could not get the triangles of static mesh "
+				"\"%s\". Check if it allows CPU access."),
+				*StaticMesh->GetName());
+			return false;
+		}
+
+		TArray<float> MeshVertices;
+		MeshVertices.Reserve(TriangleMeshData.Vertices.Num() * 3);
+		for (const auto& MeshVertex : TriangleMeshData.Vertices)
+		{
+			MeshVertices.Add(MeshVertex.X);
+			MeshVertices.Add(MeshVertex.Y);
+			MeshVertices.Add(MeshVertex.Z);
+		}
+
+		// Jolt is right-handed, so the winding is flipped, as the vertices
+		// are sent as they are
+		TArray<uint32> MeshIndices;
+		MeshIndices.Reserve(TriangleMeshData.Indices.Num() * 3);
+		for (const FTriIndices& TriangleIndices : TriangleMeshData.Indices)
+		{
+			MeshIndices.Add(TriangleIndices.v0);
+			MeshIndices.Add(TriangleIndices.v2);
+			MeshIndices.Add(TriangleIndices.v1);
+		}
+
+		OutCollisionCookingData += FString::Printf(TEXT("Vertices;%s\n"
+			"Indices;%s\n"), *FBase64::Encode(reinterpret_cast<const uint8*>
+			(MeshVertices.GetData()), MeshVertices.Num() * sizeof(float)),
+			*FBase64::Encode(reinterpret_cast<const uint8*>
+			(MeshIndices.GetData()), MeshIndices.Num() * sizeof(uint32)));
+	}
+
+	if (OutCollisionCookingData.IsEmpty())
+	{
+		RPES_LOG_ERROR(TEXT("Static mesh \"%s\" has no convex or box "
+			"collision."), *StaticMesh->GetName());
+		return false;
+	}
+
+	return true;
+}
+
+void APSDStaticMeshActor::AppendConvexHullCookingLine
+	(const TArray<FVector>& HullPoints, FString& OutCollisionCookingData)
+{
+	if (HullPoints.Num() == 0)
+	{
+		return;
+	}
+
+	TArray<float> HullVertices;
+	HullVertices.Reserve(HullPoints.Num() * 3);
+	for (const FVector& HullPoint : HullPoints)
+	{
+		HullVertices.Add(HullPoint.X);
+		HullVertices.Add(HullPoint.Y);
+		HullVertices.Add(HullPoint.Z);
+	}
+
+	OutCollisionCookingData += FString::Printf(TEXT("Hull;%s\n"),
+		*FBase64::Encode(reinterpret_cast<const uint8*>(HullVertices.GetData()),
+		HullVertices.Num() * sizeof(float)));
+}
@@ -0,0 +1,122 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+
+#include "PhysicsSimulation/PSDActors/PSDVehicle.h"
+#include "Components/StaticMeshComponent.h"
+#include "Net/UnrealNetwork.h"
+
+APSDVehicle::APSDVehicle()
+{
+	// This actor is simulated by the physics service
+	PSDActorMotionType = EPSDActorMotionType::Dynamic;
+
+	// Creating the wheels' meshes. They are placed by the physics service, so
+	// they have no collision of their own
+	const TCHAR* WheelNames[] = { TEXT("FrontLeftWheelMesh"),
+		TEXT("FrontRightWheelMesh"), TEXT("RearLeftWheelMesh"),
+		TEXT("RearRightWheelMesh") };
+
+	for (const TCHAR* WheelName : WheelNames)
+	{
+		UStaticMeshComponent* WheelMeshComponent =
+			CreateDefaultSubobject<UStaticMeshComponent>(WheelName);
+		WheelMeshComponent->SetupAttachment(ActorRootComponent);
+		WheelMeshComponent->SetCollisionEnabled
+			(ECollisionEnabled::NoCollision);
+
+		WheelMeshComponents.Add(WheelMeshComponent);
+	}
+}
+
+void APSDVehicle::GetLifetimeReplicatedProps
+	(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(APSDVehicle, WheelTransforms);
+}
+
+void APSDVehicle::SetPSDVehicleInput(float NewThrottle, float NewSteering,
+	float NewBrake, float NewHandBrake)
+{
+	Throttle = FMath::Clamp(NewThrottle, -1.f, 1.f);
+	Steering = FMath::Clamp(NewSteering, -1.f, 1.f);
+	Brake = FMath::Clamp(NewBrake, 0.f, 1.f);
+	HandBrake = FMath::Clamp(NewHandBrake, 0.f, 1.f);
+}
+
+FString APSDVehicle::GetPhysicsServiceInitializationString()
+{
+	return GetVehicleInitializationString(TEXT("primary"));
+}
+
+FString APSDVehicle::GetPhysicsServiceCloneInitializationString() const
+{
+	return GetVehicleInitializationString(TEXT("clone"));
+}
+
+FString APSDVehicle::GetVehicleInitializationString(const TCHAR* BodyType)
+	const
+{
+	const FQuat ActorRotation = GetActorQuat();
+
+	// For the initialization message, format to the template message:
+	// "vehicle; BodyID; bodyType; InitialPos (3); InitialLinearVelocity (3);
+	// InitialAngularVelocity (3); Rotation (4); ChassisHalfExtent (3);
+	// ChassisMass; WheelRadius; WheelWidth; SuspensionLength;
+	// MaxEngineTorque; MaxSteerAngle\n"
+	return FString::Printf(TEXT("vehicle;%d;%s;%s;%s;%s;%f;%f;%f;%f;%f;%f;%f;"
+		"%f;%f;%f;%f;%f;%f;%f\n"), PSDActorBodyId, BodyType,
+		*GetCurrentActorLocationAsString(),
+		*GetPSDActorLinearVelocityAsString(),
+		*GetPSDActorAngularVelocityAsString(), ActorRotation.X,
+		ActorRotation.Y, ActorRotation.Z, ActorRotation.W,
+		ChassisHalfExtent.X, ChassisHalfExtent.Y, ChassisHalfExtent.Z,
+		ChassisMass, WheelRadius, WheelWidth, SuspensionLength,
+		MaxEngineTorque, MaxSteerAngle);
+}
+
+FString APSDVehicle::GetPhysicsServiceVehicleInputString() const
+{
+	return FString::Printf(TEXT("Vehicle;%d;%f;%f;%f;%f\n"), PSDActorBodyId,
+		Throttle, Steering, Brake, HandBrake);
+}
+
+void APSDVehicle::ApplyPhysicsServiceVehicleState(const float NewEngineRPM,
+	const int32 NewCurrentGear, const TArray<FTransform>& NewWheelTransforms)
+{
+	// Only the server receives the physics state
+	if (!HasAuthority())
+	{
+		return;
+	}
+
+	EngineRPM = NewEngineRPM;
+	CurrentGear = NewCurrentGear;
+	WheelTransforms = NewWheelTransforms;
+
+	UpdateWheelMeshes();
+}
+
+void APSDVehicle::OnRep_WheelTransforms()
+{
+	UpdateWheelMeshes();
+}
+
+void APSDVehicle::UpdateWheelMeshes()
+{
+	const int32 NumberOfWheels = FMath::Min(WheelTransforms.Num(),
+		WheelMeshComponents.Num());
+
+	// The wheel transforms are relative to the chassis, so the wheels follow
+	// the chassis as it is blended between the physics states
+	for (int32 i = 0; i < NumberOfWheels; i++)
+	{
+		if (WheelMeshComponents[i])
+		{
+			WheelMeshComponents[i]->SetRelativeLocationAndRotation
+				(WheelTransforms[i].GetLocation(),
+				WheelTransforms[i].GetRotation());
+		}
+	}
+}
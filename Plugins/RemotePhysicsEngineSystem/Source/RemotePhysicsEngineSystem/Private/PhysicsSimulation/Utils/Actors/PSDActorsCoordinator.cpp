@@ -3,6 +3,8 @@
 #include "PhysicsSimulation/Utils/Actors/PSDActorsCoordinator.h"
 #include "PhysicsSimulation/Utils/Actors/PSDActorsSpawner.h"
 #include "PhysicsSimulation/Utils/Actors/PhysicsServiceRegion.h"
+#include "PhysicsSimulation/Utils/Components/PSDCharacterComponent.h"
+#include "PhysicsSimulation/Utils/Components/PSDRagdollComponent.h"
 #include "ExternalCommunication/Sockets/SocketClientProxy.h"
 #include "PhysicsSimulation/PSDActors/Base/PSDActorBase.h"
 #include "RemotePhysicsEngineSystem/RemotePhysicsEngineSystemLogging.h"
@@ -89,7 +91,11 @@ void APSDActorsCoordinator::Tick(float DeltaTime)
 	{
 		// Update PSD actors by simulating physics on the service
 		// and parsing it's results with the new actor position
-		UpdatePSDActors();
+		UpdatePSDActors(DeltaTime);
+
+		// Every step response was consumed, so this is a step boundary.
+		// Migrate any region requested to
+		MigratePendingPhysicsServiceRegions();
 	}
 }
 
@@ -118,6 +124,207 @@ void APSDActorsCoordinator::GetAllPhysicsServiceRegions()
 		return RegionA.GetPhysicsServiceRegionId() 
 			< RegionB.GetPhysicsServiceRegionId();
 	});
+
+	// The regions apply the characters' and ragdolls' states received on the
+	// steps
+	for (const auto& PhysicsServiceRegion : PhysicsServiceRegionList)
+	{
+		PhysicsServiceRegion->SetPSDCharacters(&PSDCharacters);
+		PhysicsServiceRegion->SetPSDRagdolls(&PSDRagdolls);
+	}
+}
+
+void APSDActorsCoordinator::RegisterPSDCharacter
+	(UPSDCharacterComponent* PSDCharacter)
+{
+	if (!PSDCharacter || PSDCharacter->GetPSDCharacterId() != INDEX_NONE)
+	{
+		return;
+	}
+
+	const int32 NewPSDCharacterId = NextPSDCharacterId++;
+	PSDCharacter->SetPSDCharacterId(NewPSDCharacterId);
+	PSDCharacters.Add(NewPSDCharacterId, PSDCharacter);
+
+	RPES_LOG_INFO(TEXT("Registered PSD character \"%s\" with id %d."),
+		*GetNameSafe(PSDCharacter->GetOwner()), NewPSDCharacterId);
+}
+
+void APSDActorsCoordinator::UnregisterPSDCharacter
+	(UPSDCharacterComponent* PSDCharacter)
+{
+	if (!PSDCharacter)
+	{
+		return;
+	}
+
+	PSDCharacters.Remove(PSDCharacter->GetPSDCharacterId());
+	PSDCharacter->SetIsOnPhysicsServiceRegion(false);
+	PSDCharacter->SetPSDCharacterId(INDEX_NONE);
+}
+
+void APSDActorsCoordinator::RegisterPSDRagdoll
+	(UPSDRagdollComponent* PSDRagdoll)
+{
+	if (!PSDRagdoll || PSDRagdoll->GetPSDRagdollId() != INDEX_NONE)
+	{
+		return;
+	}
+
+	const int32 NewPSDRagdollId = NextPSDRagdollId++;
+	PSDRagdoll->SetPSDRagdollId(NewPSDRagdollId);
+	PSDRagdolls.Add(NewPSDRagdollId, PSDRagdoll);
+
+	RPES_LOG_INFO(TEXT("Registered PSD ragdoll \"%s\" with id %d."),
+		*GetNameSafe(PSDRagdoll->GetOwner()), NewPSDRagdollId);
+}
+
+void APSDActorsCoordinator::UnregisterPSDRagdoll
+	(UPSDRagdollComponent* PSDRagdoll)
+{
+	if (!PSDRagdoll)
+	{
+		return;
+	}
+
+	PSDRagdolls.Remove(PSDRagdoll->GetPSDRagdollId());
+	PSDRagdoll->SetPSDRagdollId(INDEX_NONE);
+}
+
+int32 APSDActorsCoordinator::AddPSDConstraint
+	(const FPSDConstraintSettings& ConstraintSettings,
+	APSDActorBase* PSDActor1, APSDActorBase* PSDActor2)
+{
+	if (!PSDActor1 || !PhysicsServiceRegionList.IsValidIndex
+		(PSDActor1->GetActorOwnerPhysicsServiceRegionId()))
+	{
+		RPES_LOG_WARNING(TEXT("Could not add PSD constraint, as \"%s\" is "
+			"not on any physics service region."), *GetNameSafe(PSDActor1));
+		return INDEX_NONE;
+	}
+
+	const int32 NewPSDConstraintId = NextPSDConstraintId++;
+	PhysicsServiceRegionList[PSDActor1->GetActorOwnerPhysicsServiceRegionId()]
+		->QueuePSDConstraintCreation(NewPSDConstraintId, ConstraintSettings,
+		PSDActor1->GetPSDActorBodyId(), PSDActor2 ?
+		PSDActor2->GetPSDActorBodyId() : INDEX_NONE);
+
+	return NewPSDConstraintId;
+}
+
+void APSDActorsCoordinator::RemovePSDConstraint(int32 ConstraintId)
+{
+	for (const auto& PhysicsServiceRegion : PhysicsServiceRegionList)
+	{
+		if (PhysicsServiceRegion->QueuePSDConstraintRemoval(ConstraintId))
+		{
+			return;
+		}
+	}
+}
+
+void APSDActorsCoordinator::AddPSDRadialImpulse(FVector Origin,
+	float Radius, float Impulse, bool bLinearFalloff)
+{
+	const FBox ImpulseBounds = FBox::BuildAABB(Origin, FVector(Radius));
+	for (const auto& PhysicsServiceRegion : PhysicsServiceRegionList)
+	{
+		if (PhysicsServiceRegion->GetRegionBounds().Intersect(ImpulseBounds))
+		{
+			PhysicsServiceRegion->QueuePSDRadialImpulse(Origin, Radius,
+				Impulse, bLinearFalloff);
+		}
+	}
+}
+
+int32 APSDActorsCoordinator::AddPSDWindVolume(FBox WindVolume,
+	FVector WindVelocity, float Drag, float Duration)
+{
+	const int32 NewPSDForceFieldId = NextPSDForceFieldId;
+	bool bIsOnAnyRegion = false;
+
+	for (const auto& PhysicsServiceRegion : PhysicsServiceRegionList)
+	{
+		if (PhysicsServiceRegion->GetRegionBounds().Intersect(WindVolume))
+		{
+			PhysicsServiceRegion->QueuePSDWindVolume(NewPSDForceFieldId,
+				WindVolume, WindVelocity, Drag, Duration);
+			bIsOnAnyRegion = true;
+		}
+	}
+
+	if (!bIsOnAnyRegion)
+	{
+		RPES_LOG_WARNING(TEXT("Could not add PSD wind volume, as %s is not "
+			"on any physics service region."), *WindVolume.ToString());
+		return INDEX_NONE;
+	}
+
+	NextPSDForceFieldId++;
+	return NewPSDForceFieldId;
+}
+
+int32 APSDActorsCoordinator::AddPSDVortex(FVector VortexBase, float Radius,
+	float Height, float TangentialAcceleration, float InwardAcceleration,
+	float UpwardAcceleration, float Duration)
+{
+	const FBox VortexBounds(VortexBase - FVector(Radius, Radius, 0.f),
+		VortexBase + FVector(Radius, Radius, Height));
+
+	const int32 NewPSDForceFieldId = NextPSDForceFieldId;
+	bool bIsOnAnyRegion = false;
+
+	for (const auto& PhysicsServiceRegion : PhysicsServiceRegionList)
+	{
+		if (PhysicsServiceRegion->GetRegionBounds().Intersect(VortexBounds))
+		{
+			PhysicsServiceRegion->QueuePSDVortex(NewPSDForceFieldId,
+				VortexBase, Radius, Height, TangentialAcceleration,
+				InwardAcceleration, UpwardAcceleration, Duration);
+			bIsOnAnyRegion = true;
+		}
+	}
+
+	if (!bIsOnAnyRegion)
+	{
+		RPES_LOG_WARNING(TEXT("Could not add PSD vortex, as %s is not on any "
+			"physics service region."), *VortexBounds.ToString());
+		return INDEX_NONE;
+	}
+
+	NextPSDForceFieldId++;
+	return NewPSDForceFieldId;
+}
+
+void APSDActorsCoordinator::RemovePSDForceField(int32 ForceFieldId)
+{
+	for (const auto& PhysicsServiceRegion : PhysicsServiceRegionList)
+	{
+		PhysicsServiceRegion->QueuePSDForceFieldRemoval(ForceFieldId);
+	}
+}
+
+void APSDActorsCoordinator::AllocatePSDActorsBodyIndices()
+{
+	// Start from a clean index space, so indices are packed from zero
+	BodyIndexAllocator.Reset();
+
+	TArray<AActor*> FoundActors;
+	UGameplayStatics::GetAllActorsOfClass(GetWorld(),
+		APSDActorBase::StaticClass(), FoundActors);
+
+	for (auto& FoundActor : FoundActors)
+	{
+		BodyIndexAllocator.AllocateBodyIndex(Cast<APSDActorBase>(FoundActor));
+	}
+
+	for (const auto& PhysicsServiceRegion : PhysicsServiceRegionList)
+	{
+		PhysicsServiceRegion->SetBodyIndexAllocator(&BodyIndexAllocator);
+	}
+
+	RPES_LOG_INFO(TEXT("Allocated %d PSDActors body indices."),
+		BodyIndexAllocator.GetNumAllocatedBodyIndices());
 }
 
 void APSDActorsCoordinator::GetLifetimeReplicatedProps
@@ -425,7 +632,7 @@ void APSDActorsCoordinator::OnPSDActorExitPhysicsRegion
 	}
 }
 
-void APSDActorsCoordinator::UpdatePSDActors()
+void APSDActorsCoordinator::UpdatePSDActors(const float DeltaTime)
 {
 	// Check if we are simulating
 	if (!bIsSimulatingPhysics)
@@ -439,6 +646,129 @@ void APSDActorsCoordinator::UpdatePSDActors()
 	std::chrono::steady_clock::time_point preStepPhysicsTime =
 		std::chrono::steady_clock::now();
 
+	// Gather the ghost states of each region. Each clone on a region follows
+	// its primary's last physics state
+	TMap<int32, FString> GhostStatesByPhysicsServiceId;
+	for (const auto& SharedRegionsPSDActor : SharedRegionsPSDActors)
+	{
+		for (const auto& Footprint : SharedRegionsPSDActor.Value)
+		{
+			if (Footprint.BodyTypeOnPhysicsServiceRegion !=
+				EPSDActorBodyTypeOnPhysicsServiceRegion::Clone ||
+				!PhysicsServiceRegionList.IsValidIndex
+				(Footprint.PhysicsServiceRegionId))
+			{
+				continue;
+			}
+
+			GhostStatesByPhysicsServiceId.FindOrAdd(PhysicsServiceRegionList
+				[Footprint.PhysicsServiceRegionId]->RegionOwnerPhysicsServiceId)
+				+= SharedRegionsPSDActor.Key->
+				GetPhysicsServiceGhostStateString();
+		}
+	}
+
+	// Gather the characters' inputs of each region. A character is only on
+	// the region its location is in, so it leaves a physics service once it
+	// exits the region
+	TMap<int32, FString> CharacterInputsByPhysicsServiceId;
+	for (const auto& PSDCharacterPair : PSDCharacters)
+	{
+		UPSDCharacterComponent* PSDCharacter = PSDCharacterPair.Value;
+		const FVector PSDCharacterLocation =
+			PSDCharacter->GetPSDCharacterLocation();
+
+		APhysicsServiceRegion** CharacterRegion =
+			PhysicsServiceRegionList.FindByPredicate([&PSDCharacterLocation]
+			(const APhysicsServiceRegion* PhysicsServiceRegion)
+		{
+			return PhysicsServiceRegion->IsLocationInsideRegion
+				(PSDCharacterLocation);
+		});
+
+		PSDCharacter->SetIsOnPhysicsServiceRegion(CharacterRegion != nullptr);
+		if (!CharacterRegion)
+		{
+			continue;
+		}
+
+		CharacterInputsByPhysicsServiceId.FindOrAdd((*CharacterRegion)->
+			RegionOwnerPhysicsServiceId) +=
+			PSDCharacter->GetPhysicsServiceCharacterInputString();
+	}
+
+	// Gather the ragdolls to activate on each region. A ragdoll is simulated
+	// only on the region its root part is in when activated, so any other
+	// region stops applying its state
+	TMap<int32, FString> RagdollActivationsByPhysicsServiceId;
+	for (const auto& PSDRagdollPair : PSDRagdolls)
+	{
+		UPSDRagdollComponent* PSDRagdoll = PSDRagdollPair.Value;
+		if (!PSDRagdoll->HasPendingActivation())
+		{
+			continue;
+		}
+
+		const FVector PSDRagdollLocation = PSDRagdoll->GetPSDRagdollLocation();
+
+		APhysicsServiceRegion** RagdollRegion =
+			PhysicsServiceRegionList.FindByPredicate([&PSDRagdollLocation]
+			(const APhysicsServiceRegion* PhysicsServiceRegion)
+		{
+			return PhysicsServiceRegion->IsLocationInsideRegion
+				(PSDRagdollLocation);
+		});
+
+		for (const auto& PhysicsServiceRegion : PhysicsServiceRegionList)
+		{
+			PhysicsServiceRegion->RemovePSDRagdollFromRegion
+				(PSDRagdollPair.Key);
+		}
+
+		if (!RagdollRegion)
+		{
+			RPES_LOG_WARNING(TEXT("PSD ragdoll \"%s\" is not on any physics "
+				"service region. Its activation is dropped."),
+				*GetNameSafe(PSDRagdoll->GetOwner()));
+			PSDRagdoll->ClearPendingActivation();
+			continue;
+		}
+
+		// The ragdoll type is registered on the region's physics service
+		// first, if needed, as no step is in flight yet
+		RagdollActivationsByPhysicsServiceId.FindOrAdd((*RagdollRegion)->
+			RegionOwnerPhysicsServiceId) +=
+			(*RagdollRegion)->ActivatePSDRagdollOnRegion(PSDRagdoll);
+	}
+
+	// Gather the driver input of the vehicles each region owns, the targets
+	// of its movers, its constraint and force field changes and the scene
+	// queries queued on it. The queries run right after the step and return
+	// on its response
+	TMap<int32, FString> VehicleInputsByPhysicsServiceId;
+	TMap<int32, FString> KinematicTargetsByPhysicsServiceId;
+	TMap<int32, FString> ConstraintChangesByPhysicsServiceId;
+	TMap<int32, FString> ForceFieldChangesByPhysicsServiceId;
+	TMap<int32, FString> SceneQueriesByPhysicsServiceId;
+	for (const auto& PhysicsServiceRegion : PhysicsServiceRegionList)
+	{
+		VehicleInputsByPhysicsServiceId.FindOrAdd(PhysicsServiceRegion->
+			RegionOwnerPhysicsServiceId) +=
+			PhysicsServiceRegion->GetPSDVehiclesInputString();
+		KinematicTargetsByPhysicsServiceId.FindOrAdd(PhysicsServiceRegion->
+			RegionOwnerPhysicsServiceId) +=
+			PhysicsServiceRegion->GetPSDKinematicTargetsString();
+		ConstraintChangesByPhysicsServiceId.FindOrAdd(PhysicsServiceRegion->
+			RegionOwnerPhysicsServiceId) +=
+			PhysicsServiceRegion->ConsumeQueuedPSDConstraintChanges();
+		ForceFieldChangesByPhysicsServiceId.FindOrAdd(PhysicsServiceRegion->
+			RegionOwnerPhysicsServiceId) +=
+			PhysicsServiceRegion->ConsumeQueuedPSDForceFieldChanges();
+		SceneQueriesByPhysicsServiceId.FindOrAdd(PhysicsServiceRegion->
+			RegionOwnerPhysicsServiceId) +=
+			PhysicsServiceRegion->ConsumeQueuedSceneQueries();
+	}
+
 	// For each socket client thread info, set the message to "step" and send
 	// for each physics service region (we know that each thread represents
 	// a given physics region)
@@ -448,8 +778,30 @@ void APSDActorsCoordinator::UpdatePSDActors()
 		auto& ThreadInfoPair = SocketClientThreadInfo.Value;
 		auto& ThreadWoker = ThreadInfoPair.Key;
 
-		// Set the message to send on the worker
-		ThreadWoker->SetMessageToSend("Step\nMessageEnd\n");
+		// Set the message to send on the worker. The key is the physics
+		// service region id, which addresses the region's world on the 
+		// service. The payload is the elapsed time to advance, followed by
+		// the ghost states, the movers' targets, the characters' and
+		// vehicles' inputs, the ragdolls to activate, the constraint and
+		// force field changes and the scene queries
+		ThreadWoker->SetMessageToSend(FString::Printf
+			(TEXT("Step;%d\n%f\n%s%s%s%s%s%s%s%sMessageEnd\n"),
+			SocketClientThreadInfo.Key, DeltaTime,
+			*GhostStatesByPhysicsServiceId.FindRef(SocketClientThreadInfo.Key),
+			*KinematicTargetsByPhysicsServiceId.FindRef
+			(SocketClientThreadInfo.Key),
+			*CharacterInputsByPhysicsServiceId.FindRef
+			(SocketClientThreadInfo.Key),
+			*VehicleInputsByPhysicsServiceId.FindRef
+			(SocketClientThreadInfo.Key),
+			*RagdollActivationsByPhysicsServiceId.FindRef
+			(SocketClientThreadInfo.Key),
+			*ConstraintChangesByPhysicsServiceId.FindRef
+			(SocketClientThreadInfo.Key),
+			*ForceFieldChangesByPhysicsServiceId.FindRef
+			(SocketClientThreadInfo.Key),
+			*SceneQueriesByPhysicsServiceId.FindRef
+			(SocketClientThreadInfo.Key)));
 	}
 
 	//RPES_LOG_WARNING(TEXT("Sent all steps"));
@@ -549,6 +901,39 @@ void APSDActorsCoordinator::UpdatePSDActors()
 	RPES_LOG_INFO(TEXT("Physics updated for this frame."));
 }
 
+void APSDActorsCoordinator::RequestPhysicsServiceRegionMigration
+	(int32 PhysicsServiceRegionId, const FString& NewPhysicsServiceIpAddr)
+{
+	// Check if the physics service region does exist
+	if (!PhysicsServiceRegionList.IsValidIndex(PhysicsServiceRegionId))
+	{
+		RPES_LOG_ERROR(TEXT("No physics region with id: %d on the coordinator "
+			"list to migrate."), PhysicsServiceRegionId);
+		return;
+	}
+
+	// Keep only the last request for each region
+	PendingPhysicsServiceRegionMigrations.Add(PhysicsServiceRegionId,
+		NewPhysicsServiceIpAddr);
+
+	RPES_LOG_INFO(TEXT("Physics service region (id: %d) will migrate to "
+		"\"%s\" on the next step boundary."), PhysicsServiceRegionId,
+		*NewPhysicsServiceIpAddr);
+}
+
+void APSDActorsCoordinator::MigratePendingPhysicsServiceRegions()
+{
+	for (const auto& PendingMigration : PendingPhysicsServiceRegionMigrations)
+	{
+		// The region stays on its current physics service if it fails, which
+		// is logged by the region itself
+		PhysicsServiceRegionList[PendingMigration.Key]->
+			MigrateToPhysicsService(PendingMigration.Value);
+	}
+
+	PendingPhysicsServiceRegionMigrations.Empty();
+}
+
 void APSDActorsCoordinator::StartPSDActorsSimulation
 	(const TArray<FString>& SocketServerIpAddrList)
 {
@@ -599,6 +984,9 @@ void APSDActorsCoordinator::StartPSDActorsSimulation
 	AllocatedRamMeasurement = FString();
 	CPUUsageMeasurement = FString();
 
+	// Give the PSDActors their body index before the regions gather them
+	AllocatePSDActorsBodyIndices();
+
 	// Aux to attribute physicsd service regions ip addr
 	int32 CurrentPhysicsInitializedPhysicsRegion = 0;
 
@@ -613,16 +1001,13 @@ void APSDActorsCoordinator::StartPSDActorsSimulation
 			(PhysicsServiceRegionIpAddr);
 
 		// Get all the dynamic PSDActors on this region
-		const auto DynamicPSDActorsOnRegion = PhysicsServiceRegion->
+		const auto& DynamicPSDActorsOnRegion = PhysicsServiceRegion->
 			GetCachedDynamicPSDActorsOnRegion();
 
 		// For each dynamic PSDActor, bind the OnEnteredPhysicsRegion and
 		// OnExitedPhysicsRegion so the coordinator knows once it occurs
-		for (const auto& DynamicPSDActorOnRegion : DynamicPSDActorsOnRegion)
+		for (APSDActorBase* PSDActor : DynamicPSDActorsOnRegion.GetPSDActors())
 		{
-			// Get the PSDActor from the TMap
-			const auto& PSDActor = DynamicPSDActorOnRegion.Value;
-
 			// Bind the delegates
 			PSDActor->OnActorEnteredPhysicsRegion.AddDynamic(this, 
 				&APSDActorsCoordinator::OnPSDActorEnteredPhysicsRegion);
@@ -664,6 +1049,15 @@ void APSDActorsCoordinator::StopPSDActorsSimulation()
 	// Set the flag to false to stop ticking PSDActors' update
 	bIsSimulatingPhysics = false;
 
+	// Drop any migration not done yet
+	PendingPhysicsServiceRegionMigrations.Empty();
+
+	// Give the characters' movement back to their movement components
+	for (const auto& PSDCharacterPair : PSDCharacters)
+	{
+		PSDCharacterPair.Value->SetIsOnPhysicsServiceRegion(false);
+	}
+
 	// For each physics service region on the world, save the measurements
 	for (const auto& PhysicsServiceRegion : PhysicsServiceRegionList)
 	{
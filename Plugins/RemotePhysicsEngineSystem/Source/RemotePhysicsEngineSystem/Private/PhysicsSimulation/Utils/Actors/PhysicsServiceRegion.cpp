@@ -3,14 +3,23 @@
 
 #include "PhysicsSimulation/Utils/Actors/PhysicsServiceRegion.h"
 #include "PhysicsSimulation/PSDActors/Base/PSDActorBase.h"
+#include "PhysicsSimulation/PSDActors/PSDKinematicActor.h"
+#include "PhysicsSimulation/PSDActors/PSDSensorActor.h"
+#include "PhysicsSimulation/PSDActors/PSDStaticMeshActor.h"
+#include "PhysicsSimulation/PSDActors/PSDVehicle.h"
 #include "PhysicsSimulation/Utils/Components/PSDactorSpawnerComponent.h"
+#include "PhysicsSimulation/Utils/Components/PSDCharacterComponent.h"
+#include "PhysicsSimulation/Utils/Components/PSDRagdollComponent.h"
 #include "ExternalCommunication/Sockets/SocketClientProxy.h"
 #include "ExternalCommunication/Sockets/SocketClientInstance.h"
 #include "RemotePhysicsEngineSystem/RemotePhysicsEngineSystemLogging.h"
 
 #include "Components/BoxComponent.h"
+#include "Kismet/GameplayStatics.h"
+#include "Misc/Base64.h"
 
 #include <string>
+#include <chrono>
 
 APhysicsServiceRegion::APhysicsServiceRegion()
 {
@@ -57,38 +66,11 @@ void APhysicsServiceRegion::Tick(float DeltaTime)
 }
 
 void APhysicsServiceRegion::AddPSDActorCloneOnPhysicsService
-	(const APSDActorBase* PSDActorToClone)
+	(APSDActorBase* PSDActorToClone)
 {
 	RPES_LOG_INFO(TEXT("Adding PSDActor \"%s\" clone on region (id: %d)"),
 		*PSDActorToClone->GetName(), RegionOwnerPhysicsServiceId);
 
-	// Get the PSDActor ID to use it as the body ID
-	const int32 PSDActorBodyID = PSDActorToClone->GetPSDActorBodyId();
-
-	// Get the PSDActor to clone location as string
-	const auto PSDActorCloneLocation =
-		PSDActorToClone->GetCurrentActorLocationAsString();
-
-	// Get the current actor's linear velocity as a string
-	const auto PSDActorCloneLinearVelocityAsString =
-		PSDActorToClone->GetPSDActorLinearVelocityAsString();
-
-	// Get the current actor's angular velocity as a string
-	const auto PSDActorCloneAngularVelocityString =
-		PSDActorToClone->GetPSDActorAngularVelocityAsString();
-
-	// Create the message to send server
-	// The template is:
-	// "AddBody\n
-	// actorType; Id; bodyType; posX; posY; posZ; LinearVelocityX; 
-	// LinearVelocityY; LinearVelocityZ;AngularVelocityX; AngularVelocityY;
-	// AngularVelocityZ\nMessageEnd\n"
-	const FString SpawnNewPSDActorCloneMessage =
-		FString::Printf(TEXT("AddBody\nsphere;%d;clone;%s;%s;%s\nMessageEnd\n"),
-			PSDActorBodyID, *PSDActorCloneLocation,
-			*PSDActorCloneLinearVelocityAsString, 
-			*PSDActorCloneAngularVelocityString);
-
 	// Get the socket connection instance to send the message
 	auto* SocketConnectionToSend = 
 		FSocketClientProxy::GetSocketConnectionByServerId
@@ -103,6 +85,22 @@ void APhysicsServiceRegion::AddPSDActorCloneOnPhysicsService
 		return;
 	}
 
+	// The clone may reference a cooked collision this service does not have
+	SendMissingCookedMeshesToPhysicsService(SocketConnectionToSend,
+		{ PSDActorToClone });
+
+	// Create the message to send server. The clone's body line is given by
+	// the PSDActor, so each PSDActor type is cloned as itself
+	// The template is:
+	// "AddBody;WorldId\n
+	// actorType; Id; clone; posX; posY; posZ; LinearVelocityX; 
+	// LinearVelocityY; LinearVelocityZ;AngularVelocityX; AngularVelocityY;
+	// AngularVelocityZ\nMessageEnd\n"
+	const FString SpawnNewPSDActorCloneMessage =
+		FString::Printf(TEXT("AddBody;%d\n%sMessageEnd\n"),
+			RegionOwnerPhysicsServiceId,
+			*PSDActorToClone->GetPhysicsServiceCloneInitializationString());
+
 	// Convert message to std string
 	std::string MessageAsStdString
 		(TCHAR_TO_UTF8(*SpawnNewPSDActorCloneMessage));
@@ -117,6 +115,9 @@ void APhysicsServiceRegion::AddPSDActorCloneOnPhysicsService
 
 	RPES_LOG_INFO(TEXT("Add new PSDActor clone action response: %s"),
 		*Response);
+
+	// Subscribe the clone to the same contact events of its primary
+	SendContactSubscriptionsToPhysicsService({ PSDActorToClone });
 }
 
 bool APhysicsServiceRegion::ConnectToPhysicsService()
@@ -178,6 +179,18 @@ void APhysicsServiceRegion::ClearPhysicsServiceRegion()
 
 	// Clear the map and list
 	DynamicPSDActorsOnRegion.Empty();
+	StaticPSDActorsOnRegion.Empty();
+	KinematicPSDActorsOnRegion.Empty();
+
+	// The ragdolls go away with the physics service world
+	ReleasePSDRagdollsOnRegion();
+	RegisteredPSDRagdollTypes.Empty();
+
+	// And so do the constraints and force fields
+	PSDConstraintIds.Empty();
+	QueuedPSDConstraintChanges = FString();
+	PSDForceFieldIds.Empty();
+	QueuedPSDForceFieldChanges = FString();
 
 	// Close socket connection on this physics service (given its ID)
 	const bool bWasCloseSocketSuccess =
@@ -207,6 +220,13 @@ void APhysicsServiceRegion::DestroyPSDActorOnPhysicsRegion
 
 	// Remove this PSDActor from the dynamic PSDActors map
 	DynamicPSDActorsOnRegion.Remove(PSDActorBodyId);
+	KinematicPSDActorsOnRegion.Remove(PSDActorBodyId);
+
+	// Recycle its body index
+	if (BodyIndexAllocator)
+	{
+		BodyIndexAllocator->ReleaseBodyIndex(PSDActorToDestroy);
+	}
 
 	// Destroy the PSDActor
 	PSDActorToDestroy->Destroy();
@@ -234,6 +254,15 @@ void APhysicsServiceRegion::GetAllDynamicPSDActorOnRegion()
 			continue;
 		}
 
+		// The movers are not updated by the steps, but send their transform
+		// on each one
+		if (PSDActor->IsPSDActorKinematic())
+		{
+			KinematicPSDActorsOnRegion.Add(PSDActor->GetPSDActorBodyId(),
+				PSDActor);
+			continue;
+		}
+
 		// If not, it is a dynamic body.
 		// Add to map that stores all the dynamic PSD actors so they can be
 		// updated on each physics step
@@ -308,22 +337,225 @@ void APhysicsServiceRegion::InitializePhysicsServiceRegion(const FString&
 		RegionOwnerPhysicsServiceId);
 }
 
+bool APhysicsServiceRegion::MigrateToPhysicsService
+	(const FString& NewPhysicsServiceIpAddr)
+{
+	RPES_LOG_INFO(TEXT("Migrating physics service region (id: %d) from "
+		"\"%s\" to \"%s\"."), RegionOwnerPhysicsServiceId, 
+		*PhysicsServiceIpAddr, *NewPhysicsServiceIpAddr);
+
+	// Check if there is a running world to migrate
+	if (!bIsPhysicsServiceRegionActive)
+	{
+		RPES_LOG_ERROR(TEXT("Could not migrate physics service region (id: "
+			"%d) as it is not active."), RegionOwnerPhysicsServiceId);
+		return false;
+	}
+
+	// Parse the new server ip addr
+	TArray<FString> ParsedServerIpAddr;
+	NewPhysicsServiceIpAddr.ParseIntoArray(ParsedServerIpAddr, TEXT(":"));
+
+	if (ParsedServerIpAddr.Num() < 2)
+	{
+		RPES_LOG_ERROR(TEXT("Could not parse server ip addr: \"%s\". Check "
+			"parsing."), *NewPhysicsServiceIpAddr);
+		return false;
+	}
+
+	// Connect to the new physics service ahead of time. This is done before
+	// the simulation stalls, as connecting may take a while
+	USocketClientInstance* NewSocketConnection =
+		FSocketClientProxy::CreateSocketConnection(ParsedServerIpAddr[0],
+		ParsedServerIpAddr[1]);
+	if (!NewSocketConnection)
+	{
+		RPES_LOG_ERROR(TEXT("Could not connect to the physics service to "
+			"migrate to."));
+		return false;
+	}
+
+	// Get the current socket connection instance
+	auto* CurrentSocketConnection = 
+		FSocketClientProxy::GetSocketConnectionByServerId
+		(RegionOwnerPhysicsServiceId);
+
+	// Check if valid 
+	if (!CurrentSocketConnection)
+	{
+		RPES_LOG_ERROR(TEXT("Could not send message to socket with ID \"%d\" "
+			"as such connection does not exist."),
+			RegionOwnerPhysicsServiceId);
+		NewSocketConnection->CloseSocketConnection();
+		return false;
+	}
+
+	// The simulation stalls from here until the new physics service has
+	// restored the world
+	std::chrono::steady_clock::time_point preMigrationTime =
+		std::chrono::steady_clock::now();
+
+	// Save the world snapshot on the current physics service
+	// The template is:
+	// "SaveSnapshot;WorldId\n
+	// MessageEnd\n"
+	const FString SaveSnapshotMessage = FString::Printf
+		(TEXT("SaveSnapshot;%d\nMessageEnd\n"), RegionOwnerPhysicsServiceId);
+
+	// Convert message to std string
+	std::string SaveSnapshotMessageAsStdString
+		(TCHAR_TO_UTF8(*SaveSnapshotMessage));
+
+	// The response is the world snapshot, already ending with "MessageEnd"
+	const FString WorldSnapshot = 
+		CurrentSocketConnection->SendMessageAndGetResponse
+		(&SaveSnapshotMessageAsStdString[0]);
+
+	if (!WorldSnapshot.StartsWith("Settings"))
+	{
+		RPES_LOG_ERROR(TEXT("Could not save the world snapshot of region (id: "
+			"%d). Response: %s"), RegionOwnerPhysicsServiceId, 
+			*WorldSnapshot);
+		NewSocketConnection->CloseSocketConnection();
+		return false;
+	}
+
+	// The new physics service may not have the static meshes cooked yet
+	SendMissingCookedMeshesToPhysicsService(NewSocketConnection,
+		GetAllPSDActorsOnRegion());
+
+	// Restore the world snapshot on the new physics service
+	// The template is:
+	// "RestoreSnapshot;WorldId\n
+	// WorldSnapshot\n
+	// MessageEnd\n"
+	const FString RestoreSnapshotMessage = FString::Printf
+		(TEXT("RestoreSnapshot;%d\n%s"), RegionOwnerPhysicsServiceId,
+		*WorldSnapshot);
+
+	// Convert message to std string
+	std::string RestoreSnapshotMessageAsStdString
+		(TCHAR_TO_UTF8(*RestoreSnapshotMessage));
+
+	const FString RestoreSnapshotResponse = 
+		NewSocketConnection->SendMessageAndGetResponse
+		(&RestoreSnapshotMessageAsStdString[0]);
+
+	// If the restore failed, keep running on the current physics service
+	if (!RestoreSnapshotResponse.Contains("successful"))
+	{
+		RPES_LOG_ERROR(TEXT("Could not restore the world snapshot of region "
+			"(id: %d) on the new physics service. Response: %s"),
+			RegionOwnerPhysicsServiceId, *RestoreSnapshotResponse);
+		NewSocketConnection->CloseSocketConnection();
+		return false;
+	}
+
+	// Check if the restored world is on the same state as the last step
+	// received. The snapshot is taken between steps, so they must match
+	const FString RestoredChecksumString = RestoreSnapshotResponse.Mid
+		(RestoreSnapshotResponse.Find("Checksum;") + 9);
+	const uint32 RestoredStateChecksum = static_cast<uint32>
+		(FCString::Strtoui64(*RestoredChecksumString, nullptr, 10));
+
+	if (LastStateChecksum != 0 && RestoreSnapshotResponse.Contains
+		("Checksum;") && RestoredStateChecksum != LastStateChecksum)
+	{
+		RPES_LOG_ERROR(TEXT("Region (id: %d) state diverged when migrating on "
+			"step %d (checksum: %u; restored: %u)."),
+			RegionOwnerPhysicsServiceId, LastPhysicsStepIndex,
+			LastStateChecksum, RestoredStateChecksum);
+	}
+
+	// Clear the world on the previous physics service
+	const FString ClearMessage = FString::Printf(TEXT("Clear;%d\n"
+		"MessageEnd\n"), RegionOwnerPhysicsServiceId);
+
+	// Convert message to std string
+	std::string ClearMessageAsStdString(TCHAR_TO_UTF8(*ClearMessage));
+
+	CurrentSocketConnection->SendMessageAndGetResponse
+		(&ClearMessageAsStdString[0]);
+
+	// Replace the region's connection. Every message to this region is now
+	// sent to the new physics service
+	FSocketClientProxy::ReplaceSocketConnectionToServer
+		(RegionOwnerPhysicsServiceId, NewSocketConnection);
+
+	PhysicsServiceIpAddr = NewPhysicsServiceIpAddr;
+
+	// The snapshot does not carry the ragdolls, and the ragdoll types must be
+	// registered again on the new physics service
+	ReleasePSDRagdollsOnRegion();
+	RegisteredPSDRagdollTypes.Empty();
+
+	// Get post migration time
+	std::chrono::steady_clock::time_point postMigrationTime =
+		std::chrono::steady_clock::now();
+
+	// Calculate the microsseconds the simulation was stalled
+	const int64 MigrationStallMicroseconds = 
+		std::chrono::duration_cast<std::chrono::microseconds>
+		(postMigrationTime - preMigrationTime).count();
+
+	RPES_LOG_INFO(TEXT("Physics service region (id: %d) migrated to \"%s\". "
+		"Snapshot size: %d. Stall: %lld microseconds."),
+		RegionOwnerPhysicsServiceId, *PhysicsServiceIpAddr, 
+		WorldSnapshot.Len(), MigrationStallMicroseconds);
+
+	// Check if the stall was over the budget
+	if (MigrationStallMicroseconds > MaxMigrationStallMilliseconds * 1000.f)
+	{
+		RPES_LOG_WARNING(TEXT("Physics service region (id: %d) migration "
+			"stalled for %lld microseconds, over the %f milliseconds budget."),
+			RegionOwnerPhysicsServiceId, MigrationStallMicroseconds,
+			MaxMigrationStallMilliseconds);
+	}
+
+	return true;
+}
+
 void APhysicsServiceRegion::InitializeRegionPhysicsWorld()
 {
 	RPES_LOG_INFO(TEXT("Initializing physics world on physics service with "
 		"ID: %d."), RegionOwnerPhysicsServiceId);
 
 	// Create the initialization message string and initialize it with "Init"
-	// so physics service knows what this message is
-	FString InitializationMessage = "Init\n";
+	// so physics service knows what this message is. The region id addresses
+	// this region's world on the physics service, as a single service process
+	// may host the worlds of many regions. The header also carries this 
+	// region's step settings, contact events budget, rewind history and the
+	// origin its world is simulated around
+	const FVector PhysicsWorldOrigin = bUseRegionCenterAsPhysicsOrigin ?
+		PhysicsServiceRegionBoxComponent->GetComponentLocation() :
+		FVector::ZeroVector;
+
+	FString InitializationMessage = FString::Printf(TEXT("Init;%d;%f;%d;%d;"
+		"%d;%d;%d;%d;%.9g;%.9g;%.9g\n"), RegionOwnerPhysicsServiceId,
+		PhysicsFixedDeltaTime, PhysicsCollisionSteps,
+		PhysicsIntegrationSubSteps, PhysicsMaxCatchUpSteps,
+		MaxContactEventsPerStep, RewindHistoryLength, MaxRewindBodies,
+		PhysicsWorldOrigin.X, PhysicsWorldOrigin.Y, PhysicsWorldOrigin.Z);
 
 	// Get all PSDActors on this region
 	const auto PSDActorsOnRegion = GetAllPSDActorsOnRegion();
 
+	// The static and dynamic PSDActors initialization info are kept apart, as
+	// the static ones may be sent as a baked static scene
+	FString StaticBodiesInitializationMessage = FString();
+	FString DynamicBodiesInitializationMessage = FString();
+
 	// Foreach PSD actor on the region, get its initialization info and append 
 	// to the initialization message
 	for (auto& PSDActor : PSDActorsOnRegion)
 	{
+		// Keep the static PSDActors so they can be found on contact events
+		if (PSDActor->IsPSDActorStatic())
+		{
+			StaticPSDActorsOnRegion.Add(PSDActor->GetPSDActorBodyId(),
+				PSDActor);
+		}
+
 		// Get the PSDActor physics service initialization string
 		const FString PSDActorInitializationMessage =
 			PSDActor->GetPhysicsServiceInitializationString();
@@ -334,16 +566,20 @@ void APhysicsServiceRegion::InitializeRegionPhysicsWorld()
 			continue;
 		}
 
-		// Append it to the final initialization message
-		InitializationMessage += PSDActorInitializationMessage;
+		// Append it to the static or dynamic initialization message. The
+		// sensors are tracked by the physics service world, so they are never
+		// baked into a static scene
+		if (PSDActor->IsPSDActorStatic() && !PSDActor->IsA<APSDSensorActor>())
+		{
+			StaticBodiesInitializationMessage += PSDActorInitializationMessage;
+		}
+		else
+		{
+			DynamicBodiesInitializationMessage +=
+				PSDActorInitializationMessage;
+		}
 	}
 
-	// Append the end message token. This is 
-	// needed as this may reach the server in separate messages, since it 
-	// can be too big to send everything at once. The server will 
-	// acknowledge the initialization message has ended with this token
-	InitializationMessage += "MessageEnd\n";
-
 	// Get the socket connection instance to send the message
 	auto* SocketConnectionToSend = 
 		FSocketClientProxy::GetSocketConnectionByServerId
@@ -358,22 +594,95 @@ void APhysicsServiceRegion::InitializeRegionPhysicsWorld()
 		return;
 	}
 
-	// Convert message to std string
-	std::string MessageAsStdString(TCHAR_TO_UTF8(*InitializationMessage));
+	auto SendMessageToPhysicsService = [SocketConnectionToSend]
+		(const FString& MessageToSend)
+	{
+		// Convert message to std string
+		std::string MessageAsStdString(TCHAR_TO_UTF8(*MessageToSend));
+
+		// Convert message to char*. This is needed as some UE converting has
+		// the limitation of 128 bytes, returning garbage when it's over it
+		char* MessageAsChar = &MessageAsStdString[0];
+
+		return SocketConnectionToSend->SendMessageAndGetResponse
+			(MessageAsChar);
+	};
+
+	// The static meshes reference their cooked collision, which must be on
+	// the physics service before the world initialization
+	SendMissingCookedMeshesToPhysicsService(SocketConnectionToSend,
+		PSDActorsOnRegion);
+
+	// The static bodies are sent as a static scene, baked on the physics
+	// service and addressed by the map and region id. The hash of their lines
+	// tells the physics service if its baked scene is stale
+	const bool bShouldUseStaticScene = bUseStaticSceneCache &&
+		!StaticBodiesInitializationMessage.IsEmpty();
+	const FString StaticSceneKey = FString::Printf(TEXT("%s_Region%d"),
+		*UGameplayStatics::GetCurrentLevelName(GetWorld()),
+		RegionOwnerPhysicsServiceId);
+	const uint32 StaticSceneContentHash =
+		FCrc::StrCrc32(*StaticBodiesInitializationMessage);
+	const FString StaticSceneInitializationMessage = FString::Printf
+		(TEXT("StaticScene;%s;%u\n"), *StaticSceneKey,
+		StaticSceneContentHash);
 
-	// Convert message to char*. This is needed as some UE converting has 
-	// the limitation of 128 bytes, returning garbage when it's over it
-	char* MessageAsChar = &MessageAsStdString[0];
+	// Append the end message token. This is 
+	// needed as this may reach the server in separate messages, since it 
+	// can be too big to send everything at once. The server will 
+	// acknowledge the initialization message has ended with this token
+	const FString CachedInitializationMessage = InitializationMessage +
+		StaticSceneInitializationMessage + DynamicBodiesInitializationMessage +
+		"MessageEnd\n";
+	const FString FullInitializationMessage = InitializationMessage +
+		StaticBodiesInitializationMessage + DynamicBodiesInitializationMessage +
+		"MessageEnd\n";
 
 	RPES_LOG_INFO(TEXT("Sending init message for service with id \"%d\". "
-		"Message: %s"), RegionOwnerPhysicsServiceId, *InitializationMessage);
+		"Message: %s"), RegionOwnerPhysicsServiceId, bShouldUseStaticScene ?
+		*CachedInitializationMessage : *FullInitializationMessage);
 
 	// Send message to initialize physics world on service
-	const FString Response = SocketConnectionToSend->SendMessageAndGetResponse
-		(MessageAsChar);
+	FString Response = SendMessageToPhysicsService(bShouldUseStaticScene ?
+		CachedInitializationMessage : FullInitializationMessage);
+
+	// If the static scene is not baked yet, bake it and initialize again. If
+	// the bake fails, the static bodies are sent one by one
+	if (bShouldUseStaticScene && Response.Contains("StaticSceneMissing"))
+	{
+		RPES_LOG_INFO(TEXT("Baking static scene \"%s\" on physics service "
+			"with ID (%d)."), *StaticSceneKey, RegionOwnerPhysicsServiceId);
+
+		// The template is:
+		// "BakeStaticScene;WorldId\n
+		// SceneKey; ContentHash\n
+		// bodyInfoLine\n
+		// ...
+		// MessageEnd\n"
+		const FString BakeStaticSceneMessage = FString::Printf
+			(TEXT("BakeStaticScene;%d\n%s;%u\n%sMessageEnd\n"),
+			RegionOwnerPhysicsServiceId, *StaticSceneKey,
+			StaticSceneContentHash, *StaticBodiesInitializationMessage);
+
+		const FString BakeResponse = SendMessageToPhysicsService
+			(BakeStaticSceneMessage);
+		const bool bHasBakedStaticScene = BakeResponse.Contains("successful");
+		if (!bHasBakedStaticScene)
+		{
+			RPES_LOG_ERROR(TEXT("Could not bake static scene \"%s\". "
+				"Response: %s"), *StaticSceneKey, *BakeResponse);
+		}
+
+		Response = SendMessageToPhysicsService(bHasBakedStaticScene ?
+			CachedInitializationMessage : FullInitializationMessage);
+	}
 
 	RPES_LOG_WARNING(TEXT("Physics service with ID (%d) response: %s"),
 		RegionOwnerPhysicsServiceId, *Response);
+
+	// Send the contact events subscriptions of the PSDActors on this region
+	SendContactSubscriptionsToPhysicsService
+		(TArray<const APSDActorBase*>(PSDActorsOnRegion));
 }
 
 void APhysicsServiceRegion::OnRegionEntry
@@ -457,11 +766,12 @@ void APhysicsServiceRegion::RemovePSDActorFromPhysicsService
 
 	// Create the message to send to the physics service
 	// The template is:
-	// "RemoveBody\n
+	// "RemoveBody;WorldId\n
 	// BodyId\n
 	// MessageEnd\n"
 	const FString RemoveBodyMessage =
-		FString::Printf(TEXT("RemoveBody\n%d\nMessageEnd\n"), BodyIdToRemove);
+		FString::Printf(TEXT("RemoveBody;%d\n%d\nMessageEnd\n"),
+		RegionOwnerPhysicsServiceId, BodyIdToRemove);
 
 	// Get the socket connection instance to send the message
 	auto* SocketConnectionToSend =
@@ -522,11 +832,18 @@ void APhysicsServiceRegion::UpdatePSDActorsOnRegion
 		//RegionOwnerPhysicsServiceId);
 
 	// Parse physics simulation result
-	// Each line will contain a result for a actor in terms of:
+	// The first line is the step info: "StepInfo; NumberOfSteps; Alpha"
+	// Each other line will contain a result for a actor in terms of:
 	// "Id; posX; posY; posZ; rotX; rotY; rotZ"
 	TArray<FString> ParsedSimulationResult;
 	PhysicsSimulationResultStr.ParseIntoArrayLines(ParsedSimulationResult);
 
+	// The interpolation alpha to blend the PSDActors with
+	float InterpolationAlpha = 1.f;
+
+	// The results of the scene queries sent with the step, if any
+	TArray<FPSDSceneQueryResult> ReceivedSceneQueryResults;
+
 	// Foreach line, parse its results (getting each actor pos)
 	for (auto& SimulationResultLine : ParsedSimulationResult)
 	{
@@ -536,6 +853,133 @@ void APhysicsServiceRegion::UpdatePSDActorsOnRegion
 			continue;
 		}
 
+		// Check if the line is a contact event
+		if (SimulationResultLine.StartsWith("Contact"))
+		{
+			TArray<FString> ParsedContactEvent;
+			SimulationResultLine.ParseIntoArray(ParsedContactEvent, TEXT(";"));
+
+			HandleContactEvent(ParsedContactEvent);
+			continue;
+		}
+
+		// Check if the line is a character state
+		if (SimulationResultLine.StartsWith("CharacterState"))
+		{
+			TArray<FString> ParsedCharacterState;
+			SimulationResultLine.ParseIntoArray(ParsedCharacterState,
+				TEXT(";"));
+
+			HandleCharacterState(ParsedCharacterState);
+			continue;
+		}
+
+		// Check if the line is a vehicle state
+		if (SimulationResultLine.StartsWith("VehicleState"))
+		{
+			TArray<FString> ParsedVehicleState;
+			SimulationResultLine.ParseIntoArray(ParsedVehicleState,
+				TEXT(";"));
+
+			HandleVehicleState(ParsedVehicleState);
+			continue;
+		}
+
+		// Check if the line is a ragdoll state
+		if (SimulationResultLine.StartsWith("RagdollState"))
+		{
+			TArray<FString> ParsedRagdollState;
+			SimulationResultLine.ParseIntoArray(ParsedRagdollState,
+				TEXT(";"));
+
+			HandleRagdollState(ParsedRagdollState);
+			continue;
+		}
+
+		// Check if the line is a released ragdoll
+		if (SimulationResultLine.StartsWith("RagdollReleased"))
+		{
+			TArray<FString> ParsedRagdollReleased;
+			SimulationResultLine.ParseIntoArray(ParsedRagdollReleased,
+				TEXT(";"));
+
+			HandleRagdollReleased(ParsedRagdollReleased);
+			continue;
+		}
+
+		// Check if the line is a constraint removed by the physics service
+		if (SimulationResultLine.StartsWith("ConstraintRemoved"))
+		{
+			TArray<FString> ParsedConstraintRemoved;
+			SimulationResultLine.ParseIntoArray(ParsedConstraintRemoved,
+				TEXT(";"));
+
+			HandleConstraintRemoved(ParsedConstraintRemoved);
+			continue;
+		}
+
+		// Check if the line is a constraint id created twice on a batch. The
+		// service keeps the first constraint, so the id stays known
+		if (SimulationResultLine.StartsWith("ConstraintAdded"))
+		{
+			RPES_LOG_WARNING(TEXT("Physics service rejected a constraint on "
+				"region %d: %s"), RegionOwnerPhysicsServiceId,
+				*SimulationResultLine);
+			continue;
+		}
+
+		// Check if the line is the overlaps changed on a sensor
+		if (SimulationResultLine.StartsWith("Sensor"))
+		{
+			TArray<FString> ParsedSensorEvents;
+			SimulationResultLine.ParseIntoArray(ParsedSensorEvents,
+				TEXT(";"));
+
+			HandleSensorEvents(ParsedSensorEvents);
+			continue;
+		}
+
+		// Check if the line is a scene query result
+		if (SimulationResultLine.StartsWith("Query"))
+		{
+			TArray<FString> ParsedSceneQueryResult;
+			SimulationResultLine.ParseIntoArray(ParsedSceneQueryResult,
+				TEXT(";"));
+
+			FPSDSceneQueryResult SceneQueryResult;
+			if (ParseSceneQueryResult(ParsedSceneQueryResult,
+				SceneQueryResult))
+			{
+				ReceivedSceneQueryResults.Add(MoveTemp(SceneQueryResult));
+			}
+			continue;
+		}
+
+		// Check if the line is the step info
+		if (SimulationResultLine.StartsWith("StepInfo"))
+		{
+			TArray<FString> ParsedStepInfo;
+			SimulationResultLine.ParseIntoArray(ParsedStepInfo, TEXT(";"));
+
+			if (ParsedStepInfo.Num() >= 3)
+			{
+				InterpolationAlpha = FCString::Atof(*ParsedStepInfo[2]);
+			}
+
+			if (ParsedStepInfo.Num() >= 4)
+			{
+				LastPhysicsStepIndex = FCString::Atoi(*ParsedStepInfo[3]);
+			}
+
+			if (ParsedStepInfo.Num() >= 5)
+			{
+				LastStateChecksum = static_cast<uint32>(FCString::Strtoui64
+					(*ParsedStepInfo[4], nullptr, 10));
+			}
+
+			continue;
+		}
+
 		// Parse the line with ";" delimit
 		TArray<FString> ParsedActorSimulationResult;
 		SimulationResultLine.ParseIntoArray(ParsedActorSimulationResult,
@@ -554,16 +998,14 @@ void APhysicsServiceRegion::UpdatePSDActorsOnRegion
 		const int32 ActorID =
 			FCString::Atoi(*ParsedActorSimulationResult[0]);
 
-		// Check if the actor exists on the dynamic PSDActors map
-		const bool bDoesActorExistOnMap = 
-			DynamicPSDActorsOnRegion.Contains(ActorID);
-		if (!bDoesActorExistOnMap)
+		// Find the actor on the dynamic PSDActors map. This is a flat
+		// array lookup, as the actor id is its body index
+		if (!DynamicPSDActorsOnRegion.Contains(ActorID))
 		{
 			continue;
 		}
 
-		// Find the actor on the map
-		auto ActorToUpdate = DynamicPSDActorsOnRegion[ActorID];
+		auto ActorToUpdate = DynamicPSDActorsOnRegion.FindRef(ActorID);
 
 		// To be sure, check if the actor is valid
 		if (!ActorToUpdate)
@@ -620,62 +1062,995 @@ void APhysicsServiceRegion::UpdatePSDActorsOnRegion
 
 		ActorToUpdate->UpdateRotationAfterPhysicsSimulation(NewRotEuler);
 	}
+
+	// Blend every dynamic PSDActor between its two last physics states
+	for (APSDActorBase* DynamicPSDActor :
+		DynamicPSDActorsOnRegion.GetPSDActors())
+	{
+		if (DynamicPSDActor)
+		{
+			DynamicPSDActor->InterpolatePhysicsState(InterpolationAlpha);
+		}
+	}
+
+	// Keep the scene query results and notify them. This is done after the
+	// PSDActors are updated, so the listeners see them on this step's state
+	if (ReceivedSceneQueryResults.Num() > 0)
+	{
+		LastSceneQueryResults.Reset();
+		for (const FPSDSceneQueryResult& SceneQueryResult :
+			ReceivedSceneQueryResults)
+		{
+			LastSceneQueryResults.Add(SceneQueryResult.RequestId,
+				SceneQueryResult);
+		}
+
+		OnSceneQueriesCompleted.Broadcast(ReceivedSceneQueryResults);
+	}
 }
 
-void APhysicsServiceRegion::UpdatePSDActorBodyType
-	(const APSDActorBase* TargetPSDActor, const FString& NewBodyType)
+void APhysicsServiceRegion::HandleContactEvent
+	(const TArray<FString>& ParsedContactEvent)
 {
-	// Create the message to send server to update the body type. This is 
-	// needed as the body is now primary for this service
-	// The template is:
-	// "UpdateBodyType\n
-	// BodyId; newBodyType\n
-	// MessageEnd\n"
-	const FString UpdateBodyTypeMessage =
-		FString::Printf(TEXT("UpdateBodyType\n%d;%s\nMessageEnd\n"),
-		TargetPSDActor->GetPSDActorBodyId(), *NewBodyType);
-
-	// Get the socket connection instance to send the message
-	auto* SocketConnectionToSend =
-		FSocketClientProxy::GetSocketConnectionByServerId
-		(RegionOwnerPhysicsServiceId);
+	// The templates are:
+	// "Contact;B;BodyId1;BodyId2;pointX;pointY;pointZ;normalX;normalY;
+	// normalZ;impulse" and "Contact;E;BodyId1;BodyId2"
+	if (ParsedContactEvent.Num() < 4)
+	{
+		RPES_LOG_ERROR(TEXT("Could not parse contact event with %d "
+			"arguments."), ParsedContactEvent.Num());
+		return;
+	}
 
-	// Check if valid 
-	if (!SocketConnectionToSend)
+	const bool bIsContactBegin = (ParsedContactEvent[1] == "B");
+	if (bIsContactBegin && ParsedContactEvent.Num() < 11)
 	{
-		RPES_LOG_ERROR(TEXT("Could not send message to socket with ID \"%d\" "
-			"as such connection does not exist."),
-			RegionOwnerPhysicsServiceId);
+		RPES_LOG_ERROR(TEXT("Could not parse contact begin event with %d "
+			"arguments."), ParsedContactEvent.Num());
 		return;
 	}
 
-	// Convert message to std string
-	std::string MessageAsStdString(TCHAR_TO_UTF8(*UpdateBodyTypeMessage));
+	// Get both bodies on the contact
+	const int32 BodyId1 = FCString::Atoi(*ParsedContactEvent[2]);
+	const int32 BodyId2 = FCString::Atoi(*ParsedContactEvent[3]);
+
+	// Find the PSDActors of the bodies. Only the dynamic PSDActors on this
+	// region receive the event, as clones are reported by their own region
+	APSDActorBase* DynamicPSDActor1 = DynamicPSDActorsOnRegion.FindRef(BodyId1);
+	APSDActorBase* DynamicPSDActor2 = DynamicPSDActorsOnRegion.FindRef(BodyId2);
+
+	// The other PSDActor may also be a static one or a mover
+	APSDActorBase* PSDActor1 = DynamicPSDActor1 ? DynamicPSDActor1 :
+		StaticPSDActorsOnRegion.FindRef(BodyId1);
+	APSDActorBase* PSDActor2 = DynamicPSDActor2 ? DynamicPSDActor2 :
+		StaticPSDActorsOnRegion.FindRef(BodyId2);
+	if (!PSDActor1)
+	{
+		PSDActor1 = KinematicPSDActorsOnRegion.FindRef(BodyId1);
+	}
+	if (!PSDActor2)
+	{
+		PSDActor2 = KinematicPSDActorsOnRegion.FindRef(BodyId2);
+	}
 
-	// Convert message to char*. This is needed as some UE converting has the
-	// limitation of 128 bytes, returning garbage when it's over it
-	char* MessageAsChar = &MessageAsStdString[0];
+	if (!bIsContactBegin)
+	{
+		if (DynamicPSDActor1)
+		{
+			DynamicPSDActor1->OnPhysicsContactEnd(PSDActor2, BodyId2);
+		}
 
-	// Send message to update the body type on service
-	const FString Response = SocketConnectionToSend->SendMessageAndGetResponse
-		(MessageAsChar);
+		if (DynamicPSDActor2)
+		{
+			DynamicPSDActor2->OnPhysicsContactEnd(PSDActor1, BodyId1);
+		}
 
-	RPES_LOG_INFO(TEXT("Update PSDActor BodyType response: %s"),
-		*Response);
+		return;
+	}
+
+	// Get the contact info. The normal points from the first body to the
+	// second
+	const FVector ContactPoint(FCString::Atof(*ParsedContactEvent[4]),
+		FCString::Atof(*ParsedContactEvent[5]),
+		FCString::Atof(*ParsedContactEvent[6]));
+	const FVector ContactNormal(FCString::Atof(*ParsedContactEvent[7]),
+		FCString::Atof(*ParsedContactEvent[8]),
+		FCString::Atof(*ParsedContactEvent[9]));
+	const float ContactImpulse = FCString::Atof(*ParsedContactEvent[10]);
+
+	if (DynamicPSDActor1)
+	{
+		DynamicPSDActor1->OnPhysicsContactBegin(PSDActor2, BodyId2,
+			ContactPoint, ContactNormal, ContactImpulse);
+	}
+
+	// The second body sees the normal the other way around
+	if (DynamicPSDActor2)
+	{
+		DynamicPSDActor2->OnPhysicsContactBegin(PSDActor1, BodyId1,
+			ContactPoint, -ContactNormal, ContactImpulse);
+	}
 }
 
-void APhysicsServiceRegion::SetPSDActorOwnershipToRegion
-	(APSDActorBase* TargetPSDActor)
+void APhysicsServiceRegion::HandleCharacterState
+	(const TArray<FString>& ParsedCharacterState)
 {
-	RPES_LOG_INFO(TEXT("Setting PSDActor \"%s\" ownership to region "
-		"(id:%d)"), *TargetPSDActor->GetName(), RegionOwnerPhysicsServiceId);
+	if (ParsedCharacterState.Num() < 10)
+	{
+		RPES_LOG_ERROR(TEXT("Could not parse character state with %d "
+			"arguments."), ParsedCharacterState.Num());
+		return;
+	}
 
-	// Get the PSDActor body id
-	const auto PSDActorBodyId = TargetPSDActor->GetPSDActorBodyId();
+	// The character may have been unregistered since the step was sent
+	const int32 PSDCharacterId = FCString::Atoi(*ParsedCharacterState[1]);
+	UPSDCharacterComponent* PSDCharacter = PSDCharacters ?
+		PSDCharacters->FindRef(PSDCharacterId) : nullptr;
+	if (!PSDCharacter)
+	{
+		return;
+	}
 
-	// Update the PSDActor's owner physics service region id
-	TargetPSDActor->SetActorOwnerPhysicsServiceRegionId
-		(RegionOwnerPhysicsServiceId);
+	const FVector NewLocation(FCString::Atof(*ParsedCharacterState[2]),
+		FCString::Atof(*ParsedCharacterState[3]),
+		FCString::Atof(*ParsedCharacterState[4]));
+	const FVector NewVelocity(FCString::Atof(*ParsedCharacterState[5]),
+		FCString::Atof(*ParsedCharacterState[6]),
+		FCString::Atof(*ParsedCharacterState[7]));
+
+	PSDCharacter->ApplyPhysicsServiceCharacterState(NewLocation, NewVelocity,
+		FCString::Atoi(*ParsedCharacterState[8]),
+		FCString::Atoi(*ParsedCharacterState[9]));
+}
+
+void APhysicsServiceRegion::HandleVehicleState
+	(const TArray<FString>& ParsedVehicleState)
+{
+	if (ParsedVehicleState.Num() < 5)
+	{
+		RPES_LOG_ERROR(TEXT("Could not parse vehicle state with %d "
+			"arguments."), ParsedVehicleState.Num());
+		return;
+	}
+
+	// The vehicle may have left this region since the step was sent
+	const int32 VehicleBodyId = FCString::Atoi(*ParsedVehicleState[1]);
+	APSDVehicle* PSDVehicle = Cast<APSDVehicle>
+		(DynamicPSDActorsOnRegion.FindRef(VehicleBodyId));
+	if (!PSDVehicle)
+	{
+		return;
+	}
+
+	// Each wheel is 7 arguments after the first 5
+	const int32 NumberOfWheels = FMath::Min(FCString::Atoi
+		(*ParsedVehicleState[4]), (ParsedVehicleState.Num() - 5) / 7);
+
+	TArray<FTransform> NewWheelTransforms;
+	NewWheelTransforms.Reserve(NumberOfWheels);
+	for (int32 i = 0; i < NumberOfWheels; i++)
+	{
+		const int32 FirstArgument = 5 + 7 * i;
+		const FVector WheelLocation(FCString::Atof
+			(*ParsedVehicleState[FirstArgument]), FCString::Atof
+			(*ParsedVehicleState[FirstArgument + 1]), FCString::Atof
+			(*ParsedVehicleState[FirstArgument + 2]));
+		const FQuat WheelRotation(FCString::Atof
+			(*ParsedVehicleState[FirstArgument + 3]), FCString::Atof
+			(*ParsedVehicleState[FirstArgument + 4]), FCString::Atof
+			(*ParsedVehicleState[FirstArgument + 5]), FCString::Atof
+			(*ParsedVehicleState[FirstArgument + 6]));
+
+		NewWheelTransforms.Emplace(WheelRotation, WheelLocation);
+	}
+
+	PSDVehicle->ApplyPhysicsServiceVehicleState(FCString::Atof
+		(*ParsedVehicleState[2]), FCString::Atoi(*ParsedVehicleState[3]),
+		NewWheelTransforms);
+}
+
+FString APhysicsServiceRegion::GetPSDVehiclesInputString() const
+{
+	FString PSDVehiclesInputString = FString();
+
+	for (APSDActorBase* DynamicPSDActor :
+		DynamicPSDActorsOnRegion.GetPSDActors())
+	{
+		if (const APSDVehicle* PSDVehicle = Cast<APSDVehicle>(DynamicPSDActor))
+		{
+			PSDVehiclesInputString +=
+				PSDVehicle->GetPhysicsServiceVehicleInputString();
+		}
+	}
+
+	return PSDVehiclesInputString;
+}
+
+FString APhysicsServiceRegion::GetPSDKinematicTargetsString() const
+{
+	// Pack each target as the body id, position (3) and rotation (4)
+	constexpr int32 KinematicTargetSize = sizeof(int32) + 7 * sizeof(float);
+
+	TArray<uint8> PackedTargets;
+	PackedTargets.Reserve(KinematicPSDActorsOnRegion.GetPSDActors().Num() *
+		KinematicTargetSize);
+	int32 NumberOfTargets = 0;
+
+	for (APSDActorBase* KinematicPSDActor :
+		KinematicPSDActorsOnRegion.GetPSDActors())
+	{
+		const APSDKinematicActor* PSDKinematicActor =
+			Cast<APSDKinematicActor>(KinematicPSDActor);
+		if (!PSDKinematicActor)
+		{
+			continue;
+		}
+
+		const FTransform KinematicTarget =
+			PSDKinematicActor->GetPhysicsServiceKinematicTarget();
+		const FVector TargetLocation = KinematicTarget.GetLocation();
+		const FQuat TargetRotation = KinematicTarget.GetRotation();
+
+		const int32 KinematicBodyId = PSDKinematicActor->GetPSDActorBodyId();
+		const float TargetTransform[7] = { static_cast<float>
+			(TargetLocation.X), static_cast<float>(TargetLocation.Y),
+			static_cast<float>(TargetLocation.Z), static_cast<float>
+			(TargetRotation.X), static_cast<float>(TargetRotation.Y),
+			static_cast<float>(TargetRotation.Z), static_cast<float>
+			(TargetRotation.W) };
+
+		PackedTargets.Append(reinterpret_cast<const uint8*>
+			(&KinematicBodyId), sizeof(int32));
+		PackedTargets.Append(reinterpret_cast<const uint8*>
+			(TargetTransform), sizeof(TargetTransform));
+		NumberOfTargets++;
+	}
+
+	if (NumberOfTargets == 0)
+	{
+		return FString();
+	}
+
+	// The template is:
+	// "KinematicTargets; Count; TargetsBase64\n"
+	return FString::Printf(TEXT("KinematicTargets;%d;%s\n"), NumberOfTargets,
+		*FBase64::Encode(PackedTargets));
+}
+
+FString APhysicsServiceRegion::ActivatePSDRagdollOnRegion
+	(UPSDRagdollComponent* PSDRagdoll)
+{
+	const FString RagdollTypeName = PSDRagdoll->GetPSDRagdollTypeName();
+
+	if (!RegisteredPSDRagdollTypes.Contains(RagdollTypeName))
+	{
+		// Get the socket connection instance to send the message
+		auto* SocketConnectionToSend =
+			FSocketClientProxy::GetSocketConnectionByServerId
+			(RegionOwnerPhysicsServiceId);
+
+		const FString RagdollTypeString =
+			PSDRagdoll->GetPhysicsServiceRagdollTypeString();
+
+		if (!SocketConnectionToSend || RagdollTypeString.IsEmpty())
+		{
+			RPES_LOG_ERROR(TEXT("Could not register ragdoll type \"%s\" on "
+				"physics service region (id: %d)."), *RagdollTypeName,
+				RegionOwnerPhysicsServiceId);
+			PSDRagdoll->ClearPendingActivation();
+			return FString();
+		}
+
+		// The template is:
+		// "RegisterRagdollType\n
+		// RagdollTypeString
+		// MessageEnd\n"
+		const FString RegisterRagdollTypeMessage = FString::Printf
+			(TEXT("RegisterRagdollType\n%sMessageEnd\n"),
+			*RagdollTypeString);
+
+		// Convert message to std string
+		std::string MessageAsStdString
+			(TCHAR_TO_UTF8(*RegisterRagdollTypeMessage));
+
+		const FString Response = SocketConnectionToSend->
+			SendMessageAndGetResponse(&MessageAsStdString[0]);
+
+		if (!Response.Contains("successful"))
+		{
+			RPES_LOG_ERROR(TEXT("Could not register ragdoll type \"%s\". "
+				"Response: %s"), *RagdollTypeName, *Response);
+			PSDRagdoll->ClearPendingActivation();
+			return FString();
+		}
+
+		RegisteredPSDRagdollTypes.Add(RagdollTypeName);
+	}
+
+	ActivePSDRagdollIds.Add(PSDRagdoll->GetPSDRagdollId());
+
+	return PSDRagdoll->ConsumePhysicsServiceRagdollActivationString();
+}
+
+void APhysicsServiceRegion::HandleRagdollState
+	(const TArray<FString>& ParsedRagdollState)
+{
+	if (ParsedRagdollState.Num() < 9)
+	{
+		RPES_LOG_ERROR(TEXT("Could not parse ragdoll state with %d "
+			"arguments."), ParsedRagdollState.Num());
+		return;
+	}
+
+	// The ragdoll may have been activated again on another region
+	const int32 PSDRagdollId = FCString::Atoi(*ParsedRagdollState[1]);
+	UPSDRagdollComponent* PSDRagdoll = PSDRagdolls &&
+		ActivePSDRagdollIds.Contains(PSDRagdollId) ?
+		PSDRagdolls->FindRef(PSDRagdollId) : nullptr;
+	if (!PSDRagdoll)
+	{
+		return;
+	}
+
+	auto ParseTransform = [&ParsedRagdollState](const int32 FirstArgument)
+	{
+		const FVector Location(FCString::Atof
+			(*ParsedRagdollState[FirstArgument]), FCString::Atof
+			(*ParsedRagdollState[FirstArgument + 1]), FCString::Atof
+			(*ParsedRagdollState[FirstArgument + 2]));
+		const FQuat Rotation(FCString::Atof
+			(*ParsedRagdollState[FirstArgument + 3]), FCString::Atof
+			(*ParsedRagdollState[FirstArgument + 4]), FCString::Atof
+			(*ParsedRagdollState[FirstArgument + 5]), FCString::Atof
+			(*ParsedRagdollState[FirstArgument + 6]));
+
+		return FTransform(Rotation.GetNormalized(), Location);
+	};
+
+	TArray<FTransform> NewPartRelativeTransforms;
+	for (int32 FirstArgument = 9; FirstArgument + 6 <
+		ParsedRagdollState.Num(); FirstArgument += 7)
+	{
+		NewPartRelativeTransforms.Add(ParseTransform(FirstArgument));
+	}
+
+	PSDRagdoll->ApplyPhysicsServiceRagdollState(ParseTransform(2),
+		NewPartRelativeTransforms);
+}
+
+void APhysicsServiceRegion::HandleRagdollReleased
+	(const TArray<FString>& ParsedRagdollReleased)
+{
+	if (ParsedRagdollReleased.Num() < 2)
+	{
+		return;
+	}
+
+	const int32 PSDRagdollId = FCString::Atoi(*ParsedRagdollReleased[1]);
+	if (ActivePSDRagdollIds.Remove(PSDRagdollId) == 0 || !PSDRagdolls)
+	{
+		return;
+	}
+
+	if (UPSDRagdollComponent* PSDRagdoll = PSDRagdolls->FindRef(PSDRagdollId))
+	{
+		PSDRagdoll->ReleasePSDRagdoll();
+	}
+}
+
+void APhysicsServiceRegion::ReleasePSDRagdollsOnRegion()
+{
+	for (const int32 PSDRagdollId : ActivePSDRagdollIds)
+	{
+		UPSDRagdollComponent* PSDRagdoll = PSDRagdolls ?
+			PSDRagdolls->FindRef(PSDRagdollId) : nullptr;
+		if (PSDRagdoll)
+		{
+			PSDRagdoll->ReleasePSDRagdoll();
+		}
+	}
+
+	ActivePSDRagdollIds.Empty();
+}
+
+void APhysicsServiceRegion::QueuePSDConstraintCreation
+	(const int32 ConstraintId, const FPSDConstraintSettings& ConstraintSettings,
+	const int32 BodyId1, const int32 BodyId2)
+{
+	static const TCHAR* ConstraintTypeNames[] = { TEXT("fixed"),
+		TEXT("point"), TEXT("hinge"), TEXT("slider"), TEXT("distance"),
+		TEXT("sixdof") };
+
+	// The distance constraint takes its second anchor on the axis
+	const bool bIsDistance = ConstraintSettings.ConstraintType ==
+		EPSDConstraintType::Distance;
+	const FVector& Axis = bIsDistance ? ConstraintSettings.SecondAnchor :
+		ConstraintSettings.Axis;
+
+	QueuedPSDConstraintChanges += FString::Printf(TEXT("Constraint;%d;%s;%d;"
+		"%d;%f;%f;%f;%f;%f;%f;%f;%f;%f;%f;%f;%f"), ConstraintId,
+		ConstraintTypeNames[static_cast<uint8>
+		(ConstraintSettings.ConstraintType)], BodyId1, BodyId2,
+		ConstraintSettings.BreakImpulse, ConstraintSettings.Anchor.X,
+		ConstraintSettings.Anchor.Y, ConstraintSettings.Anchor.Z, Axis.X,
+		Axis.Y, Axis.Z, ConstraintSettings.Normal.X,
+		ConstraintSettings.Normal.Y, ConstraintSettings.Normal.Z,
+		ConstraintSettings.LimitMin, ConstraintSettings.LimitMax);
+
+	// The six-DOF limits follow, the translations first
+	if (ConstraintSettings.ConstraintType == EPSDConstraintType::SixDOF)
+	{
+		const FVector* SixDOFLimits[][2] = {
+			{ &ConstraintSettings.TranslationLimitsMin,
+			&ConstraintSettings.TranslationLimitsMax },
+			{ &ConstraintSettings.RotationLimitsMin,
+			&ConstraintSettings.RotationLimitsMax } };
+
+		for (const auto& AxesLimits : SixDOFLimits)
+		{
+			for (int32 AxisIndex = 0; AxisIndex < 3; AxisIndex++)
+			{
+				QueuedPSDConstraintChanges += FString::Printf(TEXT(";%f;%f"),
+					(*AxesLimits[0])[AxisIndex], (*AxesLimits[1])[AxisIndex]);
+			}
+		}
+	}
+
+	QueuedPSDConstraintChanges += "\n";
+	PSDConstraintIds.Add(ConstraintId);
+}
+
+bool APhysicsServiceRegion::QueuePSDConstraintRemoval
+	(const int32 ConstraintId)
+{
+	if (PSDConstraintIds.Remove(ConstraintId) == 0)
+	{
+		return false;
+	}
+
+	QueuedPSDConstraintChanges += FString::Printf
+		(TEXT("RemoveConstraint;%d\n"), ConstraintId);
+
+	return true;
+}
+
+FString APhysicsServiceRegion::ConsumeQueuedPSDConstraintChanges()
+{
+	FString PSDConstraintChanges = MoveTemp(QueuedPSDConstraintChanges);
+	QueuedPSDConstraintChanges = FString();
+
+	return PSDConstraintChanges;
+}
+
+void APhysicsServiceRegion::QueuePSDRadialImpulse(const FVector& Origin,
+	const float Radius, const float Impulse, const bool bLinearFalloff)
+{
+	// The template is:
+	// "RadialImpulse; posX; posY; posZ; Radius; Impulse; Falloff\n"
+	QueuedPSDForceFieldChanges += FString::Printf(TEXT("RadialImpulse;%f;%f;"
+		"%f;%f;%f;%s\n"), Origin.X, Origin.Y, Origin.Z, Radius, Impulse,
+		bLinearFalloff ? TEXT("linear") : TEXT("constant"));
+}
+
+void APhysicsServiceRegion::QueuePSDWindVolume(const int32 ForceFieldId,
+	const FBox& WindVolume, const FVector& WindVelocity, const float Drag,
+	const float Duration)
+{
+	// The template is:
+	// "ForceField; FieldId; wind; min (3); max (3); windVel (3); Drag;
+	// Duration\n"
+	QueuedPSDForceFieldChanges += FString::Printf(TEXT("ForceField;%d;wind;"
+		"%f;%f;%f;%f;%f;%f;%f;%f;%f;%f;%f\n"), ForceFieldId, WindVolume.Min.X,
+		WindVolume.Min.Y, WindVolume.Min.Z, WindVolume.Max.X,
+		WindVolume.Max.Y, WindVolume.Max.Z, WindVelocity.X, WindVelocity.Y,
+		WindVelocity.Z, Drag, Duration);
+	PSDForceFieldIds.Add(ForceFieldId);
+}
+
+void APhysicsServiceRegion::QueuePSDVortex(const int32 ForceFieldId,
+	const FVector& VortexBase, const float Radius, const float Height,
+	const float TangentialAcceleration, const float InwardAcceleration,
+	const float UpwardAcceleration, const float Duration)
+{
+	// The template is:
+	// "ForceField; FieldId; vortex; pos (3); Radius; Height;
+	// TangentialAccel; InwardAccel; UpwardAccel; Duration\n"
+	QueuedPSDForceFieldChanges += FString::Printf(TEXT("ForceField;%d;"
+		"vortex;%f;%f;%f;%f;%f;%f;%f;%f;%f\n"), ForceFieldId, VortexBase.X,
+		VortexBase.Y, VortexBase.Z, Radius, Height, TangentialAcceleration,
+		InwardAcceleration, UpwardAcceleration, Duration);
+	PSDForceFieldIds.Add(ForceFieldId);
+}
+
+bool APhysicsServiceRegion::QueuePSDForceFieldRemoval
+	(const int32 ForceFieldId)
+{
+	if (PSDForceFieldIds.Remove(ForceFieldId) == 0)
+	{
+		return false;
+	}
+
+	QueuedPSDForceFieldChanges += FString::Printf
+		(TEXT("RemoveForceField;%d\n"), ForceFieldId);
+
+	return true;
+}
+
+FString APhysicsServiceRegion::ConsumeQueuedPSDForceFieldChanges()
+{
+	FString PSDForceFieldChanges = MoveTemp(QueuedPSDForceFieldChanges);
+	QueuedPSDForceFieldChanges = FString();
+
+	return PSDForceFieldChanges;
+}
+
+void APhysicsServiceRegion::HandleConstraintRemoved
+	(const TArray<FString>& ParsedConstraintRemoved)
+{
+	if (ParsedConstraintRemoved.Num() < 3)
+	{
+		return;
+	}
+
+	// A constraint removed by the client too is no longer known
+	const int32 ConstraintId = FCString::Atoi(*ParsedConstraintRemoved[1]);
+	if (PSDConstraintIds.Remove(ConstraintId) == 0)
+	{
+		return;
+	}
+
+	RPES_LOG_INFO(TEXT("PSD constraint %d removed on region %d (%s)."),
+		ConstraintId, RegionOwnerPhysicsServiceId,
+		*ParsedConstraintRemoved[2]);
+
+	OnPSDConstraintRemoved.Broadcast(ConstraintId,
+		ParsedConstraintRemoved[2].TrimStartAndEnd());
+}
+
+void APhysicsServiceRegion::HandleSensorEvents
+	(const TArray<FString>& ParsedSensorEvents)
+{
+	if (ParsedSensorEvents.Num() < 4)
+	{
+		return;
+	}
+
+	APSDSensorActor* PSDSensor = Cast<APSDSensorActor>
+		(StaticPSDActorsOnRegion.FindRef(FCString::Atoi
+		(*ParsedSensorEvents[1])));
+	if (!PSDSensor)
+	{
+		return;
+	}
+
+	const int32 NumberOfEnteredBodies = FCString::Atoi(*ParsedSensorEvents[2]);
+	const int32 NumberOfExitedBodies = FCString::Atoi(*ParsedSensorEvents[3]);
+	if (ParsedSensorEvents.Num() < 4 + NumberOfEnteredBodies +
+		NumberOfExitedBodies)
+	{
+		RPES_LOG_WARNING(TEXT("Sensor events line of sensor \"%s\" is "
+			"incomplete on region %d."), *PSDSensor->GetName(),
+			RegionOwnerPhysicsServiceId);
+		return;
+	}
+
+	for (int32 i = 0; i < NumberOfEnteredBodies + NumberOfExitedBodies; i++)
+	{
+		const int32 OtherBodyId = FCString::Atoi(*ParsedSensorEvents[4 + i]);
+
+		APSDActorBase* OtherPSDActor =
+			DynamicPSDActorsOnRegion.FindRef(OtherBodyId);
+		if (i < NumberOfEnteredBodies)
+		{
+			PSDSensor->OnPhysicsSensorEntered(OtherPSDActor, OtherBodyId);
+		}
+		else
+		{
+			PSDSensor->OnPhysicsSensorExited(OtherPSDActor, OtherBodyId);
+		}
+	}
+}
+
+bool APhysicsServiceRegion::IsLocationInsideRegion(const FVector& Location)
+	const
+{
+	// The box may be rotated, so the location is tested on its local space
+	const FVector LocalLocation = PhysicsServiceRegionBoxComponent->
+		GetComponentTransform().InverseTransformPosition(Location);
+	const FVector BoxExtent =
+		PhysicsServiceRegionBoxComponent->GetUnscaledBoxExtent();
+
+	return FMath::Abs(LocalLocation.X) <= BoxExtent.X &&
+		FMath::Abs(LocalLocation.Y) <= BoxExtent.Y &&
+		FMath::Abs(LocalLocation.Z) <= BoxExtent.Z;
+}
+
+FBox APhysicsServiceRegion::GetRegionBounds() const
+{
+	return PhysicsServiceRegionBoxComponent->Bounds.GetBox();
+}
+
+bool APhysicsServiceRegion::ParseSceneQueryResult
+	(const TArray<FString>& ParsedSceneQueryResult,
+	FPSDSceneQueryResult& OutSceneQueryResult) const
+{
+	// The templates are:
+	// "QueryHit;RequestId;BodyId;Fraction;hitX;hitY;hitZ;normalX;normalY;
+	// normalZ", "QueryHit;RequestId;None" and
+	// "QueryOverlap;RequestId;BodyId_0;BodyId_1;..."
+	if (ParsedSceneQueryResult.Num() < 2)
+	{
+		RPES_LOG_ERROR(TEXT("Could not parse scene query result with %d "
+			"arguments."), ParsedSceneQueryResult.Num());
+		return false;
+	}
+
+	OutSceneQueryResult.RequestId = FCString::Atoi(*ParsedSceneQueryResult[1]);
+
+	if (ParsedSceneQueryResult[0] == "QueryOverlap")
+	{
+		for (int32 i = 2; i < ParsedSceneQueryResult.Num(); i++)
+		{
+			OutSceneQueryResult.OverlappingBodyIds.Add
+				(FCString::Atoi(*ParsedSceneQueryResult[i]));
+		}
+
+		OutSceneQueryResult.bHasHit =
+			OutSceneQueryResult.OverlappingBodyIds.Num() > 0;
+		return true;
+	}
+
+	if (ParsedSceneQueryResult[0] != "QueryHit")
+	{
+		RPES_LOG_ERROR(TEXT("Unknown scene query result type \"%s\"."),
+			*ParsedSceneQueryResult[0]);
+		return false;
+	}
+
+	// No hit
+	if (ParsedSceneQueryResult.Num() < 10)
+	{
+		return true;
+	}
+
+	OutSceneQueryResult.bHasHit = true;
+	OutSceneQueryResult.HitBodyId = FCString::Atoi(*ParsedSceneQueryResult[2]);
+	OutSceneQueryResult.HitFraction =
+		FCString::Atof(*ParsedSceneQueryResult[3]);
+	OutSceneQueryResult.HitLocation = FVector
+		(FCString::Atof(*ParsedSceneQueryResult[4]),
+		FCString::Atof(*ParsedSceneQueryResult[5]),
+		FCString::Atof(*ParsedSceneQueryResult[6]));
+	OutSceneQueryResult.HitNormal = FVector
+		(FCString::Atof(*ParsedSceneQueryResult[7]),
+		FCString::Atof(*ParsedSceneQueryResult[8]),
+		FCString::Atof(*ParsedSceneQueryResult[9]));
+
+	// The hit body may be any PSDActor, including the ones on other regions
+	if (BodyIndexAllocator)
+	{
+		OutSceneQueryResult.HitPSDActor =
+			BodyIndexAllocator->GetPSDActor(OutSceneQueryResult.HitBodyId);
+	}
+
+	return true;
+}
+
+int32 APhysicsServiceRegion::QueueRaycastOnPhysicsService
+	(const FVector TraceStart, const FVector TraceEnd)
+{
+	const FVector TraceDirection = TraceEnd - TraceStart;
+
+	return QueueSceneQuery(FString::Printf(TEXT("Ray;%f;%f;%f;%f;%f;%f"),
+		TraceStart.X, TraceStart.Y, TraceStart.Z, TraceDirection.X,
+		TraceDirection.Y, TraceDirection.Z));
+}
+
+int32 APhysicsServiceRegion::QueueSphereSweepOnPhysicsService
+	(const float SphereRadius, const FVector SweepStart,
+	const FVector SweepEnd)
+{
+	const FVector SweepDirection = SweepEnd - SweepStart;
+
+	return QueueSceneQuery(FString::Printf
+		(TEXT("SphereSweep;%f;%f;%f;%f;%f;%f;%f"), SphereRadius, SweepStart.X,
+		SweepStart.Y, SweepStart.Z, SweepDirection.X, SweepDirection.Y,
+		SweepDirection.Z));
+}
+
+int32 APhysicsServiceRegion::QueueBoxSweepOnPhysicsService
+	(const FVector BoxHalfExtents, const FRotator BoxRotation,
+	const FVector SweepStart, const FVector SweepEnd)
+{
+	const FVector SweepDirection = SweepEnd - SweepStart;
+	const FQuat BoxQuat = BoxRotation.Quaternion();
+
+	return QueueSceneQuery(FString::Printf
+		(TEXT("BoxSweep;%f;%f;%f;%f;%f;%f;%f;%f;%f;%f;%f;%f;%f"),
+		BoxHalfExtents.X, BoxHalfExtents.Y, BoxHalfExtents.Z, BoxQuat.X,
+		BoxQuat.Y, BoxQuat.Z, BoxQuat.W, SweepStart.X, SweepStart.Y,
+		SweepStart.Z, SweepDirection.X, SweepDirection.Y, SweepDirection.Z));
+}
+
+int32 APhysicsServiceRegion::QueueSphereOverlapOnPhysicsService
+	(const float SphereRadius, const FVector SphereCenter)
+{
+	return QueueSceneQuery(FString::Printf
+		(TEXT("SphereOverlap;%f;%f;%f;%f"), SphereRadius, SphereCenter.X,
+		SphereCenter.Y, SphereCenter.Z));
+}
+
+int32 APhysicsServiceRegion::QueueBoxOverlapOnPhysicsService
+	(const FVector BoxHalfExtents, const FRotator BoxRotation,
+	const FVector BoxCenter)
+{
+	const FQuat BoxQuat = BoxRotation.Quaternion();
+
+	return QueueSceneQuery(FString::Printf
+		(TEXT("BoxOverlap;%f;%f;%f;%f;%f;%f;%f;%f;%f;%f"), BoxHalfExtents.X,
+		BoxHalfExtents.Y, BoxHalfExtents.Z, BoxQuat.X, BoxQuat.Y, BoxQuat.Z,
+		BoxQuat.W, BoxCenter.X, BoxCenter.Y, BoxCenter.Z));
+}
+
+int32 APhysicsServiceRegion::QueueSceneQuery
+	(const FString& QueryTypeAndParams)
+{
+	const int32 RequestId = NextSceneQueryRequestId++;
+
+	QueuedSceneQueries += FString::Printf(TEXT("Query;%d;%s\n"), RequestId,
+		*QueryTypeAndParams);
+
+	return RequestId;
+}
+
+FString APhysicsServiceRegion::ConsumeQueuedSceneQueries()
+{
+	FString SceneQueries = MoveTemp(QueuedSceneQueries);
+	QueuedSceneQueries = FString();
+
+	return SceneQueries;
+}
+
+bool APhysicsServiceRegion::GetSceneQueryResult(const int32 RequestId,
+	FPSDSceneQueryResult& OutSceneQueryResult) const
+{
+	const FPSDSceneQueryResult* SceneQueryResult =
+		LastSceneQueryResults.Find(RequestId);
+	if (!SceneQueryResult)
+	{
+		return false;
+	}
+
+	OutSceneQueryResult = *SceneQueryResult;
+	return true;
+}
+
+void APhysicsServiceRegion::SendContactSubscriptionsToPhysicsService
+	(const TArray<const APSDActorBase*>& PSDActorsToSubscribe)
+{
+	// Create the message to send to the physics service
+	// The template is:
+	// "ContactSubscriptions;WorldId\n
+	// BodyId; SubscriptionFlags; MinContactImpulse\n
+	// ...
+	// MessageEnd\n"
+	FString ContactSubscriptionsMessage = FString::Printf
+		(TEXT("ContactSubscriptions;%d\n"), RegionOwnerPhysicsServiceId);
+
+	// Append each PSDActor subscription
+	int32 SubscribedPSDActorsCount = 0;
+	for (const APSDActorBase* PSDActorToSubscribe : PSDActorsToSubscribe)
+	{
+		if (!PSDActorToSubscribe)
+		{
+			continue;
+		}
+
+		const FString PSDActorSubscription =
+			PSDActorToSubscribe->GetContactSubscriptionString();
+		if (PSDActorSubscription.IsEmpty())
+		{
+			continue;
+		}
+
+		ContactSubscriptionsMessage += PSDActorSubscription;
+		SubscribedPSDActorsCount++;
+	}
+
+	// If no PSDActor is subscribed, there is nothing to send
+	if (SubscribedPSDActorsCount == 0)
+	{
+		return;
+	}
+
+	ContactSubscriptionsMessage += "MessageEnd\n";
+
+	// Get the socket connection instance to send the message
+	auto* SocketConnectionToSend =
+		FSocketClientProxy::GetSocketConnectionByServerId
+		(RegionOwnerPhysicsServiceId);
+
+	// Check if valid 
+	if (!SocketConnectionToSend)
+	{
+		RPES_LOG_ERROR(TEXT("Could not send message to socket with ID \"%d\" "
+			"as such connection does not exist."),
+			RegionOwnerPhysicsServiceId);
+		return;
+	}
+
+	// Convert message to std string
+	std::string MessageAsStdString(TCHAR_TO_UTF8(*ContactSubscriptionsMessage));
+
+	// Convert message to char*. This is needed as some UE converting has the
+	// limitation of 128 bytes, returning garbage when it's over it
+	char* MessageAsChar = &MessageAsStdString[0];
+
+	// Send message to subscribe the PSDActors on the service
+	const FString Response = SocketConnectionToSend->SendMessageAndGetResponse
+		(MessageAsChar);
+
+	RPES_LOG_INFO(TEXT("Contact subscriptions response: %s"), *Response);
+}
+
+void APhysicsServiceRegion::SendMissingCookedMeshesToPhysicsService
+	(USocketClientInstance* SocketConnectionToSend,
+	const TArray<APSDActorBase*>& PSDActorsToCook)
+{
+	if (!SocketConnectionToSend)
+	{
+		return;
+	}
+
+	// Get the static mesh PSDActors by their collision hash. Many PSDActors
+	// may share the same collision
+	TMap<FString, APSDStaticMeshActor*> StaticMeshActorsByHash;
+	for (APSDActorBase* PSDActorToCook : PSDActorsToCook)
+	{
+		APSDStaticMeshActor* StaticMeshActor =
+			Cast<APSDStaticMeshActor>(PSDActorToCook);
+		if (!StaticMeshActor)
+		{
+			continue;
+		}
+
+		const FString CollisionMeshHash =
+			StaticMeshActor->GetCollisionMeshHash();
+		if (!CollisionMeshHash.IsEmpty())
+		{
+			StaticMeshActorsByHash.Add(CollisionMeshHash, StaticMeshActor);
+		}
+	}
+
+	// If there is no static mesh, there is nothing to send
+	if (StaticMeshActorsByHash.Num() == 0)
+	{
+		return;
+	}
+
+	auto SendMessageToPhysicsService = [SocketConnectionToSend]
+		(const FString& MessageToSend)
+	{
+		// Convert message to std string
+		std::string MessageAsStdString(TCHAR_TO_UTF8(*MessageToSend));
+
+		// Convert message to char*. This is needed as some UE converting has
+		// the limitation of 128 bytes, returning garbage when it's over it
+		char* MessageAsChar = &MessageAsStdString[0];
+
+		return SocketConnectionToSend->SendMessageAndGetResponse
+			(MessageAsChar);
+	};
+
+	// Ask which collisions the physics service is missing
+	// The template is:
+	// "HasCookedMeshes\n
+	// MeshHash\n
+	// ...
+	// MessageEnd\n"
+	FString HasCookedMeshesMessage = "HasCookedMeshes\n";
+	for (const auto& StaticMeshActorByHash : StaticMeshActorsByHash)
+	{
+		HasCookedMeshesMessage += StaticMeshActorByHash.Key + "\n";
+	}
+	HasCookedMeshesMessage += "MessageEnd\n";
+
+	const FString HasCookedMeshesResponse = SendMessageToPhysicsService
+		(HasCookedMeshesMessage);
+
+	TArray<FString> HasCookedMeshesResponseLines;
+	HasCookedMeshesResponse.ParseIntoArrayLines(HasCookedMeshesResponseLines);
+
+	// Send each missing collision to be cooked
+	// The template is:
+	// "CookMesh\n
+	// CollisionCookingString
+	// MessageEnd\n"
+	for (const FString& ResponseLine : HasCookedMeshesResponseLines)
+	{
+		if (!ResponseLine.StartsWith("MissingMesh;"))
+		{
+			continue;
+		}
+
+		const FString MissingMeshHash = ResponseLine.Mid(12).TrimStartAndEnd();
+		APSDStaticMeshActor** StaticMeshActorToCook =
+			StaticMeshActorsByHash.Find(MissingMeshHash);
+		if (!StaticMeshActorToCook)
+		{
+			continue;
+		}
+
+		RPES_LOG_INFO(TEXT("Cooking mesh \"%s\" (%s) on physics service."),
+			*MissingMeshHash, *(*StaticMeshActorToCook)->GetName());
+
+		const FString CookMeshResponse = SendMessageToPhysicsService
+			(FString::Printf(TEXT("CookMesh\n%sMessageEnd\n"),
+			*(*StaticMeshActorToCook)->GetCollisionCookingString()));
+
+		if (!CookMeshResponse.Contains("successful"))
+		{
+			RPES_LOG_ERROR(TEXT("Could not cook mesh \"%s\". Response: %s"),
+				*MissingMeshHash, *CookMeshResponse);
+		}
+	}
+}
+
+void APhysicsServiceRegion::UpdatePSDActorBodyType
+	(const APSDActorBase* TargetPSDActor, const FString& NewBodyType)
+{
+	// Create the message to send server to update the body type. This is 
+	// needed as the body is now primary for this service
+	// The template is:
+	// "UpdateBodyType;WorldId\n
+	// BodyId; newBodyType\n
+	// MessageEnd\n"
+	const FString UpdateBodyTypeMessage =
+		FString::Printf(TEXT("UpdateBodyType;%d\n%d;%s\nMessageEnd\n"),
+		RegionOwnerPhysicsServiceId, TargetPSDActor->GetPSDActorBodyId(),
+		*NewBodyType);
+
+	// Get the socket connection instance to send the message
+	auto* SocketConnectionToSend =
+		FSocketClientProxy::GetSocketConnectionByServerId
+		(RegionOwnerPhysicsServiceId);
+
+	// Check if valid 
+	if (!SocketConnectionToSend)
+	{
+		RPES_LOG_ERROR(TEXT("Could not send message to socket with ID \"%d\" "
+			"as such connection does not exist."),
+			RegionOwnerPhysicsServiceId);
+		return;
+	}
+
+	// Convert message to std string
+	std::string MessageAsStdString(TCHAR_TO_UTF8(*UpdateBodyTypeMessage));
+
+	// Convert message to char*. This is needed as some UE converting has the
+	// limitation of 128 bytes, returning garbage when it's over it
+	char* MessageAsChar = &MessageAsStdString[0];
+
+	// Send message to update the body type on service
+	const FString Response = SocketConnectionToSend->SendMessageAndGetResponse
+		(MessageAsChar);
+
+	RPES_LOG_INFO(TEXT("Update PSDActor BodyType response: %s"),
+		*Response);
+}
+
+void APhysicsServiceRegion::SetPSDActorOwnershipToRegion
+	(APSDActorBase* TargetPSDActor)
+{
+	RPES_LOG_INFO(TEXT("Setting PSDActor \"%s\" ownership to region "
+		"(id:%d)"), *TargetPSDActor->GetName(), RegionOwnerPhysicsServiceId);
+
+	// Get the PSDActor body id
+	const auto PSDActorBodyId = TargetPSDActor->GetPSDActorBodyId();
+
+	// Update the PSDActor's owner physics service region id
+	TargetPSDActor->SetActorOwnerPhysicsServiceRegionId
+		(RegionOwnerPhysicsServiceId);
 
 	// Add the PSDActor to this region's DynamicPSDActors so it will start to
 	// update it
@@ -683,6 +2058,94 @@ void APhysicsServiceRegion::SetPSDActorOwnershipToRegion
 		TargetPSDActor);
 }
 
+bool APhysicsServiceRegion::RewindRaycastOnPhysicsService
+	(const int32 StepIndex, const FVector TraceStart, const FVector TraceEnd,
+	int32& OutHitBodyId, FVector& OutHitLocation)
+{
+	OutHitBodyId = -1;
+	OutHitLocation = FVector::ZeroVector;
+
+	// Create the message to send to the physics service. The ray direction
+	// also holds its length
+	// The template is:
+	// "RewindRaycast;WorldId\n
+	// StepIndex; originX; originY; originZ; directionX; directionY; 
+	// directionZ\n
+	// MessageEnd\n"
+	const FVector TraceDirection = TraceEnd - TraceStart;
+	const FString RewindRaycastMessage = FString::Printf(TEXT("RewindRaycast;"
+		"%d\n%d;%f;%f;%f;%f;%f;%f\nMessageEnd\n"), 
+		RegionOwnerPhysicsServiceId, StepIndex, TraceStart.X, TraceStart.Y,
+		TraceStart.Z, TraceDirection.X, TraceDirection.Y, TraceDirection.Z);
+
+	// Get the socket connection instance to send the message
+	auto* SocketConnectionToSend =
+		FSocketClientProxy::GetSocketConnectionByServerId
+		(RegionOwnerPhysicsServiceId);
+
+	// Check if valid 
+	if (!SocketConnectionToSend)
+	{
+		RPES_LOG_ERROR(TEXT("Could not send message to socket with ID \"%d\" "
+			"as such connection does not exist."),
+			RegionOwnerPhysicsServiceId);
+		return false;
+	}
+
+	// Convert message to std string
+	std::string MessageAsStdString(TCHAR_TO_UTF8(*RewindRaycastMessage));
+
+	// Convert message to char*. This is needed as some UE converting has the
+	// limitation of 128 bytes, returning garbage when it's over it
+	char* MessageAsChar = &MessageAsStdString[0];
+
+	// Send message to cast the ray on the service
+	const FString Response = SocketConnectionToSend->SendMessageAndGetResponse
+		(MessageAsChar);
+
+	// Find the ray result. The template is:
+	// "RewindHit;RayIndex;BodyId;Fraction;hitX;hitY;hitZ" if hit. The body id
+	// is "None" if nothing was hit and "Expired" if the step is no longer on
+	// the physics service history
+	TArray<FString> ResponseLines;
+	Response.ParseIntoArrayLines(ResponseLines);
+
+	for (const FString& ResponseLine : ResponseLines)
+	{
+		if (!ResponseLine.StartsWith("RewindHit"))
+		{
+			continue;
+		}
+
+		TArray<FString> ParsedRewindHit;
+		ResponseLine.ParseIntoArray(ParsedRewindHit, TEXT(";"));
+
+		if (ParsedRewindHit.Num() >= 3 && ParsedRewindHit[2] == "Expired")
+		{
+			RPES_LOG_WARNING(TEXT("Could not rewind raycast on step %d of "
+				"region (id: %d) as it is no longer on the history."), 
+				StepIndex, RegionOwnerPhysicsServiceId);
+			return false;
+		}
+
+		if (ParsedRewindHit.Num() < 7)
+		{
+			return false;
+		}
+
+		OutHitBodyId = FCString::Atoi(*ParsedRewindHit[2]);
+		OutHitLocation = FVector(FCString::Atof(*ParsedRewindHit[4]),
+			FCString::Atof(*ParsedRewindHit[5]),
+			FCString::Atof(*ParsedRewindHit[6]));
+
+		return true;
+	}
+
+	RPES_LOG_ERROR(TEXT("Could not parse rewind raycast response: %s"),
+		*Response);
+	return false;
+}
+
 void APhysicsServiceRegion::SpawnNewPSDSphere(const FVector NewSphereLocation,
 	const FVector NewSphereLinearVelocity, const FVector 
 	NewSphereAngularVelocity)
@@ -700,8 +2163,15 @@ void APhysicsServiceRegion::SpawnNewPSDSphere(const FVector NewSphereLocation,
 	const auto SpawnedSphere = PSDActorSpawner->SpawnPSDActor
 		(NewSphereLocation, RegionOwnerPhysicsServiceId);
 
-	// Get the new sphere ID as the PSDActor BodyID
-	const int32 NewSphereBodyId = SpawnedSphere->GetPSDActorBodyId();
+	// Give the new sphere a body index from the coordinator's allocator
+	check(BodyIndexAllocator);
+	const int32 NewSphereBodyId =
+		BodyIndexAllocator->AllocateBodyIndex(SpawnedSphere);
+	if (NewSphereBodyId == INDEX_NONE)
+	{
+		SpawnedSphere->Destroy();
+		return;
+	}
 
 	// Add the sphere to the dynamic PSDActors map so it's Transform can be 
 	// updated on next step
@@ -709,11 +2179,12 @@ void APhysicsServiceRegion::SpawnNewPSDSphere(const FVector NewSphereLocation,
 
 	// Create the message to send server
 	// The template is:
-	// "AddBody\n
+	// "AddBody;WorldId\n
 	// actorType; Id; bodyType; posX; posY; posZ\n
 	// MessageEnd\n"
 	const FString SpawnNewPSDSphereMessage =
-		FString::Printf(TEXT("AddBody\nspere;%d;primary;%f;%f;%f;%f;%f;%f;%f;%f;%f\nMessageEnd\n"), 
+		FString::Printf(TEXT("AddBody;%d\nsphere;%d;primary;%f;%f;%f;%f;%f;%f;"
+		"%f;%f;%f\nMessageEnd\n"), RegionOwnerPhysicsServiceId,
 		NewSphereBodyId, NewSphereLocation.X, NewSphereLocation.Y,
 		NewSphereLocation.Z, NewSphereLinearVelocity.X, 
 		NewSphereLinearVelocity.Y, NewSphereLinearVelocity.Z,
@@ -746,16 +2217,20 @@ void APhysicsServiceRegion::SpawnNewPSDSphere(const FVector NewSphereLocation,
 		(MessageAsChar);
 
 	RPES_LOG_INFO(TEXT("Add new sphere action response: %s"), *Response);
+
+	// Send the new sphere contact events subscription
+	SendContactSubscriptionsToPhysicsService({ SpawnedSphere });
 }
 
 void APhysicsServiceRegion::SavePhysicsServiceMeasuresements()
 {
 	// Create the message to send to the physics service
 	// The template is:
-	// "GetSimulationMeasures\n
+	// "GetSimulationMeasures;WorldId\n
 	// MessageEnd\n"
 	const FString GetSimulationMeasuresMessage =
-		FString::Printf(TEXT("GetSimulationMeasures\n%d\nMessageEnd\n"));
+		FString::Printf(TEXT("GetSimulationMeasures;%d\nMessageEnd\n"),
+		RegionOwnerPhysicsServiceId);
 
 	// Get the socket connection instance to send the message
 	auto* SocketConnectionToSend =
@@ -783,14 +2258,37 @@ void APhysicsServiceRegion::SavePhysicsServiceMeasuresements()
 	const FString Response = SocketConnectionToSend->SendMessageAndGetResponse
 		(MessageAsChar);
 	
+	// Split the step phases from the step times, so each is saved on its
+	// own file
+	TArray<FString> ResponseLines;
+	Response.ParseIntoArrayLines(ResponseLines);
+
+	FString StepTimeMeasurements = FString();
+	FString StepPhasesMeasurements = FString("Phases;StepMicroseconds;"
+		"BroadPhase;NarrowPhase;ConstraintSetup;SolveVelocity;SolvePosition;"
+		"Integration;Other;JobCount;ThreadUtilisation\n");
+	for (const FString& ResponseLine : ResponseLines)
+	{
+		if (ResponseLine.StartsWith(TEXT("Phases;")))
+		{
+			StepPhasesMeasurements += ResponseLine + "\n";
+		}
+		else if (ResponseLine != TEXT("MessageEnd"))
+		{
+			StepTimeMeasurements += ResponseLine + "\n";
+		}
+	}
+
 	// Save the physics service measurements to file
-	SavePhysicsServiceMeasuresToFile(Response);
+	SavePhysicsServiceMeasuresToFile(StepTimeMeasurements);
+	SavePhysicsServiceMeasuresToFile(StepPhasesMeasurements,
+		TEXT("StepPhysicsPhasesMeasure"), TEXT("StepPhysicsPhases"));
 }
 
 void APhysicsServiceRegion::SavePhysicsServiceMeasuresToFile
-	(const FString& Measurements) const
+	(const FString& Measurements, const FString& TargetFolder,
+	const FString& FilePrefix) const
 {
-	FString TargetFolder = TEXT("StepPhysicsMeasureWithoutCommsOverhead");
 	FString FullFolderPath =
 		FString(FPlatformProcess::UserDir() + TargetFolder);
 
@@ -814,8 +2312,8 @@ void APhysicsServiceRegion::SavePhysicsServiceMeasuresToFile
 	FString MapName = CurrentLevel->GetOuter()->GetName();
 
 	int32 FileCount = 1;
-	FString FileName = FString::Printf(TEXT("/StepPhysicsTime_%s_Region%d_%d.txt"),
-		*MapName, RegionOwnerPhysicsServiceId, FileCount);
+	FString FileName = FString::Printf(TEXT("/%s_%s_Region%d_%d.txt"),
+		*FilePrefix, *MapName, RegionOwnerPhysicsServiceId, FileCount);
 
 	FString FileFullPath = FPlatformProcess::UserDir() + TargetFolder +
 		FileName;
@@ -823,8 +2321,8 @@ void APhysicsServiceRegion::SavePhysicsServiceMeasuresToFile
 	while (IFileManager::Get().FileExists(*FileFullPath))
 	{
 		FileCount++;
-		FileName = FString::Printf(TEXT("/StepPhysicsTime_%s_Region%d_%d.txt"),
-			*MapName, RegionOwnerPhysicsServiceId, FileCount);
+		FileName = FString::Printf(TEXT("/%s_%s_Region%d_%d.txt"),
+			*FilePrefix, *MapName, RegionOwnerPhysicsServiceId, FileCount);
 
 		FileFullPath = FPlatformProcess::UserDir() + TargetFolder + FileName;
 	}
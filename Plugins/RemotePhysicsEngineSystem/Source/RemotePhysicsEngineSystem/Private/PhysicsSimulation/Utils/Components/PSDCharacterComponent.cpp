@@ -0,0 +1,145 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#include "PhysicsSimulation/Utils/Components/PSDCharacterComponent.h"
+#include "PhysicsSimulation/Utils/Actors/PSDActorsCoordinator.h"
+#include "RemotePhysicsEngineSystem/RemotePhysicsEngineSystemLogging.h"
+
+#include "Components/CapsuleComponent.h"
+#include "GameFramework/Character.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Kismet/GameplayStatics.h"
+
+UPSDCharacterComponent::UPSDCharacterComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+}
+
+void UPSDCharacterComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	OwnerCharacter = Cast<ACharacter>(GetOwner());
+	if (!OwnerCharacter)
+	{
+		RPES_LOG_ERROR(TEXT("PSD character component on \"%s\" is not owned "
+			"by a character."), *GetNameSafe(GetOwner()));
+		return;
+	}
+
+	// Only the server talks to the physics services
+	if (!OwnerCharacter->HasAuthority())
+	{
+		return;
+	}
+
+	PSDActorsCoordinator = Cast<APSDActorsCoordinator>
+		(UGameplayStatics::GetActorOfClass(GetWorld(),
+		APSDActorsCoordinator::StaticClass()));
+	if (!PSDActorsCoordinator)
+	{
+		RPES_LOG_WARNING(TEXT("No PSDActors coordinator to register character "
+			"\"%s\" on."), *OwnerCharacter->GetName());
+		return;
+	}
+
+	PSDActorsCoordinator->RegisterPSDCharacter(this);
+}
+
+void UPSDCharacterComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (PSDActorsCoordinator)
+	{
+		PSDActorsCoordinator->UnregisterPSDCharacter(this);
+		PSDActorsCoordinator = nullptr;
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+FString UPSDCharacterComponent::GetPhysicsServiceCharacterInputString() const
+{
+	if (!OwnerCharacter)
+	{
+		return FString();
+	}
+
+	const UCapsuleComponent* CharacterCapsule =
+		OwnerCharacter->GetCapsuleComponent();
+	const UCharacterMovementComponent* CharacterMovement =
+		OwnerCharacter->GetCharacterMovement();
+
+	// The movement component keeps the input acceleration (also the remote
+	// players', received on their moves), even if it does not move the
+	// character. The walk velocity is scaled by how much input there is
+	const FVector InputAcceleration =
+		CharacterMovement->GetCurrentAcceleration();
+	const float InputScale = FMath::Min(InputAcceleration.Size() /
+		FMath::Max(CharacterMovement->GetMaxAcceleration(), 1.f), 1.f);
+	const FVector DesiredVelocity = InputAcceleration.GetSafeNormal2D() *
+		InputScale * CharacterMovement->MaxWalkSpeed;
+
+	const float JumpSpeed = OwnerCharacter->bPressedJump ?
+		CharacterMovement->JumpZVelocity : 0.f;
+
+	const FVector CharacterLocation = OwnerCharacter->GetActorLocation();
+
+	return FString::Printf(TEXT("Character;%d;%f;%f;%f;%f;%f;%f;%f;%f;%f\n"),
+		PSDCharacterId, CharacterCapsule->GetScaledCapsuleRadius(),
+		CharacterCapsule->GetScaledCapsuleHalfHeight(), CharacterLocation.X,
+		CharacterLocation.Y, CharacterLocation.Z, DesiredVelocity.X,
+		DesiredVelocity.Y, DesiredVelocity.Z, JumpSpeed);
+}
+
+void UPSDCharacterComponent::ApplyPhysicsServiceCharacterState
+	(const FVector& NewLocation, const FVector& NewVelocity,
+	const int32 NewGroundState, const int32 NewGroundBodyId)
+{
+	if (!OwnerCharacter || !bIsOnPhysicsServiceRegion)
+	{
+		return;
+	}
+
+	// The service has already resolved the collisions, so no sweep is needed
+	OwnerCharacter->SetActorLocation(NewLocation);
+
+	// Keep the velocity on the movement component, so the animations and the
+	// replicated movement see the character moving
+	OwnerCharacter->GetCharacterMovement()->Velocity = NewVelocity;
+
+	GroundState = NewGroundState;
+	GroundBodyId = NewGroundBodyId;
+}
+
+void UPSDCharacterComponent::SetIsOnPhysicsServiceRegion
+	(const bool bNewIsOnPhysicsServiceRegion)
+{
+	if (!OwnerCharacter ||
+		bIsOnPhysicsServiceRegion == bNewIsOnPhysicsServiceRegion)
+	{
+		return;
+	}
+
+	bIsOnPhysicsServiceRegion = bNewIsOnPhysicsServiceRegion;
+
+	UCharacterMovementComponent* CharacterMovement =
+		OwnerCharacter->GetCharacterMovement();
+
+	if (bIsOnPhysicsServiceRegion)
+	{
+		// The movement component still takes the input, but no longer moves
+		// the character
+		CharacterMovement->DisableMovement();
+	}
+	else
+	{
+		CharacterMovement->SetDefaultMovementMode();
+		GroundState = 3;
+		GroundBodyId = INDEX_NONE;
+	}
+}
+
+FVector UPSDCharacterComponent::GetPSDCharacterLocation() const
+{
+	return OwnerCharacter ? OwnerCharacter->GetActorLocation() :
+		FVector::ZeroVector;
+}
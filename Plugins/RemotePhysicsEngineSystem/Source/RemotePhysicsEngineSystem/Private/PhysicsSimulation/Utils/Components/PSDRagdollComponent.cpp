@@ -0,0 +1,438 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#include "PhysicsSimulation/Utils/Components/PSDRagdollComponent.h"
+#include "PhysicsSimulation/Utils/Actors/PSDActorsCoordinator.h"
+#include "RemotePhysicsEngineSystem/RemotePhysicsEngineSystemLogging.h"
+
+#include "AnimationRuntime.h"
+#include "Components/PoseableMeshComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "Engine/SkeletalMesh.h"
+#include "Kismet/GameplayStatics.h"
+#include "Net/UnrealNetwork.h"
+#include "PhysicsEngine/PhysicsAsset.h"
+#include "PhysicsEngine/PhysicsConstraintTemplate.h"
+#include "PhysicsEngine/SkeletalBodySetup.h"
+
+namespace
+{
+	/** Formats a vector as "X;Y;Z" */
+	FString ToPhysicsServiceString(const FVector& Vector)
+	{
+		return FString::Printf(TEXT("%f;%f;%f"), Vector.X, Vector.Y,
+			Vector.Z);
+	}
+
+	/** Formats a rotation as "X;Y;Z;W" */
+	FString ToPhysicsServiceString(const FQuat& Rotation)
+	{
+		return FString::Printf(TEXT("%f;%f;%f;%f"), Rotation.X, Rotation.Y,
+			Rotation.Z, Rotation.W);
+	}
+
+	/** Gets a joint angular limit as the physics service takes it (degrees) */
+	float GetJointLimit(const EAngularConstraintMotion Motion,
+		const float Limit)
+	{
+		switch (Motion)
+		{
+			case EAngularConstraintMotion::ACM_Free:
+				return 180.f;
+			case EAngularConstraintMotion::ACM_Locked:
+				return 0.f;
+			default:
+				return Limit;
+		}
+	}
+}
+
+UPSDRagdollComponent::UPSDRagdollComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+
+	SetIsReplicatedByDefault(true);
+}
+
+void UPSDRagdollComponent::GetLifetimeReplicatedProps
+	(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(UPSDRagdollComponent, bIsPSDRagdollActive);
+	DOREPLIFETIME(UPSDRagdollComponent, PartWorldTransforms);
+}
+
+void UPSDRagdollComponent::BeginPlay()
+{
+	Super::BeginPlay();
+
+	OwnerSkeletalMesh = GetOwner()->FindComponentByClass
+		<USkeletalMeshComponent>();
+	if (!OwnerSkeletalMesh || !OwnerSkeletalMesh->GetPhysicsAsset())
+	{
+		RPES_LOG_ERROR(TEXT("PSD ragdoll component on \"%s\" has no skeletal "
+			"mesh with a physics asset."), *GetNameSafe(GetOwner()));
+		return;
+	}
+
+	// The clients also need the parts to pose the replicated state
+	GatherPartBoneNames();
+
+	// Only the server talks to the physics services
+	if (!GetOwner()->HasAuthority() || PartBoneNames.Num() == 0)
+	{
+		return;
+	}
+
+	PSDActorsCoordinator = Cast<APSDActorsCoordinator>
+		(UGameplayStatics::GetActorOfClass(GetWorld(),
+		APSDActorsCoordinator::StaticClass()));
+	if (!PSDActorsCoordinator)
+	{
+		RPES_LOG_WARNING(TEXT("No PSDActors coordinator to register ragdoll "
+			"\"%s\" on."), *GetOwner()->GetName());
+		return;
+	}
+
+	PSDActorsCoordinator->RegisterPSDRagdoll(this);
+}
+
+void UPSDRagdollComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (PSDActorsCoordinator)
+	{
+		PSDActorsCoordinator->UnregisterPSDRagdoll(this);
+		PSDActorsCoordinator = nullptr;
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void UPSDRagdollComponent::ActivatePSDRagdoll(FVector LinearVelocity,
+	FVector AngularVelocity)
+{
+	if (!PSDActorsCoordinator || PSDRagdollId == INDEX_NONE)
+	{
+		return;
+	}
+
+	bHasPendingActivation = true;
+	PendingLinearVelocity = LinearVelocity;
+	PendingAngularVelocity = AngularVelocity;
+}
+
+FString UPSDRagdollComponent::GetPSDRagdollTypeName() const
+{
+	return OwnerSkeletalMesh ?
+		GetNameSafe(OwnerSkeletalMesh->GetPhysicsAsset()) : FString();
+}
+
+FString UPSDRagdollComponent::GetPhysicsServiceRagdollTypeString() const
+{
+	const UPhysicsAsset* PhysicsAsset = OwnerSkeletalMesh ?
+		OwnerSkeletalMesh->GetPhysicsAsset() : nullptr;
+	if (!PhysicsAsset || PartBoneNames.Num() == 0)
+	{
+		return FString();
+	}
+
+	const FReferenceSkeleton& RefSkeleton =
+		OwnerSkeletalMesh->SkeletalMesh->RefSkeleton;
+
+	// The parts are sent on the root part's space
+	const FTransform RootPartBindTransform =
+		FAnimationRuntime::GetComponentSpaceTransformRefPose(RefSkeleton,
+		RefSkeleton.FindBoneIndex(PartBoneNames[0]));
+
+	FString RagdollTypeString = FString::Printf(TEXT("RagdollType;%s;%d\n"),
+		*GetPSDRagdollTypeName(), PoolSize);
+
+	for (int32 PartIndex = 0; PartIndex < PartBoneNames.Num(); PartIndex++)
+	{
+		const FName& PartBoneName = PartBoneNames[PartIndex];
+		const int32 BoneIndex = RefSkeleton.FindBoneIndex(PartBoneName);
+		const USkeletalBodySetup* PartBodySetup =
+			PhysicsAsset->SkeletalBodySetups[PhysicsAsset->FindBodyIndex
+			(PartBoneName)];
+
+		// The parent is the closest ancestor bone with a part. The parts with
+		// none, other than the root, hang from the root
+		int32 ParentPartIndex = PartIndex == 0 ? INDEX_NONE : 0;
+		for (int32 AncestorIndex = RefSkeleton.GetParentIndex(BoneIndex);
+			PartIndex > 0 && AncestorIndex != INDEX_NONE;
+			AncestorIndex = RefSkeleton.GetParentIndex(AncestorIndex))
+		{
+			const int32 AncestorPartIndex = PartBoneNames.IndexOfByKey
+				(RefSkeleton.GetBoneName(AncestorIndex));
+			if (AncestorPartIndex != INDEX_NONE)
+			{
+				ParentPartIndex = AncestorPartIndex;
+				break;
+			}
+		}
+
+		// Only the first shape is simulated, the capsules first
+		const FKAggregateGeom& PartGeometry = PartBodySetup->AggGeom;
+		const TCHAR* ShapeType = nullptr;
+		FVector ShapeSize = FVector::ZeroVector;
+		FTransform ShapeTransform = FTransform::Identity;
+
+		if (PartGeometry.SphylElems.Num() > 0)
+		{
+			const FKSphylElem& Capsule = PartGeometry.SphylElems[0];
+			ShapeType = TEXT("capsule");
+			ShapeSize = FVector(Capsule.Radius, 0.f, Capsule.Length * 0.5f);
+			ShapeTransform = FTransform(Capsule.Rotation, Capsule.Center);
+		}
+		else if (PartGeometry.BoxElems.Num() > 0)
+		{
+			const FKBoxElem& Box = PartGeometry.BoxElems[0];
+			ShapeType = TEXT("box");
+			ShapeSize = FVector(Box.X, Box.Y, Box.Z) * 0.5f;
+			ShapeTransform = FTransform(Box.Rotation, Box.Center);
+		}
+		else if (PartGeometry.SphereElems.Num() > 0)
+		{
+			const FKSphereElem& Sphere = PartGeometry.SphereElems[0];
+			ShapeType = TEXT("sphere");
+			ShapeSize = FVector(Sphere.Radius, 0.f, 0.f);
+			ShapeTransform = FTransform(Sphere.Center);
+		}
+		else
+		{
+			RPES_LOG_ERROR(TEXT("Ragdoll part \"%s\" of \"%s\" has no capsule, "
+				"box or sphere."), *PartBoneName.ToString(),
+				*GetPSDRagdollTypeName());
+			return FString();
+		}
+
+		const FTransform PartTransform =
+			FAnimationRuntime::GetComponentSpaceTransformRefPose(RefSkeleton,
+			BoneIndex).GetRelativeTransform(RootPartBindTransform);
+
+		// The joint frame is relative to the child part, which is the
+		// constraint's first bone
+		const FConstraintInstance* PartJoint = nullptr;
+		for (const UPhysicsConstraintTemplate* ConstraintTemplate :
+			PhysicsAsset->ConstraintSetup)
+		{
+			if (ConstraintTemplate && ConstraintTemplate->DefaultInstance.
+				ConstraintBone1 == PartBoneName)
+			{
+				PartJoint = &ConstraintTemplate->DefaultInstance;
+				break;
+			}
+		}
+
+		const FTransform JointTransform = PartJoint ?
+			PartJoint->GetRefFrame(EConstraintFrame::Frame1) * PartTransform :
+			PartTransform;
+
+		const FVector JointLimits = PartJoint ? FVector(GetJointLimit
+			(PartJoint->GetAngularSwing1Motion(),
+			PartJoint->GetAngularSwing1Limit()), GetJointLimit
+			(PartJoint->GetAngularSwing2Motion(),
+			PartJoint->GetAngularSwing2Limit()), GetJointLimit
+			(PartJoint->GetAngularTwistMotion(),
+			PartJoint->GetAngularTwistLimit())) : FVector::ZeroVector;
+
+		// The template is the one on FPhysicsRagdollTypeCache
+		RagdollTypeString += FString::Printf(TEXT("Part;%s;%d;%s;%s;%s;%s;%f;"
+			"%s;%s;%s;%s;%s;%s\n"), *PartBoneName.ToString(),
+			ParentPartIndex, ShapeType, *ToPhysicsServiceString(ShapeSize),
+			*ToPhysicsServiceString(ShapeTransform.GetLocation()),
+			*ToPhysicsServiceString(ShapeTransform.GetRotation()),
+			PartBodySetup->CalculateMass(),
+			*ToPhysicsServiceString(PartTransform.GetLocation()),
+			*ToPhysicsServiceString(PartTransform.GetRotation()),
+			*ToPhysicsServiceString(JointTransform.GetLocation()),
+			*ToPhysicsServiceString(JointTransform.GetUnitAxis(EAxis::X)),
+			*ToPhysicsServiceString(JointTransform.GetUnitAxis(EAxis::Y)),
+			*ToPhysicsServiceString(JointLimits));
+	}
+
+	return RagdollTypeString;
+}
+
+FString UPSDRagdollComponent::ConsumePhysicsServiceRagdollActivationString()
+{
+	bHasPendingActivation = false;
+
+	const FTransform RootPartTransform = GetPartWorldTransform(0);
+
+	FString RagdollActivationString = FString::Printf(TEXT("Ragdoll;%d;%s;%s;"
+		"%s;%s;%s;%f"), PSDRagdollId, *GetPSDRagdollTypeName(),
+		*ToPhysicsServiceString(RootPartTransform.GetLocation()),
+		*ToPhysicsServiceString(RootPartTransform.GetRotation()),
+		*ToPhysicsServiceString(PendingLinearVelocity),
+		*ToPhysicsServiceString(PendingAngularVelocity), RagdollLifetime);
+
+	// Start from the current pose instead of the bind pose
+	for (int32 PartIndex = 0; PartIndex < PartBoneNames.Num(); PartIndex++)
+	{
+		const FTransform PartRelativeTransform = GetPartWorldTransform
+			(PartIndex).GetRelativeTransform(RootPartTransform);
+
+		RagdollActivationString += FString::Printf(TEXT(";%s;%s"),
+			*ToPhysicsServiceString(PartRelativeTransform.GetLocation()),
+			*ToPhysicsServiceString(PartRelativeTransform.GetRotation()));
+	}
+
+	SetIsPSDRagdollActive(true);
+
+	return RagdollActivationString + "\n";
+}
+
+void UPSDRagdollComponent::ApplyPhysicsServiceRagdollState
+	(const FTransform& NewRootPartTransform,
+	const TArray<FTransform>& NewPartRelativeTransforms)
+{
+	// Only the server receives the physics state
+	if (!bIsPSDRagdollActive || !GetOwner()->HasAuthority())
+	{
+		return;
+	}
+
+	PartWorldTransforms.Reset(NewPartRelativeTransforms.Num() + 1);
+	PartWorldTransforms.Add(NewRootPartTransform);
+
+	for (const FTransform& PartRelativeTransform : NewPartRelativeTransforms)
+	{
+		PartWorldTransforms.Add(PartRelativeTransform * NewRootPartTransform);
+	}
+
+	UpdateRagdollPose();
+}
+
+void UPSDRagdollComponent::ReleasePSDRagdoll()
+{
+	bHasPendingActivation = false;
+	SetIsPSDRagdollActive(false);
+}
+
+FVector UPSDRagdollComponent::GetPSDRagdollLocation() const
+{
+	return PartBoneNames.Num() > 0 ? GetPartWorldTransform(0).GetLocation() :
+		GetOwner()->GetActorLocation();
+}
+
+void UPSDRagdollComponent::GatherPartBoneNames()
+{
+	PartBoneNames.Reset();
+
+	const FReferenceSkeleton& RefSkeleton =
+		OwnerSkeletalMesh->SkeletalMesh->RefSkeleton;
+
+	for (const USkeletalBodySetup* BodySetup :
+		OwnerSkeletalMesh->GetPhysicsAsset()->SkeletalBodySetups)
+	{
+		if (BodySetup && RefSkeleton.FindBoneIndex(BodySetup->BoneName) !=
+			INDEX_NONE)
+		{
+			PartBoneNames.Add(BodySetup->BoneName);
+		}
+	}
+
+	PartBoneNames.Sort([&RefSkeleton](const FName& BoneA, const FName& BoneB)
+	{
+		return RefSkeleton.FindBoneIndex(BoneA) <
+			RefSkeleton.FindBoneIndex(BoneB);
+	});
+}
+
+FTransform UPSDRagdollComponent::GetPartWorldTransform
+	(const int32 PartIndex) const
+{
+	const FTransform BoneTransform = OwnerSkeletalMesh->GetBoneTransform
+		(OwnerSkeletalMesh->GetBoneIndex(PartBoneNames[PartIndex]));
+
+	return FTransform(BoneTransform.GetRotation(),
+		BoneTransform.GetLocation());
+}
+
+void UPSDRagdollComponent::SetIsPSDRagdollActive
+	(const bool bNewIsPSDRagdollActive)
+{
+	if (!OwnerSkeletalMesh)
+	{
+		return;
+	}
+
+	const bool bWasPSDRagdollActive = bIsPSDRagdollActive;
+	bIsPSDRagdollActive = bNewIsPSDRagdollActive;
+
+	if (bIsPSDRagdollActive)
+	{
+		if (!RagdollPoseableMesh)
+		{
+			RagdollPoseableMesh = NewObject<UPoseableMeshComponent>(GetOwner(),
+				TEXT("PSDRagdollPoseableMesh"));
+			RagdollPoseableMesh->SetSkeletalMesh
+				(OwnerSkeletalMesh->SkeletalMesh);
+			RagdollPoseableMesh->SetCollisionEnabled
+				(ECollisionEnabled::NoCollision);
+			RagdollPoseableMesh->RegisterComponent();
+
+			for (int32 i = 0; i < OwnerSkeletalMesh->GetNumMaterials(); i++)
+			{
+				RagdollPoseableMesh->SetMaterial(i,
+					OwnerSkeletalMesh->GetMaterial(i));
+			}
+		}
+
+		// The bones with no part follow their parents from the current pose
+		RagdollPoseableMesh->SetWorldTransform
+			(OwnerSkeletalMesh->GetComponentTransform());
+		RagdollPoseableMesh->CopyPoseFromSkeletalComponent(OwnerSkeletalMesh);
+		RagdollPoseableMesh->SetVisibility(true);
+		OwnerSkeletalMesh->SetVisibility(false);
+
+		UpdateRagdollPose();
+		return;
+	}
+
+	PartWorldTransforms.Empty();
+
+	if (RagdollPoseableMesh)
+	{
+		RagdollPoseableMesh->SetVisibility(false);
+	}
+	OwnerSkeletalMesh->SetVisibility(true);
+
+	if (bWasPSDRagdollActive)
+	{
+		OnPSDRagdollReleased.Broadcast(this);
+	}
+}
+
+void UPSDRagdollComponent::UpdateRagdollPose()
+{
+	if (!RagdollPoseableMesh || !bIsPSDRagdollActive)
+	{
+		return;
+	}
+
+	// The parents come first, so each part is placed after the part it
+	// hangs from
+	const int32 NumberOfParts = FMath::Min(PartWorldTransforms.Num(),
+		PartBoneNames.Num());
+	for (int32 PartIndex = 0; PartIndex < NumberOfParts; PartIndex++)
+	{
+		RagdollPoseableMesh->SetBoneTransformByName(PartBoneNames[PartIndex],
+			PartWorldTransforms[PartIndex], EBoneSpaces::WorldSpace);
+	}
+}
+
+void UPSDRagdollComponent::OnRep_IsPSDRagdollActive()
+{
+	// The flag is already set by the replication
+	const bool bNewIsPSDRagdollActive = bIsPSDRagdollActive;
+	bIsPSDRagdollActive = !bNewIsPSDRagdollActive;
+
+	SetIsPSDRagdollActive(bNewIsPSDRagdollActive);
+}
+
+void UPSDRagdollComponent::OnRep_PartWorldTransforms()
+{
+	UpdateRagdollPose();
+}
@@ -0,0 +1,124 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+
+#include "PhysicsSimulation/Utils/PSDBodyIndexAllocator.h"
+#include "PhysicsSimulation/PSDActors/Base/PSDActorBase.h"
+#include "RemotePhysicsEngineSystem/RemotePhysicsEngineSystemLogging.h"
+
+int32 FPSDBodyIndexAllocator::AllocateBodyIndex(APSDActorBase* PSDActor)
+{
+	if (!PSDActor)
+	{
+		return INDEX_NONE;
+	}
+
+	// Keep the body index if the PSDActor already has one
+	const int32 CurrentBodyIndex = PSDActor->GetPSDActorBodyId();
+	if (GetPSDActor(CurrentBodyIndex) == PSDActor)
+	{
+		return CurrentBodyIndex;
+	}
+
+	// Recycle a released index first, so indices are kept dense
+	int32 NewBodyIndex = INDEX_NONE;
+	if (FreeBodyIndices.Num() > 0)
+	{
+		NewBodyIndex = FreeBodyIndices.Pop(false);
+		PSDActorsByBodyIndex[NewBodyIndex] = PSDActor;
+	}
+	else if (PSDActorsByBodyIndex.Num() < MaxBodyIndices)
+	{
+		NewBodyIndex = PSDActorsByBodyIndex.Add(PSDActor);
+	}
+	else
+	{
+		RPES_LOG_ERROR(TEXT("Could not allocate a body index to \"%s\": the "
+			"max of %d bodies was reached."), *PSDActor->GetName(),
+			MaxBodyIndices);
+	}
+
+	PSDActor->SetPSDActorBodyId(NewBodyIndex);
+
+	return NewBodyIndex;
+}
+
+void FPSDBodyIndexAllocator::ReleaseBodyIndex(APSDActorBase* PSDActor)
+{
+	if (!PSDActor)
+	{
+		return;
+	}
+
+	const int32 BodyIndex = PSDActor->GetPSDActorBodyId();
+	if (GetPSDActor(BodyIndex) != PSDActor)
+	{
+		return;
+	}
+
+	PSDActorsByBodyIndex[BodyIndex] = nullptr;
+	FreeBodyIndices.Add(BodyIndex);
+
+	PSDActor->SetPSDActorBodyId(INDEX_NONE);
+}
+
+void FPSDBodyIndexAllocator::Reset()
+{
+	PSDActorsByBodyIndex.Empty();
+	FreeBodyIndices.Empty();
+}
+
+void FPSDActorBodyIndexMap::Add(const int32 BodyIndex, APSDActorBase* PSDActor)
+{
+	if (BodyIndex < 0)
+	{
+		return;
+	}
+
+	// Replace the PSDActor if the body index is already mapped
+	const int32 CurrentDenseSlot = GetDenseSlot(BodyIndex);
+	if (CurrentDenseSlot != INDEX_NONE)
+	{
+		DensePSDActors[CurrentDenseSlot] = PSDActor;
+		return;
+	}
+
+	if (DenseSlotByBodyIndex.Num() <= BodyIndex)
+	{
+		const int32 NumberOfNewSlots = BodyIndex + 1 -
+			DenseSlotByBodyIndex.Num();
+		for (int32 i = 0; i < NumberOfNewSlots; i++)
+		{
+			DenseSlotByBodyIndex.Add(INDEX_NONE);
+		}
+	}
+
+	DenseSlotByBodyIndex[BodyIndex] = DensePSDActors.Add(PSDActor);
+	DenseBodyIndices.Add(BodyIndex);
+}
+
+bool FPSDActorBodyIndexMap::Remove(const int32 BodyIndex)
+{
+	const int32 RemovedDenseSlot = GetDenseSlot(BodyIndex);
+	if (RemovedDenseSlot == INDEX_NONE)
+	{
+		return false;
+	}
+
+	// Move the last PSDActor to the removed slot
+	const int32 LastBodyIndex = DenseBodyIndices.Last();
+	DenseSlotByBodyIndex[LastBodyIndex] = RemovedDenseSlot;
+
+	DensePSDActors.RemoveAtSwap(RemovedDenseSlot, 1, false);
+	DenseBodyIndices.RemoveAtSwap(RemovedDenseSlot, 1, false);
+
+	DenseSlotByBodyIndex[BodyIndex] = INDEX_NONE;
+
+	return true;
+}
+
+void FPSDActorBodyIndexMap::Empty()
+{
+	DenseSlotByBodyIndex.Empty();
+	DensePSDActors.Empty();
+	DenseBodyIndices.Empty();
+}
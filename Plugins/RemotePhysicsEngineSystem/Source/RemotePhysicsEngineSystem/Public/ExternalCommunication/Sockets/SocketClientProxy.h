@@ -49,6 +49,33 @@ public:
 	*/
 	static bool CloseSocketConnectionsToServerById(const int32 TargetServerId);
 
+	/**
+	* Opens a connection with a physics service server without adding it to
+	* the connections map. Used to connect ahead of time to a service that
+	* will later replace an existing connection.
+	*
+	* @param ServerIpAddr The server's ip address to connect to
+	* @param ServerPort The server's port to connect to
+	*
+	* @return The opened socket connection. Nullptr if the connection failed
+	*/
+	static USocketClientInstance* CreateSocketConnection
+		(const FString& ServerIpAddr, const FString& ServerPort);
+
+	/**
+	* Replaces the socket connection of a server id with a new one, closing
+	* the previous connection. Anything sending to this server id afterwards
+	* will reach the new connection's server.
+	*
+	* @param TargetServerId The server's id to replace the connection of
+	* @param NewSocketConnection The already opened connection to use. Should
+	* be created by "CreateSocketConnection()"
+	*
+	* @return True if the connection was replaced. False otherwise
+	*/
+	static bool ReplaceSocketConnectionToServer(const int32 TargetServerId,
+		USocketClientInstance* NewSocketConnection);
+
 
 	/**
 	* Get the socket connection by the server's id.
@@ -19,6 +19,21 @@ enum class EPSDActorPhysicsRegionStatus : uint8
 	NoRegion
 };
 
+/** How a PSDActor's body moves on the physics service */
+UENUM(BlueprintType)
+enum class EPSDActorMotionType : uint8
+{
+	/** Level geometry that never moves */
+	Static,
+	/**
+	* A mover driven by the game, such as a platform or door. Its transform
+	* is sent on each step and it pushes the dynamic bodies on its way
+	*/
+	Kinematic,
+	/** Simulated by the physics service, which updates its transform */
+	Dynamic
+};
+
 /** 
 * Called once the PSDActor has entered a physics service region. Will 
 * broadcast this PSDActor reference and the physics service region id he has 
@@ -35,6 +50,24 @@ DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnActorEnteredPhysicsRegion,
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnActorExitedPhysicsRegion,
 	APSDActorBase*, ExitedPSDActor, int32, ExitedPhysicsRegionId);
 
+/**
+* Called once the PSDActor starts touching another body on the physics
+* service. The other PSDActor may be null if it is not a dynamic PSDActor on
+* the same region (e.g. the floor). Thus, its body id is also given.
+*/
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_SixParams(FOnPSDActorContactBegin,
+	APSDActorBase*, PSDActor, APSDActorBase*, OtherPSDActor, int32,
+	OtherBodyId, FVector, ContactPoint, FVector, ContactNormal, float,
+	ContactImpulse);
+
+/**
+* Called once the PSDActor stops touching another body on the physics
+* service. The other PSDActor may be null, the same as on contact begin.
+*/
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnPSDActorContactEnd,
+	APSDActorBase*, PSDActor, APSDActorBase*, OtherPSDActor, int32,
+	OtherBodyId);
+
 /**
 * The base class for all Physics-Service-Drive (PSD) actors. This actor should
 * have its physics simulation driven by the physics service, and therefore, it
@@ -112,6 +145,29 @@ public:
 	*/
 	virtual FString GetPhysicsServiceInitializationString();
 
+	/**
+	* Returns the physics service initialization string of this PSDActor's
+	* clone, added on the other regions it overlaps. It has the same template
+	* as "GetPhysicsServiceInitializationString()", with the "clone" body
+	* type. By default, the clone is a sphere.
+	*
+	* @return The physics service initialization string for this PSDActor's
+	* clone
+	*/
+	virtual FString GetPhysicsServiceCloneInitializationString() const;
+
+	/**
+	* Returns the ghost state string. This is sent on the "Step" message of
+	* every region that has this PSDActor as a clone, so the clone follows
+	* this PSDActor's last physics state. The template is:
+	*
+	* "Ghost; BodyID; PosX; PosY; PosZ; LinearVelocityX; LinearVelocityY;
+	* LinearVelocityZ; AngularVelocityX; AngularVelocityY; AngularVelocityZ\n"
+	*
+	* @return The ghost state string for this PSDActor
+	*/
+	FString GetPhysicsServiceGhostStateString() const;
+
 	/**
 	* Returns the PSDActor body id on the physics service. This should be
 	* used to identify this PSDActor on the physics service.
@@ -122,12 +178,25 @@ public:
 	*/
 	int32 GetPSDActorBodyId() const { return PSDActorBodyId; }
 
+	/** Getter to how this PSDActor's body moves on the physics service */
+	UFUNCTION(BlueprintCallable)
+	EPSDActorMotionType GetPSDActorMotionType() const
+		{ return PSDActorMotionType; }
+
 	/**
 	* Returns if this PSDActor is static (should move/updated or not)
 	*
 	* @return True if this PSDActor is static. False otherwise
 	*/
-	constexpr bool IsPSDActorStatic() const { return bIsPSDActorStatic; }
+	constexpr bool IsPSDActorStatic() const
+		{ return PSDActorMotionType == EPSDActorMotionType::Static; }
+
+	/**
+	* Returns if this PSDActor is a kinematic mover, which is moved by the
+	* game and only sends its transform to the physics service
+	*/
+	constexpr bool IsPSDActorKinematic() const
+		{ return PSDActorMotionType == EPSDActorMotionType::Kinematic; }
 
 	/**
 	* Called once the PSDActor has entered a physics service region. This is
@@ -148,11 +217,39 @@ public:
 	* PSDActor has just exited
 	*/
 	void OnExitedPhysicsRegion(int32 ExitedPhysicsRegionId);
+
+	/**
+	* Returns the contact events subscription string. This should be sent to
+	* the physics service so it knows which contacts to report back, with the
+	* template:
+	*
+	* "BodyId; SubscriptionFlags; MinContactImpulse\n"
+	*
+	* @return The subscription string. Empty if this PSDActor is not
+	* subscribed to any contact event
+	*/
+	FString GetContactSubscriptionString() const;
+
+	/**
+	* Called once the physics service reports this PSDActor started touching
+	* another body. Broadcasts the "OnPSDActorContactBegin" delegate.
+	*/
+	void OnPhysicsContactBegin(APSDActorBase* OtherPSDActor,
+		const int32 OtherBodyId, const FVector& ContactPoint,
+		const FVector& ContactNormal, const float ContactImpulse);
+
+	/**
+	* Called once the physics service reports this PSDActor stopped touching
+	* another body. Broadcasts the "OnPSDActorContactEnd" delegate.
+	*/
+	void OnPhysicsContactEnd(APSDActorBase* OtherPSDActor,
+		const int32 OtherBodyId);
 	
 	/**
-	* Updates this actor's position. This should be called by the 
+	* Updates this actor's physics position. This should be called by the 
 	* PSDActorsCoordinator once the new physics update comes from the physics
-	* service.
+	* service. The current physics position becomes the previous one, so the
+	* actor can blend between both with "InterpolatePhysicsState()".
 	* 
 	* @param NewActorPosition The new actor position on the current physics
 	* world state
@@ -160,9 +257,10 @@ public:
 	void UpdatePositionAfterPhysicsSimulation(const FVector& NewActorPosition);
 
 	/**
-	* Updates this actor's rotation. This should be called by the
+	* Updates this actor's physics rotation. This should be called by the
 	* PSDActorsCoordinator once the new physics update comes from the physics
-	* service.
+	* service. The current physics rotation becomes the previous one, so the
+	* actor can blend between both with "InterpolatePhysicsState()".
 	*
 	* @param NewActorRotationEulerAngles The new actor rotation in euler angles
 	* on the current physics world state.
@@ -170,6 +268,16 @@ public:
 	void UpdateRotationAfterPhysicsSimulation
 		(const FVector& NewActorRotationEulerAngles);
 
+	/**
+	* Sets this actor's Transform by blending between the two last physics
+	* states. As the physics service steps on a fixed rate, the game frame
+	* usually lands between two physics steps.
+	*
+	* @param InterpolationAlpha How far the game time is between the previous
+	* physics state (0) and the current one (1)
+	*/
+	void InterpolatePhysicsState(const float InterpolationAlpha);
+
 	/**
 	* Updates this actor's physics region status. 
 	* 
@@ -250,6 +358,41 @@ public:
 	*/
 	FOnActorExitedPhysicsRegion OnActorExitedPhysicsRegion;
 
+	/** 
+	* Delegate called once this PSDActor starts touching another body. Only
+	* broadcasted if "bSubscribeToContactBegin" is set.
+	*/
+	UPROPERTY(BlueprintAssignable)
+	FOnPSDActorContactBegin OnPSDActorContactBegin;
+
+	/**
+	* Delegate called once this PSDActor stops touching another body. Only
+	* broadcasted if "bSubscribeToContactEnd" is set.
+	*/
+	UPROPERTY(BlueprintAssignable)
+	FOnPSDActorContactEnd OnPSDActorContactEnd;
+
+	/** 
+	* Flag that indicates if the physics service should report when this
+	* PSDActor starts touching another body
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bSubscribeToContactBegin = false;
+
+	/**
+	* Flag that indicates if the physics service should report when this
+	* PSDActor stops touching another body
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bSubscribeToContactEnd = false;
+
+	/** 
+	* The min impulse a contact must have to be reported as a contact begin.
+	* Used to filter out resting and grazing contacts.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MinContactImpulse = 0.f;
+
 protected:
 	/** 
 	* The owning physics service region id. This represents the physics service 
@@ -275,22 +418,44 @@ protected:
 	/**
 	* The PSDActor's body unique ID on the physics service. Useful to
 	* uniquely identify this PSDActor either on the world or on the physics
-	* service
+	* service. This is a dense body index given by the coordinator's body
+	* index allocator, so INDEX_NONE until the simulation starts
 	*/
 	UPROPERTY(BlueprintReadOnly, ReplicatedUsing = OnRep_PSDActorBodyId)
-	int32 PSDActorBodyId = 0;
+	int32 PSDActorBodyId = INDEX_NONE;
 
 protected:
 	/**
-	* Flag that indicates if this PSDActor is static. If false, the PSDActor
-	* will not be considered on each physics service step and will not be
-	* updated on each frame
+	* How this PSDActor's body moves. Only the dynamic PSDActors are updated
+	* by each physics service step, while the static ones are never sent
+	* again after the initialization
 	*/
-	bool bIsPSDActorStatic = false;
+	EPSDActorMotionType PSDActorMotionType = EPSDActorMotionType::Dynamic;
 
 	/** */
 	FVector PSDActorLinearVelocity = FVector();
 
 	/** */
 	FVector PSDActorAngularVelocity = FVector();
+
+private:
+	/** The actor location on the previous physics state */
+	FVector PreviousPhysicsLocation = FVector::ZeroVector;
+
+	/** The actor location on the current physics state */
+	FVector CurrentPhysicsLocation = FVector::ZeroVector;
+
+	/** The actor rotation on the previous physics state */
+	FQuat PreviousPhysicsRotation = FQuat::Identity;
+
+	/** The actor rotation on the current physics state */
+	FQuat CurrentPhysicsRotation = FQuat::Identity;
+
+	/** 
+	* Flags that indicate if the actor has received a physics location and 
+	* rotation yet. If not, the first received state is also used as the
+	* previous one
+	*/
+	bool bHasPhysicsLocation = false;
+	bool bHasPhysicsRotation = false;
 };
@@ -0,0 +1,80 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PhysicsSimulation/PSDActors/PSDStaticMeshActor.h"
+#include "PSDCompoundActor.generated.h"
+
+/**
+* The dynamic PSDActor whose collision is made of many primitives. Every
+* sphere, box and capsule component of the actor is a part of a single
+* compound body on the physics service, placed as it is relative to the
+* actor. The actor's mesh is only visual.
+*
+* The compound is cooked as the static mesh collision is, so the actors of
+* the same class share a single cooked compound. Their body line only has
+* the actor's transform, mass and the compound hash.
+*/
+UCLASS()
+class REMOTEPHYSICSENGINESYSTEM_API APSDCompoundActor :
+	public APSDStaticMeshActor
+{
+	GENERATED_BODY()
+
+public:
+	/** Default constructor */
+	APSDCompoundActor();
+
+public:
+	/**
+	* Returns the physics service initialization string. This will return
+	* a string according to the initialization message template:
+	*
+	* "compound; BodyID; bodyType; InitialPosX; InitialPosY; InitialPosZ;
+	* InitialLinearVelocityX; InitialLinearVelocityY; InitialLinearVelocityZ;
+	* InitialAngularVelocityX; InitialAngularVelocityY;
+	* InitialAngularVelocityZ; RotationX; RotationY; RotationZ; RotationW;
+	* Mass; CompoundHash\n"
+	*
+	* @return The physics service initialization string for this PSDActor.
+	* Empty if the actor has no primitive component
+	*/
+	virtual FString GetPhysicsServiceInitializationString() override;
+
+	/** Overwritten here, so the clone is also a compound */
+	virtual FString GetPhysicsServiceCloneInitializationString() const
+		override;
+
+public:
+	/** The body's mass (kg). The inertia is given by the primitives */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "PSDCompoundActor",
+		meta = (ClampMin = "0.1"))
+	float Mass = 100.f;
+
+protected:
+	/**
+	* Exports a line for each primitive component, on the actor's space. The
+	* template is:
+	*
+	* "Sphere; PosX; PosY; PosZ; Radius\n
+	* Box; Pos (3); Rotation (4); HalfExtentX; HalfExtentY; HalfExtentZ\n
+	* Capsule; Pos (3); Rotation (4); CylinderHalfHeight; Radius\n"
+	*
+	* The actor's scale is baked on the primitives.
+	*/
+	virtual bool ExportCollisionCookingData(FString& OutCollisionCookingData)
+		override;
+
+	/** Getter to the "compound" collision type */
+	virtual FString GetCollisionCookingType() const override
+		{ return TEXT("compound"); }
+
+	/** Getter to the actor's transform, without its scale */
+	virtual FTransform GetCollisionTransform() const override
+		{ return FTransform(GetActorQuat(), GetActorLocation()); }
+
+private:
+	/** Gets the compound's initialization string with the given body type */
+	FString GetCompoundInitializationString(const TCHAR* BodyType) const;
+};
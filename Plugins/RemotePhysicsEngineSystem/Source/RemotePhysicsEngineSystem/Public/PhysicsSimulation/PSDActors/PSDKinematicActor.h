@@ -0,0 +1,36 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PhysicsSimulation/PSDActors/PSDStaticMeshActor.h"
+#include "PSDKinematicActor.generated.h"
+
+/**
+* The PSDActor of a mover driven by the game, such as a moving platform, a
+* door or an elevator. The game moves this actor as any other actor, and its
+* mesh collision follows it on the physics service, pushing the dynamic
+* bodies on its way. The physics service never moves it by itself.
+*
+* The transforms of all the movers of a region are packed on a single line
+* of each step message. A mover is added to every region its mesh overlaps
+* when the simulation starts, and is only driven on them.
+*/
+UCLASS()
+class REMOTEPHYSICSENGINESYSTEM_API APSDKinematicActor :
+	public APSDStaticMeshActor
+{
+	GENERATED_BODY()
+
+public:
+	/** Default constructor */
+	APSDKinematicActor();
+
+public:
+	/**
+	* Getter to the transform the mover's body is moved to on the next step.
+	* The scale is the one the body was added with.
+	*/
+	FTransform GetPhysicsServiceKinematicTarget() const
+		{ return GetCollisionTransform(); }
+};
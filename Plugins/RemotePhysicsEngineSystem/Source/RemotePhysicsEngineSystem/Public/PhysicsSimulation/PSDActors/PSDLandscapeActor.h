@@ -0,0 +1,96 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PhysicsSimulation/PSDActors/PSDStaticMeshActor.h"
+#include "PSDLandscapeActor.generated.h"
+
+/**
+* The PSDActor that represents the terrain of a landscape. The landscape is
+* sampled inside the box of the physics service region this actor is in, and
+* the heights are cooked into a height field on the physics service. A height
+* field takes a fraction of the memory and collision time of the same terrain
+* as a triangle mesh.
+*
+* The height field is cooked and cached as any other static mesh collision,
+* so it is only sent once and loaded from the physics service's disk on the
+* next initializations.
+*
+* @note This actor's mesh must overlap the region, like any other PSDActor.
+* The landscape must have collision, as it is sampled with line traces
+*/
+UCLASS()
+class REMOTEPHYSICSENGINESYSTEM_API APSDLandscapeActor :
+	public APSDStaticMeshActor
+{
+	GENERATED_BODY()
+
+public:
+	/** Default constructor */
+	APSDLandscapeActor();
+
+public:
+	/**
+	* The landscape to sample. If not set, the first landscape inside the
+	* region's box is sampled
+	*/
+	UPROPERTY(EditInstanceOnly, BlueprintReadOnly)
+	class ALandscapeProxy* Landscape = nullptr;
+
+	/**
+	* The distance between the height samples (cm). If 0, the landscape's
+	* quad size is used, so the samples are on the landscape's vertices
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, meta = (ClampMin = "0"))
+	float SampleSpacing = 0.f;
+
+	/**
+	* The height field's block size, in samples. Bigger blocks take less
+	* memory, but the collision culls less triangles
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadOnly,
+		meta = (ClampMin = "2", ClampMax = "8"))
+	int32 HeightFieldBlockSize = 4;
+
+	/**
+	* The max amount of samples on each side of the height field. The
+	* spacing is increased if the region would need more
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadOnly,
+		meta = (ClampMin = "16", ClampMax = "8192"))
+	int32 MaxHeightFieldSampleCount = 4096;
+
+protected:
+	/**
+	* Samples the landscape inside the region's box. The template is:
+	*
+	* "HeightField; SampleCount; SampleSpacing; BlockSize\n
+	* Heights; HeightsBase64\n"
+	*
+	* The sample count is the smallest block size times a power of two that
+	* covers the region. The samples outside the region or the landscape are
+	* holes.
+	*/
+	virtual bool ExportCollisionCookingData(FString& OutCollisionCookingData)
+		override;
+
+	/** Getter to the "heightfield" collision type */
+	virtual FString GetCollisionCookingType() const override
+		{ return TEXT("heightfield"); }
+
+	/** Getter to the transform of the height field's first sample */
+	virtual FTransform GetCollisionTransform() const override
+		{ return FTransform(HeightFieldOrigin); }
+
+private:
+	/** Gets the physics service region this actor is in */
+	class APhysicsServiceRegion* FindPhysicsServiceRegion() const;
+
+	/** Gets the first landscape inside the given bounds */
+	class ALandscapeProxy* FindLandscape(const FBox& RegionBounds) const;
+
+private:
+	/** The location of the height field's first sample, on world space */
+	FVector HeightFieldOrigin = FVector::ZeroVector;
+};
@@ -0,0 +1,81 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PhysicsSimulation/PSDActors/Base/PSDActorBase.h"
+#include "PSDSensorActor.generated.h"
+
+/**
+* Called once a body enters or exits a PSD sensor on the physics service. The
+* other PSDActor may be null if it is not a PSDActor of the sensor's region,
+* so its body id is also given.
+*/
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_ThreeParams(FOnPSDSensorOverlap,
+	APSDSensorActor*, Sensor, APSDActorBase*, OtherPSDActor, int32,
+	OtherBodyId);
+
+/**
+* The PSDActor of a trigger volume, such as a goal zone or a checkpoint. Its
+* box is a sensor on the physics service: it never pushes the bodies, which
+* are reported as they enter and exit it.
+*
+* The overlaps are found on the physics service, so only the bodies that
+* entered or exited the sensor on each step are sent back, no matter how
+* many bodies are inside it. A body is never reported more than once per
+* step.
+*
+* @note Only the dynamic bodies trigger a sensor. A sensor that overlaps
+* more than one region only reports the bodies of its own region
+*/
+UCLASS()
+class REMOTEPHYSICSENGINESYSTEM_API APSDSensorActor : public APSDActorBase
+{
+	GENERATED_BODY()
+
+public:
+	/** Default constructor */
+	APSDSensorActor();
+
+public:
+	/**
+	* Returns the physics service initialization string, on the template:
+	*
+	* "sensor; BodyID; bodyType; PosX; PosY; PosZ; LinearVelocityX;
+	* LinearVelocityY; LinearVelocityZ; AngularVelocityX; AngularVelocityY;
+	* AngularVelocityZ; RotX; RotY; RotZ; RotW; HalfExtentX; HalfExtentY;
+	* HalfExtentZ\n"
+	*
+	* The transform and half extent are the sensor volume's, on world space.
+	*
+	* @return The physics service initialization string for this PSDActor
+	*/
+	virtual FString GetPhysicsServiceInitializationString() override;
+
+	/**
+	* Called once the physics service reports a body entered this sensor.
+	* Broadcasts the "OnPSDSensorBeginOverlap" delegate.
+	*/
+	void OnPhysicsSensorEntered(APSDActorBase* OtherPSDActor,
+		const int32 OtherBodyId);
+
+	/**
+	* Called once the physics service reports a body exited this sensor.
+	* Broadcasts the "OnPSDSensorEndOverlap" delegate.
+	*/
+	void OnPhysicsSensorExited(APSDActorBase* OtherPSDActor,
+		const int32 OtherBodyId);
+
+public:
+	/** The box of the sensor. Its scale is applied to the sensor */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	class UBoxComponent* SensorVolume = nullptr;
+
+	/** Delegate called once a body enters this sensor */
+	UPROPERTY(BlueprintAssignable)
+	FOnPSDSensorOverlap OnPSDSensorBeginOverlap;
+
+	/** Delegate called once a body exits this sensor */
+	UPROPERTY(BlueprintAssignable)
+	FOnPSDSensorOverlap OnPSDSensorEndOverlap;
+};
@@ -0,0 +1,138 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PhysicsSimulation/PSDActors/Base/PSDActorBase.h"
+#include "PSDStaticMeshActor.generated.h"
+
+/** The collision of the static mesh that is cooked on the physics service */
+UENUM(BlueprintType)
+enum class EPSDStaticMeshCollisionType : uint8
+{
+	/** The simple collision convex and box elements */
+	Convex,
+	/**
+	* The mesh triangles. The static mesh must allow CPU access, so its
+	* triangles are also available on cooked builds
+	*/
+	TriangleMesh
+};
+
+/**
+* The PSDActor that represents any static level geometry, given by its static
+* mesh collision. This PSDActor should be static, and therefore, not updated
+* on each physics service step.
+*
+* The collision is exported from the static mesh and cooked on the physics
+* service, which caches the cooked shape by the hash of the exported data.
+* The initialization string only references that hash, so the collision is
+* sent (and cooked) only if the physics service does not have it yet.
+*/
+UCLASS()
+class REMOTEPHYSICSENGINESYSTEM_API APSDStaticMeshActor : public APSDActorBase
+{
+	GENERATED_BODY()
+
+public:
+	/** Default constructor */
+	APSDStaticMeshActor();
+
+public:
+	/**
+	* Returns the physics service initialization string. This will return
+	* a string according to the initialization message template:
+	*
+	* "mesh; BodyID; bodyType; InitialPosX; InitialPosY; InitialPosY;
+	* InitialLinearVelocityX; InitialLinearVelocityY; InitialLinearVelocityZ;
+	* InitialAngularVelocityX; InitialAngularVelocityY;
+	* InitialAngularVelocityZ; RotationX; RotationY; RotationZ; RotationW;
+	* ScaleX; ScaleY; ScaleZ; MeshHash\n"
+	*
+	* @return The physics service initialization string for this PSDActor.
+	* Empty if the static mesh has no collision to export
+	*/
+	virtual FString GetPhysicsServiceInitializationString() override;
+
+	/**
+	* Getter to the hash of this actor's exported collision. This addresses
+	* the cooked mesh on the physics service.
+	*
+	* @return The collision hash. Empty if the static mesh has no collision
+	* to export
+	*/
+	FString GetCollisionMeshHash();
+
+	/**
+	* Returns the collision cooking string, sent on the "CookMesh" message if
+	* the physics service does not have this collision cooked yet. The
+	* template is:
+	*
+	* "MeshHash; convex\n
+	* Hull; VerticesBase64\n
+	* ..."
+	*
+	* for convex collision, and "MeshHash; mesh\n Vertices; VerticesBase64\n
+	* Indices; IndicesBase64\n" for triangle mesh collision.
+	*
+	* @return The collision cooking string. Empty if the static mesh has no
+	* collision to export
+	*/
+	FString GetCollisionCookingString();
+
+public:
+	/** The static mesh collision to cook on the physics service */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EPSDStaticMeshCollisionType CollisionType =
+		EPSDStaticMeshCollisionType::Convex;
+
+protected:
+	/**
+	* Exports the collision to cook, without the header line. Only called
+	* once, on the first time the collision is needed.
+	*
+	* @param OutCollisionCookingData The exported collision lines
+	*
+	* @return True if there was collision to export
+	*/
+	virtual bool ExportCollisionCookingData(FString& OutCollisionCookingData);
+
+	/** Getter to the collision type on the cooking string header */
+	virtual FString GetCollisionCookingType() const;
+
+	/**
+	* Getter to the transform the cooked collision is placed with. The
+	* collision is on the static mesh's local space, so it is the mesh's
+	*/
+	virtual FTransform GetCollisionTransform() const;
+
+	/**
+	* Getter to the collision hash, without exporting the collision. Empty if
+	* the collision was not exported yet
+	*/
+	const FString& GetExportedCollisionMeshHash() const
+		{ return CollisionMeshHash; }
+
+private:
+	/**
+	* Exports the collision into the cooking string, hashing it. The export
+	* is done only once, on the first time it is needed.
+	*
+	* @return True if there was collision to export
+	*/
+	bool ExportCollisionData();
+
+	/** Appends the given convex points as a "Hull" line */
+	static void AppendConvexHullCookingLine(const TArray<FVector>& HullPoints,
+		FString& OutCollisionCookingData);
+
+private:
+	/** The exported collision cooking string, without the header line */
+	FString CollisionCookingData = FString();
+
+	/** The hash of the exported collision */
+	FString CollisionMeshHash = FString();
+
+	/** Flag that indicates if the collision was already exported */
+	bool bHasExportedCollision = false;
+};
@@ -0,0 +1,159 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PhysicsSimulation/PSDActors/Base/PSDActorBase.h"
+#include "PSDVehicle.generated.h"
+
+/**
+* The PSDActor that represents a four wheeled vehicle. The actor's mesh is the
+* chassis, a box of "ChassisHalfExtent", and the wheels are placed on its
+* corners by the physics service. The wheel raycasts, suspension and
+* drivetrain are simulated on the physics service.
+*
+* The driver input is set with "SetPSDVehicleInput()" and sent on each step.
+* The chassis is updated as any other dynamic PSDActor, while the wheels are
+* updated with the vehicle state that comes on the step response.
+*/
+UCLASS()
+class REMOTEPHYSICSENGINESYSTEM_API APSDVehicle : public APSDActorBase
+{
+	GENERATED_BODY()
+
+public:
+	/** Default constructor */
+	APSDVehicle();
+
+public:
+	/**
+	* Sets the driver input sent on the next steps.
+	*
+	* @param NewThrottle From -1 (reverse) to 1 (full throttle)
+	* @param NewSteering From -1 (left) to 1 (right)
+	* @param NewBrake From 0 to 1
+	* @param NewHandBrake From 0 to 1
+	*/
+	UFUNCTION(BlueprintCallable)
+	void SetPSDVehicleInput(float NewThrottle, float NewSteering,
+		float NewBrake, float NewHandBrake);
+
+	/** Getter to the engine's rpm on the last physics state */
+	UFUNCTION(BlueprintPure)
+	float GetEngineRPM() const { return EngineRPM; }
+
+	/**
+	* Getter to the current gear on the last physics state. -1 is reverse and
+	* 0 is neutral
+	*/
+	UFUNCTION(BlueprintPure)
+	int32 GetCurrentGear() const { return CurrentGear; }
+
+	/**
+	* Returns the physics service initialization string. This will return
+	* a string according to the initialization message template:
+	*
+	* "vehicle; BodyID; bodyType; InitialPosX; InitialPosY; InitialPosZ;
+	* InitialLinearVelocityX; InitialLinearVelocityY; InitialLinearVelocityZ;
+	* InitialAngularVelocityX; InitialAngularVelocityY;
+	* InitialAngularVelocityZ; RotationX; RotationY; RotationZ; RotationW;
+	* ChassisHalfExtentX; ChassisHalfExtentY; ChassisHalfExtentZ; ChassisMass;
+	* WheelRadius; WheelWidth; SuspensionLength; MaxEngineTorque;
+	* MaxSteerAngle\n"
+	*
+	* @return The physics service initialization string for this PSDActor
+	*/
+	virtual FString GetPhysicsServiceInitializationString() override;
+
+	/** Overwritten here, so the clone is also a vehicle */
+	virtual FString GetPhysicsServiceCloneInitializationString() const
+		override;
+
+	/**
+	* Returns the driver input as a physics service step message line. The
+	* template is:
+	*
+	* "Vehicle; BodyID; Throttle; Steering; Brake; HandBrake\n"
+	*/
+	FString GetPhysicsServiceVehicleInputString() const;
+
+	/**
+	* Applies the vehicle state simulated by the physics service.
+	*
+	* @param NewEngineRPM The engine's rpm
+	* @param NewCurrentGear The current gear
+	* @param NewWheelTransforms The wheels' transforms relative to the chassis
+	*/
+	void ApplyPhysicsServiceVehicleState(const float NewEngineRPM,
+		const int32 NewCurrentGear,
+		const TArray<FTransform>& NewWheelTransforms);
+
+protected:
+	/** Called once WheelTransforms is replicated */
+	UFUNCTION()
+	void OnRep_WheelTransforms();
+
+private:
+	/** Gets the vehicle's initialization string with the given body type */
+	FString GetVehicleInitializationString(const TCHAR* BodyType) const;
+
+	/** Places the wheel meshes on the last wheel transforms */
+	void UpdateWheelMeshes();
+
+public:
+	/**
+	* The wheels' mesh components. The order is front left, front right, rear
+	* left and rear right. Their axle should be along the y-axis
+	*/
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly)
+	TArray<class UStaticMeshComponent*> WheelMeshComponents;
+
+	/** The chassis box half extent (cm) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "PSDVehicle")
+	FVector ChassisHalfExtent = FVector(200.f, 90.f, 20.f);
+
+	/** The chassis mass (kg) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "PSDVehicle")
+	float ChassisMass = 1500.f;
+
+	/** The wheels' radius (cm) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "PSDVehicle")
+	float WheelRadius = 30.f;
+
+	/** The wheels' width (cm) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "PSDVehicle")
+	float WheelWidth = 10.f;
+
+	/** How long the suspension is at its max droop (cm) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "PSDVehicle")
+	float SuspensionLength = 50.f;
+
+	/** The max torque the engine delivers (N m) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "PSDVehicle")
+	float MaxEngineTorque = 500.f;
+
+	/** How much the front wheels steer (degrees) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "PSDVehicle")
+	float MaxSteerAngle = 30.f;
+
+private:
+	/** The driver input sent on the next steps */
+	float Throttle = 0.f;
+	float Steering = 0.f;
+	float Brake = 0.f;
+	float HandBrake = 0.f;
+
+	/** The engine's rpm on the last physics state */
+	float EngineRPM = 0.f;
+
+	/** The current gear on the last physics state */
+	int32 CurrentGear = 0;
+
+	/**
+	* The wheels' transforms relative to the chassis on the last physics
+	* state. Replicated, as the wheel meshes are not moved by the actor's
+	* replicated movement
+	*/
+	UPROPERTY(ReplicatedUsing = OnRep_WheelTransforms)
+	TArray<FTransform> WheelTransforms;
+};
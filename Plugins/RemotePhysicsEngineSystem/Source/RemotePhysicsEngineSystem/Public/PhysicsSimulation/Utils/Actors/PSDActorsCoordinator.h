@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "ExternalCommunication/Sockets/SocketClientThreadWorker.h"
+#include "PhysicsSimulation/Utils/PSDBodyIndexAllocator.h"
+#include "PhysicsSimulation/Utils/Actors/PhysicsServiceRegion.h"
 #include "PSDActorsCoordinator.generated.h"
 
 /** 
@@ -18,6 +20,8 @@
 * currently driven by the given physics service region. Thus, the region is NOT
 * updating its Transform. A clone needs to exist on the physics service region
 * on shared regions, but we cannot have two services updating its Transform.
+* Thus, the clone is a kinematic body on the service, driven by the state of
+* the primary sent on each step.
 */
 enum class EPSDActorBodyTypeOnPhysicsServiceRegion : uint8
 {
@@ -113,6 +117,147 @@ public:
 	UFUNCTION(BlueprintCallable)
 	void StopPSDActorsSimulation();
 
+	/**
+	* Requests a physics service region to migrate its physics world to
+	* another physics service. The migration is done on the next step
+	* boundary, once every step response of the frame was consumed, so no
+	* request is in flight while the region's connection is replaced.
+	*
+	* @param PhysicsServiceRegionId The id of the region to migrate
+	* @param NewPhysicsServiceIpAddr The physics service ip addr ("ip:port")
+	* to migrate the region to
+	*
+	* @see APhysicsServiceRegion::MigrateToPhysicsService
+	*/
+	UFUNCTION(BlueprintCallable)
+	void RequestPhysicsServiceRegionMigration(int32 PhysicsServiceRegionId,
+		const FString& NewPhysicsServiceIpAddr);
+
+	/**
+	* Registers a character to be represented on the physics services. Its
+	* movement input is sent on each step to the physics service of the region
+	* it is in. Gives the character its id on the physics services.
+	*
+	* @param PSDCharacter The character to register
+	*
+	* @see UPSDCharacterComponent
+	*/
+	void RegisterPSDCharacter(class UPSDCharacterComponent* PSDCharacter);
+
+	/**
+	* Unregisters a character. It is removed from the physics services on the
+	* next step, as no more input is sent for it.
+	*
+	* @param PSDCharacter The character to unregister
+	*/
+	void UnregisterPSDCharacter(class UPSDCharacterComponent* PSDCharacter);
+
+	/**
+	* Registers a ragdoll to be simulated on the physics services once it is
+	* activated. Gives the ragdoll its id on the physics services.
+	*
+	* @param PSDRagdoll The ragdoll to register
+	*
+	* @see UPSDRagdollComponent
+	*/
+	void RegisterPSDRagdoll(class UPSDRagdollComponent* PSDRagdoll);
+
+	/**
+	* Unregisters a ragdoll. If it is active, the physics service releases it
+	* once its lifetime is over.
+	*
+	* @param PSDRagdoll The ragdoll to unregister
+	*/
+	void UnregisterPSDRagdoll(class UPSDRagdollComponent* PSDRagdoll);
+
+	/**
+	* Creates a constraint between two PSDActors on the next step. It is
+	* created on the region that owns the first PSDActor, so the second must
+	* be on the same region, either as a primary or as a clone. The
+	* constraint moves along with the region's world when it is migrated.
+	*
+	* @param ConstraintSettings The constraint settings
+	* @param PSDActor1 The first constrained PSDActor
+	* @param PSDActor2 The second constrained PSDActor. If null, the first
+	* PSDActor is constrained to the world
+	*
+	* @return The constraint id. INDEX_NONE if the first PSDActor is not on
+	* any region
+	*
+	* @see APhysicsServiceRegion::OnPSDConstraintRemoved
+	*/
+	UFUNCTION(BlueprintCallable)
+	int32 AddPSDConstraint(const FPSDConstraintSettings& ConstraintSettings,
+		APSDActorBase* PSDActor1, APSDActorBase* PSDActor2);
+
+	/**
+	* Removes a constraint on the next step. Has no effect if the physics
+	* service already removed it.
+	*
+	* @param ConstraintId The constraint id given on its creation
+	*/
+	UFUNCTION(BlueprintCallable)
+	void RemovePSDConstraint(int32 ConstraintId);
+
+	/**
+	* Pushes the PSDActors within a radius away from its origin on the next
+	* step, as an explosion. It is sent to every region it overlaps, as a
+	* single line, and each region pushes the PSDActors it owns.
+	*
+	* @param Origin The impulse's origin
+	* @param Radius The impulse's radius (cm)
+	* @param Impulse The impulse at the origin (kg cm/s)
+	* @param bLinearFalloff If the impulse fades to zero at the radius
+	*/
+	UFUNCTION(BlueprintCallable)
+	void AddPSDRadialImpulse(FVector Origin, float Radius, float Impulse,
+		bool bLinearFalloff = true);
+
+	/**
+	* Adds a wind volume on the regions it overlaps. The velocity of the
+	* PSDActors inside it is pulled towards the wind velocity on every step.
+	*
+	* @param WindVolume The box the wind blows on
+	* @param WindVelocity The wind velocity (cm/s)
+	* @param Drag The fraction of the velocity difference pulled per second
+	* @param Duration How long the wind blows (s). Until removed if 0
+	*
+	* @return The force field id. INDEX_NONE if it overlaps no region
+	*/
+	UFUNCTION(BlueprintCallable)
+	int32 AddPSDWindVolume(FBox WindVolume, FVector WindVelocity, float Drag,
+		float Duration = 0.f);
+
+	/**
+	* Adds a vortex on the regions it overlaps: a vertical cylinder that
+	* spins, pulls in and lifts the PSDActors inside it. Its accelerations
+	* (cm/s^2) fade to zero at its radius.
+	*
+	* @param VortexBase The center of the cylinder's base
+	* @param Radius The cylinder's radius (cm)
+	* @param Height The cylinder's height (cm)
+	* @param TangentialAcceleration The acceleration around the axis,
+	* counterclockwise seen from above
+	* @param InwardAcceleration The acceleration towards the axis
+	* @param UpwardAcceleration The acceleration up along the axis
+	* @param Duration How long the vortex lasts (s). Until removed if 0
+	*
+	* @return The force field id. INDEX_NONE if it overlaps no region
+	*/
+	UFUNCTION(BlueprintCallable)
+	int32 AddPSDVortex(FVector VortexBase, float Radius, float Height,
+		float TangentialAcceleration, float InwardAcceleration,
+		float UpwardAcceleration, float Duration = 0.f);
+
+	/**
+	* Removes a wind volume or vortex on the next step, from every region it
+	* was added to.
+	*
+	* @param ForceFieldId The force field id given on its creation
+	*/
+	UFUNCTION(BlueprintCallable)
+	void RemovePSDForceField(int32 ForceFieldId);
+
 public:
 	/** Sets default values for this actor's properties */
 	APSDActorsCoordinator();
@@ -186,12 +331,28 @@ private:
 	/** Gets all the physics services regions on the world. */
 	void GetAllPhysicsServiceRegions();
 
+	/**
+	* Gives every PSDActor on the world a body index, and hands the body index
+	* allocator to the regions so they can allocate to spawned PSDActors.
+	* Must be called before the regions gather their PSDActors.
+	*/
+	void AllocatePSDActorsBodyIndices();
+
 	/** 
 	* Updates the PSD actors Transform. This will request the physics service
 	* server physics update and await its response. Once returned, will parse 
 	* the result to update each PSD actor Transform.
+	*
+	* @param DeltaTime The game time elapsed since the last update. The
+	* physics services advance their worlds by this time
 	*/
-	void UpdatePSDActors();
+	void UpdatePSDActors(const float DeltaTime);
+
+	/** 
+	* Migrates every physics service region with a pending migration request.
+	* Must only be called between steps.
+	*/
+	void MigratePendingPhysicsServiceRegions();
 
 private:
 	/**
@@ -207,6 +368,27 @@ private:
 	/** The PSDActors Spawner reference to request PSD Actors spawn */
 	class APSDActorsSpawner* PSDActorsSpanwer = nullptr;
 
+	/** The body index allocator of every PSDActor on the world */
+	FPSDBodyIndexAllocator BodyIndexAllocator;
+
+	/** The registered characters. The key is the character id */
+	TMap<int32, class UPSDCharacterComponent*> PSDCharacters;
+
+	/** The id to give to the next registered character */
+	int32 NextPSDCharacterId = 0;
+
+	/** The registered ragdolls. The key is the ragdoll id */
+	TMap<int32, class UPSDRagdollComponent*> PSDRagdolls;
+
+	/** The id to give to the next registered ragdoll */
+	int32 NextPSDRagdollId = 0;
+
+	/** The id to give to the next constraint, on any region */
+	int32 NextPSDConstraintId = 0;
+
+	/** The id to give to the next force field, shared by its regions */
+	int32 NextPSDForceFieldId = 0;
+
 	/**
 	* The TimerHandle that handles the PSD actors test (test-purposes only).
 	*/
@@ -235,6 +417,12 @@ private:
 	/** Counts the amount of step the physics system */
 	uint32 StepPhysicsCounter = 0;
 
+	/** 
+	* The pending physics service region migrations. The key is the region id
+	* and the value the physics service ip addr to migrate to
+	*/
+	TMap<int32, FString> PendingPhysicsServiceRegionMigrations;
+
 private:
 	/** */
 	FString DeltaTimeMeasurement = FString();
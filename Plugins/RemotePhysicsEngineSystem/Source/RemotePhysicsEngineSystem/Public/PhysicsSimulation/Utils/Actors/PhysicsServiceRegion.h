@@ -4,8 +4,150 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "PhysicsSimulation/Utils/PSDBodyIndexAllocator.h"
 #include "PhysicsServiceRegion.generated.h"
 
+/** The result of a scene query run on the physics service */
+USTRUCT(BlueprintType)
+struct REMOTEPHYSICSENGINESYSTEM_API FPSDSceneQueryResult
+{
+	GENERATED_BODY()
+
+	/** The request id given when the query was queued */
+	UPROPERTY(BlueprintReadOnly)
+	int32 RequestId = INDEX_NONE;
+
+	/** If the ray or sweep hit a body, or if the overlap found any */
+	UPROPERTY(BlueprintReadOnly)
+	bool bHasHit = false;
+
+	/** The body id of the closest hit. Only set for rays and sweeps */
+	UPROPERTY(BlueprintReadOnly)
+	int32 HitBodyId = INDEX_NONE;
+
+	/** The PSDActor of the closest hit. Null if not a PSDActor */
+	UPROPERTY(BlueprintReadOnly)
+	class APSDActorBase* HitPSDActor = nullptr;
+
+	/** The fraction of the trace where the closest hit is */
+	UPROPERTY(BlueprintReadOnly)
+	float HitFraction = 1.f;
+
+	/** The closest hit location on world space */
+	UPROPERTY(BlueprintReadOnly)
+	FVector HitLocation = FVector::ZeroVector;
+
+	/** The hit body's surface normal on the closest hit */
+	UPROPERTY(BlueprintReadOnly)
+	FVector HitNormal = FVector::ZeroVector;
+
+	/** The body ids overlapping the shape. Only set for overlaps */
+	UPROPERTY(BlueprintReadOnly)
+	TArray<int32> OverlappingBodyIds;
+};
+
+/**
+* Called once the step response with the results of the queued scene queries
+* is received. Every query queued before that step is on the results.
+*/
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnPSDSceneQueriesCompleted,
+	const TArray<FPSDSceneQueryResult>&, SceneQueryResults);
+
+/** The kind of a constraint between two PSDActors */
+UENUM(BlueprintType)
+enum class EPSDConstraintType : uint8
+{
+	/** Keeps the bodies' relative transform */
+	Fixed,
+	/** Keeps the anchor together, but the bodies rotate freely around it */
+	Point,
+	/** Rotates around the axis */
+	Hinge,
+	/** Slides along the axis */
+	Slider,
+	/** Keeps the anchors within a distance range */
+	Distance,
+	/** Limits each translation and rotation axis on its own */
+	SixDOF
+};
+
+/**
+* The settings of a constraint between two PSDActors. The bodies are
+* constrained where they are when it is created, around the anchor.
+*/
+USTRUCT(BlueprintType)
+struct REMOTEPHYSICSENGINESYSTEM_API FPSDConstraintSettings
+{
+	GENERATED_BODY()
+
+	/** The constraint type */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	EPSDConstraintType ConstraintType = EPSDConstraintType::Fixed;
+
+	/** The anchor on world space */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector Anchor = FVector::ZeroVector;
+
+	/** The hinge or slider axis, or the six-DOF x-axis, on world space */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector Axis = FVector::ForwardVector;
+
+	/** The axis normal to it, the six-DOF y-axis, on world space */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector Normal = FVector::RightVector;
+
+	/** The anchor on the second body, on world space. Distance only */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector SecondAnchor = FVector::ZeroVector;
+
+	/**
+	* The hinge angle (degrees), slider translation (cm) or distance (cm)
+	* limits. Not limited if LimitMin is not below LimitMax. A distance with
+	* no limits is kept at the current one
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float LimitMin = 0.f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float LimitMax = 0.f;
+
+	/**
+	* The six-DOF translation limits along its axes (cm). An axis is locked if
+	* its min is not below its max, and free if its limits are over 1e6 cm
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector TranslationLimitsMin = FVector::ZeroVector;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector TranslationLimitsMax = FVector::ZeroVector;
+
+	/**
+	* The six-DOF rotation limits around its axes (degrees). The y and z
+	* limits are a cone, so they are made symmetric. An axis is free if its
+	* limits are -180 and 180 degrees
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector RotationLimitsMin = FVector(-180.f);
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	FVector RotationLimitsMax = FVector(180.f);
+
+	/**
+	* The max impulse the constraint can apply on a physics step before it
+	* breaks (kg cm/s). Never breaks if 0
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, meta = (ClampMin = "0"))
+	float BreakImpulse = 0.f;
+};
+
+/**
+* Called once the physics service removed a constraint by itself. The reason
+* is "broken", "failed" (could not be created) or "body" (one of its bodies
+* left the physics world).
+*/
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnPSDConstraintRemoved,
+	int32, ConstraintId, const FString&, Reason);
+
 /** 
 * This is the physics service region. This represents the simulating area of a
 * given physics service. If any PSDActor is whithin this area, it will be 
@@ -43,6 +185,229 @@ public:
 		NewSphereLinearVelocity, const FVector
 		NewSphereAngularVelocity);
 
+	/**
+	* Casts a ray against this region's physics world as it was on a past
+	* physics step. Used to validate hits with lag compensation: the moving
+	* bodies are placed where they were on the given step. Requires the
+	* rewind history to be enabled (@see RewindHistoryLength).
+	*
+	* @param StepIndex The physics step to cast the ray on. Usually the last
+	* step index minus the player's latency in steps
+	* @param TraceStart The ray start on world space
+	* @param TraceEnd The ray end on world space
+	* @param OutHitBodyId The body id hit, if any
+	* @param OutHitLocation The hit location, if any
+	*
+	* @return True if the ray hit a body. False if it did not or if the step
+	* is no longer on the physics service history
+	*/
+	UFUNCTION(BlueprintCallable)
+	bool RewindRaycastOnPhysicsService(const int32 StepIndex,
+		const FVector TraceStart, const FVector TraceEnd, int32& OutHitBodyId,
+		FVector& OutHitLocation);
+
+	/**
+	* Queues a raycast to run on this region's physics world right after the
+	* next physics step. The queued scene queries are sent on the step
+	* message, so any amount of them costs no extra round trip. The result is
+	* broadcast on "OnSceneQueriesCompleted" once the step response arrives.
+	*
+	* @param TraceStart The ray start on world space
+	* @param TraceEnd The ray end on world space
+	*
+	* @return The request id of the query, given on its result
+	*/
+	UFUNCTION(BlueprintCallable)
+	int32 QueueRaycastOnPhysicsService(const FVector TraceStart,
+		const FVector TraceEnd);
+
+	/**
+	* Queues a sphere sweep to run on this region's physics world. The result
+	* is the closest hit. @see QueueRaycastOnPhysicsService
+	*/
+	UFUNCTION(BlueprintCallable)
+	int32 QueueSphereSweepOnPhysicsService(const float SphereRadius,
+		const FVector SweepStart, const FVector SweepEnd);
+
+	/**
+	* Queues a box sweep to run on this region's physics world. The result is
+	* the closest hit. @see QueueRaycastOnPhysicsService
+	*/
+	UFUNCTION(BlueprintCallable)
+	int32 QueueBoxSweepOnPhysicsService(const FVector BoxHalfExtents,
+		const FRotator BoxRotation, const FVector SweepStart,
+		const FVector SweepEnd);
+
+	/**
+	* Queues a sphere overlap test to run on this region's physics world. The
+	* result has every overlapping body. @see QueueRaycastOnPhysicsService
+	*/
+	UFUNCTION(BlueprintCallable)
+	int32 QueueSphereOverlapOnPhysicsService(const float SphereRadius,
+		const FVector SphereCenter);
+
+	/**
+	* Queues a box overlap test to run on this region's physics world. The
+	* result has every overlapping body. @see QueueRaycastOnPhysicsService
+	*/
+	UFUNCTION(BlueprintCallable)
+	int32 QueueBoxOverlapOnPhysicsService(const FVector BoxHalfExtents,
+		const FRotator BoxRotation, const FVector BoxCenter);
+
+	/**
+	* Getter to a scene query result from the last step response that had
+	* any.
+	*
+	* @return True if the result was found
+	*/
+	UFUNCTION(BlueprintCallable)
+	bool GetSceneQueryResult(const int32 RequestId,
+		FPSDSceneQueryResult& OutSceneQueryResult) const;
+
+	/**
+	* Takes the queued scene queries as the step message "Query" lines.
+	* @see FPhysicsServiceImpl::RunSceneQueries
+	*/
+	FString ConsumeQueuedSceneQueries();
+
+	/**
+	* Gets the driver input of the vehicles this region owns as the step
+	* message "Vehicle" lines.
+	* @see APSDVehicle::GetPhysicsServiceVehicleInputString
+	*/
+	FString GetPSDVehiclesInputString() const;
+
+	/**
+	* Gets the transforms of the movers on this region, packed as the step
+	* message "KinematicTargets" line. Every mover is sent on each step, as
+	* a mover without a target keeps moving on the physics service.
+	* @see FPhysicsServiceImpl::SetKinematicBodyTargets
+	*/
+	FString GetPSDKinematicTargetsString() const;
+
+	/**
+	* Activates a ragdoll on this region's physics service. Its ragdoll type
+	* is registered on the service first, if this region has not yet. Must be
+	* called between steps, as the type is sent right away.
+	*
+	* @param PSDRagdoll The ragdoll with a pending activation
+	*
+	* @return The step message "Ragdoll" line. Empty if the ragdoll type
+	* could not be registered
+	*/
+	FString ActivatePSDRagdollOnRegion(class UPSDRagdollComponent* PSDRagdoll);
+
+	/**
+	* Stops applying a ragdoll's state on this region. The ragdoll is left on
+	* the physics service until it is released there.
+	*
+	* @param PSDRagdollId The ragdoll id
+	*/
+	void RemovePSDRagdollFromRegion(const int32 PSDRagdollId)
+		{ ActivePSDRagdollIds.Remove(PSDRagdollId); }
+
+	/**
+	* Queues a constraint to create on this region's physics service with the
+	* next step. The constraint ids are given by the coordinator, so they are
+	* unique across every region.
+	*
+	* @param ConstraintId The constraint id
+	* @param ConstraintSettings The constraint settings
+	* @param BodyId1 The first constrained body id
+	* @param BodyId2 The second constrained body id. INDEX_NONE to constrain
+	* the first body to the world
+	*/
+	void QueuePSDConstraintCreation(const int32 ConstraintId,
+		const FPSDConstraintSettings& ConstraintSettings, const int32 BodyId1,
+		const int32 BodyId2);
+
+	/**
+	* Queues a constraint removal on this region's physics service with the
+	* next step.
+	*
+	* @return False if the constraint is not on this region
+	*/
+	bool QueuePSDConstraintRemoval(const int32 ConstraintId);
+
+	/**
+	* Takes the queued constraint changes as the step message "Constraint"
+	* and "RemoveConstraint" lines.
+	* @see FPhysicsServiceConstraints::ApplyConstraintChanges
+	*/
+	FString ConsumeQueuedPSDConstraintChanges();
+
+	/**
+	* Queues a radial impulse on this region's physics service with the next
+	* step. It pushes the dynamic bodies within its radius away from its
+	* origin.
+	*
+	* @param Origin The impulse's origin
+	* @param Radius The impulse's radius (cm)
+	* @param Impulse The impulse at the origin (kg cm/s)
+	* @param bLinearFalloff If the impulse fades to zero at the radius
+	*/
+	void QueuePSDRadialImpulse(const FVector& Origin, const float Radius,
+		const float Impulse, const bool bLinearFalloff);
+
+	/**
+	* Queues a wind volume on this region's physics service with the next
+	* step. The force field ids are given by the coordinator, as a field may
+	* be on many regions.
+	*
+	* @param ForceFieldId The force field id
+	* @param WindVolume The box the wind blows on
+	* @param WindVelocity The velocity the bodies are pulled towards (cm/s)
+	* @param Drag The fraction of the velocity difference pulled per second
+	* @param Duration How long the wind blows (s). Until removed if 0
+	*/
+	void QueuePSDWindVolume(const int32 ForceFieldId, const FBox& WindVolume,
+		const FVector& WindVelocity, const float Drag, const float Duration);
+
+	/**
+	* Queues a vortex on this region's physics service with the next step.
+	* The vortex is a vertical cylinder whose accelerations (cm/s^2) fade to
+	* zero at its radius.
+	*
+	* @param ForceFieldId The force field id
+	* @param VortexBase The center of the cylinder's base
+	* @param Radius The cylinder's radius (cm)
+	* @param Height The cylinder's height (cm)
+	* @param TangentialAcceleration The acceleration around the axis,
+	* counterclockwise seen from above
+	* @param InwardAcceleration The acceleration towards the axis
+	* @param UpwardAcceleration The acceleration up along the axis
+	* @param Duration How long the vortex lasts (s). Until removed if 0
+	*/
+	void QueuePSDVortex(const int32 ForceFieldId, const FVector& VortexBase,
+		const float Radius, const float Height,
+		const float TangentialAcceleration, const float InwardAcceleration,
+		const float UpwardAcceleration, const float Duration);
+
+	/**
+	* Queues a force field removal on this region's physics service with the
+	* next step.
+	*
+	* @return False if the force field was never added to this region
+	*/
+	bool QueuePSDForceFieldRemoval(const int32 ForceFieldId);
+
+	/**
+	* Takes the queued force field changes as the step message
+	* "RadialImpulse", "ForceField" and "RemoveForceField" lines.
+	* @see FPhysicsServiceForceFields::ApplyForceFieldChanges
+	*/
+	FString ConsumeQueuedPSDForceFieldChanges();
+
+	/** Getter to the index of the last physics step received */
+	UFUNCTION(BlueprintPure)
+	int32 GetLastPhysicsStepIndex() const { return LastPhysicsStepIndex; }
+
+	/** 
+	* Getter to the physics world state checksum on the last physics step 
+	* received. Two worlds on the same step and state have the same checksum
+	*/
+	uint32 GetLastStateChecksum() const { return LastStateChecksum; }
+
 public:	
 	/** Sets default values for this actor's properties */ 
 	APhysicsServiceRegion();
@@ -59,12 +424,14 @@ public:
 	* region, if he exits his previous physics region.
 	*
 	* @note The PSDActor will not acctually spawn on this physics region, but
-	* only on the physics service.
+	* only on the physics service. There, the clone is a kinematic ghost,
+	* moved each step towards the PSDActor's state on its owning region.
+	* The PSDActor's cooked collision is sent first, if the physics service
+	* is missing it.
 	*
 	* @param PSDActorToClone The PSDActor to clone on the physics service
 	*/
-	void AddPSDActorCloneOnPhysicsService
-		(const APSDActorBase* PSDActorToClone);
+	void AddPSDActorCloneOnPhysicsService(APSDActorBase* PSDActorToClone);
 
 	/**
 	* Clears this physics service region. This will disconnect from the physics
@@ -89,11 +456,50 @@ public:
 	* @note This is done to avoid processing getting all actors again. Thus, 
 	* make sure that the TMap is already defined before using this method.
 	* 
-	* @return The DynamicPSDActorsOnRegion TMap already filled previously
+	* @return The DynamicPSDActorsOnRegion map already filled previously
 	*/
-	TMap<int32, class APSDActorBase*> GetCachedDynamicPSDActorsOnRegion()
+	const FPSDActorBodyIndexMap& GetCachedDynamicPSDActorsOnRegion() const
 		{ return DynamicPSDActorsOnRegion; }
 
+	/**
+	* Sets the body index allocator of the coordinator. PSDActors spawned on
+	* this region get their body index from it.
+	*
+	* @param InBodyIndexAllocator The coordinator's body index allocator
+	*/
+	void SetBodyIndexAllocator(FPSDBodyIndexAllocator* InBodyIndexAllocator)
+		{ BodyIndexAllocator = InBodyIndexAllocator; }
+
+	/**
+	* Sets the characters registered on the coordinator. The characters' state
+	* received on the steps is applied to them.
+	*
+	* @param InPSDCharacters The coordinator's characters, by their id
+	*/
+	void SetPSDCharacters(const TMap<int32, class UPSDCharacterComponent*>*
+		InPSDCharacters) { PSDCharacters = InPSDCharacters; }
+
+	/**
+	* Sets the ragdolls registered on the coordinator. The ragdolls' state
+	* received on the steps is applied to them.
+	*
+	* @param InPSDRagdolls The coordinator's ragdolls, by their id
+	*/
+	void SetPSDRagdolls(const TMap<int32, class UPSDRagdollComponent*>*
+		InPSDRagdolls) { PSDRagdolls = InPSDRagdolls; }
+
+	/**
+	* Checks if a location is inside this region's area.
+	*
+	* @param Location The location on world space
+	*
+	* @return True if the location is inside the region's box
+	*/
+	bool IsLocationInsideRegion(const FVector& Location) const;
+
+	/** Getter to the world space bounds of this region's box */
+	FBox GetRegionBounds() const;
+
 	/** 
 	* Getter to the physics service region id.
 	* 
@@ -115,6 +521,28 @@ public:
 	void InitializePhysicsServiceRegion(const FString& 
 		RegionPhysicsServiceIpAddr);
 
+	/**
+	* Migrates this region's physics world to another physics service. The
+	* world is saved as a snapshot on the current service and restored on the
+	* new one, keeping the bodies' velocities, sleep state and contact cache.
+	* Once restored, this region's connection is replaced by the new one and
+	* the world on the previous service is cleared.
+	*
+	* The simulation stalls while the snapshot is transferred. The connection
+	* to the new service is opened before the stall, and the stall is measured
+	* against "MaxMigrationStallMilliseconds".
+	*
+	* @note This must be called between steps, when no step request is in
+	* flight for this region. @see APSDActorsCoordinator
+	*
+	* @param NewPhysicsServiceIpAddr The physics service ip addr ("ip:port") 
+	* to migrate this region to
+	*
+	* @return True if the region was migrated. False otherwise, in which case
+	* the region keeps running on its current physics service
+	*/
+	bool MigrateToPhysicsService(const FString& NewPhysicsServiceIpAddr);
+
 	/**
 	* Removes the ownership of this region from a given PSDActor. The process
 	* of removing the ownership means that this physics service region will no
@@ -142,18 +570,38 @@ public:
 	* Updates all the PSDActors on this region by requesting a step physics
 	* on the connected physics service. The param is the physics simulation
 	* result. This should be given, as the coordinator will thread the physics
-	* service update and syncronize the update
+	* service update and syncronize the update.
+	*
+	* The result starts with the step info line, which tells if the physics
+	* world was stepped and the interpolation alpha. Every dynamic PSDActor is
+	* blended with such alpha, even if no fixed step was run on the service.
 	* 
 	* @param PhysicsSimulationResultStr The physics simulation response for 
 	* this given step to update the PSDActors on this physics region
 	*/
 	void UpdatePSDActorsOnRegion(const FString& PhysicsSimulationResultStr);
 
-	/** */
+	/**
+	* Gets the simulation measures from the physics service and saves them.
+	* The step times are saved on the "StepPhysicsMeasureWithoutCommsOverhead"
+	* folder, and the "Phases" lines (the time of each step phase, job count
+	* and thread utilisation) on the "StepPhysicsPhasesMeasure" folder.
+	*/
 	void SavePhysicsServiceMeasuresements();
 
-	/** */
-	void SavePhysicsServiceMeasuresToFile(const FString& Measurements) const;
+	/**
+	* Saves the physics service measurements to a new file on the user
+	* directory.
+	*
+	* @param Measurements The measurements to save
+	* @param TargetFolder The user directory's folder to save the file into
+	* @param FilePrefix The file name prefix, followed by the map name and
+	* region id
+	*/
+	void SavePhysicsServiceMeasuresToFile(const FString& Measurements,
+		const FString& TargetFolder =
+		TEXT("StepPhysicsMeasureWithoutCommsOverhead"),
+		const FString& FilePrefix = TEXT("StepPhysicsTime")) const;
 
 	/**
 	* Adds the ownership of this region to a given PSDActor. The process of
@@ -219,6 +667,121 @@ private:
 	*/
 	void InitializeRegionPhysicsWorld();
 
+	/**
+	* Sends the contact events subscriptions of the given PSDActors to the
+	* physics service. PSDActors not subscribed to any contact event are
+	* ignored, and no message is sent if none is subscribed.
+	*
+	* @param PSDActorsToSubscribe The PSDActors to send the subscriptions of
+	*/
+	void SendContactSubscriptionsToPhysicsService
+		(const TArray<const APSDActorBase*>& PSDActorsToSubscribe);
+
+	/**
+	* Sends the collision of the given static mesh PSDActors that the physics
+	* service has not cooked yet. The service is asked which collision hashes
+	* it is missing, so each collision is only sent and cooked once. Must be
+	* done before the world initialization or restore that uses them.
+	*
+	* @param SocketConnectionToSend The connection to the physics service
+	* @param PSDActorsToCook The PSDActors to send the collision of. Only the
+	* static mesh PSDActors (and the ones derived from them, such as the
+	* compound PSDActors) are considered
+	*/
+	void SendMissingCookedMeshesToPhysicsService
+		(class USocketClientInstance* SocketConnectionToSend,
+		const TArray<APSDActorBase*>& PSDActorsToCook);
+
+	/**
+	* Handles a contact event line from the step response, broadcasting the
+	* contact to the dynamic PSDActors on this region involved on it.
+	*
+	* @param ParsedContactEvent The contact event line parsed with ";"
+	*/
+	void HandleContactEvent(const TArray<FString>& ParsedContactEvent);
+
+	/**
+	* Queues a scene query line with a new request id.
+	*
+	* @param QueryTypeAndParams The query type and params, after the id
+	*
+	* @return The request id of the query
+	*/
+	int32 QueueSceneQuery(const FString& QueryTypeAndParams);
+
+	/**
+	* Parses a scene query result line from the step response.
+	*
+	* @param ParsedSceneQueryResult The result line parsed with ";"
+	* @param OutSceneQueryResult The parsed result
+	*
+	* @return False if the line could not be parsed
+	*/
+	bool ParseSceneQueryResult(const TArray<FString>& ParsedSceneQueryResult,
+		FPSDSceneQueryResult& OutSceneQueryResult) const;
+
+	/**
+	* Applies a character state received on the step response to its
+	* character. The template is: "CharacterState;CharacterId;posX;posY;posZ;
+	* velX;velY;velZ;GroundState;GroundBodyId"
+	*
+	* @param ParsedCharacterState The character state line parsed with ";"
+	*/
+	void HandleCharacterState(const TArray<FString>& ParsedCharacterState);
+
+	/**
+	* Applies a vehicle state received on the step response to its vehicle.
+	* The template is: "VehicleState;BodyId;EngineRPM;Gear;NumberOfWheels",
+	* followed by each wheel's "posX;posY;posZ;rotX;rotY;rotZ;rotW" relative
+	* to the chassis
+	*
+	* @param ParsedVehicleState The vehicle state line parsed with ";"
+	*/
+	void HandleVehicleState(const TArray<FString>& ParsedVehicleState);
+
+	/**
+	* Applies a ragdoll state received on the step response to its ragdoll.
+	* The template is: "RagdollState;RagdollId;posX;posY;posZ;rotX;rotY;rotZ;
+	* rotW", followed by each other part's "posX;posY;posZ;rotX;rotY;rotZ;
+	* rotW" relative to the root part
+	*
+	* @param ParsedRagdollState The ragdoll state line parsed with ";"
+	*/
+	void HandleRagdollState(const TArray<FString>& ParsedRagdollState);
+
+	/**
+	* Releases a ragdoll released by the physics service. The template is:
+	* "RagdollReleased;RagdollId"
+	*
+	* @param ParsedRagdollReleased The ragdoll released line parsed with ";"
+	*/
+	void HandleRagdollReleased(const TArray<FString>& ParsedRagdollReleased);
+
+	/**
+	* Releases every ragdoll active on this region. Used once the physics
+	* service world is gone or replaced, along with its ragdolls.
+	*/
+	void ReleasePSDRagdollsOnRegion();
+
+	/**
+	* Forgets a constraint removed by the physics service and broadcasts it.
+	* The template is: "ConstraintRemoved;ConstraintId;Reason"
+	*
+	* @param ParsedConstraintRemoved The constraint removed line parsed with
+	* ";"
+	*/
+	void HandleConstraintRemoved
+		(const TArray<FString>& ParsedConstraintRemoved);
+
+	/**
+	* Broadcasts the bodies that entered and exited a sensor on the last
+	* step. The template is: "Sensor;SensorId;EnteredCount;ExitedCount;
+	* EnteredBodyIds...;ExitedBodyIds..."
+	*
+	* @param ParsedSensorEvents The sensor events line parsed with ";"
+	*/
+	void HandleSensorEvents(const TArray<FString>& ParsedSensorEvents);
+
 public:
 	/** 
 	* The physics service ip address to connect this region to. This service
@@ -238,6 +801,88 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite)
 	int32 RegionOwnerPhysicsServiceId = 0;
 
+	/** 
+	* The fixed time each physics step advances on this region's physics
+	* world. The game's delta time is accumulated on the physics service and
+	* consumed in steps of this size.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float PhysicsFixedDeltaTime = 1.f / 60.f;
+
+	/** The collision steps done on each fixed physics step */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 PhysicsCollisionSteps = 1;
+
+	/** The integration sub steps done on each collision step */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 PhysicsIntegrationSubSteps = 1;
+
+	/** 
+	* The max amount of fixed steps the physics service runs on a single step
+	* request. If the game falls behind more than this, the extra time is
+	* dropped.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 PhysicsMaxCatchUpSteps = 4;
+
+	/** 
+	* The max amount of contact events the physics service sends back on a
+	* single step. Contact spikes beyond it are trimmed on the service, 
+	* dropping the weakest contacts first.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 MaxContactEventsPerStep = 64;
+
+	/** 
+	* The max time, in milliseconds, the simulation should stall while this
+	* region migrates to another physics service. Longer migrations are 
+	* logged as warnings.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	float MaxMigrationStallMilliseconds = 50.f;
+
+	/** 
+	* The amount of physics steps the physics service keeps on its rewind
+	* history, for lag-compensated raycasts. 0 disables the history.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 RewindHistoryLength = 0;
+
+	/** 
+	* The max amount of moving bodies recorded on each rewind history step.
+	* The history memory is preallocated for this amount of bodies.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	int32 MaxRewindBodies = 1024;
+
+	/**
+	* Flag that indicates if the physics service should simulate this
+	* region's world around the region's center, instead of the map's origin.
+	* The messages are still on the map's space, and are converted by the
+	* physics service. This keeps the simulation precise on regions far from
+	* the map's origin.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bUseRegionCenterAsPhysicsOrigin = true;
+
+	/** 
+	* Flag that indicates if the static PSDActors on this region should be
+	* baked into a static scene on the physics service. If so, the world
+	* initialization only sends the dynamic PSDActors and the scene key, and
+	* the static bodies are loaded from the physics service cache. The scene
+	* is baked again whenever the static PSDActors change.
+	*/
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+	bool bUseStaticSceneCache = true;
+
+	/** Called once the results of the queued scene queries are received */
+	UPROPERTY(BlueprintAssignable)
+	FOnPSDSceneQueriesCompleted OnSceneQueriesCompleted;
+
+	/** Called once the physics service removed a constraint by itself */
+	UPROPERTY(BlueprintAssignable)
+	FOnPSDConstraintRemoved OnPSDConstraintRemoved;
+
 private:
 	/**
 	* The box component that collides with PSDActors. This represents the
@@ -273,8 +918,73 @@ private:
 
 	/**
 	* The list of dynamic PSDActors. Theses are the PSDActors that will be 
-	* updated on each physics step. The key is a unique Id to identify it on 
-	* the physics service and the value is the PSD actor reference itself.
+	* updated on each physics step, mapped by their body index.
+	*/
+	FPSDActorBodyIndexMap DynamicPSDActorsOnRegion;
+
+	/**
+	* The list of static PSDActors on this region. Used to find the other 
+	* PSDActor on contact events (e.g. the floor). The key is the body id.
+	*/
+	FPSDActorBodyIndexMap StaticPSDActorsOnRegion;
+
+	/**
+	* The list of kinematic PSDActors on this region, the movers driven by
+	* the game. The key is the body id.
+	*/
+	FPSDActorBodyIndexMap KinematicPSDActorsOnRegion;
+
+	/** The coordinator's body index allocator. Owned by the coordinator */
+	FPSDBodyIndexAllocator* BodyIndexAllocator = nullptr;
+
+	/** The coordinator's characters, by their id. Owned by the coordinator */
+	const TMap<int32, class UPSDCharacterComponent*>* PSDCharacters = nullptr;
+
+	/** The coordinator's ragdolls, by their id. Owned by the coordinator */
+	const TMap<int32, class UPSDRagdollComponent*>* PSDRagdolls = nullptr;
+
+	/** The ids of the ragdolls activated on this region's physics service */
+	TSet<int32> ActivePSDRagdollIds;
+
+	/**
+	* The ragdoll types already registered on this region's physics service.
+	* Emptied on migration, as the new service may not have them
+	*/
+	TSet<FString> RegisteredPSDRagdollTypes;
+
+	/**
+	* The ids of the constraints on this region's physics world. They are
+	* kept on migration, as the constraints are on the world snapshot
+	*/
+	TSet<int32> PSDConstraintIds;
+
+	/** The constraint lines queued to send on the next step message */
+	FString QueuedPSDConstraintChanges = FString();
+
+	/**
+	* The ids of the force fields added to this region's physics world. The
+	* ones whose duration is over are kept, as removing them does nothing
+	*/
+	TSet<int32> PSDForceFieldIds;
+
+	/** The force field lines queued to send on the next step message */
+	FString QueuedPSDForceFieldChanges = FString();
+
+	/** The index of the last physics step received from the physics service */
+	int32 LastPhysicsStepIndex = 0;
+
+	/** The physics world state checksum on the last physics step received */
+	uint32 LastStateChecksum = 0;
+
+	/** The "Query" lines queued to send on the next step message */
+	FString QueuedSceneQueries = FString();
+
+	/** The request id to give to the next queued scene query */
+	int32 NextSceneQueryRequestId = 0;
+
+	/**
+	* The scene query results from the last step response that had any. The
+	* key is the request id
 	*/
-	TMap<int32, class APSDActorBase*> DynamicPSDActorsOnRegion;
+	TMap<int32, FPSDSceneQueryResult> LastSceneQueryResults;
 };
@@ -0,0 +1,117 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "PSDCharacterComponent.generated.h"
+
+/**
+* Represents the owning character on the physics services, as a character
+* moved by collision sweeps against the physics world. Thus, the players
+* collide with the PSDActors (and push them) instead of walking through them.
+*
+* While the character is inside a physics service region, the coordinator
+* sends its movement input on each step to the region's physics service, and
+* the resolved location and ground state are applied back to the character.
+* Meanwhile, the character movement component does not move the character
+* on the server, as the physics service does. Outside of any region, the
+* character movement component moves the character as usual.
+*
+* @note Must be owned by a ACharacter
+*
+* @see APSDActorsCoordinator
+*/
+UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
+class REMOTEPHYSICSENGINESYSTEM_API UPSDCharacterComponent :
+	public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	* Getter to the character's movement input as a physics service step
+	* message line. The template is:
+	*
+	* "Character;CharacterId;CapsuleRadius;CapsuleHalfHeight;posX;posY;posZ;
+	* desiredVelX;desiredVelY;desiredVelZ;JumpSpeed\n"
+	*
+	* The desired velocity is the walk velocity given by the character's
+	* input and the jump speed is zero if the character is not jumping.
+	*/
+	FString GetPhysicsServiceCharacterInputString() const;
+
+	/**
+	* Applies the character state resolved by the physics service.
+	*
+	* @param NewLocation The character's capsule center
+	* @param NewVelocity The character's velocity
+	* @param NewGroundState The Jolt ground state (0: on ground; 1: on steep
+	* ground; 2: not supported; 3: in air)
+	* @param NewGroundBodyId The body id the character stands on. INDEX_NONE
+	* if none
+	*/
+	void ApplyPhysicsServiceCharacterState(const FVector& NewLocation,
+		const FVector& NewVelocity, const int32 NewGroundState,
+		const int32 NewGroundBodyId);
+
+	/**
+	* Sets if the character is on a physics service region. If so, the
+	* physics service moves the character instead of its movement component.
+	*/
+	void SetIsOnPhysicsServiceRegion(const bool bNewIsOnPhysicsServiceRegion);
+
+	/** Getter to the character id on the physics services */
+	int32 GetPSDCharacterId() const { return PSDCharacterId; }
+
+	/** Setter to the character id on the physics services */
+	void SetPSDCharacterId(const int32 NewPSDCharacterId)
+		{ PSDCharacterId = NewPSDCharacterId; }
+
+	/** Getter to the owning character's location */
+	FVector GetPSDCharacterLocation() const;
+
+	/**
+	* Getter to if the character is standing on walkable ground on the
+	* physics service. Should be used by the animations instead of the
+	* movement component, as it does not move the character on a region
+	*/
+	UFUNCTION(BlueprintPure)
+	bool IsOnPhysicsServiceGround() const { return GroundState == 0; }
+
+	/** Getter to the body id the character stands on. INDEX_NONE if none */
+	UFUNCTION(BlueprintPure)
+	int32 GetGroundBodyId() const { return GroundBodyId; }
+
+public:
+	/** Sets default values for this component's properties */
+	UPSDCharacterComponent();
+
+protected:
+	/** Called when the game starts. Registers on the coordinator */
+	virtual void BeginPlay() override;
+
+	/** Called when the play is over. Unregisters from the coordinator */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	/** The owning character */
+	UPROPERTY()
+	class ACharacter* OwnerCharacter = nullptr;
+
+	/** The coordinator this character is registered on */
+	UPROPERTY()
+	class APSDActorsCoordinator* PSDActorsCoordinator = nullptr;
+
+	/** The character id on the physics services, given by the coordinator */
+	int32 PSDCharacterId = INDEX_NONE;
+
+	/** If the character is currently on a physics service region */
+	bool bIsOnPhysicsServiceRegion = false;
+
+	/** The last ground state received. Starts in the air */
+	int32 GroundState = 3;
+
+	/** The last body id the character stood on */
+	int32 GroundBodyId = INDEX_NONE;
+};
@@ -0,0 +1,203 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "PSDRagdollComponent.generated.h"
+
+/**
+* Called once the ragdoll is released by the physics service, either because
+* it fell asleep, its lifetime is over or its pool needed it. The owner's
+* skeletal mesh is visible again when it is called.
+*/
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnPSDRagdollReleased,
+	class UPSDRagdollComponent*, PSDRagdoll);
+
+/**
+* Simulates the owner's skeletal mesh as a ragdoll on the physics services.
+* The ragdoll type (the parts and joints) is built from the mesh's physics
+* asset and registered once on each physics service, which keeps a pool of
+* ragdolls of the type on each world. Thus, activating a ragdoll does not
+* create any body on the service.
+*
+* Once activated, the ragdoll is simulated on the region its root part is in.
+* The parts' transforms received on each step pose a poseable copy of the
+* mesh, shown in place of the skeletal mesh until the ragdoll is released.
+* The part transforms are replicated, so the clients see the same pose.
+*
+* @note The owner must have a USkeletalMeshComponent with a physics asset.
+* Only the first collision shape of each physics body is simulated
+*
+* @see APSDActorsCoordinator
+*/
+UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
+class REMOTEPHYSICSENGINESYSTEM_API UPSDRagdollComponent :
+	public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	/**
+	* Activates the ragdoll on the next step, from the mesh's current pose.
+	* Only has effect on the server.
+	*
+	* @param LinearVelocity The root part's linear velocity (cm/s)
+	* @param AngularVelocity The root part's angular velocity (rad/s)
+	*/
+	UFUNCTION(BlueprintCallable)
+	void ActivatePSDRagdoll(FVector LinearVelocity, FVector AngularVelocity);
+
+	/** Getter to if the ragdoll is being simulated on a physics service */
+	UFUNCTION(BlueprintPure)
+	bool IsPSDRagdollActive() const { return bIsPSDRagdollActive; }
+
+	/** Getter to if an activation is waiting for the next step */
+	bool HasPendingActivation() const { return bHasPendingActivation; }
+
+	/** Drops the pending activation, if any */
+	void ClearPendingActivation() { bHasPendingActivation = false; }
+
+	/**
+	* Getter to the ragdoll type name. It is the physics asset's name, so
+	* every mesh sharing the same physics asset shares the same pool
+	*/
+	FString GetPSDRagdollTypeName() const;
+
+	/**
+	* Builds the ragdoll type to register on the physics services from the
+	* physics asset's bind pose. @see FPhysicsRagdollTypeCache
+	*
+	* @return The "RegisterRagdollType" payload. Empty if the physics asset
+	* has no body that can be simulated
+	*/
+	FString GetPhysicsServiceRagdollTypeString() const;
+
+	/**
+	* Takes the pending activation as a physics service step message line and
+	* sets the ragdoll as active. The template is:
+	*
+	* "Ragdoll;RagdollId;TypeName;posX;posY;posZ;rotX;rotY;rotZ;rotW;
+	* linearVelX;linearVelY;linearVelZ;angularVelX;angularVelY;angularVelZ;
+	* Lifetime;...\n"
+	*
+	* The transform is the root part's, followed by each part's current
+	* transform relative to it.
+	*/
+	FString ConsumePhysicsServiceRagdollActivationString();
+
+	/**
+	* Applies the ragdoll state received from the physics service.
+	*
+	* @param NewRootPartTransform The root part's transform on world space
+	* @param NewPartRelativeTransforms The other parts' transforms, relative
+	* to the root part, in the ragdoll type's part order
+	*/
+	void ApplyPhysicsServiceRagdollState(const FTransform& NewRootPartTransform,
+		const TArray<FTransform>& NewPartRelativeTransforms);
+
+	/** Stops showing the ragdoll and shows the skeletal mesh again */
+	void ReleasePSDRagdoll();
+
+	/** Getter to the root part's location on world space */
+	FVector GetPSDRagdollLocation() const;
+
+	/** Getter to the ragdoll id on the physics services */
+	int32 GetPSDRagdollId() const { return PSDRagdollId; }
+
+	/** Setter to the ragdoll id on the physics services */
+	void SetPSDRagdollId(const int32 NewPSDRagdollId)
+		{ PSDRagdollId = NewPSDRagdollId; }
+
+public:
+	/** Sets default values for this component's properties */
+	UPSDRagdollComponent();
+
+	/** Replicates the ragdoll's state */
+	virtual void GetLifetimeReplicatedProps
+		(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+protected:
+	/**
+	* Called when the game starts. Finds the ragdoll parts and, on the server,
+	* registers on the coordinator
+	*/
+	virtual void BeginPlay() override;
+
+	/** Called when the play is over. Unregisters from the coordinator */
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	/**
+	* Gets the bones with a physics body, which are the ragdoll's parts. The
+	* bones are sorted by their index, so the parents come first
+	*/
+	void GatherPartBoneNames();
+
+	/** Gets a part's current transform on world space, with no scale */
+	FTransform GetPartWorldTransform(const int32 PartIndex) const;
+
+	/** Shows or hides the ragdoll in place of the skeletal mesh */
+	void SetIsPSDRagdollActive(const bool bNewIsPSDRagdollActive);
+
+	/** Poses the poseable mesh with the last part transforms */
+	void UpdateRagdollPose();
+
+	UFUNCTION()
+	void OnRep_IsPSDRagdollActive();
+
+	UFUNCTION()
+	void OnRep_PartWorldTransforms();
+
+public:
+	/** Called once the ragdoll is released */
+	UPROPERTY(BlueprintAssignable)
+	FOnPSDRagdollReleased OnPSDRagdollReleased;
+
+	/** The amount of ragdolls of this type each physics service world pools */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "PSDRagdoll",
+		meta = (ClampMin = "1"))
+	int32 PoolSize = 8;
+
+	/** The time the ragdoll is simulated before it is released (s) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "PSDRagdoll",
+		meta = (ClampMin = "0.1"))
+	float RagdollLifetime = 10.f;
+
+private:
+	/** The owner's skeletal mesh */
+	UPROPERTY()
+	class USkeletalMeshComponent* OwnerSkeletalMesh = nullptr;
+
+	/**
+	* The mesh copy posed by the physics service while the ragdoll is active.
+	* Created on the first activation and kept for the next ones
+	*/
+	UPROPERTY()
+	class UPoseableMeshComponent* RagdollPoseableMesh = nullptr;
+
+	/** The coordinator this ragdoll is registered on */
+	UPROPERTY()
+	class APSDActorsCoordinator* PSDActorsCoordinator = nullptr;
+
+	/** The bones of the ragdoll's parts, in the ragdoll type's part order */
+	TArray<FName> PartBoneNames;
+
+	/** The ragdoll id on the physics services, given by the coordinator */
+	int32 PSDRagdollId = INDEX_NONE;
+
+	/** If an activation is waiting for the next step */
+	bool bHasPendingActivation = false;
+
+	/** The root part's velocities on the pending activation */
+	FVector PendingLinearVelocity = FVector::ZeroVector;
+	FVector PendingAngularVelocity = FVector::ZeroVector;
+
+	/** If the ragdoll is being simulated on a physics service */
+	UPROPERTY(ReplicatedUsing = OnRep_IsPSDRagdollActive)
+	bool bIsPSDRagdollActive = false;
+
+	/** The parts' transforms on world space on the last physics state */
+	UPROPERTY(ReplicatedUsing = OnRep_PartWorldTransforms)
+	TArray<FTransform> PartWorldTransforms;
+};
@@ -0,0 +1,146 @@
+// 2023 Copyright Saulo Soares, Brazil. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class APSDActorBase;
+
+/**
+* Allocates the PSDActors body indices. The body index is the PSDActor's
+* "PSDActorBodyId", used as the Jolt BodyID index on every physics service.
+*
+* Indices are dense: they start at zero and released indices are recycled
+* before new ones are given, so they never go beyond the physics service's
+* max bodies and can index flat arrays on both ends.
+*
+* @see FPSDActorBodyIndexMap
+*/
+class REMOTEPHYSICSENGINESYSTEM_API FPSDBodyIndexAllocator
+{
+public:
+	/**
+	* Allocates a body index to the given PSDActor, setting its body id. If
+	* the PSDActor already has a body index from this allocator, it is kept.
+	*
+	* @param PSDActor The PSDActor to allocate the body index to
+	*
+	* @return The allocated body index. INDEX_NONE if there are no free indices
+	*/
+	int32 AllocateBodyIndex(APSDActorBase* PSDActor);
+
+	/**
+	* Releases the given PSDActor's body index, so it can be recycled. The
+	* PSDActor's body id is set to INDEX_NONE.
+	*
+	* @param PSDActor The PSDActor to release the body index from
+	*/
+	void ReleaseBodyIndex(APSDActorBase* PSDActor);
+
+	/**
+	* Getter to the PSDActor that owns a body index.
+	*
+	* @param BodyIndex The body index
+	*
+	* @return The PSDActor. Nullptr if the body index is not allocated
+	*/
+	APSDActorBase* GetPSDActor(const int32 BodyIndex) const
+	{
+		return PSDActorsByBodyIndex.IsValidIndex(BodyIndex) ?
+			PSDActorsByBodyIndex[BodyIndex] : nullptr;
+	}
+
+	/** Getter to the number of allocated body indices */
+	int32 GetNumAllocatedBodyIndices() const
+		{ return PSDActorsByBodyIndex.Num() - FreeBodyIndices.Num(); }
+
+	/** Releases every body index */
+	void Reset();
+
+public:
+	/**
+	* The max number of body indices. Should match the physics service's max
+	* bodies
+	*/
+	int32 MaxBodyIndices = 128000;
+
+private:
+	/** The PSDActor of each body index. Nullptr if the index is free */
+	TArray<APSDActorBase*> PSDActorsByBodyIndex;
+
+	/** The released body indices, recycled from the last released one */
+	TArray<int32> FreeBodyIndices;
+};
+
+/**
+* Maps body indices to PSDActors with flat arrays, replacing a TMap keyed by
+* the body id. Lookup, addition and removal are O(1).
+*
+* The PSDActors are kept packed on a dense array, so iterating over them does
+* not go through the free slots. Removing a PSDActor moves the last one to its
+* slot, so the dense order is not kept.
+*/
+class REMOTEPHYSICSENGINESYSTEM_API FPSDActorBodyIndexMap
+{
+public:
+	/**
+	* Adds a PSDActor to the map. If the body index is already on the map, its
+	* PSDActor is replaced.
+	*
+	* @param BodyIndex The PSDActor's body index
+	* @param PSDActor The PSDActor to add
+	*/
+	void Add(const int32 BodyIndex, APSDActorBase* PSDActor);
+
+	/**
+	* Removes a PSDActor from the map.
+	*
+	* @param BodyIndex The body index of the PSDActor to remove
+	*
+	* @return True if there was a PSDActor with the given body index
+	*/
+	bool Remove(const int32 BodyIndex);
+
+	/**
+	* Finds a PSDActor by its body index.
+	*
+	* @return The PSDActor. Nullptr if not on the map
+	*/
+	APSDActorBase* FindRef(const int32 BodyIndex) const
+	{
+		const int32 DenseSlot = GetDenseSlot(BodyIndex);
+		return DenseSlot != INDEX_NONE ? DensePSDActors[DenseSlot] : nullptr;
+	}
+
+	/** Checks if a body index is on the map */
+	bool Contains(const int32 BodyIndex) const
+		{ return GetDenseSlot(BodyIndex) != INDEX_NONE; }
+
+	/** Getter to the number of PSDActors on the map */
+	int32 Num() const { return DensePSDActors.Num(); }
+
+	/** Getter to the packed PSDActors on the map */
+	const TArray<APSDActorBase*>& GetPSDActors() const
+		{ return DensePSDActors; }
+
+	/** Removes every PSDActor from the map */
+	void Empty();
+
+private:
+	/** Getter to the dense slot of a body index. INDEX_NONE if not mapped */
+	int32 GetDenseSlot(const int32 BodyIndex) const
+	{
+		return DenseSlotByBodyIndex.IsValidIndex(BodyIndex) ?
+			DenseSlotByBodyIndex[BodyIndex] : INDEX_NONE;
+	}
+
+private:
+	/** The slot on the dense arrays of each body index */
+	TArray<int32> DenseSlotByBodyIndex;
+
+	/** The packed PSDActors */
+	TArray<APSDActorBase*> DensePSDActors;
+
+	/** The body index of each packed PSDActor */
+	TArray<int32> DenseBodyIndices;
+};
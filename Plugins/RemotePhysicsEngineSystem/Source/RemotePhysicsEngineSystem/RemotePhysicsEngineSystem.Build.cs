@@ -21,6 +21,7 @@ public class RemotePhysicsEngineSystem : ModuleRules
 		{
 			"CoreUObject",
 			"Engine",
+			"Landscape",
 			"Slate",
 			"SlateCore"
 		});
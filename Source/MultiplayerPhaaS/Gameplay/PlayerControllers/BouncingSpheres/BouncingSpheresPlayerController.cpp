@@ -45,6 +45,24 @@ void ABouncingSpheresPlayerController::Tick(float DeltaTime)
 		bIsBouncingSpheresSimulationActive =
 			PSDActorCoordinator.Get()->IsSimulating();
 	}
+
+	// If on the client, check if the local coordinator's lockstep simulation
+	// needs a resync. Only the server can send it
+	if (!HasAuthority() && IsLocalController())
+	{
+		if (!LocalPSDActorCoordinator.Get())
+		{
+			LocalPSDActorCoordinator = Cast<APSDActorsCoordinator_Local>
+				(UGameplayStatics::GetActorOfClass(GetWorld(),
+				APSDActorsCoordinator_Local::StaticClass()));
+		}
+
+		if (LocalPSDActorCoordinator.Get() &&
+			LocalPSDActorCoordinator->ConsumeLockstepResyncRequest())
+		{
+			Server_RequestLockstepResync();
+		}
+	}
 }
 
 void ABouncingSpheresPlayerController::OnPauseKeyPressed()
@@ -279,6 +297,26 @@ void ABouncingSpheresPlayerController::Server_ResetMap_Implementation()
 		(UGameplayStatics::GetCurrentLevelName(GetWorld()));
 }
 
+void ABouncingSpheresPlayerController::
+Server_RequestLockstepResync_Implementation()
+{
+	// Get the local coordinator on the map
+	if (!LocalPSDActorCoordinator.Get())
+	{
+		LocalPSDActorCoordinator = Cast<APSDActorsCoordinator_Local>
+			(UGameplayStatics::GetActorOfClass(GetWorld(),
+			APSDActorsCoordinator_Local::StaticClass()));
+	}
+
+	if (!LocalPSDActorCoordinator.Get())
+	{
+		return;
+	}
+
+	// Resend the lockstep snapshot to the clients
+	LocalPSDActorCoordinator->SendLockstepSnapshot();
+}
+
 void ABouncingSpheresPlayerController::Server_LoadMap_Implementation
 	(const FString& NewMap)
 {
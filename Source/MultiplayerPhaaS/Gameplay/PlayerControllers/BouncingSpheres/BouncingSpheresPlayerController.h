@@ -95,6 +95,15 @@ public:
 	UFUNCTION(BlueprintCallable, Server, Reliable)
 	void Server_LoadMap(const FString& NewMap);
 
+	/**
+	* Requests the server to resend the lockstep physics world snapshot. 
+	* Called once this client's lockstep simulation has diverged.
+	*
+	* @see APSDActorsCoordinator_Local::SendLockstepSnapshot()
+	*/
+	UFUNCTION(Server, Reliable)
+	void Server_RequestLockstepResync();
+
 public:
 	/** Called once every fame. */
 	virtual void Tick(float DeltaTime) override;
@@ -157,4 +166,7 @@ private:
 	/** The reference to the PSDActorsSpawner placed on the map */
 	UPROPERTY(BlueprintReadOnly, meta = (AllowPrivateAccess = "True"))
 	TWeakObjectPtr<class APSDActorsSpawner> PSDActorSpawner;
+
+	/** The reference to the local PSDActorsCoordinator placed on the map */
+	TWeakObjectPtr<class APSDActorsCoordinator_Local> LocalPSDActorCoordinator;
 };
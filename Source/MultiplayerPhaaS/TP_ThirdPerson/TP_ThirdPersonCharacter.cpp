@@ -7,6 +7,7 @@
 #include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/Controller.h"
 #include "GameFramework/SpringArmComponent.h"
+#include "PhysicsSimulation/Utils/Components/PSDCharacterComponent.h"
 
 ATP_ThirdPersonCharacter::ATP_ThirdPersonCharacter()
 {
@@ -55,6 +56,11 @@ ATP_ThirdPersonCharacter::ATP_ThirdPersonCharacter()
 	// Camera does not rotate relative to arm
 	FollowCamera->bUsePawnControlRotation = false; 
 
+	// Create the component that represents this character on the physics
+	// services
+	PSDCharacterComponent = CreateDefaultSubobject<UPSDCharacterComponent>
+		(TEXT("PSDCharacterComponent"));
+
 	// Note: The skeletal mesh and anim blueprint references on the 
 	// Mesh component (inherited from Character) 
 	// are set in the derived blueprint asset named MyCharacter
@@ -20,6 +20,14 @@ class ATP_ThirdPersonCharacter : public ACharacter
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, 
 		meta = (AllowPrivateAccess = "true"))
 	class UCameraComponent* FollowCamera;
+
+	/**
+	* Represents the character on the physics services, so it collides with
+	* the PSDActors while inside a physics service region
+	*/
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Physics,
+		meta = (AllowPrivateAccess = "true"))
+	class UPSDCharacterComponent* PSDCharacterComponent;
 public:
 	ATP_ThirdPersonCharacter();
 
@@ -75,4 +83,7 @@ public:
 	/** Returns FollowCamera subobject **/
 	FORCEINLINE class UCameraComponent* GetFollowCamera() const 
 		{ return FollowCamera; }
+	/** Returns PSDCharacterComponent subobject **/
+	FORCEINLINE class UPSDCharacterComponent* GetPSDCharacterComponent() const
+		{ return PSDCharacterComponent; }
 };